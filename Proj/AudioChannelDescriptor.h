@@ -37,6 +37,8 @@ namespace CvRtsp
         uint32_t SamplingFrequency;
         /// config string. Needed for AAC
         std::string ConfigString;
+        /// audio duration carried per RTP packet in milliseconds, 0 for the codec default
+        uint32_t PacketTimeMs;
 
         /**
          * @brief Constructor
@@ -44,7 +46,8 @@ namespace CvRtsp
         AudioChannelDescriptor()
             :Channels(0),
             BitsPerSample(0),
-            SamplingFrequency(0)
+            SamplingFrequency(0),
+            PacketTimeMs(0)
         {
 
         }
@@ -0,0 +1,86 @@
+///
+/// @class BatchedGroupsock
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <live555/GroupsockHelper.hh>
+
+#include "BatchedGroupsock.h"
+#include "UdpSendBatcher.h"
+#include "InterleavedTcpWriter.h"
+
+using namespace CvRtsp;
+
+BatchedGroupsock::
+BatchedGroupsock(UsageEnvironment& env, struct sockaddr_storage const& groupAddress, Port port,
+	u_int8_t ttl, UdpSendBatcher& sendBatcher, InterleavedTcpWriter& tcpWriter) :
+	Groupsock(env, groupAddress, port, ttl),
+	m_sendBatcher(sendBatcher),
+	m_tcpWriter(tcpWriter),
+	m_interleavedSocketNum(-1),
+	m_interleavedChannelId(0)
+{
+}
+
+BatchedGroupsock::
+~BatchedGroupsock()
+{
+	if (m_sendBatcher.HasPending())
+	{
+		m_sendBatcher.Flush();
+	}
+
+	if (m_interleavedSocketNum >= 0)
+	{
+		m_tcpWriter.Detach(m_interleavedSocketNum);
+	}
+}
+
+void
+BatchedGroupsock::
+SetInterleavedOutput(int socketNum, unsigned char channelId)
+{
+	m_interleavedChannelId = channelId;
+
+	// Called again when a paused stream is played.
+	if (socketNum == m_interleavedSocketNum)
+	{
+		return;
+	}
+
+	if (m_interleavedSocketNum >= 0)
+	{
+		m_tcpWriter.Detach(m_interleavedSocketNum);
+	}
+	m_interleavedSocketNum = socketNum;
+	m_tcpWriter.Attach(socketNum);
+}
+
+Boolean
+BatchedGroupsock::
+output(UsageEnvironment& env, unsigned char* buffer, unsigned bufferSize)
+{
+	if (m_interleavedSocketNum >= 0)
+	{
+		return m_tcpWriter.Queue(m_interleavedSocketNum, m_interleavedChannelId, buffer, bufferSize) ? True : False;
+	}
+
+	for (auto destination = fDests; destination != nullptr; destination = destination->fNext)
+	{
+		// Multicast needs the TTL handling of Groupsock.
+		if (IsMulticastAddress(destination->fGroupEId.groupAddress()))
+		{
+			return Groupsock::output(env, buffer, bufferSize);
+		}
+	}
+
+	// The group address of a destination record holds the destination port as well.
+	for (auto destination = fDests; destination != nullptr; destination = destination->fNext)
+	{
+		m_sendBatcher.Add(socketNum(), destination->fGroupEId.groupAddress(), buffer, bufferSize);
+	}
+
+	return True;
+}
@@ -0,0 +1,77 @@
+///
+/// @class BatchedGroupsock
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <live555/Groupsock.hh>
+
+namespace CvRtsp
+{
+	/// Forward declarations
+	class UdpSendBatcher;
+	class InterleavedTcpWriter;
+
+	///
+	/// Groupsock that queues unicast datagrams in the UdpSendBatcher of the event loop instead of
+	/// sending each one with its own sendto(). The batcher is flushed by LiveSourceTaskScheduler0
+	/// before the event loop blocks, so all packets sent to a client while the loop was busy, e.g.
+	/// the packets of a video frame, leave in one system call.
+	///
+	/// Multicast destinations are sent right away by Groupsock.
+	///
+	/// For RTP-over-TCP clients the groupsock has no destinations. Once SetInterleavedOutput() has
+	/// been called it queues the packets on the client's RTSP connection in the InterleavedTcpWriter
+	/// of the event loop instead, the RTP sink or RTCP instance must no longer write to the
+	/// connection itself.
+	class BatchedGroupsock : public Groupsock
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param[in] env			Usage environment.
+		/// @param[in] groupAddress	Address the socket is bound to.
+		/// @param[in] port			Port the socket is bound to.
+		/// @param[in] ttl			Time to live of multicast datagrams.
+		/// @param[in] sendBatcher	Batcher of the event loop, must outlive the groupsock.
+		/// @param[in] tcpWriter	Interleaved writer of the event loop, must outlive the groupsock.
+		BatchedGroupsock(UsageEnvironment& env, struct sockaddr_storage const& groupAddress, Port port,
+			u_int8_t ttl, UdpSendBatcher& sendBatcher, InterleavedTcpWriter& tcpWriter);
+
+		///
+		/// Destructor, sends the datagrams queued before the socket is closed.
+		~BatchedGroupsock() override;
+
+		///
+		/// Queue the packets on an RTSP connection as interleaved frames.
+		///
+		/// @param[in] socketNum	RTSP connection socket.
+		/// @param[in] channelId	Interleaved channel id.
+		void SetInterleavedOutput(int socketNum, unsigned char channelId);
+
+		///
+		/// Overridden from Groupsock: queues the datagram for all unicast destinations.
+		///
+		/// @param[in] env			Usage environment.
+		/// @param[in] buffer		Datagram.
+		/// @param[in] bufferSize	Datagram size.
+		///
+		/// @return False if an interleaved packet has been dropped, send errors are not reported back.
+		Boolean output(UsageEnvironment& env, unsigned char* buffer, unsigned bufferSize) override;
+
+	private:
+		/// Batcher of the event loop.
+		UdpSendBatcher& m_sendBatcher;
+
+		/// Interleaved writer of the event loop.
+		InterleavedTcpWriter& m_tcpWriter;
+
+		/// RTSP connection socket, -1 if none.
+		int m_interleavedSocketNum;
+
+		/// Interleaved channel id.
+		unsigned char m_interleavedChannelId;
+	};
+}
@@ -0,0 +1,142 @@
+///
+/// @class AmrFrameBench
+///
+/// Created 10/19/2026
+///
+/// AMR frames checked by LiveAMRAudioDeviceSource before they are queued:
+/// - amr-frames: for every AMR and AMR-WB frame type a frame with the speech size of its type
+///   (RFC 4867, sec. 4.3.2) must be accepted, frames one byte short or long of it, frames of the
+///   invalid types and frames with padding bits set must be rejected. Then the check is timed over
+///   a mix of valid and malformed frames.
+///
+#include "pch.h"
+
+#include <vector>
+
+#include "Bench.h"
+#include "LiveAMRAudioDeviceSource.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			/// Marks the frame types without a speech size.
+			const int InvalidType = -1;
+
+			/// Speech bytes per frame type, RFC 4867, sec. 3.6 and table 1a of 3GPP TS 26.201.
+			const int AmrSpeechSizes[16] = { 12, 13, 15, 17, 19, 20, 26, 31, 5,
+				InvalidType, InvalidType, InvalidType, InvalidType, InvalidType, InvalidType, 0 };
+			const int AmrWbSpeechSizes[16] = { 17, 23, 32, 36, 40, 46, 50, 58, 60, 5,
+				InvalidType, InvalidType, InvalidType, InvalidType, 0, 0 };
+
+			/// Quality indicator bit of the frame header, set in the frames sent.
+			const BYTE QualityBit = 0x04;
+
+			std::vector<BYTE> createFrame(int frameType, size_t speechSize)
+			{
+				std::vector<BYTE> frame(speechSize + 1, 0x5a);
+				frame[0] = static_cast<BYTE>((frameType << 3) | QualityBit);
+				return frame;
+			}
+
+			///
+			/// Check a frame against the expected outcome.
+			///
+			/// @return Description of the mismatch, empty if the check agrees.
+			std::string checkFrame(const std::vector<BYTE>& frame, bool isWideband, bool isExpectedValid, const std::string& what)
+			{
+				if (LiveAMRAudioDeviceSource::IsValidFrame(frame.data(), static_cast<unsigned>(frame.size()), isWideband) == isExpectedValid)
+				{
+					return std::string();
+				}
+				return std::string(isWideband ? "AMR-WB " : "AMR ") + what + " of " + std::to_string(frame.size()) + " bytes "
+					+ (isExpectedValid ? "rejected" : "accepted");
+			}
+
+			///
+			/// Check every frame type with matching and mismatched speech sizes.
+			///
+			/// @param[out] frames Receives the frames checked, with whether they are valid.
+			///
+			/// @return Mismatches.
+			std::vector<std::string> checkFrameTypes(bool isWideband, std::vector<std::pair<std::vector<BYTE>, bool>>& frames)
+			{
+				const auto speechSizes = isWideband ? AmrWbSpeechSizes : AmrSpeechSizes;
+				std::vector<std::string> errors;
+				for (auto frameType = 0; frameType < 16; ++frameType)
+				{
+					const auto speechSize = speechSizes[frameType];
+					if (speechSize == InvalidType)
+					{
+						frames.emplace_back(createFrame(frameType, 5), false);
+					}
+					else
+					{
+						frames.emplace_back(createFrame(frameType, static_cast<size_t>(speechSize)), true);
+						if (speechSize > 0)
+						{
+							frames.emplace_back(createFrame(frameType, static_cast<size_t>(speechSize - 1)), false);
+						}
+						frames.emplace_back(createFrame(frameType, static_cast<size_t>(speechSize + 1)), false);
+
+						// Padding bits set.
+						auto padded = createFrame(frameType, static_cast<size_t>(speechSize));
+						padded[0] |= 0x01;
+						frames.emplace_back(padded, false);
+					}
+				}
+
+				for (const auto& frame : frames)
+				{
+					const auto error = checkFrame(frame.first, isWideband, frame.second, "frame type "
+						+ std::to_string((frame.first[0] & 0x78) >> 3));
+					if (!error.empty())
+					{
+						errors.push_back(error);
+					}
+				}
+				return errors;
+			}
+		}
+
+		int RunAmrFrames(const Arguments& arguments)
+		{
+			const std::string name = "amr-frames";
+			const auto rounds = GetArgument(arguments, 0, 100000);
+
+			auto result = 0;
+			std::vector<std::pair<std::vector<BYTE>, bool>> amrFrames;
+			std::vector<std::pair<std::vector<BYTE>, bool>> amrWbFrames;
+			auto errors = checkFrameTypes(false, amrFrames);
+			const auto amrWbErrors = checkFrameTypes(true, amrWbFrames);
+			errors.insert(errors.end(), amrWbErrors.begin(), amrWbErrors.end());
+			for (const auto& error : errors)
+			{
+				result = Fail(name, error);
+			}
+
+			uint64_t validCount = 0;
+			Stopwatch stopwatch;
+			for (uint64_t round = 0; round < rounds; ++round)
+			{
+				for (const auto& frame : amrFrames)
+				{
+					validCount += LiveAMRAudioDeviceSource::IsValidFrame(frame.first.data(),
+						static_cast<unsigned>(frame.first.size()), false) ? 1 : 0;
+				}
+				for (const auto& frame : amrWbFrames)
+				{
+					validCount += LiveAMRAudioDeviceSource::IsValidFrame(frame.first.data(),
+						static_cast<unsigned>(frame.first.size()), true) ? 1 : 0;
+				}
+			}
+			const auto checkedCount = rounds * (amrFrames.size() + amrWbFrames.size());
+			PrintResult(name + " IsValidFrame", checkedCount, stopwatch.GetSeconds());
+			printf("%-48s %llu of %llu frames valid\n", "", static_cast<unsigned long long>(validCount),
+				static_cast<unsigned long long>(checkedCount));
+			return result;
+		}
+	}
+}
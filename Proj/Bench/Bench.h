@@ -0,0 +1,96 @@
+///
+/// @class Bench
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		///
+		/// Arguments of a bench run: the command line after the bench name.
+		using Arguments = std::vector<std::string>;
+
+		///
+		/// Entry point of a bench.
+		///
+		/// @param[in] arguments Arguments of the run.
+		///
+		/// @return 0 on success, a failed check otherwise.
+		using BenchFunction = int (*)(const Arguments& arguments);
+
+		///
+		/// Get a numeric argument.
+		///
+		/// @param[in] arguments	Arguments of the run.
+		/// @param[in] index		Position of the argument.
+		/// @param[in] defaultValue	Value if the argument is missing.
+		///
+		/// @return The argument or the default value.
+		inline uint64_t GetArgument(const Arguments& arguments, size_t index, uint64_t defaultValue)
+		{
+			return index < arguments.size() ? std::stoull(arguments[index]) : defaultValue;
+		}
+
+		///
+		/// Measures the wall clock time since construction or the last Restart().
+		class Stopwatch
+		{
+		public:
+			Stopwatch() :
+				m_start(std::chrono::steady_clock::now())
+			{
+			}
+
+			void Restart()
+			{
+				m_start = std::chrono::steady_clock::now();
+			}
+
+			///
+			/// @return Seconds elapsed.
+			double GetSeconds() const
+			{
+				return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+			}
+
+		private:
+			std::chrono::steady_clock::time_point m_start;
+		};
+
+		///
+		/// Print one result line: name, operations, time, rate and time per operation.
+		///
+		/// @param[in] name			Name of the measurement.
+		/// @param[in] operations	Operations done.
+		/// @param[in] seconds		Time taken.
+		inline void PrintResult(const std::string& name, uint64_t operations, double seconds)
+		{
+			const auto rate = seconds > 0.0 ? static_cast<double>(operations) / seconds : 0.0;
+			const auto nanoSeconds = operations > 0 ? seconds * 1e9 / static_cast<double>(operations) : 0.0;
+			printf("%-48s %12llu ops %10.3f s %14.0f ops/s %10.1f ns/op\n", name.c_str(),
+				static_cast<unsigned long long>(operations), seconds, rate, nanoSeconds);
+		}
+
+		///
+		/// Report a failed check.
+		///
+		/// @param[in] name		Name of the bench.
+		/// @param[in] message	What failed.
+		///
+		/// @return 1, to be returned by the bench.
+		inline int Fail(const std::string& name, const std::string& message)
+		{
+			fprintf(stderr, "%s: FAILED: %s\n", name.c_str(), message.c_str());
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,104 @@
+///
+/// @class BenchMain
+///
+/// Created 10/18/2026
+///
+/// Console runner for the benchmarks and stress runs of FiltersMediaSources.
+///
+/// Usage: FiltersMediaSourcesBench <bench>|all [arguments...]
+///
+/// Debug builds use AddressSanitizer, the stress runs are meant to be run there as well.
+///
+#include <cstdio>
+#include <cstring>
+
+#include "Bench.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		int RunCameraFanOut(const Arguments& arguments);
+		int RunShardFanOut(const Arguments& arguments);
+		int RunShmIngest(const Arguments& arguments);
+		int RunRtspShards(const Arguments& arguments);
+		int RunG711(const Arguments& arguments);
+		int RunTimerWheel(const Arguments& arguments);
+		int RunTimerWheelModel(const Arguments& arguments);
+		int RunSocketPoller(const Arguments& arguments);
+		int RunUdpBatch(const Arguments& arguments);
+		int RunMediaRing(const Arguments& arguments);
+		int RunLiveSources(const Arguments& arguments);
+		int RunOnDemandCatalog(const Arguments& arguments);
+		int RunAmrFrames(const Arguments& arguments);
+	}
+}
+
+using namespace CvRtsp::Bench;
+
+namespace
+{
+	struct BenchEntry
+	{
+		const char* Name;
+		const char* Description;
+		BenchFunction Function;
+	};
+
+	const BenchEntry Benches[] =
+	{
+		{ "camera-fanout", "[samples] two channel names of one camera consumed in parallel", RunCameraFanOut },
+		{ "shard-fanout", "[samples] [shards] one channel dequeued by every shard in parallel", RunShardFanOut },
+		{ "shm-ingest", "[frames] [frame size] shared memory ring throughput and corrupt record check", RunShmIngest },
+		{ "rtsp-shards", "[clients] [requests] [shards] [port] loopback RTSP requests, one shard against several", RunRtspShards },
+		{ "g711", "[samples] [frame size] G.711 conversion checked against and timed with the reference encoder", RunG711 },
+		{ "timer-wheel", "[timers] [rounds] timer operations of the TimerWheel against live555's DelayQueue", RunTimerWheel },
+		{ "timer-wheel-model", "[steps] [seed] random timer operations checked against a reference model", RunTimerWheelModel },
+		{ "socket-poller", "[idle sockets] [active sockets] [rounds] event loop steps of the poller against select()", RunSocketPoller },
+		{ "udp-batch", "[clients] [frames] [packets per frame] loopback RTP send calls of Groupsock against BatchedGroupsock", RunUdpBatch },
+		{ "media-ring", "[samples] [capacity] producer to consumer samples of MediaSampleRing against the TBB queue", RunMediaRing },
+		{ "live-sources", "[channels] [clients per channel] [frames] [frame size] [port] loopback H.264 delivery with 1 to 32 TBB threads", RunLiveSources },
+		{ "on-demand-catalog", "[channels] [samples] samples pushed into on-demand channels no client asked for are not queued", RunOnDemandCatalog },
+		{ "amr-frames", "[rounds] AMR frames checked against the speech size of their frame type", RunAmrFrames },
+	};
+
+	void printUsage()
+	{
+		printf("Usage: FiltersMediaSourcesBench <bench>|all [arguments...]\n\n");
+		for (const auto& bench : Benches)
+		{
+			printf("  %-24s %s\n", bench.Name, bench.Description);
+		}
+	}
+}
+
+int
+main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printUsage();
+		return 2;
+	}
+
+	const Arguments arguments(argv + 2, argv + argc);
+	const auto isAll = strcmp(argv[1], "all") == 0;
+	auto isFound = false;
+	auto result = 0;
+	for (const auto& bench : Benches)
+	{
+		if (isAll || strcmp(argv[1], bench.Name) == 0)
+		{
+			isFound = true;
+			printf("== %s\n", bench.Name);
+			result |= bench.Function(isAll ? Arguments() : arguments);
+		}
+	}
+
+	if (!isFound)
+	{
+		printUsage();
+		return 2;
+	}
+	return result;
+}
@@ -0,0 +1,194 @@
+///
+/// @class CameraFanOutBench
+///
+/// Created 10/18/2026
+///
+/// Samples shared by reference between several queues, consumed in parallel the way
+/// LiveSourceTaskScheduler0::processLiveSources() does:
+/// - camera-fanout: two channel names of one camera fed by a single CameraSourceRegistry source.
+/// - shard-fanout: one channel of a ShardedChannelRegistry, every shard dequeues the same samples.
+///
+/// The consumers must only read the samples: run in a sanitizer build (Debug, or -fsanitize=thread)
+/// to catch a consumer that writes to a shared sample.
+///
+#include "pch.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include <tbb/parallel_for_each.h>
+
+#include "Bench.h"
+#include "CameraSourceRegistry.h"
+#include "DeficitRoundRobinChannel.h"
+#include "PacketManagerMediaChannel.h"
+#include "ShardedChannelRegistry.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			const unsigned CameraId = 7;
+			const uint32_t VideoSourceId = 0;
+			const char* const SourceName = "camera-7";
+			const size_t SampleSize = 1400;
+			const size_t BatchSize = 32;
+
+			struct Consumer
+			{
+				std::string Name;
+				std::function<size_t(std::shared_ptr<MediaSample>*, size_t)> GetMediaBatch;
+				uint64_t ReceivedSamples = 0;
+				uint64_t CorruptSamples = 0;
+				DeficitRoundRobinChannel Scheduler;
+				std::shared_ptr<MediaSample> Batch[BatchSize];
+			};
+
+			///
+			/// Read-only checks of a sample as produced.
+			bool isIntact(const MediaSample& mediaSample)
+			{
+				const auto data = mediaSample.GetDataBuffer().Data();
+				return mediaSample.GetSize() == static_cast<int>(SampleSize)
+					&& mediaSample.GetSourceId() == CameraId
+					&& mediaSample.GetChannelName() == SourceName
+					&& mediaSample.GetArrivalTime() != std::chrono::steady_clock::time_point()
+					&& data[0] == data[SampleSize - 1];
+			}
+
+			boost::uuids::uuid makeChannelId(BYTE index)
+			{
+				boost::uuids::uuid channelId = {};
+				channelId.data[0] = index;
+				return channelId;
+			}
+
+			///
+			/// Add samples to the source on a producer thread while the consumers dequeue in parallel.
+			int runSharedConsumers(const std::string& name, MediaChannel& source, std::vector<Consumer>& consumers,
+				uint64_t sampleCount)
+			{
+				std::atomic<bool> isProducing(true);
+				std::thread producer([&]()
+					{
+						std::vector<BYTE> payload(SampleSize);
+						for (uint64_t i = 0; i < sampleCount; ++i)
+						{
+							std::fill(payload.begin(), payload.end(), static_cast<BYTE>(i));
+							source.AddVideoMediaSample(MediaSample::CreateMediaSample(payload.data(),
+								static_cast<int>(SampleSize), static_cast<double>(i), true, SourceName, CameraId));
+						}
+						isProducing = false;
+					});
+
+				Stopwatch stopwatch;
+				auto isDrained = false;
+				while (!isDrained)
+				{
+					const auto isLastPass = !isProducing;
+					std::atomic<size_t> dequeuedSamples(0);
+					tbb::parallel_for_each(consumers.begin(), consumers.end(), [&](Consumer& consumer)
+						{
+							const auto count = consumer.GetMediaBatch(consumer.Batch, BatchSize);
+							for (size_t i = 0; i < count; ++i)
+							{
+								consumer.Scheduler.OnDequeued(*consumer.Batch[i]);
+								if (!isIntact(*consumer.Batch[i]))
+								{
+									++consumer.CorruptSamples;
+								}
+								consumer.Batch[i].reset();
+							}
+							consumer.ReceivedSamples += count;
+							dequeuedSamples += count;
+						});
+					isDrained = isLastPass && dequeuedSamples == 0;
+				}
+				const auto seconds = stopwatch.GetSeconds();
+				producer.join();
+
+				auto result = 0;
+				for (const auto& consumer : consumers)
+				{
+					const auto& schedulingDelay = consumer.Scheduler.GetSchedulingDelayHistogram();
+					PrintResult(name + " " + consumer.Name, consumer.ReceivedSamples, seconds);
+					printf("%-48s p50 %llu us, p99 %llu us, max %llu us since ingest\n", "",
+						static_cast<unsigned long long>(schedulingDelay.GetPercentile(50.0)),
+						static_cast<unsigned long long>(schedulingDelay.GetPercentile(99.0)),
+						static_cast<unsigned long long>(schedulingDelay.GetMaxDelay()));
+					if (consumer.CorruptSamples > 0)
+					{
+						result = Fail(name, std::to_string(consumer.CorruptSamples) + " samples modified while shared");
+					}
+				}
+				return result;
+			}
+		}
+
+		int RunCameraFanOut(const Arguments& arguments)
+		{
+			const auto sampleCount = GetArgument(arguments, 0, 200000);
+
+			const std::shared_ptr<PacketManagerMediaChannel> channels[] =
+			{
+				std::make_shared<PacketManagerMediaChannel>(makeChannelId(1), "camera-7-alias"),
+				std::make_shared<PacketManagerMediaChannel>(makeChannelId(2), "camera-7-tenant"),
+			};
+
+			CameraSourceRegistry registry;
+			std::vector<Consumer> consumers(2);
+			for (size_t i = 0; i < consumers.size(); ++i)
+			{
+				const auto channel = channels[i];
+				consumers[i].Name = i == 0 ? "camera-7-alias" : "camera-7-tenant";
+				consumers[i].GetMediaBatch = [channel](std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount)
+					{
+						return channel->GetVideoBatch(mediaSamples, maxCount);
+					};
+				registry.Subscribe(CameraId, channel);
+			}
+
+			const auto result = runSharedConsumers("camera-fanout", *registry.GetCameraSource(CameraId), consumers, sampleCount);
+
+			for (const auto& channel : channels)
+			{
+				registry.Unsubscribe(CameraId, channel);
+			}
+			return result;
+		}
+
+		int RunShardFanOut(const Arguments& arguments)
+		{
+			const auto sampleCount = GetArgument(arguments, 0, 200000);
+			const auto shardCount = static_cast<unsigned>(GetArgument(arguments, 1, 4));
+
+			const auto channelId = makeChannelId(1);
+			const std::string channelName = "camera-7";
+			ShardedChannelRegistry registry(shardCount);
+			const auto source = registry.AddChannel(channelId, channelName, VideoSourceId, UINT_MAX);
+
+			std::vector<Consumer> consumers(shardCount);
+			for (unsigned shardIndex = 0; shardIndex < shardCount; ++shardIndex)
+			{
+				auto& shard = registry.GetShard(shardIndex);
+
+				// One client per shard, shards without watchers are skipped by the fan-out.
+				shard.SetWatcherCount(channelId, channelName, VideoSourceId, 1);
+				consumers[shardIndex].Name = "shard-" + std::to_string(shardIndex);
+				consumers[shardIndex].GetMediaBatch = [&shard, channelId, channelName](std::shared_ptr<MediaSample>* mediaSamples,
+					size_t maxCount)
+					{
+						return shard.GetMediaBatch(channelId, channelName, VideoSourceId, mediaSamples, maxCount);
+					};
+			}
+
+			const auto result = runSharedConsumers("shard-fanout", *source, consumers, sampleCount);
+
+			registry.RemoveChannel(channelId, channelName);
+			return result;
+		}
+	}
+}
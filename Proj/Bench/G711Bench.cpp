@@ -0,0 +1,203 @@
+///
+/// @class G711Bench
+///
+/// Created 10/18/2026
+///
+/// Linear PCM to G.711 conversion of G711Encoder:
+/// - g711: checks the mu-law and A-law output against the reference encoder (the public domain
+///   g711.c of Sun Microsystems) for every 16 bit sample, then compares the throughput of the
+///   vectorized conversion with the reference, one 20 ms frame of 8 kHz audio at a time.
+///
+#include "pch.h"
+
+#include <vector>
+
+#include "Bench.h"
+#include "G711Encoder.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			/// Samples of a 20 ms frame at 8 kHz.
+			const size_t DefaultFrameSize = 160;
+
+			const int ALawSegmentEnds[8] = { 0x1f, 0x3f, 0x7f, 0xff, 0x1ff, 0x3ff, 0x7ff, 0xfff };
+			const int MuLawSegmentEnds[8] = { 0x3f, 0x7f, 0xff, 0x1ff, 0x3ff, 0x7ff, 0xfff, 0x1fff };
+
+			int findSegment(int value, const int* segmentEnds)
+			{
+				for (auto segment = 0; segment < 8; ++segment)
+				{
+					if (value <= segmentEnds[segment])
+					{
+						return segment;
+					}
+				}
+				return 8;
+			}
+
+			///
+			/// Reference mu-law encoder, linear2ulaw() of g711.c.
+			BYTE referenceMuLaw(int16_t sample)
+			{
+				int value = sample >> 2;
+				int mask = 0xff;
+				if (value < 0)
+				{
+					value = -value;
+					mask = 0x7f;
+				}
+				if (value > 8159)
+				{
+					value = 8159;
+				}
+				value += 0x84 >> 2;
+
+				const auto segment = findSegment(value, MuLawSegmentEnds);
+				if (segment >= 8)
+				{
+					return static_cast<BYTE>(0x7f ^ mask);
+				}
+				return static_cast<BYTE>(((segment << 4) | ((value >> (segment + 1)) & 0x0f)) ^ mask);
+			}
+
+			///
+			/// Reference A-law encoder, linear2alaw() of g711.c.
+			BYTE referenceALaw(int16_t sample)
+			{
+				int value = sample >> 3;
+				int mask = 0xd5;
+				if (value < 0)
+				{
+					value = -value - 1;
+					mask = 0x55;
+				}
+
+				const auto segment = findSegment(value, ALawSegmentEnds);
+				if (segment >= 8)
+				{
+					return static_cast<BYTE>(0x7f ^ mask);
+				}
+				const auto step = segment < 2 ? (value >> 1) & 0x0f : (value >> segment) & 0x0f;
+				return static_cast<BYTE>(((segment << 4) | step) ^ mask);
+			}
+
+			///
+			/// Encode every 16 bit sample, plus a few more so that the scalar tail is used too.
+			///
+			/// @return Samples that differ from the reference.
+			size_t checkAllSamples(void (*encode)(const int16_t*, BYTE*, size_t), BYTE (*reference)(int16_t))
+			{
+				std::vector<int16_t> pcm(65536 + 7);
+				for (size_t i = 0; i < pcm.size(); ++i)
+				{
+					pcm[i] = static_cast<int16_t>(static_cast<int>(i & 0xffff) - 32768);
+				}
+
+				// Unaligned input and output, as samples are in a media sample after a header.
+				std::vector<BYTE> encoded(pcm.size() + 1);
+				encode(pcm.data() + 1, encoded.data() + 1, pcm.size() - 1);
+
+				size_t mismatchCount = 0;
+				for (size_t i = 1; i < pcm.size(); ++i)
+				{
+					if (encoded[i] != reference(pcm[i]))
+					{
+						++mismatchCount;
+					}
+				}
+				return mismatchCount;
+			}
+
+			///
+			/// Encode the same input frame by frame.
+			///
+			/// @return Seconds taken.
+			template<typename Encode>
+			double encodeFrames(const std::vector<int16_t>& pcm, std::vector<BYTE>& encoded, size_t frameSize, Encode encode)
+			{
+				Stopwatch stopwatch;
+				for (size_t offset = 0; offset + frameSize <= pcm.size(); offset += frameSize)
+				{
+					encode(pcm.data() + offset, encoded.data() + offset, frameSize);
+				}
+				return stopwatch.GetSeconds();
+			}
+
+			///
+			/// Time the reference and the vectorized encoder on the same input.
+			///
+			/// @return Samples encoded differently by the two.
+			size_t compareThroughput(const std::string& name, const std::vector<int16_t>& pcm, size_t frameSize,
+				void (*encode)(const int16_t*, BYTE*, size_t), BYTE (*reference)(int16_t))
+			{
+				std::vector<BYTE> referenceEncoded(pcm.size());
+				std::vector<BYTE> encoded(pcm.size());
+				const auto sampleCount = pcm.size() / frameSize * frameSize;
+
+				const auto referenceSeconds = encodeFrames(pcm, referenceEncoded, frameSize,
+					[reference](const int16_t* frame, BYTE* output, size_t size)
+					{
+						for (size_t i = 0; i < size; ++i)
+						{
+							output[i] = reference(frame[i]);
+						}
+					});
+				PrintResult(name + " reference samples", sampleCount, referenceSeconds);
+
+				const auto seconds = encodeFrames(pcm, encoded, frameSize, encode);
+				PrintResult(name + " G711Encoder samples", sampleCount, seconds);
+				printf("%-48s %.1fx the samples per second of the reference\n", "",
+					seconds > 0.0 ? referenceSeconds / seconds : 0.0);
+
+				size_t mismatchCount = 0;
+				for (size_t i = 0; i < sampleCount; ++i)
+				{
+					if (encoded[i] != referenceEncoded[i])
+					{
+						++mismatchCount;
+					}
+				}
+				return mismatchCount;
+			}
+		}
+
+		int RunG711(const Arguments& arguments)
+		{
+			const std::string name = "g711";
+			const auto sampleCount = static_cast<size_t>(GetArgument(arguments, 0, 64 * 1024 * 1024));
+			const auto frameSize = static_cast<size_t>(GetArgument(arguments, 1, DefaultFrameSize));
+			if (frameSize == 0 || sampleCount < frameSize)
+			{
+				return Fail(name, "at least one frame of samples is needed");
+			}
+
+			auto result = 0;
+			const auto muLawMismatches = checkAllSamples(&G711Encoder::EncodeMuLaw, &referenceMuLaw);
+			const auto aLawMismatches = checkAllSamples(&G711Encoder::EncodeALaw, &referenceALaw);
+			if (muLawMismatches > 0 || aLawMismatches > 0)
+			{
+				result = Fail(name, std::to_string(muLawMismatches) + " mu-law and " + std::to_string(aLawMismatches)
+					+ " A-law samples differ from the reference");
+			}
+
+			// Spread over the whole range, so that every segment is hit.
+			std::vector<int16_t> pcm(sampleCount);
+			for (size_t i = 0; i < pcm.size(); ++i)
+			{
+				pcm[i] = static_cast<int16_t>((i * 7919) & 0xffff);
+			}
+
+			const auto timedMismatches = compareThroughput(name + " mu-law", pcm, frameSize, &G711Encoder::EncodeMuLaw, &referenceMuLaw)
+				+ compareThroughput(name + " A-law", pcm, frameSize, &G711Encoder::EncodeALaw, &referenceALaw);
+			if (timedMismatches > 0)
+			{
+				result = Fail(name, "timed output differs from the reference");
+			}
+			return result;
+		}
+	}
+}
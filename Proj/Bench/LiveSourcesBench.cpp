@@ -0,0 +1,475 @@
+///
+/// @class LiveSourcesBench
+///
+/// Created 10/18/2026
+///
+/// Scaling of LiveSourceTaskScheduler0::processLiveSources() with the worker threads of TBB:
+/// - live-sources: a single shard serves H.264 channels to RTSP clients over loopback, the RTP
+///   packets interleaved in the RTSP connection. Once every client plays, a backlog of frames is
+///   added to every channel and the time until every client has received all of them is taken,
+///   with TBB limited to 1, 8, 16 and 32 threads (up to the number of cores). The prepare stage
+///   (filtering, splitting and packetizing per subsession) runs on that many threads, the deliver
+///   stage stays on the event loop thread. The clients check the RTP sequence numbers, so that a
+///   speedup cannot come from lost packets.
+///
+#include "pch.h"
+
+#include <atomic>
+#include <climits>
+#include <thread>
+
+#include <tbb/global_control.h>
+
+#include "Bench.h"
+#include "ShardedRtspServer.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			const unsigned short DefaultPort = 18564;
+
+			/// Thread counts measured, those above the number of cores are skipped and the number of
+			/// cores is measured as well if it is below the largest.
+			const unsigned ThreadCounts[] = { 1, 8, 16, 32 };
+			const unsigned MaxThreadCount = 32;
+
+			/// Frames per channel that fit the channel queue below its soft capacity, three quarters
+			/// of the 10240 samples of a PacketManagerMediaChannel. A speedup must not come from
+			/// evicted frames.
+			const uint64_t MaxFrameCount = 7680;
+
+			/// A keyframe every second at 30 fps.
+			const uint64_t KeyFrameInterval = 30;
+			const double FrameDurationMilliSec = 1000.0 / 30.0;
+
+			/// Longest wait for a response or a packet, and for the channels to be watched.
+			const DWORD ReceiveTimeoutMilliSec = 5000;
+
+			/// Parameter sets of the channels: base64 for the SDP, raw in front of every keyframe.
+			const char* const SpropSps = "Z0IAH5WoFAFuQA==";
+			const char* const SpropPps = "aM48gA==";
+			const BYTE Sps[] = { 0x67, 0x42, 0x00, 0x1f, 0x95, 0xa8, 0x14, 0x01, 0x6e, 0x40 };
+			const BYTE Pps[] = { 0x68, 0xce, 0x3c, 0x80 };
+			const BYTE StartCode[] = { 0x00, 0x00, 0x00, 0x01 };
+
+			/// What a client received.
+			struct ClientResult
+			{
+				uint64_t FrameCount = 0;
+				uint64_t PacketCount = 0;
+				uint64_t SequenceErrorCount = 0;
+				std::string Error;
+			};
+
+			///
+			/// RTSP client that plays one stream with RTP interleaved in the RTSP connection.
+			class RtspClient
+			{
+			public:
+				RtspClient() :
+					m_socket(INVALID_SOCKET),
+					m_offset(0),
+					m_sequence(0)
+				{
+				}
+
+				~RtspClient()
+				{
+					if (m_socket != INVALID_SOCKET)
+					{
+						closesocket(m_socket);
+					}
+				}
+
+				///
+				/// Connect and set up the stream up to PLAY.
+				///
+				/// @return Empty on success, what failed otherwise.
+				std::string Play(unsigned short port, const std::string& streamName)
+				{
+					m_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+					if (m_socket == INVALID_SOCKET)
+					{
+						return "unable to open client socket";
+					}
+
+					const auto timeout = ReceiveTimeoutMilliSec;
+					setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+					struct sockaddr_in address = {};
+					address.sin_family = AF_INET;
+					address.sin_port = htons(port);
+					address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+					if (connect(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+					{
+						return "unable to connect";
+					}
+
+					const auto url = "rtsp://127.0.0.1:" + std::to_string(port) + "/" + streamName;
+					std::string response;
+					if (!request("DESCRIBE", url, "Accept: application/sdp\r\n", response))
+					{
+						return "DESCRIBE " + url + " failed";
+					}
+					if (!request("SETUP", url + "/track1", "Transport: RTP/AVP/TCP;unicast;interleaved=0-1\r\n", response))
+					{
+						return "SETUP " + url + "/track1 failed";
+					}
+
+					const auto session = getHeader(response, "Session:");
+					if (session.empty() || !request("PLAY", url, "Session: " + session + "\r\nRange: npt=0.000-\r\n", response))
+					{
+						return "PLAY " + url + " failed";
+					}
+					return std::string();
+				}
+
+				///
+				/// Read the interleaved RTP packets until a number of frames, i.e. of RTP timestamps,
+				/// has been received.
+				void ReceiveFrames(uint64_t frameCount, ClientResult& result)
+				{
+					auto hasPacket = false;
+					uint16_t lastSequence = 0;
+					uint32_t lastTimestamp = 0;
+					while (result.FrameCount < frameCount)
+					{
+						if (!fill(4))
+						{
+							result.Error = "stream ended after " + std::to_string(result.FrameCount) + " frames";
+							return;
+						}
+
+						const auto header = reinterpret_cast<const BYTE*>(m_received.data() + m_offset);
+						if (header[0] != '$')
+						{
+							result.Error = "unexpected data in the interleaved stream";
+							return;
+						}
+
+						const size_t size = (header[2] << 8) | header[3];
+						if (!fill(4 + size))
+						{
+							result.Error = "stream ended within a packet";
+							return;
+						}
+
+						const auto packet = reinterpret_cast<const BYTE*>(m_received.data() + m_offset + 4);
+						if (m_received[m_offset + 1] == 0 && size >= 12)
+						{
+							const auto sequence = static_cast<uint16_t>((packet[2] << 8) | packet[3]);
+							const auto timestamp = (static_cast<uint32_t>(packet[4]) << 24) | (packet[5] << 16) | (packet[6] << 8) | packet[7];
+							if (hasPacket && sequence != static_cast<uint16_t>(lastSequence + 1))
+							{
+								++result.SequenceErrorCount;
+							}
+							if (!hasPacket || timestamp != lastTimestamp)
+							{
+								++result.FrameCount;
+							}
+							hasPacket = true;
+							lastSequence = sequence;
+							lastTimestamp = timestamp;
+							++result.PacketCount;
+						}
+						m_offset += 4 + size;
+					}
+				}
+
+			private:
+				SOCKET m_socket;
+
+				/// Received and not yet parsed from m_offset on.
+				std::string m_received;
+				size_t m_offset;
+
+				/// CSeq of the last request.
+				unsigned m_sequence;
+
+				///
+				/// Receive until at least size bytes are unparsed.
+				///
+				/// @return False if the connection was closed or timed out.
+				bool fill(size_t size)
+				{
+					if (m_offset > 0 && m_received.size() - m_offset < size)
+					{
+						m_received.erase(0, m_offset);
+						m_offset = 0;
+					}
+
+					char buffer[64 * 1024];
+					while (m_received.size() - m_offset < size)
+					{
+						const auto result = recv(m_socket, buffer, static_cast<int>(sizeof(buffer)), 0);
+						if (result <= 0)
+						{
+							return false;
+						}
+						m_received.append(buffer, result);
+					}
+					return true;
+				}
+
+				///
+				/// Send a request and read its response, including the body.
+				///
+				/// @return True if answered with 200 OK.
+				bool request(const std::string& method, const std::string& url, const std::string& headers, std::string& response)
+				{
+					const auto message = method + " " + url + " RTSP/1.0\r\nCSeq: " + std::to_string(++m_sequence) + "\r\n"
+						+ headers + "\r\n";
+					if (send(m_socket, message.data(), static_cast<int>(message.size()), 0) != static_cast<int>(message.size()))
+					{
+						return false;
+					}
+
+					size_t headerEnd;
+					while ((headerEnd = m_received.find("\r\n\r\n", m_offset)) == std::string::npos)
+					{
+						if (!fill(m_received.size() - m_offset + 1))
+						{
+							return false;
+						}
+					}
+
+					const auto headerSize = headerEnd + 4 - m_offset;
+					response = m_received.substr(m_offset, headerSize);
+					const auto contentLength = getHeader(response, "Content-Length:");
+					const auto bodySize = contentLength.empty() ? size_t(0) : static_cast<size_t>(std::stoul(contentLength));
+					if (!fill(headerSize + bodySize))
+					{
+						return false;
+					}
+					m_offset += headerSize + bodySize;
+					return response.compare(0, 12, "RTSP/1.0 200") == 0;
+				}
+
+				///
+				/// Value of a response header, up to the first parameter.
+				static std::string getHeader(const std::string& response, const std::string& name)
+				{
+					auto start = response.find("\r\n" + name);
+					if (start == std::string::npos)
+					{
+						return std::string();
+					}
+					start += 2 + name.size();
+					while (start < response.size() && response[start] == ' ')
+					{
+						++start;
+					}
+					const auto end = response.find_first_of(";\r", start);
+					return response.substr(start, end == std::string::npos ? std::string::npos : end - start);
+				}
+			};
+
+			boost::uuids::uuid makeChannelId(size_t index)
+			{
+				boost::uuids::uuid channelId = {};
+				channelId.data[0] = static_cast<BYTE>(index);
+				channelId.data[1] = static_cast<BYTE>(index >> 8);
+				return channelId;
+			}
+
+			///
+			/// Annex B access unit: the parameter sets and an IDR slice, or a non-IDR slice. The slice
+			/// data has no zero bytes, so that it cannot contain a start code.
+			std::vector<BYTE> createFrame(bool isKeyFrame, size_t frameSize)
+			{
+				std::vector<BYTE> frame;
+				if (isKeyFrame)
+				{
+					frame.insert(frame.end(), StartCode, StartCode + sizeof(StartCode));
+					frame.insert(frame.end(), Sps, Sps + sizeof(Sps));
+					frame.insert(frame.end(), StartCode, StartCode + sizeof(StartCode));
+					frame.insert(frame.end(), Pps, Pps + sizeof(Pps));
+				}
+				frame.insert(frame.end(), StartCode, StartCode + sizeof(StartCode));
+				frame.push_back(isKeyFrame ? 0x65 : 0x41);
+				frame.resize(frame.size() + frameSize, 0x5a);
+				return frame;
+			}
+
+			///
+			/// Serve the frames to the clients with TBB limited to a number of threads.
+			///
+			/// @return Frames received per second, negative on failure with error set.
+			double runThreads(const std::string& name, unsigned threadCount, unsigned short port, size_t channelCount,
+				size_t clientsPerChannel, uint64_t frameCount, size_t frameSize, std::string& error)
+			{
+				tbb::global_control parallelism(tbb::global_control::max_allowed_parallelism, threadCount);
+				ShardedRtspServer server(1, Port(port));
+				if (!server.Start())
+				{
+					error = "server not started on port " + std::to_string(port);
+					return -1.0;
+				}
+
+				VideoChannelDescriptor video;
+				video.Codec = MediaSubType::H264;
+				video.Width = 1920;
+				video.Height = 1080;
+				video.Sps = SpropSps;
+				video.Pps = SpropPps;
+				std::vector<RtspChannel> channels;
+				std::vector<std::shared_ptr<MediaChannel>> mediaChannels;
+				for (size_t index = 0; index < channelCount; ++index)
+				{
+					channels.emplace_back(makeChannelId(index), name + "-" + std::to_string(index), static_cast<unsigned>(index), video);
+					mediaChannels.push_back(server.AddChannel(channels.back(), 0, UINT_MAX));
+				}
+
+				std::atomic<size_t> setUpCount(0);
+				std::vector<ClientResult> results(channelCount * clientsPerChannel);
+				std::vector<std::thread> clients;
+				for (size_t index = 0; index < results.size(); ++index)
+				{
+					clients.emplace_back([&, index]()
+						{
+							RtspClient client;
+							auto& result = results[index];
+							result.Error = client.Play(port, channels[index % channelCount].ChannelName);
+							++setUpCount;
+							if (result.Error.empty())
+							{
+								client.ReceiveFrames(frameCount, result);
+							}
+						});
+				}
+
+				// The producers only add samples once the channel is watched.
+				Stopwatch setUpStopwatch;
+				while (setUpCount < results.size() && setUpStopwatch.GetSeconds() < ReceiveTimeoutMilliSec / 1000.0)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				for (const auto& mediaChannel : mediaChannels)
+				{
+					while (!mediaChannel->IsWatched(true) && setUpStopwatch.GetSeconds() < ReceiveTimeoutMilliSec / 1000.0)
+					{
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				}
+
+				// Every camera delivers its frame of the same instant, one after the other.
+				const auto keyFrame = createFrame(true, frameSize);
+				const auto deltaFrame = createFrame(false, frameSize);
+				Stopwatch stopwatch;
+				for (uint64_t frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+				{
+					const auto isKeyFrame = frameIndex % KeyFrameInterval == 0;
+					const auto& frame = isKeyFrame ? keyFrame : deltaFrame;
+					for (const auto& mediaChannel : mediaChannels)
+					{
+						mediaChannel->AddVideoMediaSample(MediaSample::CreateMediaSample(const_cast<BYTE*>(frame.data()),
+							static_cast<int>(frame.size()), frameIndex * FrameDurationMilliSec, isKeyFrame));
+					}
+				}
+				for (auto& client : clients)
+				{
+					client.join();
+				}
+				const auto seconds = stopwatch.GetSeconds();
+
+				for (const auto& channel : channels)
+				{
+					server.RemoveChannel(channel);
+				}
+				server.Stop();
+
+				uint64_t receivedFrames = 0;
+				uint64_t receivedPackets = 0;
+				uint64_t sequenceErrors = 0;
+				for (const auto& result : results)
+				{
+					if (!result.Error.empty() && error.empty())
+					{
+						error = result.Error;
+					}
+					receivedFrames += result.FrameCount;
+					receivedPackets += result.PacketCount;
+					sequenceErrors += result.SequenceErrorCount;
+				}
+				if (error.empty() && sequenceErrors > 0)
+				{
+					error = std::to_string(sequenceErrors) + " RTP packets lost or out of order";
+				}
+
+				PrintResult(name + " " + std::to_string(threadCount) + " threads frames", receivedFrames, seconds);
+				printf("%-48s %12llu RTP packets, %.0f packets/s\n", "", static_cast<unsigned long long>(receivedPackets),
+					seconds > 0.0 ? static_cast<double>(receivedPackets) / seconds : 0.0);
+				if (!error.empty())
+				{
+					return -1.0;
+				}
+				return seconds > 0.0 ? static_cast<double>(receivedFrames) / seconds : 0.0;
+			}
+		}
+
+		int RunLiveSources(const Arguments& arguments)
+		{
+			const std::string name = "live-sources";
+			const auto channelCount = static_cast<size_t>(GetArgument(arguments, 0, 64));
+			const auto clientsPerChannel = static_cast<size_t>(GetArgument(arguments, 1, 2));
+			const auto frameCount = GetArgument(arguments, 2, 300);
+			const auto frameSize = static_cast<size_t>(GetArgument(arguments, 3, 16000));
+			const auto port = static_cast<unsigned short>(GetArgument(arguments, 4, DefaultPort));
+			if (channelCount == 0 || channelCount > 65536 || clientsPerChannel == 0 || frameCount == 0)
+			{
+				return Fail(name, "at least one channel, one client per channel and one frame are needed");
+			}
+			if (frameCount > MaxFrameCount)
+			{
+				return Fail(name, "at most " + std::to_string(MaxFrameCount) + " frames per channel, the backlog must fit the queue");
+			}
+
+			WSADATA wsaData;
+			if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+			{
+				return Fail(name, "unable to initialize winsock");
+			}
+
+			std::vector<unsigned> threadCounts;
+			const auto coreCount = std::thread::hardware_concurrency();
+			for (const auto threadCount : ThreadCounts)
+			{
+				if (threadCount <= coreCount)
+				{
+					threadCounts.push_back(threadCount);
+				}
+			}
+			if (threadCounts.back() < coreCount && coreCount < MaxThreadCount)
+			{
+				threadCounts.push_back(coreCount);
+			}
+
+			auto result = 0;
+			auto singleRate = 0.0;
+			for (const auto threadCount : threadCounts)
+			{
+				std::string error;
+				const auto rate = runThreads(name, threadCount, port, channelCount, clientsPerChannel, frameCount, frameSize, error);
+				if (rate < 0.0)
+				{
+					result = Fail(name, std::to_string(threadCount) + " threads: " + error);
+					break;
+				}
+
+				if (threadCount == 1)
+				{
+					singleRate = rate;
+				}
+				else
+				{
+					printf("%-48s %.2fx the frames per second of 1 thread\n", "", singleRate > 0.0 ? rate / singleRate : 0.0);
+				}
+			}
+
+			WSACleanup();
+			return result;
+		}
+	}
+}
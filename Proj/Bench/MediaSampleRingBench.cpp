@@ -0,0 +1,427 @@
+///
+/// @class MediaSampleRingBench
+///
+/// Created 10/18/2026
+///
+/// Sample queue of PacketManagerMediaChannel, a producer and a consumer thread:
+/// - media-ring: samples passed through the MediaSampleRing, one at a time and in batches, and
+///   through the tbb::concurrent_bounded_queue it replaced, with the capacity and the try_push()
+///   and try_pop() calls of the replaced code. The producer is held back so that neither queue
+///   overflows and every sample must arrive in order. Then the consumer stalls periodically, so
+///   that both queues overflow: the ring must only drop or evict down to a keyframe, the samples
+///   after a gap are checked to start with one. The TBB queue drops the newest samples instead,
+///   how often it resumed on a delta frame is shown for comparison. The memory of a channel's
+///   video and audio ring is shown before the first sample and with the rings full.
+///
+#include "pch.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <tbb/concurrent_queue.h>
+
+#include "Bench.h"
+#include "MediaSampleRing.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			/// A keyframe every second at 30 fps.
+			const uint64_t KeyFrameInterval = 30;
+
+			/// Samples taken per PopBatch(), as a subsession does.
+			const size_t BatchSize = 32;
+
+			/// Samples the producer pushes between checks of how far the consumer is behind.
+			const uint64_t ThrottleInterval = 256;
+
+			typedef tbb::concurrent_bounded_queue<std::shared_ptr<MediaSample>> TbbQueue;
+
+			///
+			/// Samples pushed over and over, created up front so that allocation is not timed. The start
+			/// time is the index, every KeyFrameInterval-th sample is a keyframe.
+			std::vector<std::shared_ptr<MediaSample>> createSamples(size_t count)
+			{
+				std::vector<std::shared_ptr<MediaSample>> samples;
+				BYTE payload[16] = {};
+				for (size_t i = 0; i < count; ++i)
+				{
+					samples.push_back(MediaSample::CreateMediaSample(payload, static_cast<int>(sizeof(payload)),
+						static_cast<double>(i), i % KeyFrameInterval == 0));
+				}
+				return samples;
+			}
+
+			///
+			/// Follows the samples a consumer receives by their start time, which is their index in the
+			/// pool they are taken from over and over.
+			class SequenceCheck
+			{
+			public:
+				///
+				/// Constructor.
+				///
+				/// @param[in] poolSize Samples in the pool, 0 if the start time is the sequence itself.
+				explicit SequenceCheck(uint64_t poolSize) :
+					m_poolSize(poolSize)
+				{
+				}
+
+				void OnSample(const MediaSample& mediaSample)
+				{
+					// Taken from a pool, a sample that arrives too early or late shows as a distance of about the pool size.
+					const auto index = static_cast<uint64_t>(mediaSample.StartTime());
+					const auto distance = m_poolSize > 0
+						? (index + m_poolSize - m_nextSequence % m_poolSize) % m_poolSize
+						: index - m_nextSequence;
+					if (m_poolSize > 0 ? distance >= m_poolSize / 2 : index < m_nextSequence)
+					{
+						++OutOfOrderCount;
+						return;
+					}
+
+					if (distance > 0)
+					{
+						++GapCount;
+						for (auto sequence = m_nextSequence; sequence < m_nextSequence + distance; ++sequence)
+						{
+							if (sequence % KeyFrameInterval == 0)
+							{
+								++LostKeyFrameCount;
+							}
+						}
+						if (!mediaSample.GetIsKeyFrame())
+						{
+							++DeltaFrameResumeCount;
+						}
+					}
+					m_nextSequence += distance + 1;
+					++ReceivedCount;
+				}
+
+				uint64_t ReceivedCount = 0;
+				uint64_t GapCount = 0;
+				uint64_t LostKeyFrameCount = 0;
+				uint64_t DeltaFrameResumeCount = 0;
+				uint64_t OutOfOrderCount = 0;
+
+			private:
+				uint64_t m_poolSize;
+				uint64_t m_nextSequence = 0;
+			};
+
+			///
+			/// Push the samples on a producer thread and pop them on this one.
+			///
+			/// @param[in] sampleAt		Returns the sample of a sequence number.
+			/// @param[in] push			Queues a sample, false if it has been dropped.
+			/// @param[in] pushBatch	Queues BatchSize samples, nullptr to push one at a time.
+			/// @param[in] pop			Takes up to BatchSize samples, returns how many.
+			/// @param[in] maxBehind	Samples the producer may be ahead of the consumer, 0 for no limit.
+			/// @param[in] stallEvery	Samples after which the consumer stalls until the producer has
+			///							pushed stallFor more, 0 for no stalls.
+			///
+			/// @return Seconds taken.
+			template<typename SampleAt, typename Push, typename Pop>
+			double passSamples(SampleAt sampleAt, uint64_t sampleCount, Push push,
+				const std::function<void(std::shared_ptr<MediaSample>*)>& pushBatch, Pop pop, uint64_t maxBehind,
+				uint64_t stallEvery, uint64_t stallFor, SequenceCheck& check)
+			{
+				std::atomic<uint64_t> pushedCount(0);
+				std::atomic<uint64_t> poppedCount(0);
+				std::atomic<bool> isProducing(true);
+
+				Stopwatch stopwatch;
+				std::thread producer([&]()
+					{
+						std::shared_ptr<MediaSample> batch[BatchSize];
+						uint64_t i = 0;
+						while (i < sampleCount)
+						{
+							if (maxBehind > 0 && i % ThrottleInterval == 0)
+							{
+								while (i - poppedCount.load(std::memory_order_acquire) > maxBehind)
+								{
+									std::this_thread::yield();
+								}
+							}
+
+							if (pushBatch != nullptr && i + BatchSize <= sampleCount)
+							{
+								for (size_t j = 0; j < BatchSize; ++j)
+								{
+									batch[j] = sampleAt(i + j);
+								}
+								pushBatch(batch);
+								i += BatchSize;
+							}
+							else
+							{
+								push(sampleAt(i));
+								++i;
+							}
+							if (stallEvery > 0)
+							{
+								pushedCount.store(i, std::memory_order_release);
+							}
+						}
+						isProducing = false;
+					});
+
+				std::shared_ptr<MediaSample> received[BatchSize];
+				uint64_t popped = 0;
+				uint64_t nextStall = stallEvery;
+				for (;;)
+				{
+					const auto isLastPass = !isProducing;
+					const auto count = pop(received);
+					for (size_t i = 0; i < count; ++i)
+					{
+						check.OnSample(*received[i]);
+						received[i].reset();
+					}
+					popped += count;
+
+					if (count == 0)
+					{
+						if (isLastPass)
+						{
+							break;
+						}
+						poppedCount.store(popped, std::memory_order_release);
+						std::this_thread::yield();
+					}
+					else if (popped % ThrottleInterval < count)
+					{
+						poppedCount.store(popped, std::memory_order_release);
+					}
+
+					if (stallEvery > 0 && popped >= nextStall)
+					{
+						// As a subsession whose client stops reading for a while.
+						const auto stallUntil = pushedCount.load(std::memory_order_acquire) + stallFor;
+						while (isProducing && pushedCount.load(std::memory_order_acquire) < stallUntil)
+						{
+							std::this_thread::yield();
+						}
+						nextStall = popped + stallEvery;
+					}
+				}
+				const auto seconds = stopwatch.GetSeconds();
+				producer.join();
+				return seconds;
+			}
+
+			///
+			/// Bytes taken by a ring and its slots.
+			size_t ringBytes(const MediaSampleRingStats& stats)
+			{
+				return sizeof(MediaSampleRing) + stats.AllocatedSlots * sizeof(std::shared_ptr<MediaSample>);
+			}
+
+			///
+			/// Pass the samples through a new ring.
+			///
+			/// @param[in] isBatched Use PushBatch() and PopBatch() rather than Push() and Pop().
+			///
+			/// @return Seconds taken.
+			template<typename SampleAt>
+			double passThroughRing(SampleAt sampleAt, uint64_t sampleCount, size_t capacity, bool isBatched,
+				uint64_t maxBehind, uint64_t stallEvery, uint64_t stallFor, SequenceCheck& check, MediaSampleRingStats& stats)
+			{
+				MediaSampleRing ring(capacity, true);
+				std::function<void(std::shared_ptr<MediaSample>*)> pushBatch;
+				if (isBatched)
+				{
+					pushBatch = [&ring](std::shared_ptr<MediaSample>* mediaSamples) { ring.PushBatch(mediaSamples, BatchSize); };
+				}
+				const auto push = [&ring](const std::shared_ptr<MediaSample>& mediaSample) { return ring.Push(mediaSample); };
+				const auto pop = [&ring, isBatched](std::shared_ptr<MediaSample>* mediaSamples)
+					{
+						if (isBatched)
+						{
+							return ring.PopBatch(mediaSamples, BatchSize);
+						}
+						mediaSamples[0] = ring.Pop();
+						return mediaSamples[0] ? size_t(1) : size_t(0);
+					};
+
+				const auto seconds = passSamples(sampleAt, sampleCount, push, pushBatch, pop, maxBehind, stallEvery, stallFor, check);
+				stats = ring.GetStats();
+				return seconds;
+			}
+
+			///
+			/// Pass the samples through a new TBB queue, as the replaced code used it.
+			///
+			/// @param[in] isRetrying Retry a push while the queue is full, drop the sample otherwise.
+			///
+			/// @return Seconds taken.
+			template<typename SampleAt>
+			double passThroughTbb(SampleAt sampleAt, uint64_t sampleCount, size_t capacity, bool isRetrying,
+				uint64_t maxBehind, uint64_t stallEvery, uint64_t stallFor, SequenceCheck& check)
+			{
+				TbbQueue queue;
+				queue.set_capacity(static_cast<TbbQueue::size_type>(capacity));
+				const auto push = [&queue, isRetrying](const std::shared_ptr<MediaSample>& mediaSample)
+					{
+						while (!queue.try_push(mediaSample))
+						{
+							if (!isRetrying)
+							{
+								return false;
+							}
+							std::this_thread::yield();
+						}
+						return true;
+					};
+				const auto pop = [&queue](std::shared_ptr<MediaSample>* mediaSamples)
+					{
+						return queue.try_pop(mediaSamples[0]) ? size_t(1) : size_t(0);
+					};
+				return passSamples(sampleAt, sampleCount, push, nullptr, pop, maxBehind, stallEvery, stallFor, check);
+			}
+
+			///
+			/// Check that every sample arrived, in order.
+			///
+			/// @return Empty if so, what went wrong otherwise.
+			std::string checkComplete(const std::string& name, const SequenceCheck& check, uint64_t sampleCount)
+			{
+				if (check.ReceivedCount != sampleCount || check.GapCount > 0 || check.OutOfOrderCount > 0)
+				{
+					return name + ": " + std::to_string(check.ReceivedCount) + " of " + std::to_string(sampleCount)
+						+ " samples received, " + std::to_string(check.GapCount) + " gaps, "
+						+ std::to_string(check.OutOfOrderCount) + " out of order";
+				}
+				return std::string();
+			}
+
+			void printOverload(const SequenceCheck& check, uint64_t sampleCount)
+			{
+				printf("%-48s %llu of %llu received, %llu gaps, %llu resumed on a delta frame, %llu keyframes lost\n", "",
+					static_cast<unsigned long long>(check.ReceivedCount), static_cast<unsigned long long>(sampleCount),
+					static_cast<unsigned long long>(check.GapCount), static_cast<unsigned long long>(check.DeltaFrameResumeCount),
+					static_cast<unsigned long long>(check.LostKeyFrameCount));
+			}
+		}
+
+		int RunMediaRing(const Arguments& arguments)
+		{
+			const std::string name = "media-ring";
+			const auto sampleCount = GetArgument(arguments, 0, 20000000);
+			const auto capacity = static_cast<size_t>(GetArgument(arguments, 1, 10240));
+			if (capacity < 1024 || capacity > 1024 * 1024)
+			{
+				return Fail(name, "a capacity between 1024 and 1048576 samples is needed");
+			}
+
+			// Several times the capacity, so that a reordering cannot go unnoticed.
+			const auto poolSize = static_cast<uint64_t>((capacity * 8 / KeyFrameInterval + 1) * KeyFrameInterval);
+			const auto samples = createSamples(static_cast<size_t>(poolSize));
+			const auto pooledSample = [&samples](uint64_t sequence) -> const std::shared_ptr<MediaSample>&
+				{
+					return samples[static_cast<size_t>(sequence % samples.size())];
+				};
+
+			// Every sample is new while overloaded, so that a gap of any length is told apart.
+			BYTE payload[16] = {};
+			const auto newSample = [&payload](uint64_t sequence)
+				{
+					return MediaSample::CreateMediaSample(payload, static_cast<int>(sizeof(payload)),
+						static_cast<double>(sequence), sequence % KeyFrameInterval == 0);
+				};
+
+			// Half the capacity, the ring starts evicting at seven eighths.
+			const auto maxBehind = static_cast<uint64_t>(capacity / 2);
+			std::vector<std::string> errors;
+			MediaSampleRingStats stats;
+
+			// A video and an audio ring per channel, as PacketManagerMediaChannel creates them.
+			{
+				const MediaSampleRing videoRing(capacity, true);
+				const MediaSampleRing audioRing(capacity, false);
+				const auto channelBytes = ringBytes(videoRing.GetStats()) + ringBytes(audioRing.GetStats());
+				// A full ring has grown to the capacity rounded up to a power of two.
+				MediaSampleRingStats fullStats;
+				fullStats.AllocatedSlots = 1;
+				while (fullStats.AllocatedSlots < capacity)
+				{
+					fullStats.AllocatedSlots <<= 1;
+				}
+				printf("%-48s %llu bytes per channel before the first sample, %llu with both rings full\n",
+					(name + " footprint").c_str(), static_cast<unsigned long long>(channelBytes),
+					static_cast<unsigned long long>(2 * ringBytes(fullStats)));
+				if (videoRing.GetStats().AllocatedSlots > MediaSampleRing::InitialSlotCount)
+				{
+					errors.push_back("MediaSampleRing: more than " + std::to_string(MediaSampleRing::InitialSlotCount)
+						+ " slots allocated up front");
+				}
+			}
+
+			SequenceCheck tbbCheck(poolSize);
+			const auto tbbSeconds = passThroughTbb(pooledSample, sampleCount, capacity, true, maxBehind, 0, 0, tbbCheck);
+			PrintResult(name + " tbb::concurrent_bounded_queue", tbbCheck.ReceivedCount, tbbSeconds);
+			errors.push_back(checkComplete("tbb::concurrent_bounded_queue", tbbCheck, sampleCount));
+
+			for (const auto isBatched : { false, true })
+			{
+				const std::string ringName = isBatched ? "MediaSampleRing batched" : "MediaSampleRing";
+				SequenceCheck check(poolSize);
+				const auto seconds = passThroughRing(pooledSample, sampleCount, capacity, isBatched, maxBehind, 0, 0, check, stats);
+				PrintResult(name + " " + ringName, check.ReceivedCount, seconds);
+				printf("%-48s %.1fx the samples per second of tbb::concurrent_bounded_queue\n", "",
+					seconds > 0.0 ? tbbSeconds / seconds : 0.0);
+				errors.push_back(checkComplete(ringName, check, sampleCount));
+			}
+
+			// Overload: every few frames the consumer stalls while the producer pushes twice the capacity.
+			const auto overloadCount = sampleCount / 4;
+			const auto stallEvery = static_cast<uint64_t>(capacity / 4);
+			const auto stallFor = static_cast<uint64_t>(capacity * 2);
+
+			SequenceCheck tbbOverloadCheck(0);
+			const auto tbbOverloadSeconds = passThroughTbb(newSample, overloadCount, capacity, false, 0, stallEvery, stallFor,
+				tbbOverloadCheck);
+			PrintResult(name + " tbb::concurrent_bounded_queue overload", overloadCount, tbbOverloadSeconds);
+			printOverload(tbbOverloadCheck, overloadCount);
+
+			SequenceCheck overloadCheck(0);
+			const auto overloadSeconds = passThroughRing(newSample, overloadCount, capacity, true, 0, stallEvery, stallFor,
+				overloadCheck, stats);
+			PrintResult(name + " MediaSampleRing overload", overloadCount, overloadSeconds);
+			printOverload(overloadCheck, overloadCount);
+			printf("%-48s %llu dropped, %llu evicted, %llu overflows, %llu slots allocated\n", "",
+				static_cast<unsigned long long>(stats.DroppedSamples), static_cast<unsigned long long>(stats.EvictedSamples),
+				static_cast<unsigned long long>(stats.OverflowCount), static_cast<unsigned long long>(stats.AllocatedSlots));
+			if (overloadCheck.DeltaFrameResumeCount > 0 || overloadCheck.OutOfOrderCount > 0)
+			{
+				errors.push_back("MediaSampleRing overload: " + std::to_string(overloadCheck.DeltaFrameResumeCount)
+					+ " gaps not resumed on a keyframe, " + std::to_string(overloadCheck.OutOfOrderCount) + " out of order");
+			}
+			if (overloadCheck.ReceivedCount + stats.DroppedSamples + stats.EvictedSamples != overloadCount)
+			{
+				errors.push_back("MediaSampleRing overload: received, dropped and evicted samples do not add up to "
+					+ std::to_string(overloadCount));
+			}
+			if (stats.OverflowCount == 0)
+			{
+				errors.push_back("MediaSampleRing overload: the ring never overflowed");
+			}
+
+			auto result = 0;
+			for (const auto& error : errors)
+			{
+				if (!error.empty())
+				{
+					result = Fail(name, error);
+				}
+			}
+			return result;
+		}
+	}
+}
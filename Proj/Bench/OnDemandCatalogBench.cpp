@@ -0,0 +1,146 @@
+///
+/// @class OnDemandCatalogBench
+///
+/// Created 10/19/2026
+///
+/// Samples pushed into on-demand channels that no client has asked for yet:
+/// - on-demand-catalog: channels are added to a channel manager and, on demand, to a LiveRtspServer,
+///   which only catalogs them. The samples pushed into these channels must be dropped up front
+///   rather than queued, a channel the server does not know of is pushed into as well to show that
+///   its samples are queued.
+///
+#include "pch.h"
+
+#include <vector>
+
+#include <live555/BasicUsageEnvironment.hh>
+#include <live555/GroupsockHelper.hh>
+
+#include "Bench.h"
+#include "LiveRtspServer.h"
+#include "LiveSourceTaskScheduler.h"
+#include "MultiChannelManager.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			/// Source ids the server gives the subsessions of a channel.
+			const uint32_t VideoSourceId = 0;
+			const uint32_t AudioSourceId = 1;
+
+			boost::uuids::uuid makeChannelId(size_t index)
+			{
+				boost::uuids::uuid channelId = {};
+				channelId.data[0] = static_cast<BYTE>(index);
+				channelId.data[1] = static_cast<BYTE>(index >> 8);
+				return channelId;
+			}
+
+			///
+			/// Push the samples into a channel's video and audio, one at a time as a device source does.
+			///
+			/// @return Samples queued in the channel afterwards.
+			size_t pushSamples(MultiChannelManager& channelManager, const RtspChannel& channel,
+				const std::vector<std::shared_ptr<MediaSample>>& samples)
+			{
+				const auto packetManager = channelManager.GetPacketManager(channel.ChannelId, channel.ChannelName);
+				if (!packetManager)
+				{
+					return 0;
+				}
+
+				for (const auto& sample : samples)
+				{
+					auto videoSample = sample;
+					packetManager->AddVideoMediaSample(std::move(videoSample));
+					auto audioSample = sample;
+					packetManager->AddAudioMediaSample(std::move(audioSample));
+				}
+				return packetManager->GetVideoStats().QueuedSamples + packetManager->GetAudioStats().QueuedSamples;
+			}
+		}
+
+		int RunOnDemandCatalog(const Arguments& arguments)
+		{
+			const std::string name = "on-demand-catalog";
+			const auto channelCount = static_cast<size_t>(GetArgument(arguments, 0, 16));
+			const auto sampleCount = static_cast<size_t>(GetArgument(arguments, 1, 1000));
+			if (channelCount < 1 || channelCount > 4096)
+			{
+				return Fail(name, "between 1 and 4096 channels are needed");
+			}
+
+			BYTE payload[16] = {};
+			std::vector<std::shared_ptr<MediaSample>> samples;
+			for (size_t index = 0; index < sampleCount; ++index)
+			{
+				samples.push_back(MediaSample::CreateMediaSample(payload, static_cast<int>(sizeof(payload)),
+					static_cast<double>(index), index % 30 == 0));
+			}
+
+			MultiChannelManager channelManager;
+			const auto scheduler = LiveSourceTaskScheduler::createNew(channelManager);
+			const auto env = BasicUsageEnvironment::createNew(*scheduler);
+			const auto listeningSocket = setupStreamSocket(*env, Port(0), AF_INET);
+			if (listeningSocket < 0)
+			{
+				env->reclaim();
+				delete scheduler;
+				return Fail(name, "no listening socket");
+			}
+			const auto server = new LiveRtspServer(*env, listeningSocket, -1, Port(0), nullptr, nullptr, nullptr);
+
+			// The last channel is known to the channel manager only.
+			std::vector<RtspChannel> channels;
+			for (size_t index = 0; index <= channelCount; ++index)
+			{
+				channels.emplace_back(makeChannelId(index), name + "-" + std::to_string(index), static_cast<unsigned>(index),
+					VideoChannelDescriptor());
+				channels.back().IsOnDemand = true;
+				channelManager.SetVideoSourceId(channels.back().ChannelId, channels.back().ChannelName, VideoSourceId);
+				channelManager.SetAudioSourceId(channels.back().ChannelId, channels.back().ChannelName, AudioSourceId);
+				if (index < channelCount)
+				{
+					server->AddRtspMediaSession(channels.back());
+				}
+			}
+
+			std::vector<std::string> errors;
+			size_t catalogedQueued = 0;
+			Stopwatch stopwatch;
+			for (size_t index = 0; index < channelCount; ++index)
+			{
+				catalogedQueued += pushSamples(channelManager, channels[index], samples);
+			}
+			const auto seconds = stopwatch.GetSeconds();
+			PrintResult(name + " cataloged channels", 2 * channelCount * sampleCount, seconds);
+			if (catalogedQueued > 0)
+			{
+				errors.push_back(std::to_string(catalogedQueued) + " samples queued in cataloged channels");
+			}
+
+			const auto unknownQueued = pushSamples(channelManager, channels.back(), samples);
+			printf("%-48s %llu queued in cataloged channels, %llu of %llu in a channel unknown to the server\n", "",
+				static_cast<unsigned long long>(catalogedQueued), static_cast<unsigned long long>(unknownQueued),
+				static_cast<unsigned long long>(2 * sampleCount));
+			if (unknownQueued == 0)
+			{
+				errors.push_back("no samples queued in the channel unknown to the server, the check proves nothing");
+			}
+
+			Medium::close(server);
+			env->reclaim();
+			delete scheduler;
+
+			auto result = 0;
+			for (const auto& error : errors)
+			{
+				result = Fail(name, error);
+			}
+			return result;
+		}
+	}
+}
@@ -0,0 +1,153 @@
+///
+/// @class ShardedRtspServerBench
+///
+/// Created 10/18/2026
+///
+/// RTSP request throughput of a ShardedRtspServer over loopback:
+/// - rtsp-shards: clients connect to one port and send OPTIONS requests back to back, once served
+///   by a single shard and once by several. The connections are spread over the shards by the
+///   kernel (SO_REUSEPORT) or by the shard that accepts first (duplicated listening socket), the
+///   requests per second should grow with the shards up to the number of cores.
+///
+#include "pch.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "Bench.h"
+#include "ShardedRtspServer.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			const unsigned short DefaultPort = 18554;
+
+			///
+			/// Connect to the server and send requests one after the other, each waiting for its response.
+			///
+			/// @return Requests answered with 200 OK.
+			uint64_t runClient(unsigned short port, uint64_t requestCount)
+			{
+				const auto clientSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+				if (clientSocket == INVALID_SOCKET)
+				{
+					return 0;
+				}
+
+				struct sockaddr_in address = {};
+				address.sin_family = AF_INET;
+				address.sin_port = htons(port);
+				address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+				uint64_t answeredCount = 0;
+				if (connect(clientSocket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0)
+				{
+					char response[1024];
+					for (uint64_t i = 0; i < requestCount; ++i)
+					{
+						const auto request = "OPTIONS rtsp://127.0.0.1:" + std::to_string(port) + "/ RTSP/1.0\r\nCSeq: "
+							+ std::to_string(i + 1) + "\r\n\r\n";
+						if (send(clientSocket, request.data(), static_cast<int>(request.size()), 0) != static_cast<int>(request.size()))
+						{
+							break;
+						}
+
+						// Read until the end of the headers, OPTIONS responses have no body.
+						size_t responseSize = 0;
+						while (responseSize < sizeof(response) - 1)
+						{
+							const auto result = recv(clientSocket, response + responseSize, static_cast<int>(sizeof(response) - 1 - responseSize), 0);
+							if (result <= 0)
+							{
+								break;
+							}
+							responseSize += result;
+							response[responseSize] = '\0';
+							if (strstr(response, "\r\n\r\n"))
+							{
+								break;
+							}
+						}
+
+						if (strncmp(response, "RTSP/1.0 200", 12) != 0 || !strstr(response, "\r\n\r\n"))
+						{
+							break;
+						}
+						++answeredCount;
+					}
+				}
+
+				closesocket(clientSocket);
+				return answeredCount;
+			}
+
+			///
+			/// Serve the clients with a number of shards.
+			///
+			/// @return Requests per second, negative if the server could not be started or requests failed.
+			double runShards(unsigned shardCount, unsigned short port, unsigned clientCount, uint64_t requestCount)
+			{
+				ShardedRtspServer server(shardCount, Port(port));
+				if (!server.Start())
+				{
+					return -1.0;
+				}
+
+				std::atomic<uint64_t> answeredCount(0);
+				std::vector<std::thread> clients;
+				Stopwatch stopwatch;
+				for (unsigned i = 0; i < clientCount; ++i)
+				{
+					clients.emplace_back([&]() { answeredCount += runClient(port, requestCount); });
+				}
+				for (auto& client : clients)
+				{
+					client.join();
+				}
+				const auto seconds = stopwatch.GetSeconds();
+				server.Stop();
+
+				PrintResult("rtsp-shards " + std::to_string(shardCount) + " shards", answeredCount, seconds);
+				if (answeredCount != clientCount * requestCount)
+				{
+					return -1.0;
+				}
+				return seconds > 0.0 ? static_cast<double>(answeredCount) / seconds : 0.0;
+			}
+		}
+
+		int RunRtspShards(const Arguments& arguments)
+		{
+			const std::string name = "rtsp-shards";
+			const auto clientCount = static_cast<unsigned>(GetArgument(arguments, 0, 64));
+			const auto requestCount = GetArgument(arguments, 1, 500);
+			const auto shardCount = static_cast<unsigned>(GetArgument(arguments, 2, std::thread::hardware_concurrency()));
+			const auto port = static_cast<unsigned short>(GetArgument(arguments, 3, DefaultPort));
+
+			WSADATA wsaData;
+			if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+			{
+				return Fail(name, "unable to initialize winsock");
+			}
+
+			auto result = 0;
+			const auto singleRate = runShards(1, port, clientCount, requestCount);
+			const auto shardedRate = shardCount > 1 ? runShards(shardCount, port, clientCount, requestCount) : singleRate;
+			if (singleRate < 0.0 || shardedRate < 0.0)
+			{
+				result = Fail(name, "server not started on port " + std::to_string(port) + " or requests not answered");
+			}
+			else
+			{
+				printf("%-48s %.2fx the requests per second of a single shard\n", "",
+					singleRate > 0.0 ? shardedRate / singleRate : 0.0);
+			}
+
+			WSACleanup();
+			return result;
+		}
+	}
+}
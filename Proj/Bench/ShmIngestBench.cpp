@@ -0,0 +1,180 @@
+///
+/// @class ShmIngestBench
+///
+/// Created 10/18/2026
+///
+/// Frames handed from a ShmIngestProducer to the ShmIngestChannelManager of the same process:
+/// - shm-ingest: throughput of a producer thread pushing into the ring while the consumer
+///   dequeues and releases the borrowed samples, and a check that a forged record running past
+///   the end of the ring is skipped rather than handed out.
+///
+#include "pch.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "Bench.h"
+#include "ShmIngestChannelManager.h"
+#include "ShmIngestProducer.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			const uint32_t SourceId = 0;
+			const uint32_t RingSize = 4 * 1024 * 1024;
+			const size_t BatchSize = 32;
+
+			boost::uuids::uuid makeChannelId()
+			{
+				boost::uuids::uuid channelId = {};
+				channelId.data[0] = 1;
+				return channelId;
+			}
+
+			///
+			/// Forge a record in the stream that is inside the published range but runs past the end
+			/// of the ring, as a broken producer could.
+			bool forgeRecordPastRingEnd(const std::string& regionName, int streamIndex)
+			{
+				using namespace ShmIngestRing;
+
+				const auto mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, regionName.c_str());
+				const auto view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0) : nullptr;
+				if (!view)
+				{
+					if (mapping)
+					{
+						CloseHandle(mapping);
+					}
+					return false;
+				}
+
+				auto& stream = GetStream(view, static_cast<uint32_t>(streamIndex));
+				const auto ringSize = static_cast<const Header*>(view)->RingSize;
+				const auto writeIndex = stream.WriteIndex.load(std::memory_order_relaxed);
+				const auto offset = static_cast<uint32_t>(writeIndex % ringSize);
+
+				Record record = {};
+				record.Size = ringSize - offset + RecordAlignment;
+				record.DataSize = record.Size - sizeof(Record);
+				memcpy(GetRing(view, static_cast<uint32_t>(streamIndex)) + offset, &record, sizeof(Record));
+				stream.WriteIndex.store(writeIndex + record.Size, std::memory_order_release);
+
+				UnmapViewOfFile(view);
+				CloseHandle(mapping);
+				return true;
+			}
+		}
+
+		int RunShmIngest(const Arguments& arguments)
+		{
+			const std::string name = "shm-ingest";
+			const auto frameCount = GetArgument(arguments, 0, 200000);
+			const auto frameSize = static_cast<uint32_t>(GetArgument(arguments, 1, 16 * 1024));
+
+			const auto regionName = "Local\\CvRtspIngestBench-" + std::to_string(GetCurrentProcessId());
+			ShmIngestChannelManager channelManager(regionName, 1, RingSize);
+			ShmIngestProducer producer;
+			if (!channelManager.IsValid() || !producer.Open(regionName))
+			{
+				return Fail(name, "unable to set up region " + regionName);
+			}
+
+			const auto channelId = makeChannelId();
+			const std::string channelName = "shm-bench";
+			const auto streamIndex = producer.OpenStream(channelId, channelName, SourceId);
+			if (streamIndex < 0)
+			{
+				return Fail(name, "unable to open a stream");
+			}
+
+			std::atomic<bool> isProducing(true);
+			std::thread producerThread([&]()
+				{
+					std::vector<uint8_t> frame(frameSize);
+					for (uint64_t i = 0; i < frameCount; ++i)
+					{
+						std::fill(frame.begin(), frame.end(), static_cast<uint8_t>(i));
+
+						// Full while the consumer is behind, retried rather than dropped.
+						while (!producer.Push(streamIndex, frame.data(), frameSize, static_cast<double>(i), false))
+						{
+							std::this_thread::yield();
+						}
+					}
+					isProducing = false;
+				});
+
+			Stopwatch stopwatch;
+			std::shared_ptr<MediaSample> batch[BatchSize];
+			uint64_t receivedFrames = 0;
+			uint64_t corruptFrames = 0;
+			while (receivedFrames < frameCount)
+			{
+				const auto isLastPass = !isProducing;
+				const auto count = channelManager.GetMediaBatch(channelId, channelName, SourceId, batch, BatchSize);
+				for (size_t i = 0; i < count; ++i)
+				{
+					const auto data = batch[i]->GetDataBuffer().Data();
+					const auto expected = static_cast<BYTE>(receivedFrames + i);
+					if (batch[i]->GetSize() != static_cast<int>(frameSize) || data[0] != expected || data[frameSize - 1] != expected)
+					{
+						++corruptFrames;
+					}
+					batch[i].reset();
+				}
+				receivedFrames += count;
+				if (count == 0)
+				{
+					if (isLastPass)
+					{
+						break;
+					}
+					std::this_thread::yield();
+				}
+			}
+			const auto seconds = stopwatch.GetSeconds();
+			producerThread.join();
+
+			PrintResult(name + " frames", receivedFrames, seconds);
+			printf("%-48s %10.1f MB/s, %llu pushes retried on a full ring\n", "",
+				seconds > 0.0 ? static_cast<double>(receivedFrames) * frameSize / seconds / 1e6 : 0.0,
+				static_cast<unsigned long long>(producer.GetDroppedCount(streamIndex)));
+
+			auto result = 0;
+			if (receivedFrames != frameCount)
+			{
+				result = Fail(name, std::to_string(receivedFrames) + " of " + std::to_string(frameCount) + " frames received");
+			}
+			if (corruptFrames > 0)
+			{
+				result = Fail(name, std::to_string(corruptFrames) + " frames corrupt");
+			}
+
+			// A record past the end of the ring is skipped, the frames published after it arrive.
+			const uint8_t frame[] = { 0x5a, 0x5a, 0x5a, 0x5a };
+			if (!forgeRecordPastRingEnd(regionName, streamIndex))
+			{
+				result = Fail(name, "unable to map region " + regionName + " to forge a record");
+			}
+			else if (channelManager.GetMediaBatch(channelId, channelName, SourceId, batch, BatchSize) != 0)
+			{
+				result = Fail(name, "record past the end of the ring handed out");
+			}
+			else if (!producer.Push(streamIndex, frame, sizeof(frame), 0.0, true)
+				|| channelManager.GetMediaBatch(channelId, channelName, SourceId, batch, BatchSize) != 1
+				|| batch[0]->GetSize() != static_cast<int>(sizeof(frame)))
+			{
+				result = Fail(name, "stream not resumed after a corrupt record");
+			}
+			batch[0].reset();
+
+			producer.CloseStream(streamIndex);
+			return result;
+		}
+	}
+}
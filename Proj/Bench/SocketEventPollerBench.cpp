@@ -0,0 +1,301 @@
+///
+/// @class SocketEventPollerBench
+///
+/// Created 10/18/2026
+///
+/// Socket handling of LiveSourceTaskScheduler0 with thousands of sockets, most of them idle:
+/// - socket-poller: datagrams sent over loopback to a few active sockets among many idle ones,
+///   handled by a SocketEventPoller and by live555's stock BasicTaskScheduler, which select()s
+///   all sockets and calls one handler per step. Also the cost of an event loop step that finds
+///   no socket ready. The stock scheduler only takes FD_SETSIZE sockets, it is compared with the
+///   poller on that many, the poller is then run on all of them.
+///
+#include "pch.h"
+
+#include <functional>
+
+#include <live555/BasicUsageEnvironment.hh>
+
+#include "Bench.h"
+#include "SocketEventPoller.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			/// Sockets kept free of the stock scheduler's fd_set for the sender and the scheduler itself.
+			const size_t ReservedSocketCount = 16;
+
+			/// Longest wait for the datagrams of a round.
+			const double RoundTimeoutSeconds = 5.0;
+
+			/// Socket of the bench and the datagrams its handler read.
+			struct Receiver
+			{
+				int SocketNum;
+				uint16_t Port;
+				uint64_t ReceivedCount;
+			};
+
+			///
+			/// Handler of a receiving socket, reads one datagram per call as live555's handlers do.
+			void readDatagram(void* clientData, int /*mask*/)
+			{
+				auto& receiver = *static_cast<Receiver*>(clientData);
+				char datagram[64];
+				if (recv(receiver.SocketNum, datagram, sizeof(datagram), 0) > 0)
+				{
+					++receiver.ReceivedCount;
+				}
+			}
+
+			///
+			/// Open a non-blocking UDP socket on a loopback port.
+			///
+			/// @return Socket, -1 on failure.
+			int openUdpSocket(uint16_t& port)
+			{
+				const auto socketNum = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+				if (socketNum < 0)
+				{
+					return -1;
+				}
+
+				struct sockaddr_in address = {};
+				address.sin_family = AF_INET;
+				address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+				SOCKLEN_T addressSize = sizeof(address);
+				u_long isNonBlocking = 1;
+				if (bind(socketNum, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0
+					|| getsockname(socketNum, reinterpret_cast<struct sockaddr*>(&address), &addressSize) != 0
+					|| ioctlsocket(socketNum, FIONBIO, &isNonBlocking) != 0)
+				{
+					closesocket(socketNum);
+					return -1;
+				}
+				port = ntohs(address.sin_port);
+				return socketNum;
+			}
+
+			///
+			/// Spread the active sockets over the first receivers, so that every step scans past idle ones.
+			std::vector<size_t> spreadActive(size_t receiverCount, size_t activeCount)
+			{
+				std::vector<size_t> active;
+				for (size_t i = 0; i < activeCount && i < receiverCount; ++i)
+				{
+					active.push_back(i * receiverCount / activeCount);
+				}
+				return active;
+			}
+
+			///
+			/// Send a datagram to each active socket per round and step the event loop until all are read.
+			///
+			/// @return Seconds taken, negative if datagrams were not handled in time.
+			double runDatagrams(const std::string& name, std::vector<Receiver>& receivers, const std::vector<size_t>& active,
+				int senderSocket, uint64_t rounds, const std::function<void()>& step)
+			{
+				for (auto& receiver : receivers)
+				{
+					receiver.ReceivedCount = 0;
+				}
+
+				const char datagram[32] = {};
+				uint64_t expectedCount = 0;
+				uint64_t receivedCount = 0;
+				uint64_t stepCount = 0;
+				Stopwatch stopwatch;
+				for (uint64_t round = 0; round < rounds; ++round)
+				{
+					for (const auto index : active)
+					{
+						struct sockaddr_in address = {};
+						address.sin_family = AF_INET;
+						address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+						address.sin_port = htons(receivers[index].Port);
+						sendto(senderSocket, datagram, sizeof(datagram), 0, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+					}
+					expectedCount += active.size();
+
+					const auto roundStart = stopwatch.GetSeconds();
+					while (receivedCount < expectedCount)
+					{
+						step();
+						++stepCount;
+						receivedCount = 0;
+						for (const auto index : active)
+						{
+							receivedCount += receivers[index].ReceivedCount;
+						}
+						if (stopwatch.GetSeconds() - roundStart > RoundTimeoutSeconds)
+						{
+							return -1.0;
+						}
+					}
+				}
+				const auto seconds = stopwatch.GetSeconds();
+
+				PrintResult(name + " datagrams", receivedCount, seconds);
+				printf("%-48s %10.1f handlers per step, %10.1f us per step\n", "",
+					stepCount > 0 ? static_cast<double>(receivedCount) / static_cast<double>(stepCount) : 0.0,
+					stepCount > 0 ? seconds * 1e6 / static_cast<double>(stepCount) : 0.0);
+				return seconds;
+			}
+
+			///
+			/// Step the event loop while no socket is ready.
+			///
+			/// @return Seconds taken.
+			double runIdleSteps(const std::string& name, uint64_t stepCount, const std::function<void()>& step)
+			{
+				Stopwatch stopwatch;
+				for (uint64_t i = 0; i < stepCount; ++i)
+				{
+					step();
+				}
+				const auto seconds = stopwatch.GetSeconds();
+				PrintResult(name + " idle steps", stepCount, seconds);
+				return seconds;
+			}
+
+			///
+			/// Datagrams and idle steps with a SocketEventPoller watching the receivers.
+			///
+			/// @return Seconds taken by the datagrams and by the idle steps, negative on failure.
+			std::pair<double, double> runPoller(const std::string& name, std::vector<Receiver>& receivers,
+				const std::vector<size_t>& active, int senderSocket, uint64_t rounds)
+			{
+				SocketEventPoller poller;
+				if (!poller.IsValid())
+				{
+					return std::make_pair(-1.0, -1.0);
+				}
+				for (auto& receiver : receivers)
+				{
+					poller.SetHandler(receiver.SocketNum, SOCKET_READABLE, &readDatagram, &receiver);
+				}
+
+				const auto step = [&poller]() { poller.Poll(1); };
+				const auto datagramSeconds = runDatagrams(name, receivers, active, senderSocket, rounds, step);
+				const auto seconds = std::make_pair(datagramSeconds, runIdleSteps(name, rounds, step));
+
+				for (const auto& receiver : receivers)
+				{
+					poller.SetHandler(receiver.SocketNum, 0, nullptr, nullptr);
+				}
+				return seconds;
+			}
+
+			///
+			/// Datagrams and idle steps with live555's stock scheduler watching the receivers.
+			///
+			/// @return Seconds taken by the datagrams and by the idle steps, negative on failure.
+			std::pair<double, double> runStockScheduler(const std::string& name, std::vector<Receiver>& receivers,
+				const std::vector<size_t>& active, int senderSocket, uint64_t rounds)
+			{
+				// SingleStep() and the socket handling are only public in the base classes.
+				BasicTaskScheduler0* const scheduler = BasicTaskScheduler::createNew();
+				for (auto& receiver : receivers)
+				{
+					scheduler->setBackgroundHandling(receiver.SocketNum, SOCKET_READABLE, &readDatagram, &receiver);
+				}
+
+				const auto step = [scheduler]() { scheduler->SingleStep(1); };
+				const auto datagramSeconds = runDatagrams(name, receivers, active, senderSocket, rounds, step);
+				const auto seconds = std::make_pair(datagramSeconds, runIdleSteps(name, rounds, step));
+
+				for (const auto& receiver : receivers)
+				{
+					scheduler->disableBackgroundHandling(receiver.SocketNum);
+				}
+				delete scheduler;
+				return seconds;
+			}
+
+			double ratio(double stockSeconds, double pollerSeconds)
+			{
+				return pollerSeconds > 0.0 ? stockSeconds / pollerSeconds : 0.0;
+			}
+		}
+
+		int RunSocketPoller(const Arguments& arguments)
+		{
+			const std::string name = "socket-poller";
+			const auto idleCount = static_cast<size_t>(GetArgument(arguments, 0, 4000));
+			const auto activeCount = static_cast<size_t>(GetArgument(arguments, 1, 32));
+			const auto rounds = GetArgument(arguments, 2, 2000);
+			if (activeCount == 0 || activeCount + ReservedSocketCount >= FD_SETSIZE)
+			{
+				return Fail(name, "between 1 and " + std::to_string(FD_SETSIZE - ReservedSocketCount - 1) + " active sockets are needed");
+			}
+
+			WSADATA wsaData;
+			if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+			{
+				return Fail(name, "unable to initialize winsock");
+			}
+
+			auto result = 0;
+			uint16_t senderPort = 0;
+			const auto senderSocket = openUdpSocket(senderPort);
+			std::vector<Receiver> receivers;
+			while (senderSocket >= 0 && receivers.size() < idleCount + activeCount)
+			{
+				Receiver receiver = {};
+				receiver.SocketNum = openUdpSocket(receiver.Port);
+				if (receiver.SocketNum < 0)
+				{
+					break;
+				}
+				receivers.push_back(receiver);
+			}
+
+			if (receivers.size() < idleCount + activeCount)
+			{
+				result = Fail(name, "only " + std::to_string(receivers.size()) + " sockets opened, the process limit may be too low");
+			}
+			else
+			{
+				// The sockets opened first, on Unix those have the descriptors below FD_SETSIZE.
+				const auto selectCount = receivers.size() < FD_SETSIZE - ReservedSocketCount
+					? receivers.size() : FD_SETSIZE - ReservedSocketCount;
+				std::vector<Receiver> selectReceivers(receivers.begin(), receivers.begin() + selectCount);
+				const auto selectActive = spreadActive(selectCount, activeCount);
+				const auto selectName = name + " " + std::to_string(selectCount);
+
+				const auto stockSeconds = runStockScheduler(selectName + " select()", selectReceivers, selectActive, senderSocket, rounds);
+				const auto pollerSeconds = runPoller(selectName + " poller", selectReceivers, selectActive, senderSocket, rounds);
+				if (stockSeconds.first < 0.0 || pollerSeconds.first < 0.0)
+				{
+					result = Fail(name, "datagrams not handled within " + std::to_string(RoundTimeoutSeconds) + " s");
+				}
+				else
+				{
+					printf("%-48s %.1fx the datagram rate, %.1fx the idle step rate of select() on %zu sockets\n", "",
+						ratio(stockSeconds.first, pollerSeconds.first), ratio(stockSeconds.second, pollerSeconds.second), selectCount);
+				}
+
+				if (receivers.size() > selectCount
+					&& runPoller(name + " " + std::to_string(receivers.size()) + " poller", receivers,
+						spreadActive(receivers.size(), activeCount), senderSocket, rounds).first < 0.0)
+				{
+					result = Fail(name, "datagrams not handled within " + std::to_string(RoundTimeoutSeconds) + " s");
+				}
+			}
+
+			for (const auto& receiver : receivers)
+			{
+				closesocket(receiver.SocketNum);
+			}
+			if (senderSocket >= 0)
+			{
+				closesocket(senderSocket);
+			}
+			WSACleanup();
+			return result;
+		}
+	}
+}
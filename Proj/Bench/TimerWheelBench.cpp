@@ -0,0 +1,506 @@
+///
+/// @class TimerWheelBench
+///
+/// Created 10/18/2026
+///
+/// Delayed tasks of LiveSourceTaskScheduler0, kept in a TimerWheel:
+/// - timer-wheel: schedules, reschedules and unschedules thousands of timers, the way the liveness
+///   and RTCP timers of the clients are, once on a TimerWheel and once on live555's stock
+///   BasicTaskScheduler, whose DelayQueue is a sorted list that is searched by token. Firing is
+///   only timed for the wheel, the stock scheduler fires one timer per select() round.
+/// - timer-wheel-model: random schedules, reschedules, cancellations and time steps, also from
+///   within the callbacks, checked against a plain model of which timers must fire when.
+///
+#include "pch.h"
+
+#include <chrono>
+#include <deque>
+#include <random>
+#include <set>
+
+#include <live555/BasicUsageEnvironment.hh>
+
+#include "Bench.h"
+#include "TimerWheel.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			/// Client timers are in seconds: liveness, RTCP and session timeouts.
+			const int64_t MinDelayMicroSec = 1000000;
+			const int64_t MaxDelayMicroSec = 60000000;
+
+			int64_t nowMicroSec()
+			{
+				return std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()).count();
+			}
+
+			void countTimer(void* clientData)
+			{
+				++*static_cast<uint64_t*>(clientData);
+			}
+
+			///
+			/// Operations on the timers of one implementation.
+			struct TimerOperations
+			{
+				std::function<void*(int64_t)> Schedule;
+				std::function<void(void*&, int64_t)> Reschedule;
+				std::function<void(void*&)> Unschedule;
+			};
+
+			///
+			/// Time scheduling, rescheduling and unscheduling the same timers with the same delays.
+			///
+			/// @return Seconds taken by each of the three phases.
+			std::vector<double> runTimerOperations(const std::string& name, const TimerOperations& operations,
+				const std::vector<int64_t>& delays, size_t timerCount, size_t rounds)
+			{
+				std::vector<void*> tokens(timerCount);
+				std::vector<double> seconds;
+
+				Stopwatch stopwatch;
+				for (size_t i = 0; i < timerCount; ++i)
+				{
+					tokens[i] = operations.Schedule(delays[i]);
+				}
+				seconds.push_back(stopwatch.GetSeconds());
+				PrintResult(name + " schedule", timerCount, seconds.back());
+
+				stopwatch.Restart();
+				for (size_t round = 0; round < rounds; ++round)
+				{
+					for (size_t i = 0; i < timerCount; ++i)
+					{
+						operations.Reschedule(tokens[i], delays[(round * timerCount + i) % delays.size()]);
+					}
+				}
+				seconds.push_back(stopwatch.GetSeconds());
+				PrintResult(name + " reschedule", timerCount * rounds, seconds.back());
+
+				stopwatch.Restart();
+				for (auto& token : tokens)
+				{
+					operations.Unschedule(token);
+				}
+				seconds.push_back(stopwatch.GetSeconds());
+				PrintResult(name + " unschedule", timerCount, seconds.back());
+				return seconds;
+			}
+
+			///
+			/// Time firing timers spread over a few seconds, the clock advanced in 1 ms steps.
+			///
+			/// @return Timers fired.
+			uint64_t runWheelExpiry(const std::string& name, const std::vector<int64_t>& delays, size_t timerCount)
+			{
+				const int64_t stepMicroSec = 1000;
+				TimerWheel wheel(0);
+				uint64_t firedCount = 0;
+				int64_t maxDelay = 0;
+				for (size_t i = 0; i < timerCount; ++i)
+				{
+					const auto delay = delays[i] % (10 * MinDelayMicroSec);
+					wheel.Schedule(0, delay, &countTimer, &firedCount);
+					maxDelay = delay > maxDelay ? delay : maxDelay;
+				}
+
+				Stopwatch stopwatch;
+				uint64_t steps = 0;
+				for (int64_t now = 0; now <= maxDelay + stepMicroSec; now += stepMicroSec, ++steps)
+				{
+					wheel.Expire(now);
+				}
+				const auto seconds = stopwatch.GetSeconds();
+				PrintResult(name + " fire", firedCount, seconds);
+				printf("%-48s %10.1f ns per 1 ms event loop step\n", "",
+					steps > 0 ? seconds * 1e9 / static_cast<double>(steps) : 0.0);
+				return firedCount;
+			}
+
+			///
+			/// Timer of the model, the wheel's callback argument.
+			struct ModelTimer
+			{
+				/// Model the timer belongs to.
+				struct Model* Owner = nullptr;
+
+				/// Position in Model::Timers.
+				size_t Index = 0;
+
+				/// Current token, null if not scheduled.
+				void* Token = nullptr;
+
+				/// First tick the timer may fire at.
+				uint64_t ExpiryTick = 0;
+
+				/// Scheduled before the current Expire() and due by then: must fire in it.
+				bool IsExpiring = false;
+			};
+
+			///
+			/// Reference of the timer semantics, driven alongside a TimerWheel.
+			struct Model
+			{
+				std::mt19937_64 Random;
+				int64_t ResolutionMicroSec;
+				TimerWheel Wheel;
+
+				/// Timers, some scheduled; a deque so that the callback arguments stay valid.
+				std::deque<ModelTimer> Timers;
+
+				/// Indices of the scheduled timers.
+				std::set<size_t> Scheduled;
+
+				/// Tokens of timers that have fired or were cancelled.
+				std::vector<void*> StaleTokens;
+
+				/// Current time.
+				int64_t Now = 0;
+
+				/// Last tick processed by Expire().
+				uint64_t ProcessedTick = 0;
+
+				/// The callbacks of the current Expire() are running.
+				bool IsExpiring = false;
+
+				/// Inside a callback.
+				bool IsInCallback = false;
+
+				/// Timers fired by the current Expire().
+				size_t FiredCount = 0;
+
+				/// First check that failed.
+				std::string Error;
+
+				Model(uint64_t seed, int64_t resolutionMicroSec) :
+					Random(seed),
+					ResolutionMicroSec(resolutionMicroSec),
+					Wheel(0, resolutionMicroSec)
+				{
+				}
+
+				void check(bool condition, const std::string& message)
+				{
+					if (!condition && Error.empty())
+					{
+						Error = message + " at " + std::to_string(Now) + " us";
+					}
+				}
+
+				uint64_t random(uint64_t range)
+				{
+					return range > 0 ? Random() % range : 0;
+				}
+
+				///
+				/// Delay in ticks that reaches each level of the wheel.
+				int64_t randomDelay()
+				{
+					static const int64_t LevelRanges[] = { 1, 300, 70000, 20000000, 100000000 };
+					const auto level = random(sizeof(LevelRanges) / sizeof(LevelRanges[0]));
+					return static_cast<int64_t>(random(LevelRanges[level])) * ResolutionMicroSec + static_cast<int64_t>(random(ResolutionMicroSec));
+				}
+
+				uint64_t toTick(int64_t microSec) const
+				{
+					return static_cast<uint64_t>((microSec + ResolutionMicroSec - 1) / ResolutionMicroSec);
+				}
+
+				///
+				/// Pick a scheduled timer.
+				ModelTimer* randomScheduled()
+				{
+					if (Scheduled.empty())
+					{
+						return nullptr;
+					}
+					auto position = Scheduled.lower_bound(random(Timers.size()));
+					if (position == Scheduled.end())
+					{
+						position = Scheduled.begin();
+					}
+					return &Timers[*position];
+				}
+
+				void schedule()
+				{
+					const auto delay = randomDelay();
+					Timers.emplace_back();
+					auto& timer = Timers.back();
+					timer.Owner = this;
+					timer.Index = Timers.size() - 1;
+					timer.ExpiryTick = toTick(Now + delay);
+					timer.Token = Wheel.Schedule(Now, delay, &Model::fire, &timer);
+					check(timer.Token != nullptr, "null token");
+					Scheduled.insert(timer.Index);
+				}
+
+				void reschedule()
+				{
+					// A stale token schedules a new timer.
+					if (!StaleTokens.empty() && random(4) == 0)
+					{
+						const auto index = random(StaleTokens.size());
+						auto token = StaleTokens[index];
+						const auto delay = randomDelay();
+						Timers.emplace_back();
+						auto& timer = Timers.back();
+						timer.Owner = this;
+						timer.Index = Timers.size() - 1;
+						timer.ExpiryTick = toTick(Now + delay);
+						Wheel.Reschedule(token, Now, delay, &Model::fire, &timer);
+						check(token != StaleTokens[index], "stale token kept by reschedule");
+						timer.Token = token;
+						Scheduled.insert(timer.Index);
+						return;
+					}
+
+					const auto timer = randomScheduled();
+					if (timer)
+					{
+						const auto delay = randomDelay();
+						auto token = timer->Token;
+						Wheel.Reschedule(token, Now, delay, &Model::fire, timer);
+						check(token == timer->Token, "token of a scheduled timer changed by reschedule");
+						timer->ExpiryTick = toTick(Now + delay);
+						timer->IsExpiring = false;
+					}
+				}
+
+				void unschedule()
+				{
+					if (!StaleTokens.empty() && random(4) == 0)
+					{
+						check(!Wheel.Unschedule(StaleTokens[random(StaleTokens.size())]), "stale token cancelled a timer");
+						return;
+					}
+
+					const auto timer = randomScheduled();
+					if (timer)
+					{
+						check(Wheel.Unschedule(timer->Token), "scheduled timer not cancelled");
+						retire(*timer);
+					}
+				}
+
+				void retire(ModelTimer& timer)
+				{
+					StaleTokens.push_back(timer.Token);
+					timer.Token = nullptr;
+					timer.IsExpiring = false;
+					Scheduled.erase(timer.Index);
+				}
+
+				///
+				/// Random operations, as the clients' timers do from within callbacks.
+				void mutate(size_t count)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						switch (random(3))
+						{
+						case 0:
+							schedule();
+							break;
+						case 1:
+							reschedule();
+							break;
+						default:
+							unschedule();
+							break;
+						}
+					}
+				}
+
+				static void fire(void* clientData)
+				{
+					auto& timer = *static_cast<ModelTimer*>(clientData);
+					auto& model = *timer.Owner;
+					model.check(model.IsExpiring && !model.IsInCallback, "timer fired outside of Expire()");
+					model.check(timer.Token != nullptr, "cancelled timer fired");
+					model.check(timer.IsExpiring, "timer fired before it was due, or scheduled by a callback fired in the same Expire()");
+					if (!timer.Token || !timer.IsExpiring)
+					{
+						return;
+					}
+
+					++model.FiredCount;
+					model.retire(timer);
+
+					// Callbacks reschedule, cancel and schedule timers, including ones about to fire.
+					model.IsInCallback = true;
+					model.mutate(model.random(3));
+					model.IsInCallback = false;
+				}
+
+				///
+				/// Advance the clock and fire the due timers.
+				void expire(int64_t stepMicroSec)
+				{
+					Now += stepMicroSec;
+					const auto nowTick = static_cast<uint64_t>(Now / ResolutionMicroSec);
+					const auto processedTick = nowTick > ProcessedTick ? nowTick : ProcessedTick;
+
+					size_t dueCount = 0;
+					for (const auto index : Scheduled)
+					{
+						auto& timer = Timers[index];
+						timer.IsExpiring = timer.ExpiryTick <= processedTick;
+						dueCount += timer.IsExpiring ? 1 : 0;
+					}
+
+					// A timer that is due must not be reported later than now.
+					const auto timeToNextExpiry = Wheel.TimeToNextExpiry(Now);
+					if (Scheduled.empty())
+					{
+						check(timeToNextExpiry < 0, "time to next expiry without timers");
+					}
+					else if (dueCount > 0)
+					{
+						check(timeToNextExpiry == 0, "timers due but time to next expiry not 0");
+					}
+					else
+					{
+						uint64_t nextTick = UINT64_MAX;
+						for (const auto index : Scheduled)
+						{
+							nextTick = Timers[index].ExpiryTick < nextTick ? Timers[index].ExpiryTick : nextTick;
+						}
+						check(timeToNextExpiry >= 0 && timeToNextExpiry <= static_cast<int64_t>(nextTick) * ResolutionMicroSec - Now,
+							"time to next expiry later than the next timer");
+					}
+
+					IsExpiring = true;
+					FiredCount = 0;
+					const auto firedCount = Wheel.Expire(Now);
+					IsExpiring = false;
+					ProcessedTick = processedTick;
+					check(firedCount == FiredCount, "fired count differs from the callbacks run");
+
+					for (const auto index : Scheduled)
+					{
+						check(!Timers[index].IsExpiring, "due timer not fired");
+						Timers[index].IsExpiring = false;
+					}
+					check(Wheel.GetTimerCount() == Scheduled.size(), "timer count differs");
+				}
+			};
+		}
+
+		int RunTimerWheel(const Arguments& arguments)
+		{
+			const std::string name = "timer-wheel";
+			const auto timerCount = static_cast<size_t>(GetArgument(arguments, 0, 10000));
+			const auto rounds = static_cast<size_t>(GetArgument(arguments, 1, 10));
+			if (timerCount == 0)
+			{
+				return Fail(name, "at least one timer is needed");
+			}
+
+			std::mt19937_64 random(37);
+			std::vector<int64_t> delays(timerCount * 4);
+			for (auto& delay : delays)
+			{
+				delay = MinDelayMicroSec + static_cast<int64_t>(random() % (MaxDelayMicroSec - MinDelayMicroSec));
+			}
+
+			TimerWheel wheel(nowMicroSec());
+			uint64_t firedCount = 0;
+			TimerOperations wheelOperations;
+			wheelOperations.Schedule = [&](int64_t delay)
+			{
+				return wheel.Schedule(nowMicroSec(), delay, &countTimer, &firedCount);
+			};
+			wheelOperations.Reschedule = [&](void*& token, int64_t delay)
+			{
+				wheel.Reschedule(token, nowMicroSec(), delay, &countTimer, &firedCount);
+			};
+			wheelOperations.Unschedule = [&](void*& token)
+			{
+				wheel.Unschedule(token);
+				token = nullptr;
+			};
+
+			const auto scheduler = BasicTaskScheduler::createNew();
+			TimerOperations stockOperations;
+			stockOperations.Schedule = [&](int64_t delay)
+			{
+				return static_cast<void*>(scheduler->scheduleDelayedTask(delay, &countTimer, &firedCount));
+			};
+			stockOperations.Reschedule = [&](void*& token, int64_t delay)
+			{
+				scheduler->rescheduleDelayedTask(token, delay, &countTimer, &firedCount);
+			};
+			stockOperations.Unschedule = [&](void*& token)
+			{
+				scheduler->unscheduleDelayedTask(token);
+			};
+
+			const auto wheelSeconds = runTimerOperations(name + " wheel", wheelOperations, delays, timerCount, rounds);
+			const auto stockSeconds = runTimerOperations(name + " DelayQueue", stockOperations, delays, timerCount, rounds);
+			delete scheduler;
+
+			const char* const phases[] = { "schedule", "reschedule", "unschedule" };
+			for (size_t phase = 0; phase < wheelSeconds.size(); ++phase)
+			{
+				printf("%-48s %.1fx the %s rate of the DelayQueue\n", "", wheelSeconds[phase] > 0.0
+					? stockSeconds[phase] / wheelSeconds[phase] : 0.0, phases[phase]);
+			}
+
+			auto result = 0;
+			if (firedCount != 0 || wheel.GetTimerCount() != 0)
+			{
+				result = Fail(name, "timers fired or left behind while only being scheduled");
+			}
+			if (runWheelExpiry(name + " wheel", delays, timerCount) != timerCount)
+			{
+				result = Fail(name, "not all timers fired");
+			}
+			return result;
+		}
+
+		int RunTimerWheelModel(const Arguments& arguments)
+		{
+			const std::string name = "timer-wheel-model";
+			const auto stepCount = GetArgument(arguments, 0, 20000);
+			const auto seed = GetArgument(arguments, 1, 37);
+
+			// A 1 us tick reaches the upper levels of the wheel within the run, 100 us is the default.
+			const int64_t resolutions[] = { 1, TimerWheel::DefaultResolutionMicroSec };
+			for (const auto resolution : resolutions)
+			{
+				Model model(seed, resolution);
+				uint64_t firedCount = 0;
+				for (uint64_t step = 0; step < stepCount && model.Error.empty(); ++step)
+				{
+					model.mutate(model.random(8));
+
+					// Mostly event loop sized steps, now and then a long one that cascades the upper levels.
+					const auto stepTicks = model.random(50) == 0 ? model.random(500000) : model.random(2000);
+					model.expire(static_cast<int64_t>(stepTicks) * resolution + static_cast<int64_t>(model.random(resolution)));
+					firedCount += model.FiredCount;
+				}
+
+				// Run out the remaining timers, only the callbacks schedule more.
+				while (!model.Scheduled.empty() && model.Error.empty())
+				{
+					model.expire(5000000 * resolution);
+					firedCount += model.FiredCount;
+				}
+
+				if (!model.Error.empty())
+				{
+					return Fail(name, model.Error + " (" + std::to_string(resolution) + " us ticks, seed " + std::to_string(seed) + ")");
+				}
+				printf("%-48s %12llu timers fired, %zu scheduled in all, checked with %lld us ticks\n", name.c_str(),
+					static_cast<unsigned long long>(firedCount), model.Timers.size(), static_cast<long long>(resolution));
+			}
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,272 @@
+///
+/// @class UdpSendBatcherBench
+///
+/// Created 10/18/2026
+///
+/// RTP datagrams of an event loop iteration sent to many clients over loopback:
+/// - udp-batch: every client gets the packets of a video frame per iteration, sent once through
+///   live555's stock Groupsock (one sendto() per datagram) and once through BatchedGroupsock,
+///   flushing its UdpSendBatcher at the end of the iteration as the event loop does, with and
+///   without segmentation offload. The send system calls are counted and the receivers check
+///   that every datagram arrives, in order and intact.
+///
+#include "pch.h"
+
+#include <cstring>
+#include <memory>
+
+#include <live555/BasicUsageEnvironment.hh>
+
+#include "BatchedGroupsock.h"
+#include "Bench.h"
+#include "InterleavedTcpWriter.h"
+#include "UdpSendBatcher.h"
+
+namespace CvRtsp
+{
+	namespace Bench
+	{
+		namespace
+		{
+			/// RTP packet size of the frames, the last packet of a frame is shorter.
+			const unsigned PacketSize = 1400;
+			const unsigned LastPacketSize = 600;
+
+			/// Receive buffer of a client, holds the packets of several frames.
+			const int ReceiveBufferSize = 4 * 1024 * 1024;
+
+			/// Client of the bench and what it received.
+			struct Client
+			{
+				int SocketNum = -1;
+				struct sockaddr_storage Address = {};
+				uint32_t NextSequence = 0;
+				uint64_t ReceivedCount = 0;
+				uint64_t CorruptCount = 0;
+			};
+
+			///
+			/// Open a non-blocking UDP socket on a loopback port for a client.
+			///
+			/// @return False on failure.
+			bool openClient(Client& client)
+			{
+				client.SocketNum = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+				if (client.SocketNum < 0)
+				{
+					return false;
+				}
+
+				auto& address = reinterpret_cast<struct sockaddr_in&>(client.Address);
+				address.sin_family = AF_INET;
+				address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+				SOCKLEN_T addressSize = sizeof(address);
+				u_long isNonBlocking = 1;
+				return setsockopt(client.SocketNum, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&ReceiveBufferSize),
+						sizeof(ReceiveBufferSize)) == 0
+					&& bind(client.SocketNum, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0
+					&& getsockname(client.SocketNum, reinterpret_cast<struct sockaddr*>(&address), &addressSize) == 0
+					&& ioctlsocket(client.SocketNum, FIONBIO, &isNonBlocking) == 0;
+			}
+
+			///
+			/// Read all datagrams a client has received, checking the sequence number and size of each.
+			void receive(Client& client, unsigned packetsPerFrame)
+			{
+				unsigned char datagram[2048];
+				for (;;)
+				{
+					const auto size = recv(client.SocketNum, reinterpret_cast<char*>(datagram), sizeof(datagram), 0);
+					if (size <= 0)
+					{
+						break;
+					}
+
+					uint32_t sequence = 0;
+					memcpy(&sequence, datagram, sizeof(sequence));
+					const auto isLastPacket = sequence % packetsPerFrame == packetsPerFrame - 1;
+					if (sequence != client.NextSequence || size != static_cast<int>(isLastPacket ? LastPacketSize : PacketSize))
+					{
+						++client.CorruptCount;
+					}
+					client.NextSequence = sequence + 1;
+					++client.ReceivedCount;
+				}
+			}
+
+			///
+			/// Send the frames to the clients, one frame to every client per event loop iteration.
+			///
+			/// @param[in] flush Called at the end of every iteration.
+			///
+			/// @return Seconds taken.
+			double sendFrames(UsageEnvironment& env, std::vector<std::unique_ptr<Groupsock>>& groupsocks,
+				std::vector<Client>& clients, uint64_t frameCount, unsigned packetsPerFrame, const std::function<void()>& flush)
+			{
+				for (auto& client : clients)
+				{
+					client.NextSequence = 0;
+					client.ReceivedCount = 0;
+					client.CorruptCount = 0;
+				}
+
+				unsigned char packet[PacketSize] = {};
+				Stopwatch stopwatch;
+				for (uint64_t frame = 0; frame < frameCount; ++frame)
+				{
+					// The sinks of the clients take turns, as they are scheduled by the event loop.
+					for (unsigned packetIndex = 0; packetIndex < packetsPerFrame; ++packetIndex)
+					{
+						const auto sequence = static_cast<uint32_t>(frame * packetsPerFrame + packetIndex);
+						memcpy(packet, &sequence, sizeof(sequence));
+						const auto size = packetIndex == packetsPerFrame - 1 ? LastPacketSize : PacketSize;
+						for (auto& groupsock : groupsocks)
+						{
+							groupsock->output(env, packet, size);
+						}
+					}
+					flush();
+
+					for (auto& client : clients)
+					{
+						receive(client, packetsPerFrame);
+					}
+				}
+				return stopwatch.GetSeconds();
+			}
+
+			///
+			/// Check that every client received every datagram, in order and intact.
+			///
+			/// @return Empty if so, what went wrong otherwise.
+			std::string checkClients(const std::vector<Client>& clients, uint64_t expectedCount)
+			{
+				uint64_t receivedCount = 0;
+				uint64_t corruptCount = 0;
+				for (const auto& client : clients)
+				{
+					receivedCount += client.ReceivedCount;
+					corruptCount += client.CorruptCount;
+				}
+				if (receivedCount != expectedCount || corruptCount > 0)
+				{
+					return std::to_string(receivedCount) + " of " + std::to_string(expectedCount) + " datagrams received, "
+						+ std::to_string(corruptCount) + " out of order or corrupt";
+				}
+				return std::string();
+			}
+
+			///
+			/// Groupsocks on an ephemeral port, one per client, as the subsessions create them.
+			///
+			/// @param[in] createGroupsock Creates a groupsock bound to an address and port.
+			template<typename CreateGroupsock>
+			std::vector<std::unique_ptr<Groupsock>> createGroupsocks(const std::vector<Client>& clients, CreateGroupsock createGroupsock)
+			{
+				struct sockaddr_storage anyAddress = {};
+				reinterpret_cast<struct sockaddr_in&>(anyAddress).sin_family = AF_INET;
+
+				std::vector<std::unique_ptr<Groupsock>> groupsocks;
+				for (size_t index = 0; index < clients.size(); ++index)
+				{
+					groupsocks.emplace_back(createGroupsock(anyAddress, Port(0)));
+					const auto& address = reinterpret_cast<const struct sockaddr_in&>(clients[index].Address);
+					groupsocks.back()->addDestination(clients[index].Address, Port(ntohs(address.sin_port)),
+						static_cast<unsigned>(index + 1));
+				}
+				return groupsocks;
+			}
+		}
+
+		int RunUdpBatch(const Arguments& arguments)
+		{
+			const std::string name = "udp-batch";
+			const auto clientCount = static_cast<size_t>(GetArgument(arguments, 0, 200));
+			const auto frameCount = GetArgument(arguments, 1, 300);
+			const auto packetsPerFrame = static_cast<unsigned>(GetArgument(arguments, 2, 30));
+			if (clientCount == 0 || packetsPerFrame == 0)
+			{
+				return Fail(name, "at least one client and one packet per frame are needed");
+			}
+
+			WSADATA wsaData;
+			if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+			{
+				return Fail(name, "unable to initialize winsock");
+			}
+
+			auto result = 0;
+			std::vector<Client> clients(clientCount);
+			for (auto& client : clients)
+			{
+				if (!openClient(client))
+				{
+					result = Fail(name, "unable to open client socket");
+					break;
+				}
+			}
+
+			const auto scheduler = BasicTaskScheduler::createNew();
+			const auto env = BasicUsageEnvironment::createNew(*scheduler);
+			const auto datagramCount = clientCount * frameCount * packetsPerFrame;
+			if (result == 0)
+			{
+				// live555's groupsock, a sendto() per datagram and destination.
+				auto groupsocks = createGroupsocks(clients, [env](const struct sockaddr_storage& address, Port port)
+					{
+						return new Groupsock(*env, address, port, 255);
+					});
+				const auto stockSeconds = sendFrames(*env, groupsocks, clients, frameCount, packetsPerFrame, []() {});
+				PrintResult(name + " Groupsock datagrams", datagramCount, stockSeconds);
+				printf("%-48s %12llu send calls\n", "", static_cast<unsigned long long>(datagramCount));
+				auto error = checkClients(clients, datagramCount);
+				groupsocks.clear();
+
+				// Batched, with and without segmentation offload.
+				for (const auto isSegmentationOffloadEnabled : { true, false })
+				{
+					UdpSendBatcher sendBatcher;
+					InterleavedTcpWriter tcpWriter;
+					sendBatcher.SetSegmentationOffload(isSegmentationOffloadEnabled);
+					groupsocks = createGroupsocks(clients, [&](const struct sockaddr_storage& address, Port port)
+						{
+							return new BatchedGroupsock(*env, address, port, 255, sendBatcher, tcpWriter);
+						});
+
+					const auto batchName = name + (isSegmentationOffloadEnabled ? " batched, offload" : " batched, no offload");
+					const auto seconds = sendFrames(*env, groupsocks, clients, frameCount, packetsPerFrame,
+						[&sendBatcher]() { sendBatcher.Flush(); });
+					groupsocks.clear();
+
+					const auto sendCallCount = sendBatcher.GetSendCallCount();
+					PrintResult(batchName + " datagrams", datagramCount, seconds);
+					printf("%-48s %12llu send calls, %.1f datagrams per call, %.1fx the rate of Groupsock\n", "",
+						static_cast<unsigned long long>(sendCallCount),
+						sendCallCount > 0 ? static_cast<double>(datagramCount) / static_cast<double>(sendCallCount) : 0.0,
+						seconds > 0.0 ? stockSeconds / seconds : 0.0);
+					if (error.empty())
+					{
+						error = checkClients(clients, datagramCount);
+					}
+				}
+
+				if (!error.empty())
+				{
+					result = Fail(name, error);
+				}
+			}
+
+			env->reclaim();
+			delete scheduler;
+			for (const auto& client : clients)
+			{
+				if (client.SocketNum >= 0)
+				{
+					closesocket(client.SocketNum);
+				}
+			}
+			WSACleanup();
+			return result;
+		}
+	}
+}
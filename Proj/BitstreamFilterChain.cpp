@@ -0,0 +1,124 @@
+///
+/// @class BitstreamFilterChain
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "BitstreamFilterChain.h"
+
+using namespace CvRtsp;
+
+void
+BitstreamFilterChain::
+SplitAccessUnit(const BYTE* data, uint32_t size, NalUnitSliceList& nalUnits)
+{
+	nalUnits.clear();
+	if (!data || size < NalUnitPrefixWithoutZeroBitSize)
+	{
+		return;
+	}
+
+	// Offset of the current nal unit (after its start code), -1 until the first start code.
+	int64_t nalUnitStart = -1;
+	uint32_t i = 0;
+	while (i + NalUnitPrefixWithoutZeroBitSize <= size)
+	{
+		if (data[i] == 0x00 && data[i + 1] == 0x00 && data[i + 2] == 0x01)
+		{
+			if (nalUnitStart >= 0)
+			{
+				// The end of the previous nal unit; a 4 byte start code has an extra zero byte.
+				auto nalUnitEnd = i;
+				if (nalUnitEnd > static_cast<uint32_t>(nalUnitStart) && data[nalUnitEnd - 1] == 0x00)
+				{
+					--nalUnitEnd;
+				}
+				if (nalUnitEnd > static_cast<uint32_t>(nalUnitStart))
+				{
+					nalUnits.emplace_back(data + nalUnitStart, nalUnitEnd - static_cast<uint32_t>(nalUnitStart));
+				}
+			}
+			i += NalUnitPrefixWithoutZeroBitSize;
+			nalUnitStart = i;
+			continue;
+		}
+		++i;
+	}
+
+	if (nalUnitStart < 0)
+	{
+		// No start code at all: treat the buffer as a single nal unit.
+		nalUnits.emplace_back(data, size);
+	}
+	else if (static_cast<uint32_t>(nalUnitStart) < size)
+	{
+		nalUnits.emplace_back(data + nalUnitStart, size - static_cast<uint32_t>(nalUnitStart));
+	}
+}
+
+std::shared_ptr<MediaSample>
+BitstreamFilterChain::
+Process(const std::shared_ptr<MediaSample>& mediaSample)
+{
+	if (m_filters.empty() || !mediaSample)
+	{
+		return mediaSample;
+	}
+
+	SplitAccessUnit(mediaSample->GetDataBuffer().Data(), static_cast<uint32_t>(mediaSample->GetSize()), m_nalUnits);
+
+	auto isLayoutChanged = false;
+	for (const auto& filter : m_filters)
+	{
+		if (filter->Filter(m_nalUnits))
+		{
+			isLayoutChanged = true;
+		}
+	}
+
+	if (!isLayoutChanged)
+	{
+		// Nothing changed, the sample can be passed on as is.
+		m_nalUnits.clear();
+		return mediaSample;
+	}
+
+	if (m_nalUnits.empty())
+	{
+		return nullptr;
+	}
+
+	// Re-assemble the access unit using 4 byte start codes, straight into a new sample: the
+	// original may be shared with other channels or borrowed, and is left untouched.
+	size_t totalSize = 0;
+	for (const auto& nalUnit : m_nalUnits)
+	{
+		totalSize += NalUnitPrefixWithZeroBitSize + nalUnit.Size;
+	}
+
+	auto filteredSample = MediaSample::AllocateMediaSample(static_cast<int>(totalSize), mediaSample->StartTime(),
+		mediaSample->GetIsKeyFrame());
+	filteredSample->SetMarker(mediaSample->IsMarkerSet());
+	filteredSample->SetChannelId(mediaSample->GetChannelId());
+	filteredSample->SetChannelName(mediaSample->GetChannelName());
+	filteredSample->SetSourceId(mediaSample->GetSourceId());
+
+	auto writePosition = filteredSample->GetDataBuffer().Data();
+	for (const auto& nalUnit : m_nalUnits)
+	{
+		memcpy(writePosition, NalUnitPrefixWithZeroBit, NalUnitPrefixWithZeroBitSize);
+		writePosition += NalUnitPrefixWithZeroBitSize;
+		if (nalUnit.Size > 0)
+		{
+			*writePosition = nalUnit.Header;
+			memcpy(writePosition + 1, nalUnit.Data + 1, nalUnit.Size - 1);
+		}
+		writePosition += nalUnit.Size;
+	}
+
+	// The views may point into the original sample, don't keep them around.
+	m_nalUnits.clear();
+
+	return filteredSample;
+}
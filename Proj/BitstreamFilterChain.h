@@ -0,0 +1,87 @@
+///
+/// @class BitstreamFilterChain
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "IBitstreamFilter.h"
+#include "MediaSample.h"
+
+namespace CvRtsp
+{
+	///
+	/// Ordered list of bitstream filters that is executed once per media sample.
+	///
+	/// The access unit is split into nal unit views once, all filters operate on those
+	/// views, and the access unit is only re-assembled (one copy, into the new sample) if a
+	/// filter removed, inserted or rewrote nal units. The media sample itself is never
+	/// modified, it may be shared. An empty chain returns the media sample untouched.
+	class BitstreamFilterChain
+	{
+	public:
+		///
+		/// Default constructor.
+		BitstreamFilterChain() = default;
+
+		///
+		/// Disallow copying, the chain owns its filters.
+		BitstreamFilterChain(const BitstreamFilterChain&) = delete;
+		BitstreamFilterChain& operator=(const BitstreamFilterChain&) = delete;
+
+		///
+		/// Append a filter to the end of the chain. The chain takes ownership.
+		///
+		/// @param[in] filter Bitstream filter.
+		void AddFilter(std::unique_ptr<IBitstreamFilter> filter)
+		{
+			if (filter)
+			{
+				m_filters.emplace_back(std::move(filter));
+			}
+		}
+
+		///
+		/// Remove all filters from the chain.
+		void Clear()
+		{
+			m_filters.clear();
+		}
+
+		///
+		/// Check if the chain contains any filters.
+		///
+		/// @return True if there are no filters.
+		bool IsEmpty() const
+		{
+			return m_filters.empty();
+		}
+
+		///
+		/// Run all filters over the media sample.
+		///
+		/// @param[in] mediaSample Annex-B framed media sample.
+		///
+		/// @return The filtered media sample, which is the passed in sample if no filter changed
+		/// anything, or nullptr if all nal units were filtered out.
+		std::shared_ptr<MediaSample> Process(const std::shared_ptr<MediaSample>& mediaSample);
+
+		///
+		/// Split an Annex-B access unit into nal unit views.
+		///
+		/// @param[in] data Access unit.
+		/// @param[in] size Size of the access unit.
+		/// @param[out] nalUnits Nal units found, start codes are not included.
+		static void SplitAccessUnit(const BYTE* data, uint32_t size, NalUnitSliceList& nalUnits);
+
+	private:
+		/// Filters, in order of execution.
+		std::vector<std::unique_ptr<IBitstreamFilter>> m_filters;
+
+		/// Nal unit views of the current access unit, kept to avoid re-allocating per frame.
+		NalUnitSliceList m_nalUnits;
+	};
+}
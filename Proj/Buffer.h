@@ -24,7 +24,8 @@ namespace CvRtsp
 			m_buffer(nullptr),
 			m_size(0),
 			m_prebufferSize(0),
-			m_postbufferSize(0)
+			m_postbufferSize(0),
+			m_borrowedData(nullptr)
 		{
 		}
 
@@ -37,7 +38,8 @@ namespace CvRtsp
 			m_buffer(std::make_unique<BYTE[]>(size)),
 			m_size(size),
 			m_prebufferSize(0),
-			m_postbufferSize(0)
+			m_postbufferSize(0),
+			m_borrowedData(nullptr)
 		{
 			memcpy(m_buffer.get(), buffer, size);
 		}
@@ -56,7 +58,8 @@ namespace CvRtsp
 			m_buffer(std::make_unique<BYTE[]>(size + prebufferSize + postbufferSize)),
 			m_size(size),
 			m_prebufferSize(prebufferSize),
-			m_postbufferSize(postbufferSize)
+			m_postbufferSize(postbufferSize),
+			m_borrowedData(nullptr)
 		{
 			assert(prebufferSize >= 0 && postbufferSize >= 0);
 			if (size < m_prebufferSize + m_postbufferSize)
@@ -78,7 +81,7 @@ namespace CvRtsp
 		/// @return Reference as byte element.
 		BYTE& operator[](const std::ptrdiff_t index) const
 		{
-			return m_buffer[index + m_prebufferSize];
+			return Data()[index];
 		}
 
 		/// 
@@ -123,7 +126,16 @@ namespace CvRtsp
 		/// @return Pointer to data.
 		BYTE* Data() const
 		{
-			return m_buffer.get() + m_prebufferSize;
+			return m_borrowedData ? m_borrowedData : m_buffer.get() + m_prebufferSize;
+		}
+
+		///
+		/// Does the buffer refer to data owned by someone else.
+		///
+		/// @return True if the data has been set with SetBorrowedData().
+		bool IsBorrowed() const
+		{
+			return m_borrowedData != nullptr;
 		}
 
 		/// 
@@ -137,6 +149,8 @@ namespace CvRtsp
 			{
 				m_buffer.reset();
 			}
+			m_borrowedData = nullptr;
+			m_owner.reset();
 			m_size = size;
 			m_prebufferSize = 0;
 			m_postbufferSize = 0;
@@ -145,6 +159,38 @@ namespace CvRtsp
 			memcpy(m_buffer.get(), buffer, size);
 		}
 
+		///
+		/// Allocate room for data without initializing it, to be filled in through Data().
+		///
+		/// @param[in] size Size of the data.
+		void Allocate(size_t size)
+		{
+			m_borrowedData = nullptr;
+			m_owner.reset();
+			m_size = size;
+			m_prebufferSize = 0;
+			m_postbufferSize = 0;
+			m_buffer = DataBuffer(new BYTE[size]);
+		}
+
+		///
+		/// Refer to data owned by someone else instead of copying it. The data must stay valid
+		/// as long as the owner is alive, the buffer releases the owner when it is destroyed or
+		/// its data is replaced.
+		///
+		/// @param[in] buffer	Data.
+		/// @param[in] size		Size of the data.
+		/// @param[in] owner	Keeps the data alive.
+		void SetBorrowedData(BYTE* buffer, size_t size, std::shared_ptr<void> owner)
+		{
+			m_buffer.reset();
+			m_size = size;
+			m_prebufferSize = 0;
+			m_postbufferSize = 0;
+			m_borrowedData = buffer;
+			m_owner = std::move(owner);
+		}
+
 	private:
 		/// Buffer containing the data.
 		DataBuffer m_buffer;
@@ -157,5 +203,11 @@ namespace CvRtsp
 
 		/// Size of the postbuffer.
 		size_t m_postbufferSize;
+
+		/// Data set with SetBorrowedData(), nullptr if the data is in m_buffer.
+		BYTE* m_borrowedData;
+
+		/// Keeps the borrowed data alive.
+		std::shared_ptr<void> m_owner;
 	};
 }
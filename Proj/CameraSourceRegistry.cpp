@@ -0,0 +1,76 @@
+///
+/// @class CameraSourceRegistry
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <boost/uuid/nil_generator.hpp>
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "CameraSourceRegistry.h"
+
+using namespace CvRtsp;
+
+std::shared_ptr<MediaChannel>
+CameraSourceRegistry::
+GetCameraSource(unsigned cameraId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return getCameraSource(cameraId);
+}
+
+void
+CameraSourceRegistry::
+Subscribe(unsigned cameraId, const std::shared_ptr<MediaChannel>& mediaChannel)
+{
+	std::shared_ptr<FanOutMediaChannel> cameraSource;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		cameraSource = getCameraSource(cameraId);
+	}
+
+	// Waits for samples being handed on, outside of the lock.
+	cameraSource->Subscribe(mediaChannel);
+	log_rtsp_debug("CameraSourceRegistry: camera " + std::to_string(cameraId) + " has "
+		+ std::to_string(cameraSource->GetSubscriberCount()) + " subscribers.");
+}
+
+void
+CameraSourceRegistry::
+Unsubscribe(unsigned cameraId, const std::shared_ptr<MediaChannel>& mediaChannel)
+{
+	std::shared_ptr<FanOutMediaChannel> cameraSource;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const auto source = m_cameraSources.find(cameraId);
+		if (source == m_cameraSources.end())
+		{
+			log_rtsp_warning("CameraSourceRegistry: camera " + std::to_string(cameraId) + " not found.");
+			return;
+		}
+		cameraSource = source->second;
+	}
+
+	cameraSource->Unsubscribe(mediaChannel);
+}
+
+void
+CameraSourceRegistry::
+RemoveCamera(unsigned cameraId)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_cameraSources.erase(cameraId);
+}
+
+std::shared_ptr<FanOutMediaChannel>
+CameraSourceRegistry::
+getCameraSource(unsigned cameraId)
+{
+	auto& cameraSource = m_cameraSources[cameraId];
+	if (!cameraSource)
+	{
+		cameraSource = std::make_shared<FanOutMediaChannel>(boost::uuids::nil_uuid(), "camera-" + std::to_string(cameraId));
+	}
+	return cameraSource;
+}
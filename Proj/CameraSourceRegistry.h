@@ -0,0 +1,78 @@
+///
+/// @class CameraSourceRegistry
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "FanOutMediaChannel.h"
+
+namespace CvRtsp
+{
+	///
+	/// Shared per-camera sources, so that several channels of the same camera (RtspChannel::CameraId),
+	/// e.g. aliases or per-tenant names, are fed by a single ingest.
+	///
+	/// The producer adds the samples of a camera to its source once. The source hands them by
+	/// reference to the media channels subscribed to it: the packet manager of a channel
+	/// (MultiChannelManager::AddChannel()) or the media channel of a sharded channel
+	/// (ShardedRtspServer::AddChannel()), for channels with RtspChannel::IsCameraSourceShared set.
+	/// The demand of the source covers all its subscribers, the producer sees a camera nobody watches.
+	///
+	/// Only the ingest is shared: the subsessions of each channel still parse and prepare the
+	/// samples for their own clients.
+	///
+	/// A channel must be unsubscribed before it is removed, otherwise its queue keeps filling up;
+	/// channels added through the managers above are unsubscribed when they are removed.
+	class CameraSourceRegistry
+	{
+	public:
+		///
+		/// Get the source of a camera, created on first use.
+		///
+		/// @param[in] cameraId Camera id.
+		///
+		/// @return Media channel that the producer adds the samples of the camera to.
+		std::shared_ptr<MediaChannel> GetCameraSource(unsigned cameraId);
+
+		///
+		/// Hand the samples of a camera to a channel as well.
+		///
+		/// @param[in] cameraId		Camera id.
+		/// @param[in] mediaChannel	Media channel of the channel.
+		void Subscribe(unsigned cameraId, const std::shared_ptr<MediaChannel>& mediaChannel);
+
+		///
+		/// Stop handing the samples of a camera to a channel.
+		///
+		/// @param[in] cameraId		Camera id.
+		/// @param[in] mediaChannel	Media channel of the channel.
+		void Unsubscribe(unsigned cameraId, const std::shared_ptr<MediaChannel>& mediaChannel);
+
+		///
+		/// Remove the source of a camera. Sources handed out for it stay valid, samples added to
+		/// them are handed to the channels still subscribed.
+		///
+		/// @param[in] cameraId Camera id.
+		void RemoveCamera(unsigned cameraId);
+
+	private:
+		/// Guards m_cameraSources.
+		std::mutex m_mutex;
+
+		/// Sources by camera id.
+		std::map<unsigned, std::shared_ptr<FanOutMediaChannel>> m_cameraSources;
+
+		///
+		/// Get the source of a camera, created on first use. Must be called with m_mutex held.
+		///
+		/// @param[in] cameraId Camera id.
+		///
+		/// @return Camera source.
+		std::shared_ptr<FanOutMediaChannel> getCameraSource(unsigned cameraId);
+	};
+}
@@ -24,10 +24,15 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 ///
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <boost/uuid/uuid.hpp>
 
 #include "MediaSample.h"
+#include "MediaArrivalSignal.h"
+#include "MediaQueueHandle.h"
+#include "MediaReadyList.h"
 
 namespace CvRtsp
 {
@@ -51,5 +56,140 @@ namespace CvRtsp
 		/// @return Media sample, nullptr if not found.
 		virtual std::shared_ptr<MediaSample> GetMedia(const boost::uuids::uuid &channelId, 
 			const std::string& channelName, uint32_t sourceId) = 0;
+
+		///
+		/// Get up to maxCount media samples of the specified channel and source id in one go. The
+		/// default asks GetMedia() per sample, implementations should override it to look the
+		/// channel up once.
+		///
+		/// @param[in] channelId	Unique Channel id.
+		/// @param[in] channelName	Channel name.
+		/// @param[in] sourceId		Source id.
+		/// @param[out] mediaSamples Receives the samples, room for maxCount.
+		/// @param[in] maxCount		Maximum number of samples.
+		///
+		/// @return Number of samples returned.
+		virtual size_t GetMediaBatch(const boost::uuids::uuid& channelId, const std::string& channelName,
+			uint32_t sourceId, std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount)
+		{
+			size_t count = 0;
+			while (count < maxCount && (mediaSamples[count] = GetMedia(channelId, channelName, sourceId)) != nullptr)
+			{
+				++count;
+			}
+			return count;
+		}
+
+		///
+		/// Get up to maxCount media samples from a queue resolved with ResolveMediaQueue(), with a
+		/// single update of the queue indices.
+		///
+		/// @param[in] mediaQueue	Valid media queue handle.
+		/// @param[out] mediaSamples Receives the samples, room for maxCount.
+		/// @param[in] maxCount		Maximum number of samples.
+		///
+		/// @return Number of samples returned.
+		static size_t GetMediaBatch(const MediaQueueHandle& mediaQueue, std::shared_ptr<MediaSample>* mediaSamples,
+			size_t maxCount)
+		{
+			return mediaQueue.PopBatch(mediaSamples, maxCount);
+		}
+
+		///
+		/// Resolve the queue that GetMedia() would read for a channel and source id, so that the
+		/// caller can dequeue from it directly. Implementations that do not support this return an
+		/// invalid handle and the caller keeps using GetMedia().
+		///
+		/// @param[in] channelId	Unique Channel id.
+		/// @param[in] channelName	Channel name.
+		/// @param[in] sourceId		Source id.
+		///
+		/// @return Media queue handle, invalid if the queue cannot be resolved.
+		virtual MediaQueueHandle ResolveMediaQueue(const boost::uuids::uuid& /*channelId*/,
+			const std::string& /*channelName*/, uint32_t /*sourceId*/)
+		{
+			return MediaQueueHandle();
+		}
+
+		///
+		/// Get the media queue generation. It changes whenever channels or source ids change,
+		/// handles resolved before the change must then be resolved again.
+		///
+		/// @return Media queue generation.
+		uint64_t GetMediaQueueGeneration() const
+		{
+			return m_mediaQueueGeneration.load(std::memory_order_acquire);
+		}
+
+		///
+		/// Get the signal that wakes up the task scheduler serving the channels. It belongs to the
+		/// channel manager, not to the task scheduler: producers may still be adding media when a
+		/// scheduler is destroyed, and must not signal a destroyed one. Called on the event loop thread.
+		///
+		/// @return Media arrival signal.
+		MediaArrivalSignal& GetMediaArrivalSignal()
+		{
+			if (!m_ownedMediaArrivalSignal)
+			{
+				m_ownedMediaArrivalSignal.reset(new MediaArrivalSignal());
+			}
+			return *m_ownedMediaArrivalSignal;
+		}
+
+		///
+		/// Get the list the media queues of the channels are put on when they receive samples. Like
+		/// the media arrival signal it outlives the task schedulers that drain it.
+		///
+		/// @return Ready list.
+		MediaReadyList& GetMediaReadyList()
+		{
+			return m_mediaReadyList;
+		}
+
+		///
+		/// Set the signal that the media channels raise when media is added, called by the task scheduler.
+		/// Implementations must pass it on to the media channels they create.
+		///
+		/// @param[in] mediaArrivalSignal Signal of the task scheduler, nullptr to detach.
+		virtual void SetMediaArrivalSignal(MediaArrivalSignal* mediaArrivalSignal)
+		{
+			m_mediaArrivalSignal = mediaArrivalSignal;
+		}
+
+		///
+		/// Report the number of consumers of a channel's source, called by the task scheduler
+		/// whenever clients, timeshift buffers or segment stores come and go. Implementations
+		/// pass it on to the media channel (MediaChannel::SetWatcherCount()), the default
+		/// ignores it.
+		///
+		/// @param[in] channelId	Unique Channel id.
+		/// @param[in] channelName	Channel name.
+		/// @param[in] sourceId		Source id.
+		/// @param[in] watcherCount	Number of consumers.
+		virtual void SetWatcherCount(const boost::uuids::uuid& /*channelId*/, const std::string& /*channelName*/,
+			uint32_t /*sourceId*/, uint32_t /*watcherCount*/)
+		{
+		}
+
+	protected:
+		///
+		/// Invalidate all resolved media queue handles, called after channels or source ids changed.
+		void invalidateMediaQueues()
+		{
+			m_mediaQueueGeneration.fetch_add(1, std::memory_order_acq_rel);
+		}
+
+		/// Signal of the task scheduler, not owned.
+		MediaArrivalSignal* m_mediaArrivalSignal = nullptr;
+
+	private:
+		/// Signal handed out by GetMediaArrivalSignal(), created by the first task scheduler.
+		std::unique_ptr<MediaArrivalSignal> m_ownedMediaArrivalSignal;
+
+		/// Ready list handed out by GetMediaReadyList().
+		MediaReadyList m_mediaReadyList;
+
+		/// Media queue generation.
+		std::atomic<uint64_t> m_mediaQueueGeneration{ 0 };
 	};
 }
@@ -54,6 +54,39 @@ namespace CvRtsp
 	{
 		return (nalUnitHeader & 0x1f) == 8;
 	}
+
+	///
+	/// Determine if nal unit header is supplemental enhancement information.
+	///
+	/// @param[in] nalUnitHeader Nal unit header.
+	///
+	/// @return True if the nal unit is a sei.
+	static bool isH264Sei(unsigned char nalUnitHeader)
+	{
+		return (nalUnitHeader & 0x1f) == 6;
+	}
+
+	///
+	/// Determine if nal unit header is an access unit delimiter.
+	///
+	/// @param[in] nalUnitHeader Nal unit header.
+	///
+	/// @return True if the nal unit is an aud.
+	static bool isH264AccessUnitDelimiter(unsigned char nalUnitHeader)
+	{
+		return (nalUnitHeader & 0x1f) == 9;
+	}
+
+	///
+	/// Determine if nal unit header contains filler data.
+	///
+	/// @param[in] nalUnitHeader Nal unit header.
+	///
+	/// @return True if the nal unit is filler data.
+	static bool isH264FillerData(unsigned char nalUnitHeader)
+	{
+		return (nalUnitHeader & 0x1f) == 12;
+	}
 #pragma endregion
 
 
@@ -133,6 +166,8 @@ namespace CvRtsp
 		static const std::string H265("H265");
 		static const std::string AMR("AMR");
 		static const std::string AAC("AAC");
+		static const std::string PCMU("PCMU");
+		static const std::string PCMA("PCMA");
 		static const std::string MMF("MMF");
 	}
 #pragma endregion
@@ -0,0 +1,43 @@
+///
+/// @class DeficitRoundRobinChannel
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "DeficitRoundRobinChannel.h"
+#include "MediaSample.h"
+
+using namespace CvRtsp;
+
+DeficitRoundRobinChannel::
+DeficitRoundRobinChannel(unsigned weight) :
+	m_weight(weight > 0 ? weight : 1),
+	m_deficit(0)
+{
+}
+
+void
+DeficitRoundRobinChannel::
+BeginRound(unsigned byteQuantum, unsigned timeQuantumMicroSec)
+{
+	m_deficit += static_cast<int64_t>(m_weight) * byteQuantum;
+	m_roundEnd = std::chrono::steady_clock::now()
+		+ std::chrono::microseconds(static_cast<int64_t>(m_weight) * timeQuantumMicroSec);
+}
+
+void
+DeficitRoundRobinChannel::
+OnDequeued(const MediaSample& mediaSample)
+{
+	m_deficit -= mediaSample.GetSize();
+
+	// Samples that did not come through a media channel carry no arrival time.
+	const auto arrivalTime = mediaSample.GetArrivalTime();
+	if (arrivalTime != std::chrono::steady_clock::time_point())
+	{
+		const auto delay = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - arrivalTime).count();
+		m_schedulingDelay.Add(delay > 0 ? static_cast<uint64_t>(delay) : 0);
+	}
+}
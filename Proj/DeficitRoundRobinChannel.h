@@ -0,0 +1,128 @@
+///
+/// @class DeficitRoundRobinChannel
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "SchedulingDelayHistogram.h"
+
+namespace CvRtsp
+{
+	/// Forward declarations
+	class MediaSample;
+
+	///
+	/// Scheduling state of one media subsession in the event loop's weighted deficit round robin.
+	///
+	/// Each round the channel is credited its weight times the byte quantum and may dequeue samples
+	/// while it has credit left, a sample that overdraws the credit is still processed and the debt
+	/// carries over to the next round. The round is additionally cut off after the weight times the
+	/// time quantum, which bounds the time spent on expensive samples whatever their size. An idle
+	/// channel does not bank credit.
+	///
+	/// A round therefore takes at most the largest weighted time quantum plus the processing time
+	/// of one sample, and a backlogged channel is served at least once per round.
+	class DeficitRoundRobinChannel
+	{
+	public:
+		/// Default byte quantum per round and unit of weight.
+		static const unsigned DefaultByteQuantum = 64 * 1024;
+
+		/// Default time quantum per round and unit of weight, in microseconds.
+		static const unsigned DefaultTimeQuantumMicroSec = 2000;
+
+		///
+		/// Constructor.
+		///
+		/// @param[in] weight Relative share of the event loop, at least 1.
+		explicit DeficitRoundRobinChannel(unsigned weight = 1);
+
+		DeficitRoundRobinChannel(const DeficitRoundRobinChannel&) = delete;
+		DeficitRoundRobinChannel& operator=(const DeficitRoundRobinChannel&) = delete;
+
+		///
+		/// Set the relative share of the event loop, takes effect with the next round.
+		///
+		/// @param[in] weight Weight, at least 1.
+		void SetWeight(unsigned weight)
+		{
+			m_weight = weight > 0 ? weight : 1;
+		}
+
+		///
+		/// Get the relative share of the event loop.
+		///
+		/// @return Weight.
+		unsigned GetWeight() const
+		{
+			return m_weight;
+		}
+
+		///
+		/// Start a round: credit the quanta.
+		///
+		/// @param[in] byteQuantum Bytes per round and unit of weight.
+		/// @param[in] timeQuantumMicroSec Time per round and unit of weight in microseconds.
+		void BeginRound(unsigned byteQuantum, unsigned timeQuantumMicroSec);
+
+		///
+		/// May the channel dequeue another sample in this round.
+		///
+		/// @return True if credit and time are left.
+		bool CanDequeue() const
+		{
+			return m_deficit > 0 && std::chrono::steady_clock::now() < m_roundEnd;
+		}
+
+		///
+		/// Charge a dequeued sample and record its scheduling delay.
+		///
+		/// @param[in] mediaSample Dequeued media sample.
+		void OnDequeued(const MediaSample& mediaSample);
+
+		///
+		/// Finish a round.
+		///
+		/// @param[in] isQueueEmpty True if the round ended because the channel ran out of samples.
+		void EndRound(bool isQueueEmpty)
+		{
+			if (isQueueEmpty && m_deficit > 0)
+			{
+				m_deficit = 0;
+			}
+		}
+
+		///
+		/// Get the scheduling delays of the samples dequeued so far.
+		///
+		/// @return Scheduling delay histogram.
+		const SchedulingDelayHistogram& GetSchedulingDelayHistogram() const
+		{
+			return m_schedulingDelay;
+		}
+
+		///
+		/// Clear the scheduling delay histogram.
+		void ResetSchedulingDelayHistogram()
+		{
+			m_schedulingDelay.Reset();
+		}
+
+	private:
+		/// Relative share of the event loop.
+		unsigned m_weight;
+
+		/// Bytes left in this round, negative if the last sample overdrew the credit.
+		int64_t m_deficit;
+
+		/// End of this round's time quantum.
+		std::chrono::steady_clock::time_point m_roundEnd;
+
+		/// Scheduling delays of dequeued samples.
+		SchedulingDelayHistogram m_schedulingDelay;
+	};
+}
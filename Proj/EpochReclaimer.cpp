@@ -0,0 +1,73 @@
+///
+/// @class EpochReclaimer
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <functional>
+#include <thread>
+
+#include "EpochReclaimer.h"
+
+using namespace CvRtsp;
+
+EpochReclaimer::ReadGuard::
+ReadGuard(EpochReclaimer& reclaimer) :
+	m_readerCount(reclaimer.m_readerSlots[readerSlotIndex()]
+		.Count[reclaimer.m_epoch.load(std::memory_order_seq_cst) & 1])
+{
+	// Sequentially consistent, so that the data is read after the reader has been counted.
+	m_readerCount.fetch_add(1, std::memory_order_seq_cst);
+}
+
+EpochReclaimer::ReadGuard::
+~ReadGuard()
+{
+	m_readerCount.fetch_sub(1, std::memory_order_release);
+}
+
+EpochReclaimer::
+EpochReclaimer() :
+	m_epoch(0)
+{
+	for (auto& readerSlot : m_readerSlots)
+	{
+		readerSlot.Count[0].store(0, std::memory_order_relaxed);
+		readerSlot.Count[1].store(0, std::memory_order_relaxed);
+	}
+}
+
+void
+EpochReclaimer::
+Synchronize()
+{
+	std::lock_guard<std::mutex> lock(m_synchronizeMutex);
+
+	// A reader may have read the epoch before the first flip and count itself in the previous
+	// epoch only after the first wait has finished: the second flip and wait catches it.
+	flipAndWait();
+	flipAndWait();
+}
+
+void
+EpochReclaimer::
+flipAndWait()
+{
+	const auto parity = m_epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+	for (auto& readerSlot : m_readerSlots)
+	{
+		while (readerSlot.Count[parity].load(std::memory_order_acquire) != 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+size_t
+EpochReclaimer::
+readerSlotIndex()
+{
+	static thread_local const size_t slotIndex = std::hash<std::thread::id>()(std::this_thread::get_id()) % ReaderSlotCount;
+	return slotIndex;
+}
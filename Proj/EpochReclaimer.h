@@ -0,0 +1,103 @@
+///
+/// @class EpochReclaimer
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace CvRtsp
+{
+	///
+	/// Epoch-based reclamation for data structures that are read without locks and replaced by
+	/// writers (read-copy-update).
+	///
+	/// Readers wrap their accesses in a ReadGuard: entering and leaving is a counter increment and
+	/// decrement on a cache line picked per thread, wait-free and without contention between
+	/// readers on different lines. A writer publishes the new version, calls Synchronize() and
+	/// may then free the old version: Synchronize() returns once every read that could still see
+	/// the old version has left. Readers count themselves in one of two epochs, Synchronize() flips
+	/// the epoch twice and waits for the readers of the previous one each time, so that a reader
+	/// that read the epoch just before a flip is still waited for.
+	class EpochReclaimer
+	{
+	public:
+		/// Number of reader counter lines, threads are spread over them.
+		static const size_t ReaderSlotCount = 64;
+
+		/// Size of the cache lines the reader counters are kept apart by.
+		static const size_t CacheLineSize = 64;
+
+		///
+		/// Marks a read-side critical section, must not be held across Synchronize().
+		class ReadGuard
+		{
+		public:
+			///
+			/// Enter the read-side critical section.
+			///
+			/// @param[in] reclaimer Reclaimer protecting the data read.
+			explicit ReadGuard(EpochReclaimer& reclaimer);
+
+			///
+			/// Leave the read-side critical section.
+			~ReadGuard();
+
+			ReadGuard(const ReadGuard&) = delete;
+			ReadGuard& operator=(const ReadGuard&) = delete;
+
+		private:
+			/// Reader counter the guard is counted in.
+			std::atomic<uint64_t>& m_readerCount;
+		};
+
+		///
+		/// Constructor.
+		EpochReclaimer();
+
+		EpochReclaimer(const EpochReclaimer&) = delete;
+		EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+		///
+		/// Wait until all read-side critical sections that were entered before the call have been
+		/// left. Writers may call it concurrently, the calls are serialized.
+		void Synchronize();
+
+	private:
+		/// Reader counters of one line, per epoch parity. Padded rather than aligned: the
+		/// reclaimers are members of heap allocated channel managers, which new does not align
+		/// beyond 16 bytes before C++17. The padding keeps the counters of neighbouring slots a
+		/// cache line apart at any base alignment.
+		struct ReaderSlot
+		{
+			/// Readers in the even and odd epochs.
+			std::atomic<uint64_t> Count[2];
+
+			/// Keeps the next slot's counters off this slot's lines.
+			char Padding[CacheLineSize];
+		};
+
+		/// Current epoch, readers count themselves in its parity.
+		std::atomic<uint64_t> m_epoch;
+
+		/// Keeps the first reader counters off the line of the epoch.
+		char m_epochPadding[CacheLineSize];
+
+		/// Reader counters.
+		ReaderSlot m_readerSlots[ReaderSlotCount];
+
+		/// Serializes Synchronize().
+		std::mutex m_synchronizeMutex;
+
+		/// Flip the epoch and wait for the readers counted in the previous one.
+		void flipAndWait();
+
+		/// Reader slot of the calling thread.
+		///
+		/// @return Slot index.
+		static size_t readerSlotIndex();
+	};
+}
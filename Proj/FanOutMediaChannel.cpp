@@ -0,0 +1,220 @@
+///
+/// @class FanOutMediaChannel
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "FanOutMediaChannel.h"
+
+using namespace CvRtsp;
+
+FanOutMediaChannel::
+FanOutMediaChannel(const boost::uuids::uuid& channelId, const std::string& channelName) :
+	MediaChannel(channelId, channelName),
+	m_subscribers(new Subscribers())
+{
+}
+
+FanOutMediaChannel::
+~FanOutMediaChannel()
+{
+	const std::unique_ptr<const Subscribers> subscribers(m_subscribers.load(std::memory_order_relaxed));
+
+	// Waits for notifications in progress.
+	for (const auto& subscriber : *subscribers)
+	{
+		subscriber->SetDemandHandler(nullptr);
+	}
+}
+
+void
+FanOutMediaChannel::
+Subscribe(const std::shared_ptr<MediaChannel>& mediaChannel)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		const auto& subscribers = *m_subscribers.load(std::memory_order_relaxed);
+		if (std::find(subscribers.begin(), subscribers.end(), mediaChannel) != subscribers.end())
+		{
+			return;
+		}
+
+		std::unique_ptr<Subscribers> newSubscribers(new Subscribers(subscribers));
+		newSubscribers->push_back(mediaChannel);
+		mediaChannel->SetCreditWindow(GetCreditWindow());
+		mediaChannel->SetDemandHandler([this](bool isVideo, const MediaDemand& /*demand*/) { onSubscriberDemand(isVideo); });
+		publish(std::move(newSubscribers));
+	}
+
+	onSubscriberDemand(true);
+	onSubscriberDemand(false);
+}
+
+void
+FanOutMediaChannel::
+Unsubscribe(const std::shared_ptr<MediaChannel>& mediaChannel)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		const auto& subscribers = *m_subscribers.load(std::memory_order_relaxed);
+		if (std::find(subscribers.begin(), subscribers.end(), mediaChannel) == subscribers.end())
+		{
+			return;
+		}
+
+		std::unique_ptr<Subscribers> newSubscribers(new Subscribers());
+		std::copy_if(subscribers.begin(), subscribers.end(), std::back_inserter(*newSubscribers),
+			[&mediaChannel](const std::shared_ptr<MediaChannel>& subscriber) { return subscriber != mediaChannel; });
+		publish(std::move(newSubscribers));
+		mediaChannel->SetDemandHandler(nullptr);
+	}
+
+	onSubscriberDemand(true);
+	onSubscriberDemand(false);
+}
+
+size_t
+FanOutMediaChannel::
+GetSubscriberCount() const
+{
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	return m_subscribers.load(std::memory_order_seq_cst)->size();
+}
+
+void
+FanOutMediaChannel::
+SetCreditWindow(uint32_t creditWindow)
+{
+	MediaChannel::SetCreditWindow(creditWindow);
+
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	for (const auto& subscriber : *m_subscribers.load(std::memory_order_seq_cst))
+	{
+		subscriber->SetCreditWindow(creditWindow);
+	}
+}
+
+void
+FanOutMediaChannel::
+publish(std::unique_ptr<Subscribers> subscribers)
+{
+	const std::unique_ptr<const Subscribers> previousSubscribers(
+		m_subscribers.exchange(subscribers.release(), std::memory_order_seq_cst));
+
+	// Samples may still be handed to the previous subscribers, the subscribers themselves are shared.
+	m_reclaimer.Synchronize();
+}
+
+void
+FanOutMediaChannel::
+onSubscriberDemand(bool isVideo)
+{
+	// Every subscriber updates its own state before it gets here, the last one sees all of them.
+	std::lock_guard<std::mutex> lock(m_subscriberDemandMutex);
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+
+	uint32_t watcherCount = 0;
+	auto isTracked = IsDemandTracked(isVideo);
+	auto isPaused = false;
+	for (const auto& subscriber : *m_subscribers.load(std::memory_order_seq_cst))
+	{
+		if (subscriber->IsDemandTracked(isVideo))
+		{
+			watcherCount += subscriber->GetDemand(isVideo).WatcherCount;
+			isTracked = true;
+		}
+		else
+		{
+			// Nobody tells, the subscriber may be consumed.
+			++watcherCount;
+		}
+		isPaused = isPaused || subscriber->IsPaused(isVideo);
+	}
+
+	// Until a subscriber reports its watchers, samples are handed on whether or not anybody watches.
+	if (isTracked)
+	{
+		SetWatcherCount(isVideo, watcherCount);
+	}
+	setPaused(isVideo, isPaused);
+}
+
+bool
+FanOutMediaChannel::
+deliverVideo(const boost::uuids::uuid& /*channelId*/, const std::string& /*channelName*/,
+	const std::vector<std::shared_ptr<MediaSample>>& mediaSamples)
+{
+	return deliver(true, mediaSamples);
+}
+
+bool
+FanOutMediaChannel::
+deliverAudio(const boost::uuids::uuid& /*channelId*/, const std::string& /*channelName*/,
+	const std::vector<std::shared_ptr<MediaSample>>& mediaSamples)
+{
+	return deliver(false, mediaSamples);
+}
+
+bool
+FanOutMediaChannel::
+deliverMovedVideo(const boost::uuids::uuid& /*channelId*/, const std::string& /*channelName*/,
+	std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+{
+	return deliverMoved(true, mediaSamples, count);
+}
+
+bool
+FanOutMediaChannel::
+deliverMovedAudio(const boost::uuids::uuid& /*channelId*/, const std::string& /*channelName*/,
+	std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+{
+	return deliverMoved(false, mediaSamples, count);
+}
+
+bool
+FanOutMediaChannel::
+deliver(bool isVideo, const std::vector<std::shared_ptr<MediaSample>>& mediaSamples)
+{
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	auto isDelivered = true;
+	for (const auto& subscriber : *m_subscribers.load(std::memory_order_seq_cst))
+	{
+		// Each subscriber wakes up its own event loop.
+		isDelivered = (isVideo ? subscriber->AddVideoMediaSamples(mediaSamples)
+			: subscriber->AddAudioMediaSamples(mediaSamples)) && isDelivered;
+	}
+	return isDelivered;
+}
+
+bool
+FanOutMediaChannel::
+deliverMoved(bool isVideo, std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+{
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	const auto& subscribers = *m_subscribers.load(std::memory_order_seq_cst);
+
+	// Subscribers without watchers would discard the copies.
+	const auto lastWatched = std::find_if(subscribers.rbegin(), subscribers.rend(),
+		[isVideo](const std::shared_ptr<MediaChannel>& subscriber) { return subscriber->IsWatched(isVideo); });
+	if (lastWatched == subscribers.rend())
+	{
+		return true;
+	}
+
+	auto isDelivered = true;
+	for (auto subscriber = subscribers.begin(); *subscriber != *lastWatched; ++subscriber)
+	{
+		if ((*subscriber)->IsWatched(isVideo))
+		{
+			std::vector<std::shared_ptr<MediaSample>> copies(mediaSamples, mediaSamples + count);
+			isDelivered = (isVideo ? (*subscriber)->AddVideoMediaSamples(std::move(copies))
+				: (*subscriber)->AddAudioMediaSamples(std::move(copies))) && isDelivered;
+		}
+	}
+	return (isVideo ? (*lastWatched)->AddVideoMediaSamples(mediaSamples, count)
+		: (*lastWatched)->AddAudioMediaSamples(mediaSamples, count)) && isDelivered;
+}
@@ -0,0 +1,131 @@
+///
+/// @class FanOutMediaChannel
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "EpochReclaimer.h"
+#include "MediaChannel.h"
+
+namespace CvRtsp
+{
+	///
+	/// Media channel that hands every sample to the media channels subscribed to it. The samples
+	/// are shared by reference, the frame data is never copied: one ingest feeds several shards,
+	/// or several channel names of the same camera. The consumers of the subscribers run in
+	/// parallel, so a sample must not be modified once it has been added.
+	///
+	/// Subscribers can be added and removed while samples are added: the subscriber list is
+	/// replaced as a whole and read without locks (EpochReclaimer). Subscribers without watchers
+	/// are skipped. The demand of the fan-out sums up the watchers of its subscribers, a subscriber
+	/// whose watchers are not reported counts as one, and it is paused while any subscriber is.
+	/// The fan-out takes over the demand handler of its subscribers.
+	class FanOutMediaChannel : public MediaChannel
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param[in] channelId	Unique channel id.
+		/// @param[in] channelName	Channel name.
+		FanOutMediaChannel(const boost::uuids::uuid& channelId, const std::string& channelName);
+
+		///
+		/// Destructor, detaches from the subscribers, which may outlive this.
+		~FanOutMediaChannel() override;
+
+		///
+		/// Hand the samples added from now on to a media channel as well.
+		///
+		/// @param[in] mediaChannel Subscriber, ignored if it is subscribed already.
+		void Subscribe(const std::shared_ptr<MediaChannel>& mediaChannel);
+
+		///
+		/// Stop handing samples to a media channel. Returns once no sample is being handed to it.
+		///
+		/// @param[in] mediaChannel Subscriber.
+		void Unsubscribe(const std::shared_ptr<MediaChannel>& mediaChannel);
+
+		///
+		/// Get the number of subscribers.
+		///
+		/// @return Subscribers.
+		size_t GetSubscriberCount() const;
+
+		///
+		/// Overridden from MediaChannel: applies to the subscribers as well.
+		///
+		/// @param[in] creditWindow Samples, at least 2.
+		void SetCreditWindow(uint32_t creditWindow) override;
+
+	private:
+		/// Subscriber list, replaced as a whole.
+		using Subscribers = std::vector<std::shared_ptr<MediaChannel>>;
+
+		/// Current subscriber list.
+		std::atomic<const Subscribers*> m_subscribers;
+
+		/// Protects readers of previous subscriber lists.
+		mutable EpochReclaimer m_reclaimer;
+
+		/// Serializes writers.
+		std::mutex m_writeMutex;
+
+		/// Serializes the aggregation of the subscribers' demand.
+		std::mutex m_subscriberDemandMutex;
+
+		///
+		/// Publish a new subscriber list and free the previous one once no reader uses it anymore.
+		/// Must be called with m_writeMutex held.
+		///
+		/// @param[in] subscribers New subscriber list.
+		void publish(std::unique_ptr<Subscribers> subscribers);
+
+		///
+		/// Called when the demand of a subscriber changes, with its demand lock held.
+		///
+		/// @param[in] isVideo True for the video direction.
+		void onSubscriberDemand(bool isVideo);
+
+		/// Overridden from MediaChannel.
+		bool deliverVideo(const boost::uuids::uuid& channelId, const std::string& channelName,
+			const std::vector<std::shared_ptr<MediaSample>>& mediaSamples) override;
+
+		/// Overridden from MediaChannel.
+		bool deliverAudio(const boost::uuids::uuid& channelId, const std::string& channelName,
+			const std::vector<std::shared_ptr<MediaSample>>& mediaSamples) override;
+
+		/// Overridden from MediaChannel: the last watched subscriber takes the samples, the others copies.
+		bool deliverMovedVideo(const boost::uuids::uuid& channelId, const std::string& channelName,
+			std::shared_ptr<MediaSample>* mediaSamples, size_t count) override;
+
+		/// Overridden from MediaChannel: the last watched subscriber takes the samples, the others copies.
+		bool deliverMovedAudio(const boost::uuids::uuid& channelId, const std::string& channelName,
+			std::shared_ptr<MediaSample>* mediaSamples, size_t count) override;
+
+		///
+		/// Hand samples to the watched subscribers.
+		///
+		/// @param[in] isVideo		True for video samples.
+		/// @param[in] mediaSamples	Samples.
+		///
+		/// @return False if a subscriber dropped samples.
+		bool deliver(bool isVideo, const std::vector<std::shared_ptr<MediaSample>>& mediaSamples);
+
+		///
+		/// Hand samples that may be moved from to the watched subscribers.
+		///
+		/// @param[in] isVideo		True for video samples.
+		/// @param[in] mediaSamples	Samples.
+		/// @param[in] count		Number of samples.
+		///
+		/// @return False if a subscriber dropped samples.
+		bool deliverMoved(bool isVideo, std::shared_ptr<MediaSample>* mediaSamples, size_t count);
+	};
+}
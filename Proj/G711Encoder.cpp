@@ -0,0 +1,285 @@
+///
+/// @class G711Encoder
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "G711Encoder.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define G711_USE_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC emits AVX2 intrinsics without /arch:AVX2, the code path is selected at runtime.
+#define G711_TARGET_AVX2
+#else
+#define G711_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace CvRtsp;
+
+/// Mu-law magnitudes are clipped so that the biased magnitude stays below 0x2000 (segment 7).
+static const int MuLawClip = 8158;
+
+/// Mu-law bias, applied to the 14 bit magnitude.
+static const int MuLawBias = 0x21;
+
+/// Biased IEEE 754 exponent of the smallest magnitude in segment 0, in the position of bits >> 19.
+/// The exponent and the 4 bits below the leading one of a float are exactly the G.711 segment and
+/// quantization step once the exponent of the first segment is subtracted.
+static const int MuLawSegmentBase = (127 + 5) << 4;
+static const int ALawSegmentBase = (127 + 4) << 4;
+
+BYTE
+G711Encoder::
+MuLawFromLinear(int16_t sample)
+{
+	auto value = sample >> 2;
+	BYTE mask = 0xff;
+	if (value < 0)
+	{
+		value = -value;
+		mask = 0x7f;
+	}
+	if (value > MuLawClip)
+	{
+		value = MuLawClip;
+	}
+	value += MuLawBias;
+
+	// Segment: position of the leading one, segment 0 starts at 0x20.
+	auto segment = 0;
+	while ((value >> (segment + 6)) != 0)
+	{
+		++segment;
+	}
+
+	const auto code = (segment << 4) | ((value >> (segment + 1)) & 0x0f);
+	return static_cast<BYTE>(code ^ mask);
+}
+
+BYTE
+G711Encoder::
+ALawFromLinear(int16_t sample)
+{
+	auto value = sample >> 3;
+	BYTE mask = 0xd5;
+	if (value < 0)
+	{
+		value = -value - 1;
+		mask = 0x55;
+	}
+
+	// Segment: position of the leading one, segments 0 and 1 share the same step size.
+	auto segment = 0;
+	while ((value >> (segment + 5)) != 0)
+	{
+		++segment;
+	}
+
+	const auto code = (segment << 4) | ((value >> (segment == 0 ? 1 : segment)) & 0x0f);
+	return static_cast<BYTE>(code ^ mask);
+}
+
+#ifdef G711_USE_SIMD
+///
+/// Convert non-negative 32 bit magnitudes to segment and step, see MuLawSegmentBase.
+static inline __m128i segmentAndStep(__m128i magnitude, __m128i segmentBase)
+{
+	const auto exponentAndMantissa = _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(magnitude)), 19);
+	return _mm_sub_epi32(exponentAndMantissa, segmentBase);
+}
+
+G711_TARGET_AVX2
+static inline __m256i segmentAndStep(__m256i magnitude, __m256i segmentBase)
+{
+	const auto exponentAndMantissa = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(magnitude)), 19);
+	return _mm256_sub_epi32(exponentAndMantissa, segmentBase);
+}
+
+///
+/// Mu-law code words for 8 samples, as 16 bit values.
+static inline __m128i muLawCodes(__m128i pcm)
+{
+	const auto zero = _mm_setzero_si128();
+	const auto value = _mm_srai_epi16(pcm, 2);
+	const auto negative = _mm_cmplt_epi16(value, zero);
+	auto magnitude = _mm_sub_epi16(_mm_xor_si128(value, negative), negative);
+	magnitude = _mm_add_epi16(_mm_min_epi16(magnitude, _mm_set1_epi16(MuLawClip)), _mm_set1_epi16(MuLawBias));
+
+	const auto segmentBase = _mm_set1_epi32(MuLawSegmentBase);
+	const auto low = segmentAndStep(_mm_unpacklo_epi16(magnitude, zero), segmentBase);
+	const auto high = segmentAndStep(_mm_unpackhi_epi16(magnitude, zero), segmentBase);
+
+	const auto mask = _mm_xor_si128(_mm_set1_epi16(0xff), _mm_and_si128(negative, _mm_set1_epi16(0x80)));
+	return _mm_xor_si128(_mm_packs_epi32(low, high), mask);
+}
+
+///
+/// A-law code words for 8 samples, as 16 bit values.
+static inline __m128i aLawCodes(__m128i pcm)
+{
+	const auto zero = _mm_setzero_si128();
+	const auto value = _mm_srai_epi16(pcm, 3);
+	const auto negative = _mm_cmplt_epi16(value, zero);
+	// One's complement gives -value - 1 for negative samples.
+	const auto magnitude = _mm_xor_si128(value, negative);
+
+	const auto segmentBase = _mm_set1_epi32(ALawSegmentBase);
+	const auto low = segmentAndStep(_mm_unpacklo_epi16(magnitude, zero), segmentBase);
+	const auto high = segmentAndStep(_mm_unpackhi_epi16(magnitude, zero), segmentBase);
+	const auto large = _mm_packs_epi32(low, high);
+
+	// Segment 0 is linear and is not covered by the exponent trick.
+	const auto isSegmentZero = _mm_cmplt_epi16(magnitude, _mm_set1_epi16(32));
+	const auto small = _mm_srli_epi16(magnitude, 1);
+	const auto codes = _mm_or_si128(_mm_and_si128(isSegmentZero, small), _mm_andnot_si128(isSegmentZero, large));
+
+	const auto mask = _mm_xor_si128(_mm_set1_epi16(0xd5), _mm_and_si128(negative, _mm_set1_epi16(0x80)));
+	return _mm_xor_si128(codes, mask);
+}
+
+///
+/// Mu-law code words for 16 samples, as 16 bit values in sample order.
+G711_TARGET_AVX2
+static inline __m256i muLawCodes(__m256i pcm)
+{
+	const auto zero = _mm256_setzero_si256();
+	const auto value = _mm256_srai_epi16(pcm, 2);
+	const auto negative = _mm256_cmpgt_epi16(zero, value);
+	auto magnitude = _mm256_sub_epi16(_mm256_xor_si256(value, negative), negative);
+	magnitude = _mm256_add_epi16(_mm256_min_epi16(magnitude, _mm256_set1_epi16(MuLawClip)), _mm256_set1_epi16(MuLawBias));
+
+	const auto segmentBase = _mm256_set1_epi32(MuLawSegmentBase);
+	const auto low = segmentAndStep(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(magnitude)), segmentBase);
+	const auto high = segmentAndStep(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(magnitude, 1)), segmentBase);
+	// Packing works per 128 bit lane, restore the sample order.
+	const auto codes = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xd8);
+
+	const auto mask = _mm256_xor_si256(_mm256_set1_epi16(0xff), _mm256_and_si256(negative, _mm256_set1_epi16(0x80)));
+	return _mm256_xor_si256(codes, mask);
+}
+
+///
+/// A-law code words for 16 samples, as 16 bit values in sample order.
+G711_TARGET_AVX2
+static inline __m256i aLawCodes(__m256i pcm)
+{
+	const auto zero = _mm256_setzero_si256();
+	const auto value = _mm256_srai_epi16(pcm, 3);
+	const auto negative = _mm256_cmpgt_epi16(zero, value);
+	const auto magnitude = _mm256_xor_si256(value, negative);
+
+	const auto segmentBase = _mm256_set1_epi32(ALawSegmentBase);
+	const auto low = segmentAndStep(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(magnitude)), segmentBase);
+	const auto high = segmentAndStep(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(magnitude, 1)), segmentBase);
+	const auto large = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xd8);
+
+	const auto isSegmentZero = _mm256_cmpgt_epi16(_mm256_set1_epi16(32), magnitude);
+	const auto small = _mm256_srli_epi16(magnitude, 1);
+	const auto codes = _mm256_blendv_epi8(large, small, isSegmentZero);
+
+	const auto mask = _mm256_xor_si256(_mm256_set1_epi16(0xd5), _mm256_and_si256(negative, _mm256_set1_epi16(0x80)));
+	return _mm256_xor_si256(codes, mask);
+}
+
+///
+/// Encode with SSE2, 16 samples per iteration.
+///
+/// @return Number of samples encoded.
+template<__m128i (*Codes)(__m128i)>
+static size_t encodeSse2(const int16_t* pcm, BYTE* encoded, size_t sampleCount)
+{
+	size_t index = 0;
+	for (; index + 16 <= sampleCount; index += 16)
+	{
+		const auto first = Codes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pcm + index)));
+		const auto second = Codes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pcm + index + 8)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(encoded + index), _mm_packus_epi16(first, second));
+	}
+	return index;
+}
+
+///
+/// Encode with AVX2, 32 samples per iteration.
+///
+/// @return Number of samples encoded.
+template<__m256i (*Codes)(__m256i)>
+G711_TARGET_AVX2
+static size_t encodeAvx2(const int16_t* pcm, BYTE* encoded, size_t sampleCount)
+{
+	size_t index = 0;
+	for (; index + 32 <= sampleCount; index += 32)
+	{
+		const auto first = Codes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + index)));
+		const auto second = Codes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pcm + index + 16)));
+		const auto packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xd8);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(encoded + index), packed);
+	}
+	return index;
+}
+
+///
+/// Determine once if the processor and the operating system support AVX2.
+static bool hasAvx2()
+{
+	static const bool hasAvx2 = []()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+		{
+			return false;
+		}
+		__cpuid(info, 1);
+		const auto osSavesAvxState = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0
+			&& (_xgetbv(0) & 0x06) == 0x06;
+		if (!osSavesAvxState)
+		{
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}();
+	return hasAvx2;
+}
+#endif
+
+void
+G711Encoder::
+EncodeMuLaw(const int16_t* pcm, BYTE* encoded, size_t sampleCount)
+{
+	size_t index = 0;
+#ifdef G711_USE_SIMD
+	index = hasAvx2()
+		? encodeAvx2<muLawCodes>(pcm, encoded, sampleCount)
+		: encodeSse2<muLawCodes>(pcm, encoded, sampleCount);
+#endif
+	for (; index < sampleCount; ++index)
+	{
+		encoded[index] = MuLawFromLinear(pcm[index]);
+	}
+}
+
+void
+G711Encoder::
+EncodeALaw(const int16_t* pcm, BYTE* encoded, size_t sampleCount)
+{
+	size_t index = 0;
+#ifdef G711_USE_SIMD
+	index = hasAvx2()
+		? encodeAvx2<aLawCodes>(pcm, encoded, sampleCount)
+		: encodeSse2<aLawCodes>(pcm, encoded, sampleCount);
+#endif
+	for (; index < sampleCount; ++index)
+	{
+		encoded[index] = ALawFromLinear(pcm[index]);
+	}
+}
@@ -0,0 +1,54 @@
+///
+/// @class G711Encoder
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace CvRtsp
+{
+	///
+	/// Converts 16 bit linear PCM to G.711 mu-law (PCMU) or A-law (PCMA).
+	///
+	/// The conversion runs 16 samples at a time with AVX2 when the processor supports it,
+	/// 8 samples at a time with SSE2 otherwise, and falls back to a scalar loop on other
+	/// architectures and for the tail. All paths produce bit-identical output.
+	class G711Encoder
+	{
+	public:
+		///
+		/// Encode linear PCM to mu-law.
+		///
+		/// @param[in] pcm Native endian 16 bit samples.
+		/// @param[out] encoded Output buffer of at least sampleCount bytes.
+		/// @param[in] sampleCount Number of samples.
+		static void EncodeMuLaw(const int16_t* pcm, BYTE* encoded, size_t sampleCount);
+
+		///
+		/// Encode linear PCM to A-law.
+		///
+		/// @param[in] pcm Native endian 16 bit samples.
+		/// @param[out] encoded Output buffer of at least sampleCount bytes.
+		/// @param[in] sampleCount Number of samples.
+		static void EncodeALaw(const int16_t* pcm, BYTE* encoded, size_t sampleCount);
+
+		///
+		/// Encode a single sample to mu-law.
+		///
+		/// @param[in] sample Linear PCM sample.
+		///
+		/// @return Mu-law code word.
+		static BYTE MuLawFromLinear(int16_t sample);
+
+		///
+		/// Encode a single sample to A-law.
+		///
+		/// @param[in] sample Linear PCM sample.
+		///
+		/// @return A-law code word.
+		static BYTE ALawFromLinear(int16_t sample);
+	};
+}
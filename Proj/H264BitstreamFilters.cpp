@@ -0,0 +1,186 @@
+///
+/// H.264 bitstream filters.
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <algorithm>
+
+#include "H264BitstreamFilters.h"
+
+using namespace CvRtsp;
+
+/// Marks nal unit types whose nal_ref_idc is left untouched.
+static const int UnchangedNalRefIdc = -1;
+
+#pragma region H264NalUnitStripFilter
+H264NalUnitStripFilter::
+H264NalUnitStripFilter(bool stripAccessUnitDelimiters, bool stripFillerData) :
+	m_stripAccessUnitDelimiters(stripAccessUnitDelimiters),
+	m_stripFillerData(stripFillerData)
+{
+}
+
+bool
+H264NalUnitStripFilter::
+Filter(NalUnitSliceList& nalUnits)
+{
+	const auto sizeBefore = nalUnits.size();
+	nalUnits.erase(std::remove_if(nalUnits.begin(), nalUnits.end(), [this](const NalUnitSlice& nalUnit)
+		{
+			return (m_stripAccessUnitDelimiters && isH264AccessUnitDelimiter(nalUnit.Header))
+				|| (m_stripFillerData && isH264FillerData(nalUnit.Header));
+		}), nalUnits.end());
+
+	return nalUnits.size() != sizeBefore;
+}
+#pragma endregion
+
+
+#pragma region H264SeiFilter
+H264SeiFilter::
+H264SeiFilter(const std::set<unsigned>& payloadTypesToKeep) :
+	m_payloadTypesToKeep(payloadTypesToKeep)
+{
+}
+
+bool
+H264SeiFilter::
+Filter(NalUnitSliceList& nalUnits)
+{
+	const auto sizeBefore = nalUnits.size();
+	nalUnits.erase(std::remove_if(nalUnits.begin(), nalUnits.end(), [this](const NalUnitSlice& nalUnit)
+		{
+			if (!isH264Sei(nalUnit.Header))
+			{
+				return false;
+			}
+			if (m_payloadTypesToKeep.empty())
+			{
+				return true;
+			}
+
+			// payloadType is coded as a run of 0xff bytes followed by a final byte (7.3.2.3.1).
+			unsigned payloadType = 0;
+			uint32_t position = 1;
+			while (position < nalUnit.Size && nalUnit.Data[position] == 0xff)
+			{
+				payloadType += 255;
+				++position;
+			}
+			if (position >= nalUnit.Size)
+			{
+				return true;
+			}
+			payloadType += nalUnit.Data[position];
+
+			return m_payloadTypesToKeep.find(payloadType) == m_payloadTypesToKeep.end();
+		}), nalUnits.end());
+
+	return nalUnits.size() != sizeBefore;
+}
+#pragma endregion
+
+
+#pragma region H264ParameterSetInsertFilter
+H264ParameterSetInsertFilter::
+H264ParameterSetInsertFilter(const std::vector<BYTE>& sps, const std::vector<BYTE>& pps) :
+	m_sps(sps),
+	m_pps(pps)
+{
+}
+
+bool
+H264ParameterSetInsertFilter::
+Filter(NalUnitSliceList& nalUnits)
+{
+	auto hasSps = false;
+	auto hasPps = false;
+	auto idrPosition = nalUnits.end();
+
+	for (auto nalUnit = nalUnits.begin(); nalUnit != nalUnits.end(); ++nalUnit)
+	{
+		const auto header = nalUnit->Header;
+		if (isH264Sps(header))
+		{
+			hasSps = true;
+			m_sps.assign(nalUnit->Data, nalUnit->Data + nalUnit->Size);
+			m_sps[0] = header;
+		}
+		else if (isH264Pps(header))
+		{
+			hasPps = true;
+			m_pps.assign(nalUnit->Data, nalUnit->Data + nalUnit->Size);
+			m_pps[0] = header;
+		}
+		else if (isH264IdrFrame(header) && idrPosition == nalUnits.end())
+		{
+			idrPosition = nalUnit;
+		}
+	}
+
+	if (idrPosition == nalUnits.end() || (hasSps && hasPps))
+	{
+		return false;
+	}
+
+	// Insert what is missing in front of the first IDR slice, SPS before PPS.
+	NalUnitSliceList parameterSets;
+	if (!hasSps && !m_sps.empty())
+	{
+		parameterSets.emplace_back(m_sps.data(), static_cast<uint32_t>(m_sps.size()));
+	}
+	if (!hasPps && !m_pps.empty())
+	{
+		parameterSets.emplace_back(m_pps.data(), static_cast<uint32_t>(m_pps.size()));
+	}
+	if (parameterSets.empty())
+	{
+		return false;
+	}
+
+	nalUnits.insert(idrPosition, parameterSets.begin(), parameterSets.end());
+	return true;
+}
+#pragma endregion
+
+
+#pragma region H264NalRefIdcRewriteFilter
+H264NalRefIdcRewriteFilter::
+H264NalRefIdcRewriteFilter()
+{
+	m_nalRefIdc.fill(UnchangedNalRefIdc);
+}
+
+void
+H264NalRefIdcRewriteFilter::
+SetNalRefIdc(unsigned nalUnitType, unsigned nalRefIdc)
+{
+	assert(nalUnitType < m_nalRefIdc.size() && nalRefIdc < 4);
+	if (nalUnitType < m_nalRefIdc.size())
+	{
+		m_nalRefIdc[nalUnitType] = static_cast<int>(nalRefIdc & 0x03);
+	}
+}
+
+bool
+H264NalRefIdcRewriteFilter::
+Filter(NalUnitSliceList& nalUnits)
+{
+	auto isRewritten = false;
+	for (auto& nalUnit : nalUnits)
+	{
+		const auto nalRefIdc = m_nalRefIdc[nalUnit.Header & 0x1f];
+		if (nalRefIdc != UnchangedNalRefIdc)
+		{
+			const auto header = static_cast<BYTE>((nalUnit.Header & 0x9f) | (nalRefIdc << 5));
+			isRewritten = isRewritten || header != nalUnit.Header;
+			nalUnit.Header = header;
+		}
+	}
+
+	// The sample may be shared, only a re-assembled copy carries the new headers.
+	return isRewritten;
+}
+#pragma endregion
@@ -0,0 +1,112 @@
+///
+/// H.264 bitstream filters.
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <array>
+#include <set>
+#include <vector>
+
+#include "IBitstreamFilter.h"
+
+namespace CvRtsp
+{
+	///
+	/// Removes access unit delimiters and/or filler data nal units.
+	class H264NalUnitStripFilter : public IBitstreamFilter
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param[in] stripAccessUnitDelimiters True to remove access unit delimiters.
+		/// @param[in] stripFillerData True to remove filler data.
+		H264NalUnitStripFilter(bool stripAccessUnitDelimiters = true, bool stripFillerData = true);
+
+		///
+		/// Overridden from IBitstreamFilter.
+		bool Filter(NalUnitSliceList& nalUnits) override;
+
+	private:
+		/// Remove access unit delimiters.
+		bool m_stripAccessUnitDelimiters;
+
+		/// Remove filler data.
+		bool m_stripFillerData;
+	};
+
+	///
+	/// Removes SEI nal units, optionally keeping those whose first SEI message is of
+	/// one of the selected payload types (e.g. 5 for user data unregistered).
+	class H264SeiFilter : public IBitstreamFilter
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param[in] payloadTypesToKeep SEI payload types to keep, empty to drop all SEI.
+		explicit H264SeiFilter(const std::set<unsigned>& payloadTypesToKeep = std::set<unsigned>());
+
+		///
+		/// Overridden from IBitstreamFilter.
+		bool Filter(NalUnitSliceList& nalUnits) override;
+
+	private:
+		/// SEI payload types that are passed through.
+		std::set<unsigned> m_payloadTypesToKeep;
+	};
+
+	///
+	/// Inserts the most recently seen SPS and PPS in front of every IDR access unit that
+	/// does not carry them in-band, so that clients joining mid-stream can decode.
+	class H264ParameterSetInsertFilter : public IBitstreamFilter
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param[in] sps Initial sequence parameter set (nal unit without start code), may be empty.
+		/// @param[in] pps Initial picture parameter set (nal unit without start code), may be empty.
+		H264ParameterSetInsertFilter(const std::vector<BYTE>& sps = std::vector<BYTE>(),
+			const std::vector<BYTE>& pps = std::vector<BYTE>());
+
+		///
+		/// Overridden from IBitstreamFilter.
+		bool Filter(NalUnitSliceList& nalUnits) override;
+
+	private:
+		/// Cached sequence parameter set.
+		std::vector<BYTE> m_sps;
+
+		/// Cached picture parameter set.
+		std::vector<BYTE> m_pps;
+	};
+
+	///
+	/// Rewrites the nal_ref_idc field of nal units of selected types. Access units whose headers
+	/// change are re-assembled, those that already carry the configured values are passed on.
+	class H264NalRefIdcRewriteFilter : public IBitstreamFilter
+	{
+	public:
+		///
+		/// Default constructor, no nal unit types are rewritten.
+		H264NalRefIdcRewriteFilter();
+
+		///
+		/// Set the nal_ref_idc to be written for a nal unit type.
+		///
+		/// @param[in] nalUnitType Nal unit type (0-31).
+		/// @param[in] nalRefIdc New nal_ref_idc (0-3).
+		void SetNalRefIdc(unsigned nalUnitType, unsigned nalRefIdc);
+
+		///
+		/// Overridden from IBitstreamFilter.
+		bool Filter(NalUnitSliceList& nalUnits) override;
+
+	private:
+		/// nal_ref_idc per nal unit type, negative if the nal unit type is left untouched.
+		std::array<int, 32> m_nalRefIdc;
+	};
+}
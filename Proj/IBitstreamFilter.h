@@ -0,0 +1,67 @@
+///
+/// @class IBitstreamFilter
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace CvRtsp
+{
+	///
+	/// View onto a single nal unit (without start code) of an Annex-B access unit.
+	///
+	/// The view does not own its data: it either points into the media sample that is
+	/// being filtered, or into storage owned by the filter that inserted it. The data is
+	/// read only, the media sample may be shared with other channels or borrowed. A filter
+	/// rewrites the nal unit header through Header instead, which makes the chain
+	/// re-assemble the access unit into a new sample.
+	struct NalUnitSlice
+	{
+		NalUnitSlice(const BYTE* data, uint32_t size) :
+			Data(data),
+			Size(size),
+			Header(size > 0 ? data[0] : 0)
+		{
+		}
+
+		/// Start of the nal unit (nal unit header as received).
+		const BYTE* Data;
+
+		/// Size of the nal unit in bytes.
+		uint32_t Size;
+
+		/// Nal unit header to be written, Data[0] unless a filter rewrote it.
+		BYTE Header;
+	};
+
+	/// Nal units making up one access unit, in decoding order.
+	using NalUnitSliceList = std::vector<NalUnitSlice>;
+
+	///
+	/// The IBitstreamFilter abstracts a per-frame transformation of an access unit.
+	///
+	/// Filters are run once per frame on ingest, before the frame is fanned out to the
+	/// device sources of a subsession, so any work done here is paid once per channel
+	/// rather than once per client.
+	class IBitstreamFilter
+	{
+	public:
+		///
+		/// Virtual destructor.
+		virtual ~IBitstreamFilter() = default;
+
+		///
+		/// The subclass must implement the filtering of the nal units of an access unit.
+		/// Nal units may be removed from or inserted into the list, and their header may be
+		/// rewritten (NalUnitSlice::Header); the nal unit data itself is never modified.
+		///
+		/// @param[in,out] nalUnits Nal units of the access unit.
+		///
+		/// @return True if nal units were removed, inserted or their header rewritten, i.e. the
+		/// access unit needs to be re-assembled.
+		virtual bool Filter(NalUnitSliceList& nalUnits) = 0;
+	};
+}
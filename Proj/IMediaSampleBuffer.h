@@ -43,6 +43,18 @@ namespace CvRtsp
 		/// @param[in] mediaSample Media sample.
 		virtual void AddMediaSample(const std::shared_ptr<MediaSample>& mediaSample) = 0;
 
+		///
+		/// Make a frame owned by the caller the current one, without copying it where the buffer
+		/// allows. The data must stay valid until the next frame is added. The default copies it.
+		///
+		/// @param[in] data			Frame data.
+		/// @param[in] size			Frame size.
+		/// @param[in] startTime	Frame start time.
+		virtual void SetBorrowedFrame(BYTE* data, unsigned size, double startTime)
+		{
+			AddMediaSample(MediaSample::CreateMediaSample(data, static_cast<int>(size), startTime));
+		}
+
 		///
 		/// Override to return current channel.
 		virtual unsigned GetCurrentChannel() = 0;
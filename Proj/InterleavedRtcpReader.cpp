@@ -0,0 +1,86 @@
+///
+/// @class InterleavedRtcpReader
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "InterleavedRtcpReader.h"
+
+using namespace CvRtsp;
+
+InterleavedRtcpReader*
+InterleavedRtcpReader::
+createNew(UsageEnvironment& env, RTCPInstance& rtcpInstance, int socketNum, unsigned char channelId,
+	TaskFunc* rtcpRRHandler, void* rtcpRRHandlerClientData)
+{
+	return new InterleavedRtcpReader(env, rtcpInstance, socketNum, channelId, rtcpRRHandler, rtcpRRHandlerClientData);
+}
+
+InterleavedRtcpReader::
+InterleavedRtcpReader(UsageEnvironment& env, RTCPInstance& rtcpInstance, int socketNum, unsigned char channelId,
+	TaskFunc* rtcpRRHandler, void* rtcpRRHandlerClientData) :
+	Medium(env),
+	m_rtcpInstance(rtcpInstance),
+	m_interface(this, rtcpInstance.RTCPgs()),
+	m_rtcpRRHandler(rtcpRRHandler),
+	m_rtcpRRHandlerClientData(rtcpRRHandlerClientData),
+	m_reportSize(0)
+{
+	// The interface is only ever read from, so it never writes to the connection.
+	m_interface.addStreamSocket(socketNum, channelId, nullptr);
+	m_interface.startNetworkReading(&InterleavedRtcpReader::incomingReportHandler);
+}
+
+InterleavedRtcpReader::
+~InterleavedRtcpReader()
+{
+	m_interface.stopNetworkReading();
+}
+
+void
+InterleavedRtcpReader::
+incomingReportHandler(void* clientData, int /*mask*/)
+{
+	// The interface passes its owner, which is the reader.
+	static_cast<InterleavedRtcpReader*>(static_cast<Medium*>(clientData))->incomingReportHandler();
+}
+
+void
+InterleavedRtcpReader::
+incomingReportHandler()
+{
+	if (m_reportSize >= MaxReportSize)
+	{
+		// Larger than any report, read the rest of the frame over the start of the buffer.
+		m_reportSize = 0;
+	}
+
+	unsigned bytesRead = 0;
+	struct sockaddr_storage fromAddress = {};
+	int tcpSocketNum = -1;
+	unsigned char tcpStreamChannelId = 0;
+	Boolean isIncomplete = False;
+	const auto isRead = m_interface.handleRead(m_report + m_reportSize, MaxReportSize - m_reportSize, bytesRead,
+		fromAddress, tcpSocketNum, tcpStreamChannelId, isIncomplete);
+	if (isIncomplete)
+	{
+		m_reportSize += bytesRead;
+		return;
+	}
+
+	const auto reportSize = m_reportSize + bytesRead;
+	m_reportSize = 0;
+	if (!isRead || reportSize == 0)
+	{
+		return;
+	}
+
+	// Injected reports are processed as if they arrived over UDP, the RR handler that was set for
+	// the connection is not found by the instance and is called here instead.
+	m_rtcpInstance.injectReport(m_report, reportSize, fromAddress);
+	if (m_rtcpRRHandler)
+	{
+		m_rtcpRRHandler(m_rtcpRRHandlerClientData);
+	}
+}
@@ -0,0 +1,85 @@
+///
+/// @class InterleavedRtcpReader
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <live555/liveMedia.hh>
+
+namespace CvRtsp
+{
+	///
+	/// Reads the RTCP reports of an RTP-over-TCP client for an RTCP instance that no longer uses the
+	/// client's RTSP connection.
+	///
+	/// live555 writes RTCP over every TCP stream an RTCP instance reads from, with blocking writes
+	/// in the middle of the frames the InterleavedTcpWriter queues. To have RTCP queued as well the
+	/// connection is removed from the RTCP instance; this reader takes over reading the RTCP
+	/// channel, hands the reports to the instance and signals the client's liveness, as the RR
+	/// handler of the instance would have.
+	///
+	/// It also takes over the read handler of the RTCP groupsock: an RTP-over-TCP client has no
+	/// UDP destination, datagrams arriving there anyway are handed on the same way.
+	///
+	/// Created with createNew(), destroyed with Medium::close(), before the RTCP instance.
+	class InterleavedRtcpReader : public Medium
+	{
+	public:
+		///
+		/// Start reading the RTCP channel of a connection. Must be called while the RTCP instance
+		/// still reads it, so that live555 keeps the connection's demultiplexer.
+		///
+		/// @param[in] env						Usage environment.
+		/// @param[in] rtcpInstance				RTCP instance the reports are for.
+		/// @param[in] socketNum				RTSP connection socket.
+		/// @param[in] channelId				Interleaved RTCP channel id.
+		/// @param[in] rtcpRRHandler			Called for every report, may be nullptr.
+		/// @param[in] rtcpRRHandlerClientData	Argument of rtcpRRHandler.
+		///
+		/// @return The reader.
+		static InterleavedRtcpReader* createNew(UsageEnvironment& env, RTCPInstance& rtcpInstance, int socketNum,
+			unsigned char channelId, TaskFunc* rtcpRRHandler, void* rtcpRRHandlerClientData);
+
+	protected:
+		///
+		/// Constructor, called only by createNew().
+		InterleavedRtcpReader(UsageEnvironment& env, RTCPInstance& rtcpInstance, int socketNum,
+			unsigned char channelId, TaskFunc* rtcpRRHandler, void* rtcpRRHandlerClientData);
+
+		///
+		/// Destructor, stops reading.
+		~InterleavedRtcpReader() override;
+
+	private:
+		/// Largest report read, as live555's RTCP instance.
+		static const unsigned MaxReportSize = 1456;
+
+		/// RTCP instance the reports are for.
+		RTCPInstance& m_rtcpInstance;
+
+		/// Reads the RTCP channel of the connection.
+		RTPInterface m_interface;
+
+		/// Called for every report.
+		TaskFunc* m_rtcpRRHandler;
+
+		/// Argument of m_rtcpRRHandler.
+		void* m_rtcpRRHandlerClientData;
+
+		/// Report being read.
+		unsigned char m_report[MaxReportSize];
+
+		/// Bytes of the report read so far, a report arrives in several reads over TCP.
+		unsigned m_reportSize;
+
+		/// Background read handler.
+		///
+		/// @param[in] clientData	The reader.
+		/// @param[in] mask			Socket condition.
+		static void incomingReportHandler(void* clientData, int mask);
+
+		/// Read from the connection and hand on a completely read report.
+		void incomingReportHandler();
+	};
+}
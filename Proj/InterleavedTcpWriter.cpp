@@ -0,0 +1,301 @@
+///
+/// @class InterleavedTcpWriter
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <cerrno>
+
+#include <live555/NetCommon.h>
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "InterleavedTcpWriter.h"
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#endif
+
+using namespace CvRtsp;
+
+/// Size of the '$', channel id and length prefix of an interleaved frame.
+static const unsigned FrameHeaderSize = 4;
+
+/// Written bytes that are kept in the queue before it is compacted.
+static const size_t CompactionThreshold = 64 * 1024;
+
+#if defined(MSG_NOSIGNAL)
+static const int SendFlags = MSG_NOSIGNAL;
+#else
+static const int SendFlags = 0;
+#endif
+
+/// Send on a non-blocking socket.
+///
+/// @return Bytes sent, 0 if the socket is full, -1 on error.
+static int
+sendNonBlocking(int socketNum, const unsigned char* data, size_t size)
+{
+	while (true)
+	{
+		const auto result = send(socketNum, reinterpret_cast<const char*>(data), static_cast<int>(size), SendFlags);
+		if (result >= 0)
+		{
+			return static_cast<int>(result);
+		}
+
+#if defined(_WIN32)
+		return WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1;
+#else
+		if (errno == EINTR)
+		{
+			continue;
+		}
+		return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+#endif
+	}
+}
+
+InterleavedTcpWriter::
+InterleavedTcpWriter() :
+	m_maxQueuedBytes(DefaultMaxQueuedBytes),
+	m_sendCallCount(0)
+{
+}
+
+void
+InterleavedTcpWriter::
+Attach(int socketNum)
+{
+	auto& connection = m_connections[socketNum];
+	if (connection.AttachCount == 0)
+	{
+		// The socket number may have been used by an earlier connection.
+		connection = Connection();
+	}
+	++connection.AttachCount;
+}
+
+void
+InterleavedTcpWriter::
+Detach(int socketNum)
+{
+	const auto it = m_connections.find(socketNum);
+	if (it != m_connections.end() && --it->second.AttachCount == 0)
+	{
+		// Removed from m_pendingSockets by the next flush.
+		m_connections.erase(it);
+	}
+}
+
+bool
+InterleavedTcpWriter::
+Queue(int socketNum, unsigned char channelId, const unsigned char* data, unsigned size)
+{
+	const auto it = m_connections.find(socketNum);
+	if (it == m_connections.end() || it->second.IsFailed || size > 0xffff)
+	{
+		return false;
+	}
+
+	auto& connection = it->second;
+	if (connection.Stats.QueuedBytes + FrameHeaderSize + size > m_maxQueuedBytes)
+	{
+		if (!connection.IsDropping)
+		{
+			log_rtsp_warning("InterleavedTcpWriter: client on socket " + std::to_string(socketNum)
+				+ " is not keeping up, dropping packets");
+			connection.IsDropping = true;
+		}
+		++connection.Stats.DroppedPackets;
+		connection.Stats.IsCongested = true;
+		return false;
+	}
+
+	const unsigned char header[FrameHeaderSize] = { '$', channelId,
+		static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size & 0xff) };
+	connection.Buffer.insert(connection.Buffer.end(), header, header + FrameHeaderSize);
+	connection.Buffer.insert(connection.Buffer.end(), data, data + size);
+	connection.FrameEnds.push_back(connection.Buffer.size());
+	connection.Stats.QueuedBytes += FrameHeaderSize + size;
+
+	if (!connection.IsPending)
+	{
+		connection.IsPending = true;
+		m_pendingSockets.push_back(socketNum);
+	}
+	return true;
+}
+
+void
+InterleavedTcpWriter::
+Flush()
+{
+	m_flushSockets.swap(m_pendingSockets);
+	for (const auto socketNum : m_flushSockets)
+	{
+		const auto it = m_connections.find(socketNum);
+		if (it == m_connections.end())
+		{
+			continue;
+		}
+
+		// A socket detached and attached again can be listed twice.
+		auto& connection = it->second;
+		if (connection.IsPending)
+		{
+			connection.IsPending = false;
+			write(socketNum, connection);
+		}
+	}
+
+	// The sockets that are full are written again by the next flush.
+	for (const auto socketNum : m_flushSockets)
+	{
+		const auto it = m_connections.find(socketNum);
+		if (it != m_connections.end() && it->second.Stats.QueuedBytes > 0 && !it->second.IsPending)
+		{
+			it->second.IsPending = true;
+			m_pendingSockets.push_back(socketNum);
+		}
+	}
+	m_flushSockets.clear();
+}
+
+bool
+InterleavedTcpWriter::
+CompletePartialFrame(int socketNum)
+{
+	const auto it = m_connections.find(socketNum);
+	if (it == m_connections.end())
+	{
+		return true;
+	}
+
+	auto& connection = it->second;
+	if (connection.IsFailed)
+	{
+		return false;
+	}
+	if (connection.SentOffset == connection.FrameStart)
+	{
+		return true;
+	}
+
+	// Only the rest of the partial frame, the frames behind it can wait.
+	const auto result = sendNonBlocking(socketNum, connection.Buffer.data() + connection.SentOffset,
+		connection.FrameEnds.front() - connection.SentOffset);
+	++m_sendCallCount;
+	if (result < 0)
+	{
+		fail(connection);
+		return false;
+	}
+
+	connection.SentOffset += result;
+	connection.Stats.SentBytes += result;
+	connection.Stats.QueuedBytes -= result;
+	if (connection.SentOffset < connection.FrameEnds.front())
+	{
+		log_rtsp_warning("InterleavedTcpWriter: unable to complete frame on socket " + std::to_string(socketNum)
+			+ ", closing the connection");
+		shutDown(socketNum, connection);
+		return false;
+	}
+
+	connection.FrameStart = connection.FrameEnds.front();
+	connection.FrameEnds.pop_front();
+	return true;
+}
+
+bool
+InterleavedTcpWriter::
+GetClientStats(int socketNum, InterleavedClientStats& stats) const
+{
+	const auto it = m_connections.find(socketNum);
+	if (it == m_connections.end())
+	{
+		return false;
+	}
+
+	stats = it->second.Stats;
+	return true;
+}
+
+void
+InterleavedTcpWriter::
+write(int socketNum, Connection& connection)
+{
+	if (connection.IsFailed)
+	{
+		return;
+	}
+
+	// One call for all frames queued; a short write means the socket is full.
+	const auto size = connection.Buffer.size() - connection.SentOffset;
+	const auto result = sendNonBlocking(socketNum, connection.Buffer.data() + connection.SentOffset, size);
+	++m_sendCallCount;
+	if (result < 0)
+	{
+		fail(connection);
+		return;
+	}
+
+	connection.SentOffset += result;
+	connection.Stats.SentBytes += result;
+	connection.Stats.QueuedBytes -= result;
+	while (!connection.FrameEnds.empty() && connection.FrameEnds.front() <= connection.SentOffset)
+	{
+		connection.FrameStart = connection.FrameEnds.front();
+		connection.FrameEnds.pop_front();
+	}
+
+	if (connection.SentOffset == connection.Buffer.size())
+	{
+		connection.Buffer.clear();
+		connection.SentOffset = 0;
+		connection.FrameStart = 0;
+		connection.Stats.IsCongested = false;
+		connection.IsDropping = false;
+		return;
+	}
+
+	connection.Stats.IsCongested = true;
+	if (connection.FrameStart >= CompactionThreshold)
+	{
+		// Drop the frames written, keeping the partial frame.
+		const auto written = connection.FrameStart;
+		connection.Buffer.erase(connection.Buffer.begin(), connection.Buffer.begin() + written);
+		connection.SentOffset -= written;
+		connection.FrameStart = 0;
+		for (auto& frameEnd : connection.FrameEnds)
+		{
+			frameEnd -= written;
+		}
+	}
+}
+
+void
+InterleavedTcpWriter::
+fail(Connection& connection)
+{
+	connection.IsFailed = true;
+	connection.Buffer.clear();
+	connection.FrameEnds.clear();
+	connection.SentOffset = 0;
+	connection.FrameStart = 0;
+	connection.Stats.QueuedBytes = 0;
+	connection.Stats.IsCongested = true;
+}
+
+void
+InterleavedTcpWriter::
+shutDown(int socketNum, Connection& connection)
+{
+	fail(connection);
+#if defined(_WIN32)
+	shutdown(socketNum, SD_BOTH);
+#else
+	shutdown(socketNum, SHUT_RDWR);
+#endif
+}
@@ -0,0 +1,200 @@
+///
+/// @class InterleavedTcpWriter
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace CvRtsp
+{
+	///
+	/// Back-pressure state of an RTSP connection that RTP is interleaved on.
+	struct InterleavedClientStats
+	{
+		/// Bytes waiting for the socket.
+		size_t QueuedBytes = 0;
+
+		/// Bytes written to the socket.
+		uint64_t SentBytes = 0;
+
+		/// Packets dropped because the queue was full.
+		uint64_t DroppedPackets = 0;
+
+		/// True while the socket does not take all queued bytes.
+		bool IsCongested = false;
+	};
+
+	///
+	/// Writes the RTP packets of RTSP-interleaved (RTP over TCP) clients without blocking the
+	/// event loop.
+	///
+	/// live555 writes the '$' header and the packet of every interleaved packet with a send() each
+	/// and blocks the event loop while a client's socket is full. The writer instead appends the
+	/// framed packets to a queue per connection and writes the whole queue with a single send()
+	/// per connection when it is flushed. Whatever the socket does not take stays queued and is
+	/// written by later flushes; once a connection has more than the maximum queued, further
+	/// packets are dropped and counted (back-pressure).
+	///
+	/// RTCP is queued as well (see InterleavedRtcpReader), so the only bytes live555 still writes
+	/// to the socket are the RTSP responses. Before it does, the frame that was partially written
+	/// has to be completed, see CompletePartialFrame().
+	///
+	/// Not thread-safe, owned by the event loop.
+	class InterleavedTcpWriter
+	{
+	public:
+		/// Default maximum of bytes queued per connection.
+		static const size_t DefaultMaxQueuedBytes = 1024 * 1024;
+
+		///
+		/// Constructor.
+		InterleavedTcpWriter();
+
+		InterleavedTcpWriter(const InterleavedTcpWriter&) = delete;
+		InterleavedTcpWriter& operator=(const InterleavedTcpWriter&) = delete;
+
+		///
+		/// Start using a socket, connections are counted so that audio and video can share one.
+		///
+		/// @param[in] socketNum RTSP connection socket.
+		void Attach(int socketNum);
+
+		///
+		/// Stop using a socket, the queue is dropped with the last user.
+		///
+		/// @param[in] socketNum RTSP connection socket.
+		void Detach(int socketNum);
+
+		///
+		/// Queue an interleaved packet.
+		///
+		/// @param[in] socketNum	RTSP connection socket, must be attached.
+		/// @param[in] channelId	Interleaved channel id.
+		/// @param[in] data			RTP or RTCP packet.
+		/// @param[in] size			Packet size.
+		///
+		/// @return False if the packet has been dropped.
+		bool Queue(int socketNum, unsigned char channelId, const unsigned char* data, unsigned size);
+
+		///
+		/// Write the queues of all connections as far as the sockets take them.
+		void Flush();
+
+		///
+		/// Finish writing the partially written frame of a connection, without blocking, so that
+		/// live555 can write to the socket. If the socket does not take the rest of the frame the
+		/// connection is shut down: the client would read whatever is written next as the rest of
+		/// the frame and lose the interleaved framing for good.
+		///
+		/// @param[in] socketNum RTSP connection socket.
+		///
+		/// @return False if the connection has been shut down or failed before, the caller must
+		/// close it rather than write to it.
+		bool CompletePartialFrame(int socketNum);
+
+		///
+		/// Do connections have bytes queued.
+		///
+		/// @return True if a later Flush() has something to write.
+		bool HasPending() const
+		{
+			return !m_pendingSockets.empty();
+		}
+
+		///
+		/// Set the maximum of bytes queued per connection.
+		///
+		/// @param[in] maxQueuedBytes Maximum queued bytes.
+		void SetMaxQueuedBytes(size_t maxQueuedBytes)
+		{
+			m_maxQueuedBytes = maxQueuedBytes;
+		}
+
+		///
+		/// Get the back-pressure state of a connection.
+		///
+		/// @param[in] socketNum	RTSP connection socket.
+		/// @param[out] stats		Connection state.
+		///
+		/// @return False if the socket is not attached.
+		bool GetClientStats(int socketNum, InterleavedClientStats& stats) const;
+
+		///
+		/// Number of send system calls made.
+		///
+		/// @return Send calls since construction.
+		uint64_t GetSendCallCount() const
+		{
+			return m_sendCallCount;
+		}
+
+	private:
+		/// Queue of a connection.
+		struct Connection
+		{
+			/// Framed packets, written from SentOffset on.
+			std::vector<unsigned char> Buffer;
+
+			/// Bytes of Buffer written.
+			size_t SentOffset = 0;
+
+			/// End offsets of the frames in Buffer that have not been written completely.
+			std::deque<size_t> FrameEnds;
+
+			/// Start offset of the first frame in FrameEnds.
+			size_t FrameStart = 0;
+
+			/// Number of users of the socket.
+			unsigned AttachCount = 0;
+
+			/// True once writing failed, nothing is written anymore.
+			bool IsFailed = false;
+
+			/// True while the connection is in m_pendingSockets.
+			bool IsPending = false;
+
+			/// True from the first dropped packet until the queue has been written, to log once.
+			bool IsDropping = false;
+
+			/// Back-pressure state.
+			InterleavedClientStats Stats;
+		};
+
+		/// Queues by socket.
+		std::unordered_map<int, Connection> m_connections;
+
+		/// Sockets with bytes queued.
+		std::vector<int> m_pendingSockets;
+
+		/// Sockets being flushed, reused to avoid allocating per flush.
+		std::vector<int> m_flushSockets;
+
+		/// Maximum of bytes queued per connection.
+		size_t m_maxQueuedBytes;
+
+		/// Number of send system calls made.
+		uint64_t m_sendCallCount;
+
+		/// Write as much of a connection's queue as the socket takes.
+		///
+		/// @param[in] socketNum	Socket.
+		/// @param[in] connection	Connection.
+		void write(int socketNum, Connection& connection);
+
+		/// Drop the queue of a connection after writing failed.
+		///
+		/// @param[in] connection Connection.
+		static void fail(Connection& connection);
+
+		/// Fail a connection and shut its socket down, live555 closes it once it reads the end.
+		///
+		/// @param[in] socketNum	Socket.
+		/// @param[in] connection	Connection.
+		static void shutDown(int socketNum, Connection& connection);
+	};
+}
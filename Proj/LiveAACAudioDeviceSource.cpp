@@ -0,0 +1,212 @@
+///
+/// @class LiveAACAudioDeviceSource
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "LiveAACAudioDeviceSource.h"
+#include "IFrameGrabber.h"
+#include "SimpleFrameGrabber.h"
+
+using namespace CvRtsp;
+
+/// Size of an ADTS header without and with CRC.
+static const unsigned AdtsHeaderSize = 7;
+static const unsigned AdtsHeaderWithCrcSize = 9;
+
+/// Size of the AU-headers-length field and of a single AU header (13 bit size, 3 bit index).
+static const unsigned AuHeadersLengthSize = 2;
+static const unsigned AuHeaderSize = 2;
+
+LiveAACAudioDeviceSource*
+LiveAACAudioDeviceSource::
+CreateNew(UsageEnvironment& env, unsigned clientId, LiveMediaSubsession* parentSubsession,
+	IMediaSampleBuffer* sampleBuffer, unsigned samplingFrequency, unsigned maxAccessUnitsPerPacket,
+	unsigned maxPayloadSize)
+{
+	return new LiveAACAudioDeviceSource(env, clientId, parentSubsession, new SimpleFrameGrabber(sampleBuffer),
+		samplingFrequency, maxAccessUnitsPerPacket, maxPayloadSize);
+}
+
+LiveAACAudioDeviceSource::
+LiveAACAudioDeviceSource(UsageEnvironment& env, unsigned clientId, LiveMediaSubsession* parentSubsession,
+	IFrameGrabber* frameGrabber, unsigned samplingFrequency, unsigned maxAccessUnitsPerPacket,
+	unsigned maxPayloadSize) :
+	LiveDeviceSource(env, clientId, parentSubsession, frameGrabber, nullptr, nullptr),
+	m_accessUnitDuration(samplingFrequency > 0 ? static_cast<double>(SamplesPerAccessUnit) / samplingFrequency : 0.0),
+	m_maxAccessUnitsPerPacket(maxAccessUnitsPerPacket > 0 ? maxAccessUnitsPerPacket : 1),
+	m_maxPayloadSize(maxPayloadSize),
+	m_pendingAccessUnits(0),
+	m_pendingStartTime(0.0)
+{
+	m_auHeaders.reserve(AuHeaderSize * m_maxAccessUnitsPerPacket);
+	m_auData.reserve(m_maxPayloadSize);
+}
+
+unsigned
+LiveAACAudioDeviceSource::
+AccessUnitsForLatencyBudget(unsigned samplingFrequency, unsigned latencyBudgetMs)
+{
+	// Round down so that a packet never holds more audio than the budget allows.
+	const auto accessUnits = static_cast<unsigned>(
+		(static_cast<uint64_t>(latencyBudgetMs) * samplingFrequency) / (SamplesPerAccessUnit * 1000ull));
+	return accessUnits > 0 ? accessUnits : 1;
+}
+
+bool
+LiveAACAudioDeviceSource::
+RetrieveMediaSampleFromBuffer()
+{
+	unsigned bufferSize = 0;
+	auto startTime = 0.0;
+	const auto dataBuffer = m_frameGrabber->GetNextFrame(bufferSize, startTime);
+
+	// Make sure there's data, the frame grabber should return null if it doesn't have any data.
+	if (!dataBuffer || bufferSize == 0)
+	{
+		return false;
+	}
+
+	findAccessUnits(dataBuffer, bufferSize);
+
+	auto hasQueuedPayload = false;
+	for (size_t index = 0; index < m_accessUnits.size(); ++index)
+	{
+		// A sample carrying several ADTS frames holds consecutive access units.
+		const auto accessUnitStartTime = startTime + index * m_accessUnitDuration;
+		hasQueuedPayload |= appendAccessUnit(m_accessUnits[index], accessUnitStartTime);
+	}
+
+	return hasQueuedPayload;
+}
+
+void
+LiveAACAudioDeviceSource::
+DiscardQueuedSamples()
+{
+	LiveDeviceSource::DiscardQueuedSamples();
+
+	// The access units being aggregated belong to the discarded live audio as well.
+	m_auHeaders.clear();
+	m_auData.clear();
+	m_pendingAccessUnits = 0;
+	m_pendingStartTime = 0.0;
+}
+
+void
+LiveAACAudioDeviceSource::
+findAccessUnits(const BYTE* data, unsigned size)
+{
+	m_accessUnits.clear();
+
+	// Without the ADTS syncword the sample is taken to be a single raw access unit.
+	if (size < AdtsHeaderSize || data[0] != 0xff || (data[1] & 0xf6) != 0xf0)
+	{
+		m_accessUnits.push_back({ data, size });
+		return;
+	}
+
+	unsigned position = 0;
+	while (position + AdtsHeaderSize <= size)
+	{
+		const auto header = data + position;
+		if (header[0] != 0xff || (header[1] & 0xf6) != 0xf0)
+		{
+			log_rtsp_warning("LiveAACAudioDeviceSource: lost ADTS sync, dropping rest of sample");
+			return;
+		}
+
+		const auto headerSize = (header[1] & 0x01) ? AdtsHeaderSize : AdtsHeaderWithCrcSize;
+		const auto frameLength = ((header[3] & 0x03u) << 11) | (header[4] << 3) | (header[5] >> 5);
+		const auto rawDataBlocks = (header[6] & 0x03u) + 1;
+		if (frameLength <= headerSize || position + frameLength > size)
+		{
+			log_rtsp_warning("LiveAACAudioDeviceSource: invalid ADTS frame length, dropping rest of sample");
+			return;
+		}
+
+		// Several raw data blocks per ADTS frame cannot be split without parsing the raw data, skip them.
+		if (rawDataBlocks == 1)
+		{
+			m_accessUnits.push_back({ header + headerSize, frameLength - headerSize });
+		}
+		else
+		{
+			log_rtsp_warning("LiveAACAudioDeviceSource: ADTS frames with several raw data blocks are not supported");
+		}
+
+		position += frameLength;
+	}
+}
+
+bool
+LiveAACAudioDeviceSource::
+appendAccessUnit(const AccessUnit& accessUnit, double startTime)
+{
+	if (accessUnit.Size > MaxAccessUnitSize
+		|| AuHeadersLengthSize + AuHeaderSize + accessUnit.Size > m_maxPayloadSize)
+	{
+		log_rtsp_warning("LiveAACAudioDeviceSource: access unit does not fit into a single packet, dropping it");
+		return false;
+	}
+
+	auto hasQueuedPayload = false;
+
+	// Close the current packet if this access unit would push it beyond the maximum payload size.
+	const auto payloadSize = AuHeadersLengthSize + m_auHeaders.size() + m_auData.size();
+	if (m_pendingAccessUnits > 0 && payloadSize + AuHeaderSize + accessUnit.Size > m_maxPayloadSize)
+	{
+		flushPendingPayload();
+		hasQueuedPayload = true;
+	}
+
+	if (m_pendingAccessUnits == 0)
+	{
+		m_pendingStartTime = startTime;
+	}
+
+	// AU-size in the upper 13 bits, AU-index/AU-index-delta is always 0 for consecutive access units.
+	const auto auHeader = static_cast<uint16_t>(accessUnit.Size << 3);
+	m_auHeaders.push_back(static_cast<BYTE>(auHeader >> 8));
+	m_auHeaders.push_back(static_cast<BYTE>(auHeader & 0xff));
+	m_auData.insert(m_auData.end(), accessUnit.Data, accessUnit.Data + accessUnit.Size);
+	++m_pendingAccessUnits;
+
+	// Close the packet once it carries the latency budget worth of audio.
+	if (m_pendingAccessUnits >= m_maxAccessUnitsPerPacket)
+	{
+		flushPendingPayload();
+		hasQueuedPayload = true;
+	}
+
+	return hasQueuedPayload;
+}
+
+void
+LiveAACAudioDeviceSource::
+flushPendingPayload()
+{
+	assert(m_pendingAccessUnits > 0);
+
+	// AU-headers-length is given in bits.
+	const auto auHeadersLength = static_cast<uint16_t>(m_auHeaders.size() * 8);
+	m_auHeaders.insert(m_auHeaders.begin(), { static_cast<BYTE>(auHeadersLength >> 8),
+		static_cast<BYTE>(auHeadersLength & 0xff) });
+	m_auHeaders.insert(m_auHeaders.end(), m_auData.begin(), m_auData.end());
+
+	const auto mediaSample = MediaSample::CreateMediaSample(m_auHeaders.data(),
+		static_cast<int>(m_auHeaders.size()), m_pendingStartTime);
+	m_mediaSampleQueue.push_back(mediaSample);
+	if (static_cast<int>(m_mediaSampleQueue.size()) > MaxMediaPackets)
+	{
+		// Client is not keeping up, drop the oldest packet.
+		m_mediaSampleQueue.pop_front();
+	}
+
+	m_auHeaders.clear();
+	m_auData.clear();
+	m_pendingAccessUnits = 0;
+}
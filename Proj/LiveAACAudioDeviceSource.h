@@ -0,0 +1,137 @@
+///
+/// @class LiveAACAudioDeviceSource
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <vector>
+
+#include "LiveDeviceSource.h"
+
+namespace CvRtsp
+{
+	///
+	/// Device source for AAC audio that produces ready-made RFC 3640 (AAC-hbr) payloads.
+	///
+	/// ADTS headers are detected and skipped in place, and the raw access units are
+	/// aggregated, together with their AU headers, into a single payload per RTP packet.
+	/// A packet is closed when the next access unit would not fit into the maximum payload
+	/// size or when the packet carries the configured latency budget worth of audio.
+	/// The matching sink is LiveAACAudioRTPSink, which sends each payload as is.
+	class LiveAACAudioDeviceSource : public LiveDeviceSource
+	{
+	public:
+		///
+		/// Destructor.
+		virtual ~LiveAACAudioDeviceSource() = default;
+
+		///
+		/// Named constructor.
+		///
+		/// @param env Usage environment.
+		/// @param clientId Client identifier.
+		/// @param parentSubsession Live media subsession parent class.
+		/// @param sampleBuffer Sample buffer.
+		/// @param samplingFrequency Sampling frequency in Hz.
+		/// @param maxAccessUnitsPerPacket Maximum number of access units aggregated into one packet.
+		/// @param maxPayloadSize Maximum RTP payload size in bytes.
+		///
+		/// @return Live AAC audio device source.
+		static LiveAACAudioDeviceSource* CreateNew(UsageEnvironment& env, unsigned clientId,
+			LiveMediaSubsession* parentSubsession, IMediaSampleBuffer* sampleBuffer,
+			unsigned samplingFrequency, unsigned maxAccessUnitsPerPacket, unsigned maxPayloadSize);
+
+		///
+		/// Method to add data to the device. Overridden from LiveDeviceSource base class.
+		///
+		/// @return True if a complete RTP payload has been queued.
+		bool RetrieveMediaSampleFromBuffer() override;
+
+		///
+		/// Drop the queued payloads and the payload being aggregated.
+		void DiscardQueuedSamples() override;
+
+		///
+		/// Compute the number of access units that fit into a latency budget.
+		///
+		/// @param samplingFrequency Sampling frequency in Hz.
+		/// @param latencyBudgetMs Audio duration that may be buffered per packet in milliseconds.
+		///
+		/// @return Maximum number of access units per packet, at least 1.
+		static unsigned AccessUnitsForLatencyBudget(unsigned samplingFrequency, unsigned latencyBudgetMs);
+
+	protected:
+		///
+		/// Constructor.
+		///
+		/// @param env Usage environment.
+		/// @param clientId Client identifier.
+		/// @param parentSubsession Live media subsession parent class.
+		/// @param frameGrabber Frame grabber.
+		/// @param samplingFrequency Sampling frequency in Hz.
+		/// @param maxAccessUnitsPerPacket Maximum number of access units aggregated into one packet.
+		/// @param maxPayloadSize Maximum RTP payload size in bytes.
+		LiveAACAudioDeviceSource(UsageEnvironment& env, unsigned clientId,
+			LiveMediaSubsession* parentSubsession, IFrameGrabber* frameGrabber,
+			unsigned samplingFrequency, unsigned maxAccessUnitsPerPacket, unsigned maxPayloadSize);
+
+	private:
+		/// Location of a raw access unit within a media sample.
+		struct AccessUnit
+		{
+			const BYTE* Data;
+			unsigned Size;
+		};
+
+		/// Samples per AAC access unit.
+		static const unsigned SamplesPerAccessUnit = 1024;
+
+		/// Largest access unit size that can be signalled with a 13 bit AU-size field.
+		static const unsigned MaxAccessUnitSize = (1 << 13) - 1;
+
+		/// Duration of one access unit in seconds.
+		double m_accessUnitDuration;
+
+		/// Maximum number of access units per packet.
+		unsigned m_maxAccessUnitsPerPacket;
+
+		/// Maximum RTP payload size.
+		unsigned m_maxPayloadSize;
+
+		/// Access units of the current media sample, reused to avoid allocating per sample.
+		std::vector<AccessUnit> m_accessUnits;
+
+		/// AU headers of the payload being aggregated.
+		std::vector<BYTE> m_auHeaders;
+
+		/// Access unit data of the payload being aggregated.
+		std::vector<BYTE> m_auData;
+
+		/// Number of access units in the payload being aggregated.
+		unsigned m_pendingAccessUnits;
+
+		/// Start time of the first access unit in the payload being aggregated.
+		double m_pendingStartTime;
+
+		///
+		/// Locate the raw access units in a sample, skipping ADTS headers if present.
+		///
+		/// @param data Media sample data.
+		/// @param size Media sample size.
+		void findAccessUnits(const BYTE* data, unsigned size);
+
+		///
+		/// Append an access unit to the payload being aggregated.
+		///
+		/// @param accessUnit Raw access unit.
+		/// @param startTime Start time of the access unit.
+		///
+		/// @return True if a payload was completed and queued.
+		bool appendAccessUnit(const AccessUnit& accessUnit, double startTime);
+
+		///
+		/// Queue the aggregated payload (AU header section followed by the access units).
+		void flushPendingPayload();
+	};
+}
@@ -0,0 +1,57 @@
+///
+/// @class LiveAACAudioRTPSink
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "LiveAACAudioRTPSink.h"
+
+using namespace CvRtsp;
+
+LiveAACAudioRTPSink*
+LiveAACAudioRTPSink::
+CreateNew(UsageEnvironment& env, Groupsock* rtpGroupsock, u_int8_t rtpPayloadFormat,
+	u_int32_t samplingFrequency, char const* configString, unsigned numChannels)
+{
+	return new LiveAACAudioRTPSink(env, rtpGroupsock, rtpPayloadFormat, samplingFrequency,
+		configString, numChannels);
+}
+
+LiveAACAudioRTPSink::
+LiveAACAudioRTPSink(UsageEnvironment& env, Groupsock* rtpGroupsock, u_int8_t rtpPayloadFormat,
+	u_int32_t samplingFrequency, char const* configString, unsigned numChannels) :
+	MPEG4GenericRTPSink(env, rtpGroupsock, rtpPayloadFormat, samplingFrequency,
+		"audio", "AAC-hbr", configString, numChannels)
+{
+}
+
+Boolean
+LiveAACAudioRTPSink::
+frameCanAppearAfterPacketStart(unsigned char const* /*frameStart*/, unsigned /*numBytesInFrame*/) const
+{
+	// Each frame is a complete payload with its own AU header section.
+	return False;
+}
+
+void
+LiveAACAudioRTPSink::
+doSpecialFrameHandling(unsigned fragmentationOffset, unsigned char* frameStart,
+	unsigned numBytesInFrame, struct timeval framePresentationTime, unsigned numRemainingBytes)
+{
+	// The AU headers are part of the frame, only the marker bit is set here (RFC 3640, 3.2.1).
+	if (numRemainingBytes == 0)
+	{
+		setMarkerBit();
+	}
+
+	MultiFramedRTPSink::doSpecialFrameHandling(fragmentationOffset, frameStart,
+		numBytesInFrame, framePresentationTime, numRemainingBytes);
+}
+
+unsigned
+LiveAACAudioRTPSink::
+specialHeaderSize() const
+{
+	return 0;
+}
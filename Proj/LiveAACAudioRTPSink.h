@@ -0,0 +1,63 @@
+///
+/// @class LiveAACAudioRTPSink
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <live555/MPEG4GenericRTPSink.hh>
+
+namespace CvRtsp
+{
+	///
+	/// MPEG4-generic (RFC 3640, AAC-hbr) sink for payloads built by LiveAACAudioDeviceSource.
+	///
+	/// The device source already prefixes each payload with the AU header section for all the
+	/// access units it aggregated, so every frame is sent as a packet of its own without adding
+	/// another AU header. The SDP is the one of MPEG4GenericRTPSink.
+	class LiveAACAudioRTPSink : public MPEG4GenericRTPSink
+	{
+	public:
+		///
+		/// Named constructor.
+		///
+		/// @param env Usage environment.
+		/// @param rtpGroupsock RTP groupsock.
+		/// @param rtpPayloadFormat RTP payload type.
+		/// @param samplingFrequency Sampling frequency, used as RTP timestamp frequency.
+		/// @param configString AudioSpecificConfig as hex string.
+		/// @param numChannels Number of audio channels.
+		///
+		/// @return Live AAC audio RTP sink.
+		static LiveAACAudioRTPSink* CreateNew(UsageEnvironment& env, Groupsock* rtpGroupsock,
+			u_int8_t rtpPayloadFormat, u_int32_t samplingFrequency, char const* configString,
+			unsigned numChannels);
+
+	protected:
+		///
+		/// Constructor.
+		///
+		/// @param env Usage environment.
+		/// @param rtpGroupsock RTP groupsock.
+		/// @param rtpPayloadFormat RTP payload type.
+		/// @param samplingFrequency Sampling frequency, used as RTP timestamp frequency.
+		/// @param configString AudioSpecificConfig as hex string.
+		/// @param numChannels Number of audio channels.
+		LiveAACAudioRTPSink(UsageEnvironment& env, Groupsock* rtpGroupsock,
+			u_int8_t rtpPayloadFormat, u_int32_t samplingFrequency, char const* configString,
+			unsigned numChannels);
+
+		///
+		/// Destructor, called only by Medium::close().
+		virtual ~LiveAACAudioRTPSink() = default;
+
+	private:
+		/// Redefined virtual functions from MPEG4GenericRTPSink.
+		Boolean frameCanAppearAfterPacketStart(unsigned char const* frameStart,
+			unsigned numBytesInFrame) const override;
+		void doSpecialFrameHandling(unsigned fragmentationOffset, unsigned char* frameStart,
+			unsigned numBytesInFrame, struct timeval framePresentationTime,
+			unsigned numRemainingBytes) override;
+		unsigned specialHeaderSize() const override;
+	};
+}
@@ -24,23 +24,28 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "pch.h"
 
 #include "LiveAACSubsession.h"
-#include "LiveDeviceSource.h"
-#include <live555/MPEG4GenericRTPSink.hh>
+#include "LiveAACAudioDeviceSource.h"
+#include "LiveAACAudioRTPSink.h"
 #include "LiveRtspServer.h"
 
 using namespace CvRtsp;
 
+// Largest RTP payload built from aggregated access units, leaves room below the sink's maximum packet size.
+static const unsigned AacMaxPayloadSize = 1400;
+
 LiveAACSubsession::LiveAACSubsession(UsageEnvironment& env, LiveRtspServer& rParent,
 	const boost::uuids::uuid& uiChannelId, unsigned uiSourceID,
 	const std::string& sSessionName,
 	const unsigned uiNumChannels, const unsigned uiBitsPerSample, const unsigned uiSamplingFrequency,
 	const std::string& sConfigStr,
-	IRateAdaptationFactory* pFactory, IRateController* pGlobalRateControl)
+	IRateAdaptationFactory* pFactory, IRateController* pGlobalRateControl,
+	const unsigned uiPacketTimeMs)
 	:LiveMediaSubsession(env, rParent, uiChannelId, uiSourceID, sSessionName, false, 1, false, pFactory, pGlobalRateControl),
 	m_numChannels(uiNumChannels),
 	m_bitsPerSample(uiBitsPerSample),
 	m_samplingFrequency(uiSamplingFrequency),
 	m_bitsPerSecond(m_samplingFrequency* m_bitsPerSample* m_numChannels),
+	m_maxAccessUnitsPerPacket(uiPacketTimeMs == 0 ? 1 : LiveAACAudioDeviceSource::AccessUnitsForLatencyBudget(uiSamplingFrequency, uiPacketTimeMs)),
 	m_sConfigStr(sConfigStr)
 {
 #if 0
@@ -62,7 +67,8 @@ FramedSource* LiveAACSubsession::createSubsessionSpecificSource(unsigned clientS
 	IRateController* /*pRateControl*/)
 {
 	// not performing rate adaptation in this module
-	return LiveDeviceSource::CreateNew(envir(), clientSessionId, this, pMediaSampleBuffer, NULL, NULL);
+	return LiveAACAudioDeviceSource::CreateNew(envir(), clientSessionId, this, pMediaSampleBuffer,
+		m_samplingFrequency, m_maxAccessUnitsPerPacket, AacMaxPayloadSize);
 }
 
 void LiveAACSubsession::setEstimatedBitRate(unsigned& estBitrate)
@@ -73,10 +79,10 @@ void LiveAACSubsession::setEstimatedBitRate(unsigned& estBitrate)
 
 RTPSink* LiveAACSubsession::createSubsessionSpecificRTPSink(Groupsock* rtpGroupsock, unsigned char rtpPayloadTypeIfDynamic, FramedSource* inputSource)
 {
-	// Create an appropriate audio RTP sink (using "SimpleRTPSink") from the RTP 'groupsock':
-	return MPEG4GenericRTPSink::createNew(envir(), rtpGroupsock,
+	// The device source builds the AU header section, the sink sends its payloads as they are.
+	return LiveAACAudioRTPSink::CreateNew(envir(), rtpGroupsock,
 		rtpPayloadTypeIfDynamic,
 		m_samplingFrequency,
-		"audio", "AAC-hbr", m_sConfigStr.c_str(),
+		m_sConfigStr.c_str(),
 		m_numChannels);
 }
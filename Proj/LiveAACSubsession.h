@@ -41,7 +41,8 @@ namespace CvRtsp
 			const std::string& sSessionName,
 			const unsigned uiNumChannels, const unsigned uiBitsPerSample, const unsigned uiSamplingFrequency,
 			const std::string& sConfigStr,
-			IRateAdaptationFactory* pFactory, IRateController* pGlobalRateControl);
+			IRateAdaptationFactory* pFactory, IRateController* pGlobalRateControl,
+			const unsigned uiPacketTimeMs = 0);
 
 		virtual ~LiveAACSubsession();
 
@@ -64,6 +65,9 @@ namespace CvRtsp
 		unsigned m_samplingFrequency;
 		unsigned m_bitsPerSecond;
 
+		/// Access units aggregated into one RTP packet, derived from the packet time.
+		unsigned m_maxAccessUnitsPerPacket;
+
 		std::string m_sConfigStr;
 	};
 
@@ -27,11 +27,13 @@ using namespace CvRtsp;
 
 LiveAMRAudioDeviceSource::LiveAMRAudioDeviceSource(UsageEnvironment& env, unsigned uiClientId, LiveMediaSubsession* pParent,
     IMediaSampleBuffer* pSampleBuffer, IRateAdaptationFactory* pRateAdaptationFactory,
-    IRateController* pGlobalRateControl)
+    IRateController* pGlobalRateControl, Boolean isWideband)
     :LiveDeviceSource(env, uiClientId, pParent, new SimpleFrameGrabber(pSampleBuffer), pRateAdaptationFactory, pGlobalRateControl),
-    fIsWideband(False),
+    fIsWideband(isWideband),
     fNumChannels(1),
-    fLastFrameHeader(0)
+    fLastFrameHeader(0),
+    m_frameReadIndex(0),
+    m_frameCount(0)
 {
 
 }
@@ -44,9 +46,10 @@ LiveAMRAudioDeviceSource::~LiveAMRAudioDeviceSource()
 LiveAMRAudioDeviceSource* LiveAMRAudioDeviceSource::createNew(UsageEnvironment& env, unsigned uiClientId, LiveMediaSubsession* pParent,
     IMediaSampleBuffer* pSampleBuffer,
     IRateAdaptationFactory* pRateAdaptationFactory,
-    IRateController* pRateControl)
+    IRateController* pRateControl,
+    Boolean isWideband)
 {
-    LiveAMRAudioDeviceSource* pSource = new LiveAMRAudioDeviceSource(env, uiClientId, pParent, pSampleBuffer, pRateAdaptationFactory, pRateControl);
+    LiveAMRAudioDeviceSource* pSource = new LiveAMRAudioDeviceSource(env, uiClientId, pParent, pSampleBuffer, pRateAdaptationFactory, pRateControl, isWideband);
     return pSource;
 }
 
@@ -65,69 +68,122 @@ static unsigned short frameSizeWideband[16] = {
   FT_INVALID, FT_INVALID, 0, 0
 };
 
-// #define DEBUG
-bool LiveAMRAudioDeviceSource::retrieveMediaSampleFromBuffer()
+bool LiveAMRAudioDeviceSource::IsValidFrame(const u_int8_t* pFrame, unsigned uiSize, bool isWideband)
 {
-    unsigned uiSize = 0;
-    double dStartTime = 0.0;
-    BYTE* pBuffer = m_frameGrabber->GetNextFrame(uiSize, dStartTime);
-#if 1
-    fLastFrameHeader = pBuffer[0]; // Should be pos 0 or 1???
-    if ((fLastFrameHeader & 0x83) != 0)
+    if (!pFrame || uiSize == 0)
     {
-#ifdef DEBUG
-        fprintf(stderr, "Invalid frame header 0x%02x (padding bits (0x83) are not zero)\n", fLastFrameHeader);
-        log_rtsp_warning("Invalid frame header " + std::to_string(fLastFrameHeader) + " (padding bits(0x83) are not zero).");
-#endif
+        return false;
     }
-    else
+
+    const u_int8_t frameHeader = pFrame[0];
+    if ((frameHeader & 0x83) != 0)
     {
-        unsigned char ft = (fLastFrameHeader & 0x78) >> 3;
-        fFrameSize = fIsWideband ? frameSizeWideband[ft] : frameSize[ft];
-        if (fFrameSize == FT_INVALID)
-        {
-#ifdef DEBUG
-            fprintf(stderr, "Invalid FT field %d (from frame header 0x%02x)\n", ft, fLastFrameHeader);
-            log_rtsp_warning("Invalid FT field  " + std::to_string(ft) + " (from frame header " + std::to_string(fLastFrameHeader) + ".");
-#endif
-        }
-        else
-        {
-            // The frame header is OK
-
-            fprintf(stderr, "Valid frame header 0x%02x -> ft %d -> frame size %d\n", fLastFrameHeader, ft, fFrameSize);
-            log_rtsp_debug("Valid frame header " + std::to_string(fLastFrameHeader) + " -> ft " + std::to_string(ft) + " -> frame size " + std::to_string(fFrameSize) + ".");
-
-        }
+        // padding bits (0x83) are not zero
+        return false;
     }
-#endif
+
+    // A frame whose size does not match its frame type would be sent with a TOC that
+    // misdescribes the payload.
+    const unsigned char ft = (frameHeader & 0x78) >> 3;
+    const unsigned expectedSize = isWideband ? frameSizeWideband[ft] : frameSize[ft];
+    return expectedSize != FT_INVALID && uiSize - 1 == expectedSize;
+}
+
+bool LiveAMRAudioDeviceSource::RetrieveMediaSampleFromBuffer()
+{
+    unsigned uiSize = 0;
+    double dStartTime = 0.0;
+    BYTE* pBuffer = m_frameGrabber->GetNextFrame(uiSize, dStartTime);
 
     // Make sure there's data, the frame grabber should return null if it doesn't have any
-    if (!pBuffer)
+    if (!pBuffer || uiSize == 0)
     {
-#if 0
-        log_rtsp_warning("NULL Sample retrieved from frame grabber.");
-#endif
         return false;
     }
-    else
+
+    if (!IsValidFrame(pBuffer, uiSize, fIsWideband != False))
+    {
+        log_rtsp_debug("LiveAMRAudioDeviceSource: dropped malformed AMR frame of " + std::to_string(uiSize) + " bytes");
+        return false;
+    }
+
+    // Slice the frame header off: it is carried in the payload TOC instead (RFC 4867, sec. 4.4.2).
+    const u_int8_t frameHeader = pBuffer[0];
+    const unsigned speechSize = uiSize - 1;
+
+    if (m_frameCount == MaxQueuedFrames)
     {
-        // Without TOC!!!!!!
-        //MediaSample mediaSample;
-        //mediaSample.setPresentationTime(dStartTime);
-        BYTE* pData = new uint8_t[uiSize - 1];
-        memcpy(pData, pBuffer + 1, uiSize - 1);
-
-        auto mediaSample = MediaSample::CreateMediaSample(pData, uiSize - 1, dStartTime);
-        //mediaSample.setData(Buffer(pData, uiSize - 1));
-        m_mediaSampleQueue.push_back(mediaSample);
-        return true;
+        // Client is not keeping up, drop the oldest frame.
+        m_frameReadIndex = (m_frameReadIndex + 1) % MaxQueuedFrames;
+        --m_frameCount;
     }
+
+    AmrFrame& frame = m_frames[(m_frameReadIndex + m_frameCount) % MaxQueuedFrames];
+    frame.Header = frameHeader;
+    frame.Size = static_cast<u_int8_t>(speechSize);
+    frame.StartTime = dStartTime;
+    memcpy(frame.Data, pBuffer + 1, speechSize);
+    ++m_frameCount;
+
+    return true;
+}
+
+void LiveAMRAudioDeviceSource::DiscardQueuedSamples()
+{
+    LiveDeviceSource::DiscardQueuedSamples();
+
+    m_frameReadIndex = 0;
+    m_frameCount = 0;
 }
 
 void LiveAMRAudioDeviceSource::doGetNextFrame()
 {
-    LiveDeviceSource::doGetNextFrame();
+    if (m_frameCount == 0)
+    {
+        m_isPlaying = false;
+        return;
+    }
+
+    m_isPlaying = true;
+
+    DeliverFrame();
+}
+
+void LiveAMRAudioDeviceSource::DeliverFrame()
+{
+    if (!isCurrentlyAwaitingData())
+    {
+        return; // we're not ready for the data yet
+    }
+
+    assert(m_frameCount > 0);
+
+    const AmrFrame& frame = m_frames[m_frameReadIndex];
+    m_frameReadIndex = (m_frameReadIndex + 1) % MaxQueuedFrames;
+    --m_frameCount;
+
+    // The sink reads the header of the frame being delivered when building the TOC.
+    fLastFrameHeader = frame.Header;
+
+    setPresentationTime(frame.StartTime);
+
+    fFrameSize = frame.Size;
+    if (fFrameSize > fMaxSize)
+    {
+        fNumTruncatedBytes = fFrameSize - fMaxSize;
+        fFrameSize = fMaxSize;
+    }
+    else
+    {
+        fNumTruncatedBytes = 0;
+    }
+    memcpy(fTo, frame.Data, fFrameSize);
+
+    // 20 ms per frame, but live sources deliver as soon as data is available.
+    fDurationInMicroseconds = 0;
+
+    // After delivering the data, inform the reader that it is now available:
+    afterGetting(this);
 }
 
 Boolean LiveAMRAudioDeviceSource::isAMRAudioSource() const
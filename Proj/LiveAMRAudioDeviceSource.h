@@ -16,6 +16,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 // "liveMedia"
 // Copyright (c) 1996-2014 Live Networks, Inc.  All rights reserved.
 #pragma once
+#include <array>
 #include "LiveDeviceSource.h"
 
 namespace CvRtsp
@@ -25,6 +26,14 @@ namespace CvRtsp
     class IMediaSampleBuffer;
     class LiveMediaSubsession;
 
+    /**
+     * @brief Device source for octet-aligned AMR frames (RFC 4867).
+     *
+     * Incoming samples are single AMR frames starting with the frame header (TOC) byte.
+     * The header is sliced off and the speech bits are kept in a fixed ring of frame
+     * slots, so that no heap allocation happens per frame. The header of the frame
+     * being delivered is exposed through lastFrameHeader() for the RTP sink.
+     */
     class LiveAMRAudioDeviceSource : public LiveDeviceSource
     {
     public:
@@ -37,15 +46,23 @@ namespace CvRtsp
          */
         static LiveAMRAudioDeviceSource* createNew(UsageEnvironment& env, unsigned uiClientId, LiveMediaSubsession* pParent,
             IMediaSampleBuffer* pSampleBuffer, IRateAdaptationFactory* pRateAdaptationFactory,
-            IRateController* pGlobalRateControl);
+            IRateController* pGlobalRateControl, Boolean isWideband = False);
         /**
          * @brief Retrieves data from buffer and adds to the device
          */
-        virtual bool retrieveMediaSampleFromBuffer();
+        bool RetrieveMediaSampleFromBuffer() override;
+        /**
+         * @brief Delivers the oldest queued AMR frame into the live555 pipeline
+         */
+        void DeliverFrame() override;
+        /**
+         * @brief Drops the frames queued in the ring
+         */
+        void DiscardQueuedSamples() override;
         /**
          * @brief Required to be compatible with LiveAMRAudioRTPSink and AMRAudioRTPSink
          */
-        virtual Boolean isAMRAudioSource() const;
+        Boolean isAMRAudioSource() const override;
         /**
          * @brief Getter for if AMR is wide-band
          */
@@ -55,9 +72,14 @@ namespace CvRtsp
          */
         unsigned numChannels() const { return fNumChannels; }
         /**
-         * @brief Returns the frame header for the most recently read frame (RFC 3267, sec. 5.3)
+         * @brief Returns the frame header for the most recently delivered frame (RFC 3267, sec. 5.3)
          */
         u_int8_t lastFrameHeader() const { return fLastFrameHeader; }
+        /**
+         * @brief Checks an incoming AMR frame: zero padding bits in the frame header, a valid frame
+         * type and exactly as many speech bytes after the header as the frame type carries
+         */
+        static bool IsValidFrame(const u_int8_t* pFrame, unsigned uiSize, bool isWideband);
 
     protected:
         /**
@@ -66,17 +88,42 @@ namespace CvRtsp
         LiveAMRAudioDeviceSource(UsageEnvironment& env, unsigned uiClientId, LiveMediaSubsession* pParent,
             IMediaSampleBuffer* pSampleBuffer,
             IRateAdaptationFactory* pRateAdaptationFactory,
-            IRateController* pRateControl);
+            IRateController* pRateControl,
+            Boolean isWideband);
         /**
          * brief redefined virtual function from FramedSource
          */
-        virtual void doGetNextFrame();
+        void doGetNextFrame() override;
 
     protected:
         Boolean fIsWideband;
         unsigned fNumChannels;
         u_int8_t fLastFrameHeader;
+
+    private:
+        /// Largest AMR/AMR-WB speech frame without the frame header (AMR-WB mode 8).
+        static const unsigned MaxFrameSize = 60;
+
+        /// Number of frames that can be queued per client (one second of audio).
+        static const unsigned MaxQueuedFrames = 50;
+
+        /// A queued AMR frame: frame header and speech bits.
+        struct AmrFrame
+        {
+            u_int8_t Header;
+            u_int8_t Size;
+            double StartTime;
+            u_int8_t Data[MaxFrameSize];
+        };
+
+        /// Fixed ring of queued frames.
+        std::array<AmrFrame, MaxQueuedFrames> m_frames;
+
+        /// Index of the oldest queued frame.
+        unsigned m_frameReadIndex;
+
+        /// Number of queued frames.
+        unsigned m_frameCount;
     };
 
 } // lme
-
@@ -27,14 +27,17 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 using namespace CvRtsp;
 
-LiveAMRAudioRTPSink* LiveAMRAudioRTPSink::createNew(UsageEnvironment& env, Groupsock* RTPgs, unsigned char rtpPayloadFormat, Boolean sourceIsWideband /*= False*/, unsigned numChannelsInSource /*= 1*/)
+LiveAMRAudioRTPSink* LiveAMRAudioRTPSink::createNew(UsageEnvironment& env, Groupsock* RTPgs, unsigned char rtpPayloadFormat, Boolean sourceIsWideband /*= False*/, unsigned numChannelsInSource /*= 1*/,
+    unsigned framesPerPacket /*= DefaultFramesPerPacket*/)
 {
     return new LiveAMRAudioRTPSink(env, RTPgs, rtpPayloadFormat,
-        sourceIsWideband, numChannelsInSource);
+        sourceIsWideband, numChannelsInSource, framesPerPacket);
 }
 
-LiveAMRAudioRTPSink::LiveAMRAudioRTPSink(UsageEnvironment& env, Groupsock* RTPgs, unsigned char rtpPayloadFormat, Boolean sourceIsWideband, unsigned numChannelsInSource)
-    :AMRAudioRTPSink(env, RTPgs, rtpPayloadFormat, sourceIsWideband, numChannelsInSource)
+LiveAMRAudioRTPSink::LiveAMRAudioRTPSink(UsageEnvironment& env, Groupsock* RTPgs, unsigned char rtpPayloadFormat, Boolean sourceIsWideband, unsigned numChannelsInSource,
+    unsigned framesPerPacket)
+    :AMRAudioRTPSink(env, RTPgs, rtpPayloadFormat, sourceIsWideband, numChannelsInSource),
+    fFramesPerPacket(framesPerPacket == 0 ? 1 : (framesPerPacket > MaxFramesPerPacket ? MaxFramesPerPacket : framesPerPacket))
 {
 
 }
@@ -72,8 +75,6 @@ Boolean LiveAMRAudioRTPSink::sourceIsCompatibleWithUs(MediaSource& source)
 
 void LiveAMRAudioRTPSink::doSpecialFrameHandling(unsigned fragmentationOffset, unsigned char* frameStart, unsigned numBytesInFrame, struct timeval frameTimestamp, unsigned numRemainingBytes)
 {
-#define AUDIO_FRAMES_PER_RTP_FRAME 5
-
     // If this is the 1st frame in the 1st packet, set the RTP 'M' (marker)
     // bit (because this is considered the start of a talk spurt):
     if (isFirstPacket() && isFirstFrameInPacket()) {
@@ -93,7 +94,7 @@ void LiveAMRAudioRTPSink::doSpecialFrameHandling(unsigned fragmentationOffset, u
     if (amrSource == NULL) return; // sanity check
 
     u_int8_t toc = amrSource->lastFrameHeader();
-    if (numFramesUsedSoFar() < AUDIO_FRAMES_PER_RTP_FRAME - 1) {
+    if (numFramesUsedSoFar() < fFramesPerPacket - 1) {
         toc |= 0x80;
     }
     else {
@@ -113,7 +114,7 @@ void LiveAMRAudioRTPSink::doSpecialFrameHandling(unsigned fragmentationOffset, u
 }
 
 Boolean LiveAMRAudioRTPSink::frameCanAppearAfterPacketStart(unsigned char const* /*frameStart*/, unsigned /*numBytesInFrame*/) const {
-    return numFramesUsedSoFar() < AUDIO_FRAMES_PER_RTP_FRAME;
+    return numFramesUsedSoFar() < fFramesPerPacket;
 
 }
 
@@ -122,5 +123,5 @@ unsigned LiveAMRAudioRTPSink::frameSpecificHeaderSize() const {
 }
 
 unsigned LiveAMRAudioRTPSink::specialHeaderSize() const {
-    return 1 + AUDIO_FRAMES_PER_RTP_FRAME;
+    return 1 + fFramesPerPacket;
 }
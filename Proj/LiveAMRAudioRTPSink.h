@@ -30,17 +30,28 @@ namespace CvRtsp
     {
     public:
 
+        /// Default number of 20 ms AMR frames aggregated into one RTP packet (ptime 100 ms).
+        static const unsigned DefaultFramesPerPacket = 5;
+
+        /// Maximum number of AMR frames aggregated into one RTP packet.
+        static const unsigned MaxFramesPerPacket = 20;
+
         static LiveAMRAudioRTPSink* createNew(UsageEnvironment& env,
             Groupsock* RTPgs,
             unsigned char rtpPayloadFormat,
             Boolean sourceIsWideband = False,
-            unsigned numChannelsInSource = 1);
+            unsigned numChannelsInSource = 1,
+            unsigned framesPerPacket = DefaultFramesPerPacket);
+
+        /// Number of AMR frames aggregated into one RTP packet.
+        unsigned framesPerPacket() const { return fFramesPerPacket; }
 
     protected:
 
         LiveAMRAudioRTPSink(UsageEnvironment& env, Groupsock* RTPgs,
             unsigned char rtpPayloadFormat,
-            Boolean sourceIsWideband, unsigned numChannelsInSource);
+            Boolean sourceIsWideband, unsigned numChannelsInSource,
+            unsigned framesPerPacket);
         // called only by createNew()
 
         virtual ~LiveAMRAudioRTPSink();
@@ -57,6 +68,8 @@ namespace CvRtsp
         virtual unsigned frameSpecificHeaderSize() const;
         virtual unsigned specialHeaderSize() const;
 
+    private:
+        unsigned fFramesPerPacket;
 
     };
 
@@ -30,16 +30,22 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 using namespace CvRtsp;
 
+/// Duration of a single AMR / AMR-WB frame.
+static const unsigned AmrFrameDurationMs = 20;
+
 LiveAMRSubsession::LiveAMRSubsession(UsageEnvironment& env, LiveRtspServer& rParent,
     const boost::uuids::uuid& uiChannelId, unsigned uniqueSessionID,
     const std::string& sSessionName,
     const unsigned uiNumChannels, const unsigned uiBitsPerSample, const unsigned uiSamplingFrequency,
-    IRateAdaptationFactory* pFactory, IRateController* pGlobalRateControl)
+    IRateAdaptationFactory* pFactory, IRateController* pGlobalRateControl,
+    const unsigned uiPacketTimeMs)
     :LiveMediaSubsession(env, rParent, uiChannelId, uniqueSessionID, sSessionName, false, 1, false, pFactory, pGlobalRateControl),
     m_numChannels(uiNumChannels),
     m_bitsPerSample(uiBitsPerSample),
     m_samplingFrequency(uiSamplingFrequency),
-    m_bitsPerSecond(m_samplingFrequency* m_bitsPerSample* m_numChannels)
+    m_bitsPerSecond(m_samplingFrequency* m_bitsPerSample* m_numChannels),
+    m_isWideband(uiSamplingFrequency == 16000),
+    m_framesPerPacket(uiPacketTimeMs == 0 ? LiveAMRAudioRTPSink::DefaultFramesPerPacket : (uiPacketTimeMs + AmrFrameDurationMs - 1) / AmrFrameDurationMs)
 {
 #if 0
     "Subsession created: Sampling frequency: " << m_samplingFrequency << "Hz Bits per sample: " << m_bitsPerSample << " Channels: " << m_numChannels << " Bits per second: " << m_bitsPerSecond);
@@ -62,7 +68,8 @@ FramedSource* LiveAMRSubsession::createSubsessionSpecificSource(unsigned clientS
 {
     return LiveAMRAudioDeviceSource::createNew(envir(), clientSessionId, this, pMediaSampleBuffer,
         NULL /* no rate adaptation for AMR */,
-        NULL /* no rate adaptation for AMR */);
+        NULL /* no rate adaptation for AMR */,
+        m_isWideband);
 }
 
 void LiveAMRSubsession::setEstimatedBitRate(unsigned& estBitrate)
@@ -73,6 +80,7 @@ void LiveAMRSubsession::setEstimatedBitRate(unsigned& estBitrate)
 RTPSink* LiveAMRSubsession::createSubsessionSpecificRTPSink(Groupsock* rtpGroupsock, unsigned char rtpPayloadTypeIfDynamic, FramedSource* inputSource)
 {
     // Create an appropriate audio RTP sink (using "SimpleRTPSink") from the RTP 'groupsock':
-    RTPSink* pRtpSink = LiveAMRAudioRTPSink::createNew(envir(), rtpGroupsock, rtpPayloadTypeIfDynamic, false, m_numChannels);
+    RTPSink* pRtpSink = LiveAMRAudioRTPSink::createNew(envir(), rtpGroupsock, rtpPayloadTypeIfDynamic, m_isWideband, m_numChannels,
+        m_framesPerPacket);
     return pRtpSink;
 }
@@ -39,7 +39,8 @@ namespace CvRtsp
 			const boost::uuids::uuid& uiChannelId, unsigned uniqueSessionID,
 			const std::string& sSessionName,
 			const unsigned uiNumChannels, const unsigned uiBitsPerSample, const unsigned uiSamplingFrequency,
-			IRateAdaptationFactory* pFactory, IRateController* pGlobalRateControl);
+			IRateAdaptationFactory* pFactory, IRateController* pGlobalRateControl,
+			const unsigned uiPacketTimeMs = 0);
 
 		virtual ~LiveAMRSubsession();
 
@@ -59,6 +60,10 @@ namespace CvRtsp
 		unsigned m_bitsPerSample;
 		unsigned m_samplingFrequency;
 		unsigned m_bitsPerSecond;
+		/// AMR-WB if sampled at 16 kHz
+		bool m_isWideband;
+		/// Number of 20 ms frames per RTP packet, derived from the packet time
+		unsigned m_framesPerPacket;
 	};
 
 } // lme
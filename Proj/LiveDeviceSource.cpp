@@ -172,10 +172,40 @@ DeliverFrame()
 	const auto mediaSample = m_mediaSampleQueue.front();
 	m_mediaSampleQueue.pop_front();
 
-	const auto startTime = mediaSample->StartTime();
 	const auto bufferSize = mediaSample->GetSize();
 	const auto dataBuffer = mediaSample->GetDataBuffer().Data();
 
+	setPresentationTime(mediaSample->StartTime());
+
+	if (bufferSize > static_cast<int>(fMaxSize))
+	{
+		// TODONB
+		//TOREVISE/TODO
+		fNumTruncatedBytes = bufferSize - fFrameSize;
+		fFrameSize = fMaxSize;
+		//TODO How do we send the rest in the following packet???
+		//TODO How do we delete the frame??? Unless we store extra attributes in the MediaFrame class
+		//LOG(WARNING) << "TODO: Truncated packet";
+	}
+	else
+	{
+		fFrameSize = bufferSize;
+		memcpy(fTo, dataBuffer, fFrameSize);
+		// Testing with current time of day
+		//gettimeofday(&fPresentationTime, NULL);
+		// 04/04/2008 RG: http://lists.live555.com/pipermail/live-devel/2008-April/008395.html
+		//Testing with 'live' config
+		fDurationInMicroseconds = 0;
+	}
+
+	// After delivering the data, inform the reader that it is now available:
+	afterGetting(this);
+}
+
+void
+LiveDeviceSource::
+setPresentationTime(double startTime)
+{
 	// The start time of the first sample is stored as a reference start time for the media samples
 	// Similarly we store the current time obtained by gettimeofday in m_offsetTimeStruct.
 	// The reason for this is that we need to start timestamping the samples with timestamps starting at gettimeofday
@@ -203,30 +233,6 @@ DeliverFrame()
 		fPresentationTime.tv_sec = m_offsetTimeStruct.tv_sec + timeDifferenceSecs;
 		fPresentationTime.tv_usec = m_offsetTimeStruct.tv_usec + timeDifferenceMicroSecs;
 	}
-
-	if (bufferSize > static_cast<int>(fMaxSize))
-	{
-		// TODONB
-		//TOREVISE/TODO
-		fNumTruncatedBytes = bufferSize - fFrameSize;
-		fFrameSize = fMaxSize;
-		//TODO How do we send the rest in the following packet???
-		//TODO How do we delete the frame??? Unless we store extra attributes in the MediaFrame class
-		//LOG(WARNING) << "TODO: Truncated packet";
-	}
-	else
-	{
-		fFrameSize = bufferSize;
-		memcpy(fTo, dataBuffer, fFrameSize);
-		// Testing with current time of day
-		//gettimeofday(&fPresentationTime, NULL);
-		// 04/04/2008 RG: http://lists.live555.com/pipermail/live-devel/2008-April/008395.html
-		//Testing with 'live' config
-		fDurationInMicroseconds = 0;
-	}
-
-	// After delivering the data, inform the reader that it is now available:
-	afterGetting(this);
 }
 
 void
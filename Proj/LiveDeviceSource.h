@@ -84,7 +84,7 @@ namespace CvRtsp
 
 		///
 		/// Delivers frame into the live555 pipeline.
-		void DeliverFrame();
+		virtual void DeliverFrame();
 
 		///
 		/// Retrieves a sample from the media buffer.
@@ -132,6 +132,23 @@ namespace CvRtsp
 			return m_isPlaying;
 		}
 
+		///
+		/// Has a sample been delivered to the sink.
+		///
+		/// @return True once the first sample has been delivered.
+		bool HasDeliveredMedia() const
+		{
+			return m_useTimeOffset;
+		}
+
+		///
+		/// Drop the samples queued for delivery. Sources that buffer media of their own drop
+		/// that as well.
+		virtual void DiscardQueuedSamples()
+		{
+			m_mediaSampleQueue.clear();
+		}
+
 	protected:
 		/// Maximum allowed media packets.
 		int MaxMediaPackets = 200;
@@ -192,5 +209,12 @@ namespace CvRtsp
 
 		/// Redefined virtual functions from live555 FramedSource.
 		void doGetNextFrame() override;
+
+		///
+		/// Sets fPresentationTime from the media start time, relative to the wall clock time
+		/// at which the first sample was delivered.
+		///
+		/// @param startTime Media sample start time in seconds.
+		void setPresentationTime(double startTime);
 	};
 }
@@ -0,0 +1,119 @@
+///
+/// @class LiveG711Subsession
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <live555/SimpleRTPSink.hh>
+
+#include "LiveG711Subsession.h"
+#include "G711Encoder.h"
+#include "LiveDeviceSource.h"
+#include "LiveRtspServer.h"
+
+using namespace CvRtsp;
+
+/// Default packet time (RFC 3551, 4.5).
+static const unsigned DefaultG711PacketTimeMs = 20;
+
+/// Static payload types, only valid for 8 kHz mono (RFC 3551, table 4).
+static const unsigned char PcmuPayloadType = 0;
+static const unsigned char PcmaPayloadType = 8;
+
+LiveG711Subsession::
+LiveG711Subsession(UsageEnvironment& env, LiveRtspServer& parent,
+	const boost::uuids::uuid& channelId, unsigned sourceId, const std::string& sessionName,
+	unsigned numChannels, unsigned samplingFrequency, bool isALaw,
+	IRateAdaptationFactory* rateAdaptationFactory, IRateController* globalRateControl,
+	unsigned packetTimeMs) :
+	LiveMediaSubsession(env, parent, channelId, sourceId, sessionName, false, 1, false,
+		rateAdaptationFactory, globalRateControl),
+	m_numChannels(numChannels > 0 ? numChannels : 1),
+	m_samplingFrequency(samplingFrequency),
+	m_isALaw(isALaw),
+	m_pendingStartTime(0.0)
+{
+	const auto ptime = packetTimeMs > 0 ? packetTimeMs : DefaultG711PacketTimeMs;
+	auto framesPerPacket = static_cast<size_t>(m_samplingFrequency) * ptime / 1000;
+	if (framesPerPacket == 0)
+	{
+		framesPerPacket = 1;
+	}
+	m_bytesPerPacket = framesPerPacket * m_numChannels;
+	m_packetDuration = m_samplingFrequency > 0 ? static_cast<double>(framesPerPacket) / m_samplingFrequency : 0.0;
+	m_pending.reserve(2 * m_bytesPerPacket);
+}
+
+void
+LiveG711Subsession::
+prepareMediaSample(const std::shared_ptr<MediaSample>& mediaSample,
+	std::vector<std::shared_ptr<MediaSample>>& preparedSamples)
+{
+	const auto sampleCount = static_cast<size_t>(mediaSample->GetSize()) / sizeof(int16_t);
+	if (sampleCount == 0)
+	{
+		return;
+	}
+
+	if (m_pending.empty())
+	{
+		m_pendingStartTime = mediaSample->StartTime();
+	}
+
+	// Encode straight behind the pending samples, one byte per sample.
+	const auto pendingSize = m_pending.size();
+	m_pending.resize(pendingSize + sampleCount);
+	const auto pcm = reinterpret_cast<const int16_t*>(mediaSample->GetDataBuffer().Data());
+	if (m_isALaw)
+	{
+		G711Encoder::EncodeALaw(pcm, m_pending.data() + pendingSize, sampleCount);
+	}
+	else
+	{
+		G711Encoder::EncodeMuLaw(pcm, m_pending.data() + pendingSize, sampleCount);
+	}
+
+	// Cut on packet time boundaries, the remainder waits for the next sample.
+	size_t offset = 0;
+	for (; offset + m_bytesPerPacket <= m_pending.size(); offset += m_bytesPerPacket)
+	{
+		preparedSamples.push_back(MediaSample::CreateMediaSample(m_pending.data() + offset,
+			static_cast<int>(m_bytesPerPacket), m_pendingStartTime));
+		m_pendingStartTime += m_packetDuration;
+	}
+	m_pending.erase(m_pending.begin(), m_pending.begin() + offset);
+}
+
+FramedSource*
+LiveG711Subsession::
+createSubsessionSpecificSource(unsigned clientSessionId, IMediaSampleBuffer* mediaSampleBuffer,
+	IRateAdaptationFactory* /*rateAdaptationFactory*/, IRateController* /*rateControl*/)
+{
+	// not performing rate adaptation in this module
+	return LiveDeviceSource::CreateNew(envir(), clientSessionId, this, mediaSampleBuffer, nullptr, nullptr);
+}
+
+void
+LiveG711Subsession::
+setEstimatedBitRate(unsigned& estBitrate)
+{
+	// 8 bits per sample, in kbps.
+	estBitrate = (m_samplingFrequency * m_numChannels * 8 + 500) / 1000;
+}
+
+RTPSink*
+LiveG711Subsession::
+createSubsessionSpecificRTPSink(Groupsock* rtpGroupsock, unsigned char rtpPayloadTypeIfDynamic,
+	FramedSource* /*inputSource*/)
+{
+	// The static payload types imply 8 kHz mono, anything else is announced with a dynamic one.
+	auto payloadType = rtpPayloadTypeIfDynamic;
+	if (m_samplingFrequency == 8000 && m_numChannels == 1)
+	{
+		payloadType = m_isALaw ? PcmaPayloadType : PcmuPayloadType;
+	}
+
+	return SimpleRTPSink::createNew(envir(), rtpGroupsock, payloadType, m_samplingFrequency,
+		"audio", m_isALaw ? "PCMA" : "PCMU", m_numChannels);
+}
@@ -0,0 +1,91 @@
+///
+/// @class LiveG711Subsession
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <vector>
+
+#include "LiveMediaSubsession.h"
+
+namespace CvRtsp
+{
+	class LiveRtspServer;
+
+	///
+	/// Serves 16 bit linear PCM as G.711 mu-law (PCMU) or A-law (PCMA).
+	///
+	/// Samples are converted once per channel when they are added, before they reach the
+	/// per client device sources, and are cut into RTP payloads on packet time boundaries.
+	class LiveG711Subsession : public LiveMediaSubsession
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param env Usage environment.
+		/// @param parent Rtsp server.
+		/// @param channelId Channel id.
+		/// @param sourceId Source id.
+		/// @param sessionName Session name.
+		/// @param numChannels Number of interleaved audio channels.
+		/// @param samplingFrequency Sampling frequency in Hz.
+		/// @param isALaw True for PCMA, false for PCMU.
+		/// @param rateAdaptationFactory Rate adaptation factory.
+		/// @param globalRateControl Rate controller.
+		/// @param packetTimeMs Audio duration per RTP packet in milliseconds, 0 for 20 ms.
+		LiveG711Subsession(UsageEnvironment& env, LiveRtspServer& parent,
+			const boost::uuids::uuid& channelId, unsigned sourceId, const std::string& sessionName,
+			unsigned numChannels, unsigned samplingFrequency, bool isALaw,
+			IRateAdaptationFactory* rateAdaptationFactory, IRateController* globalRateControl,
+			unsigned packetTimeMs = 0);
+
+		///
+		/// Destructor.
+		virtual ~LiveG711Subsession() = default;
+
+	protected:
+		///
+		/// Converts the 16 bit linear PCM sample and returns the completed packets.
+		/// Overridden from LiveMediaSubsession.
+		///
+		/// @param[in] mediaSample Native endian 16 bit interleaved PCM.
+		/// @param[out] preparedSamples Completed G.711 packets.
+		void prepareMediaSample(const std::shared_ptr<MediaSample>& mediaSample,
+			std::vector<std::shared_ptr<MediaSample>>& preparedSamples) override;
+
+		/// Overridden from LiveMediaSubsession.
+		FramedSource* createSubsessionSpecificSource(unsigned clientSessionId, IMediaSampleBuffer* mediaSampleBuffer,
+			IRateAdaptationFactory* rateAdaptationFactory, IRateController* rateControl) override;
+
+		/// Overridden from LiveMediaSubsession.
+		void setEstimatedBitRate(unsigned& estBitrate) override;
+
+		/// Overridden from LiveMediaSubsession.
+		RTPSink* createSubsessionSpecificRTPSink(Groupsock* rtpGroupsock, unsigned char rtpPayloadTypeIfDynamic,
+			FramedSource* inputSource) override;
+
+	private:
+		/// Number of interleaved audio channels.
+		unsigned m_numChannels;
+
+		/// Sampling frequency.
+		unsigned m_samplingFrequency;
+
+		/// PCMA if true, PCMU otherwise.
+		bool m_isALaw;
+
+		/// Encoded bytes (one per sample) per RTP packet.
+		size_t m_bytesPerPacket;
+
+		/// Duration of one RTP packet in seconds.
+		double m_packetDuration;
+
+		/// Encoded samples not yet sent, less than one packet.
+		std::vector<BYTE> m_pending;
+
+		/// Start time of the first pending sample.
+		double m_pendingStartTime;
+	};
+}
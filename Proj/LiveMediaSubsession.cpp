@@ -23,13 +23,17 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 ///
 #include "pch.h"
 
+#include <algorithm>
 #include <cassert>
+#include <boost/uuid/uuid_io.hpp>
 #include <live555/liveMedia.hh>
 
 #include "LiveMediaSubsession.h"
 #include "LiveAMRAudioDeviceSource.h"
 #include "LiveDeviceSource.h"
 #include "LiveSourceTaskScheduler.h"
+#include "BatchedGroupsock.h"
+#include "InterleavedRtcpReader.h"
 #include "LiveRtspServer.h"
 #include "IMediaSampleBuffer.h"
 #include "MultiMediaSampleBuffer.h"
@@ -39,6 +43,13 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 // In our case we want a separate device source per client so that we can control the switching on a per client basis
 static const bool ReuseFirstSource = false;
 
+// Grace period for clients to rejoin before an idle channel is killed.
+static const int64_t DefaultIdleTimeoutMicroSec = 1000000;
+
+// Recorded samples sent to a client playing from the timeshift buffer per sample ingested: the
+// client catches up with live at twice the recording speed.
+static const size_t TimeshiftCatchUpRate = 2;
+
 using namespace CvRtsp;
 
 LiveMediaSubsession::
@@ -57,7 +68,9 @@ LiveMediaSubsession(UsageEnvironment& env, LiveRtspServer& parent,
 	m_rateAdaptationFactory(rateAdaptationFactory),
 	m_globalRateControl(globalRateControl),
 	m_hasServedAnyVideoDeviceSource(false),
-	m_hasBeenProcessedToKill(false)
+	m_hasBeenProcessedToKill(false),
+	m_idleTimeoutMicroSec(DefaultIdleTimeoutMicroSec),
+	m_idleTimeoutTask(nullptr)
 {
 	// sanity checks
 	assert(m_channelId.is_nil() == false);
@@ -69,6 +82,7 @@ LiveMediaSubsession(UsageEnvironment& env, LiveRtspServer& parent,
 	{
 		pollingScheduler->RegisterMediaSubsession(m_channelId, m_sessionName, m_sourceId, this);
 	}
+	updateWatcherCount();
 
 	// Create sample buffer according to number of 'switchable' channels.
 	assert(m_totalChannels > 0);
@@ -89,12 +103,15 @@ void
 LiveMediaSubsession::
 cleanup()
 {
+	envir().taskScheduler().unscheduleDelayedTask(m_idleTimeoutTask);
+
 	// get handle to task-scheduler.
 	const auto pScheduler = &(envir().taskScheduler());
 	const auto pPollingScheduler = dynamic_cast<LiveSourceTaskScheduler*>(pScheduler);
 	if (pPollingScheduler)
 	{
-		// unregister this subsession from task scheduler.
+		// nobody consumes the source anymore, then unregister this subsession from task scheduler.
+		pPollingScheduler->SetWatcherCount(m_channelId, m_sessionName, m_sourceId, 0);
 		pPollingScheduler->DeRegisterMediaSubsession(m_channelId, m_sessionName, m_sourceId, this);
 	}
 
@@ -117,28 +134,220 @@ LiveMediaSubsession::
 void
 LiveMediaSubsession::
 AddMediaSample(const std::shared_ptr<MediaSample>& mediaSample)
+{
+	PrepareMediaSample(mediaSample);
+	DeliverPreparedFrames();
+}
+
+void
+LiveMediaSubsession::
+PrepareMediaSample(const std::shared_ptr<MediaSample>& mediaSample)
 {
 	assert(m_sampleBuffer);
 
-	// Add the sample to the buffer where it will be parsed
-	m_sampleBuffer->AddMediaSample(mediaSample);
-	
-	// Iterate over all device sources and deliver the samples to the clients
-	for (const auto& deviceSource : m_deviceSources)
+	// Samples still queued when the last watcher left are not worth filtering.
+	if (GetWatcherCount() == 0)
+	{
+		return;
+	}
+
+	m_preparedSamples.clear();
+	prepareMediaSample(mediaSample, m_preparedSamples);
+
+	const auto now = TimeshiftBuffer::Clock::now();
+	for (const auto& preparedSample : m_preparedSamples)
+	{
+		if (m_timeshiftBuffer)
+		{
+			m_timeshiftBuffer->Append(preparedSample, now);
+		}
+		if (m_segmentStore)
+		{
+			m_segmentStore->Append(preparedSample, now);
+		}
+
+		// Add the sample to the buffer where it will be parsed
+		m_sampleBuffer->AddMediaSample(preparedSample);
+
+		// Let every device source split and packetize the sample into its own queue
+		for (const auto& deviceSource : m_deviceSources)
+		{
+			if (!m_hasServedAnyVideoDeviceSource)
+			{
+				// mark as this subsession has served media samples.
+				m_hasServedAnyVideoDeviceSource = true;
+			}
+
+			// Clients playing from the timeshift buffer get the sample once they have caught up.
+			if (!m_timeshiftClients.empty() && m_timeshiftClients.count(deviceSource->GetClientId()) != 0)
+			{
+				continue;
+			}
+
+			if (deviceSource->RetrieveMediaSampleFromBuffer()
+				&& std::find(m_readyDeviceSources.begin(), m_readyDeviceSources.end(), deviceSource) == m_readyDeviceSources.end())
+			{
+				m_readyDeviceSources.push_back(deviceSource);
+			}
+		}
+	}
+
+	if (!m_timeshiftClients.empty())
+	{
+		replayTimeshift(m_preparedSamples.size());
+	}
+	m_preparedSamples.clear();
+}
+
+void
+LiveMediaSubsession::
+updateWatcherCount()
+{
+	const auto pollingScheduler = dynamic_cast<LiveSourceTaskScheduler*>(&envir().taskScheduler());
+	if (pollingScheduler)
+	{
+		pollingScheduler->SetWatcherCount(m_channelId, m_sessionName, m_sourceId, GetWatcherCount());
+	}
+}
+
+void
+LiveMediaSubsession::
+replayTimeshift(size_t sampleCount)
+{
+	for (auto client = m_timeshiftClients.begin(); client != m_timeshiftClients.end();)
 	{
-		if (!m_hasServedAnyVideoDeviceSource)
+		auto& timeshiftClient = client->second;
+		if (timeshiftClient.IsSeekPending)
 		{
-			// mark as this subsession has served media samples.
-			m_hasServedAnyVideoDeviceSource = true;
+			// The segment store is only used if the timeshift buffer does not reach back far enough.
+			TimeshiftBuffer::Clock::time_point oldestTime;
+			timeshiftClient.IsFromSegmentStore = m_segmentStore && (!m_timeshiftBuffer
+				|| !m_timeshiftBuffer->GetOldestTime(oldestTime) || oldestTime > timeshiftClient.StartTime);
+			timeshiftClient.Position = timeshiftClient.IsFromSegmentStore
+				? m_segmentStore->Seek(timeshiftClient.StartTime)
+				: m_timeshiftBuffer->Seek(timeshiftClient.StartTime);
+			timeshiftClient.IsSeekPending = false;
 		}
 
-		if (deviceSource->RetrieveMediaSampleFromBuffer())
+		// The recorded samples go through the sample buffer like live ones, it is refilled with
+		// the next live sample before any other client reads it. The segment store's samples are
+		// read in place from the mapped segments.
+		for (size_t count = 0; count < sampleCount * TimeshiftCatchUpRate; ++count)
 		{
-			if (!deviceSource->IsPlaying())
+			if (timeshiftClient.IsFromSegmentStore)
 			{
-				deviceSource->DeliverFrame();
+				SegmentSlice slice;
+				if (!m_segmentStore->Read(timeshiftClient.Position, slice))
+				{
+					break;
+				}
+				m_sampleBuffer->SetBorrowedFrame(slice.Data, slice.Size, slice.StartTime);
 			}
+			else
+			{
+				const auto mediaSample = m_timeshiftBuffer->Read(timeshiftClient.Position);
+				if (!mediaSample)
+				{
+					break;
+				}
+				m_sampleBuffer->AddMediaSample(mediaSample);
+			}
+
+			const auto deviceSource = timeshiftClient.DeviceSource;
+			if (deviceSource->RetrieveMediaSampleFromBuffer()
+				&& std::find(m_readyDeviceSources.begin(), m_readyDeviceSources.end(), deviceSource) == m_readyDeviceSources.end())
+			{
+				m_readyDeviceSources.push_back(deviceSource);
+			}
+		}
+
+		// The client has sent the newest recorded sample: it is live from the next one on.
+		const auto endPosition = timeshiftClient.IsFromSegmentStore
+			? m_segmentStore->GetEndPosition() : m_timeshiftBuffer->GetEndPosition();
+		if (timeshiftClient.Position >= endPosition)
+		{
+			client = m_timeshiftClients.erase(client);
+		}
+		else
+		{
+			++client;
+		}
+	}
+}
+
+void
+LiveMediaSubsession::
+EnableTimeshift(TimeshiftBuffer::Clock::duration duration, size_t maxBytes,
+	std::shared_ptr<TimeshiftMemoryBudget> memoryBudget)
+{
+	m_timeshiftBuffer = std::make_unique<TimeshiftBuffer>(duration, maxBytes, m_isVideo, std::move(memoryBudget));
+	updateWatcherCount();
+}
+
+void
+LiveMediaSubsession::
+EnableSegmentStore(const std::string& directory, uint64_t maxBytes, SegmentStore::Clock::duration maxAge)
+{
+	m_segmentStore = std::make_unique<SegmentStore>(directory,
+		boost::uuids::to_string(m_channelId) + "-" + std::to_string(m_sourceId), maxBytes, maxAge, m_isVideo);
+	updateWatcherCount();
+}
+
+bool
+LiveMediaSubsession::
+SeekTimeshift(uint32_t clientSessionId, TimeshiftBuffer::Clock::time_point startTime)
+{
+	if (!m_timeshiftBuffer && !m_segmentStore)
+	{
+		return false;
+	}
+
+	const auto deviceSource = std::find_if(m_deviceSources.begin(), m_deviceSources.end(),
+		[clientSessionId](const LiveDeviceSource* source) { return source->GetClientId() == clientSessionId; });
+	if (deviceSource == m_deviceSources.end() || (*deviceSource)->HasDeliveredMedia())
+	{
+		return false;
+	}
+
+	// The live samples queued since SETUP are replaced by the recorded ones, the keyframe is looked
+	// up by the next ingest stage.
+	(*deviceSource)->DiscardQueuedSamples();
+	m_timeshiftClients[clientSessionId] = { *deviceSource, startTime, 0, true, false };
+	return true;
+}
+
+void
+LiveMediaSubsession::
+DeliverPreparedFrames()
+{
+	// Only kick off sources whose sink is waiting, the others pick up their queue when the sink asks for the next frame
+	for (const auto& deviceSource : m_readyDeviceSources)
+	{
+		if (!deviceSource->IsPlaying())
+		{
+			deviceSource->DeliverFrame();
+		}
+	}
+	m_readyDeviceSources.clear();
+}
+
+void
+LiveMediaSubsession::
+prepareMediaSample(const std::shared_ptr<MediaSample>& mediaSample,
+	std::vector<std::shared_ptr<MediaSample>>& preparedSamples)
+{
+	// Run the bitstream filters once for all clients, a sample may be filtered out completely.
+	const auto filteredSample = m_bitstreamFilterChain.Process(mediaSample);
+	if (filteredSample)
+	{
+		if (filteredSample != mediaSample)
+		{
+			// Only the filtered copy belongs to this subsession, the input may be shared.
+			filteredSample->SetChannelId(m_channelId);
+			filteredSample->SetChannelName(m_sessionName);
+			filteredSample->SetSourceId(m_sourceId);
 		}
+		preparedSamples.push_back(filteredSample);
 	}
 }
 
@@ -189,6 +398,21 @@ createNewRTPSink(Groupsock* rtpGroupsock, unsigned char rtpPayloadTypeIfDynamic,
 	return rtpSink;
 }
 
+Groupsock*
+LiveMediaSubsession::
+createGroupsock(struct sockaddr_storage const& address, Port port)
+{
+	const auto pollingScheduler = dynamic_cast<LiveSourceTaskScheduler*>(&envir().taskScheduler());
+	if (pollingScheduler && pollingScheduler->IsUdpBatchingEnabled())
+	{
+		// Same TTL as OnDemandServerMediaSubsession.
+		return new BatchedGroupsock(envir(), address, port, 255, pollingScheduler->GetUdpSendBatcher(),
+			pollingScheduler->GetInterleavedTcpWriter());
+	}
+
+	return OnDemandServerMediaSubsession::createGroupsock(address, port);
+}
+
 void
 LiveMediaSubsession::
 ProcessClientStatistics()
@@ -204,6 +428,10 @@ LiveMediaSubsession::
 addDeviceSource(LiveDeviceSource* deviceSource)
 {
 	m_deviceSources.emplace_back(deviceSource);
+	updateWatcherCount();
+
+	// A client (re)joined, the channel is no longer idle.
+	envir().taskScheduler().unscheduleDelayedTask(m_idleTimeoutTask);
 }
 
 void
@@ -215,16 +443,17 @@ removeDeviceSource(LiveDeviceSource* deviceSource)
 		if (*source == deviceSource)
 		{
 			m_deviceSources.erase(source);
+			m_timeshiftClients.erase(deviceSource->GetClientId());
+			m_readyDeviceSources.erase(std::remove(m_readyDeviceSources.begin(), m_readyDeviceSources.end(), deviceSource),
+				m_readyDeviceSources.end());
+			updateWatcherCount();
 
 			// is this the last device-source/client that was using this subsession?
-			if (m_deviceSources.empty())
+			// (the sample buffer is gone once the subsession is being destroyed)
+			if (m_deviceSources.empty() && m_hasServedAnyVideoDeviceSource && !m_hasBeenProcessedToKill && m_sampleBuffer)
 			{
-				// kill this subsession.
-				//cleanup(); - @TODO check if this needs to be called, it looks like its called when we call 
-				// CvRtspServer::RemoveChannel()
-
-				// kill the channel associated with this subsession.
-				//m_rtspServer.OnRtspDestroyChannel(m_sessionName);
+				// kill the channel associated with this subsession unless a client rejoins in time.
+				envir().taskScheduler().rescheduleDelayedTask(m_idleTimeoutTask, m_idleTimeoutMicroSec, &onIdleTimeout, this);
 			}
 
 			break;
@@ -232,10 +461,84 @@ removeDeviceSource(LiveDeviceSource* deviceSource)
 	}
 }
 
+void
+LiveMediaSubsession::
+startStream(uint32_t clientSessionId, void* streamToken, TaskFunc* rtcpRRHandler, void* rtcpRRHandlerClientData,
+	unsigned short& rtpSeqNum, unsigned& rtpTimestamp, ServerRequestAlternativeByteHandler* serverRequestAlternativeByteHandler,
+	void* serverRequestAlternativeByteHandlerClientData)
+{
+	// Adds the RTSP connection to the RTP sink and the RTCP instance of RTP-over-TCP clients.
+	OnDemandServerMediaSubsession::startStream(clientSessionId, streamToken, rtcpRRHandler, rtcpRRHandlerClientData,
+		rtpSeqNum, rtpTimestamp, serverRequestAlternativeByteHandler, serverRequestAlternativeByteHandlerClientData);
+
+	const auto client = m_interleavedClients.find(clientSessionId);
+	if (client == m_interleavedClients.end())
+	{
+		return;
+	}
+
+	// Only streams started after the interleaved output has been enabled are queued.
+	const auto pollingScheduler = dynamic_cast<LiveSourceTaskScheduler*>(&envir().taskScheduler());
+	if (!client->second.IsQueued && (!pollingScheduler || !pollingScheduler->IsInterleavedTcpOutputEnabled()))
+	{
+		return;
+	}
+
+	RTPSink* rtpSink = nullptr;
+	RTCPInstance* rtcpInstance = nullptr;
+	getRTPSinkandRTCP(streamToken, rtpSink, rtcpInstance);
+	const auto rtpGroupsock = rtpSink ? dynamic_cast<BatchedGroupsock*>(&rtpSink->groupsockBeingUsed()) : nullptr;
+	if (!rtpGroupsock)
+	{
+		return;
+	}
+
+	// The groupsocks queue the RTP and RTCP packets from now on, so that nothing but the RTSP
+	// responses is written to the connection by live555.
+	rtpSink->removeStreamSocket(client->second.SocketNum, client->second.RtpChannelId);
+	rtpGroupsock->SetInterleavedOutput(client->second.SocketNum, client->second.RtpChannelId);
+	const auto rtcpGroupsock = rtcpInstance ? dynamic_cast<BatchedGroupsock*>(rtcpInstance->RTCPgs()) : nullptr;
+	if (rtcpGroupsock)
+	{
+		// The reader takes over the receiver reports before the RTCP instance lets go of the
+		// connection, which would hand the connection back to the RTSP parser otherwise.
+		if (!client->second.RtcpReader)
+		{
+			client->second.RtcpReader = InterleavedRtcpReader::createNew(envir(), *rtcpInstance,
+				client->second.SocketNum, client->second.RtcpChannelId, rtcpRRHandler, rtcpRRHandlerClientData);
+		}
+		rtcpInstance->removeStreamSocket(client->second.SocketNum, client->second.RtcpChannelId);
+		rtcpGroupsock->SetInterleavedOutput(client->second.SocketNum, client->second.RtcpChannelId);
+	}
+	client->second.IsQueued = true;
+}
+
+bool
+LiveMediaSubsession::
+GetInterleavedClientStats(uint32_t clientSessionId, InterleavedClientStats& stats) const
+{
+	const auto client = m_interleavedClients.find(clientSessionId);
+	if (client == m_interleavedClients.end() || !client->second.IsQueued)
+	{
+		return false;
+	}
+
+	const auto pollingScheduler = dynamic_cast<LiveSourceTaskScheduler*>(&envir().taskScheduler());
+	return pollingScheduler && pollingScheduler->GetInterleavedTcpWriter().GetClientStats(client->second.SocketNum, stats);
+}
+
 void
 LiveMediaSubsession::
 deleteStream(uint32_t clientSessionId, void*& streamToken)
 {
+	const auto client = m_interleavedClients.find(clientSessionId);
+	if (client != m_interleavedClients.end())
+	{
+		// Stops reading before the RTCP instance is deleted.
+		Medium::close(client->second.RtcpReader);
+		m_interleavedClients.erase(client);
+	}
+
 	// Call super class method
 	OnDemandServerMediaSubsession::deleteStream(clientSessionId, streamToken);
 
@@ -269,6 +572,11 @@ getStreamParameters(uint32_t clientSessionId, struct sockaddr_storage const& cli
 
 	OnDemandServerMediaSubsession::getStreamParameters(clientSessionId, clientAddress, clientRTPPort, clientRTCPPort, tcpSocketNum, rtpChannelId,
 		rtcpChannelId, nullptr, destinationAddress, destinationTTL, isMulticast, serverRTPPort, serverRTCPPort, streamToken);
+
+	if (tcpSocketNum >= 0)
+	{
+		m_interleavedClients[clientSessionId] = { tcpSocketNum, rtpChannelId, rtcpChannelId, false, nullptr };
+	}
 }
 
 std::vector<uint32_t>
@@ -284,6 +592,20 @@ GetConnectedClientIds() const
 }
 
 
+void
+LiveMediaSubsession::
+onIdleTimeout(void* clientData)
+{
+	const auto subsession = static_cast<LiveMediaSubsession*>(clientData);
+	subsession->m_idleTimeoutTask = nullptr;
+
+	if (!subsession->IsAnyActiveDeviceSourcePresent() && !subsession->HasBeenProcessedToKill())
+	{
+		// kill the channel(remote rtsp-session in camera-server for this associated subsession)
+		subsession->KillChannel();
+	}
+}
+
 void 
 LiveMediaSubsession::
 KillChannel()
@@ -24,21 +24,29 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <functional>
+#include <unordered_map>
 #include <boost/uuid/uuid.hpp>
 
 #ifndef _ON_DEMAND_SERVER_MEDIA_SUBSESSION_HH
 #include <live555/OnDemandServerMediaSubsession.hh>
 #endif
 #include "MediaSample.h"
+#include "BitstreamFilterChain.h"
+#include "InterleavedTcpWriter.h"
+#include "SegmentStore.h"
+#include "TimeshiftBuffer.h"
 
 
 namespace CvRtsp
 {
 	/// Forward class declarations.
 	class IMediaSampleBuffer;
+	class InterleavedRtcpReader;
 	class LiveDeviceSource;
 	class LiveRtspServer;
 	class IRateAdaptationFactory;
@@ -77,6 +85,24 @@ namespace CvRtsp
 		/// Helper function to cleanup before destroying this subsession.
 		void cleanup();
 
+		///
+		/// Delayed task armed when the last client leaves: kills the channel if nobody rejoined.
+		///
+		/// @param[in] clientData Live media subsession.
+		static void onIdleTimeout(void* clientData);
+
+		///
+		/// Feed the clients playing from the timeshift buffer or the segment store. Runs in the first
+		/// ingest stage, after the live samples have been recorded and handed to the other clients.
+		///
+		/// @param[in] sampleCount Number of samples recorded in this stage.
+		void replayTimeshift(size_t sampleCount);
+
+		///
+		/// Report the number of consumers of the source to the task scheduler, so that the
+		/// producer can stop while nobody watches.
+		void updateWatcherCount();
+
 	public:
 		/// Destructor
 		virtual ~LiveMediaSubsession();
@@ -127,11 +153,35 @@ namespace CvRtsp
 		}
 
 		///
-		/// Add a media sample to the subsession.
+		/// Add a media sample to the subsession: prepares and delivers it in one go.
 		///
 		/// @param[in] mediaSample Media sample.
 		virtual void AddMediaSample(const std::shared_ptr<MediaSample>& mediaSample);
 
+		///
+		/// First ingest stage: filters the sample, adds it to the sample buffer and lets every
+		/// device source split and packetize it into its queue. Makes no live555 calls, so it
+		/// may run on a worker thread as long as the event loop thread is not touching this
+		/// subsession and no two threads prepare samples for the same subsession at once.
+		///
+		/// @param[in] mediaSample Media sample.
+		void PrepareMediaSample(const std::shared_ptr<MediaSample>& mediaSample);
+
+		///
+		/// Second ingest stage: hands the frames queued by PrepareMediaSample to the sinks of
+		/// idle device sources. Must be called on the event loop thread.
+		void DeliverPreparedFrames();
+
+		///
+		/// Append a bitstream filter that is run once per media sample, before the sample
+		/// is delivered to the device sources. The subsession takes ownership.
+		///
+		/// @param[in] filter Bitstream filter.
+		void AddBitstreamFilter(std::unique_ptr<IBitstreamFilter> filter)
+		{
+			m_bitstreamFilterChain.AddFilter(std::move(filter));
+		}
+
 		///
 		/// This method processes the received receiver reports.
 		void ProcessClientStatistics();
@@ -178,6 +228,16 @@ namespace CvRtsp
 			return m_deviceSources.empty() == false;
 		}
 
+		///
+		/// Get the number of consumers of the source: the device sources of the clients, plus the
+		/// timeshift buffer and segment store, which record even without clients.
+		///
+		/// @return Number of consumers.
+		uint32_t GetWatcherCount() const
+		{
+			return static_cast<uint32_t>(m_deviceSources.size()) + (m_timeshiftBuffer || m_segmentStore ? 1 : 0);
+		}
+
 		///
 		/// Getter for if this subsession has served any video device-source with mediasample.
 		inline bool HasServedVideoDeviceSource() const
@@ -189,6 +249,16 @@ namespace CvRtsp
 		/// Ends channel associated with this subsession.
 		void KillChannel();
 
+		///
+		/// Set how long the subsession waits for a client to rejoin after the last client left,
+		/// before the channel is killed.
+		///
+		/// @param[in] idleTimeoutMicroSec Idle timeout in microseconds.
+		void SetIdleTimeout(int64_t idleTimeoutMicroSec)
+		{
+			m_idleTimeoutMicroSec = idleTimeoutMicroSec;
+		}
+
 		///
 		/// Getter for whether this subsession has been processed to kill.
 		inline bool HasBeenProcessedToKill() const
@@ -196,6 +266,46 @@ namespace CvRtsp
 			return m_hasBeenProcessedToKill;
 		}
 
+		///
+		/// Get the back-pressure state of an RTP-over-TCP client whose packets are queued by the
+		/// scheduler's interleaved writer.
+		///
+		/// @param[in] clientSessionId	Client session id.
+		/// @param[out] stats			Back-pressure state of the client's RTSP connection.
+		///
+		/// @return False if the client's packets are not queued.
+		bool GetInterleavedClientStats(uint32_t clientSessionId, InterleavedClientStats& stats) const;
+
+		///
+		/// Record the most recent samples, so that clients can start playing in the past.
+		///
+		/// @param[in] duration		Duration of media to keep.
+		/// @param[in] maxBytes		Maximum number of sample bytes kept by this subsession.
+		/// @param[in] memoryBudget	Memory limit shared with the other subsessions.
+		void EnableTimeshift(TimeshiftBuffer::Clock::duration duration, size_t maxBytes,
+			std::shared_ptr<TimeshiftMemoryBudget> memoryBudget);
+
+		///
+		/// Record the samples to memory-mapped segment files as well, for clients that start further
+		/// in the past than the timeshift buffer reaches.
+		///
+		/// @param[in] directory	Directory of the segment files.
+		/// @param[in] maxBytes		Maximum size of the segment files, not 0.
+		/// @param[in] maxAge		Duration of media to keep.
+		void EnableSegmentStore(const std::string& directory, uint64_t maxBytes, SegmentStore::Clock::duration maxAge);
+
+		///
+		/// Start a client's stream at the nearest keyframe recorded at or before a point in time.
+		/// The recorded samples are sent faster than they are recorded until the client has caught
+		/// up with live. Must be called before the client's stream is started.
+		///
+		/// @param[in] clientSessionId	Client session id.
+		/// @param[in] startTime		Point in time to start at.
+		///
+		/// @return False if neither timeshift nor the segment store is enabled, the client is
+		/// unknown or already playing.
+		bool SeekTimeshift(uint32_t clientSessionId, TimeshiftBuffer::Clock::time_point startTime);
+
 	protected:
 		///
 		/// Register live device source with subsession.
@@ -209,6 +319,15 @@ namespace CvRtsp
 		/// @param[in] deviceSource Live device source.
 		void removeDeviceSource(LiveDeviceSource* deviceSource);
 
+		///
+		/// Transform an incoming media sample into the samples that are added to the sample buffer.
+		/// Runs in the first ingest stage. The default runs the bitstream filter chain.
+		///
+		/// @param[in] mediaSample Media sample.
+		/// @param[out] preparedSamples Samples to add to the sample buffer, in order.
+		virtual void prepareMediaSample(const std::shared_ptr<MediaSample>& mediaSample,
+			std::vector<std::shared_ptr<MediaSample>>& preparedSamples);
+
 		///
 		/// Constructor
 		///
@@ -281,6 +400,15 @@ namespace CvRtsp
 		/// @return New rtp sink. 
 		RTPSink* createNewRTPSink(Groupsock* rtpGroupsock, unsigned char rtpPayloadTypeIfDynamic, FramedSource* inputSource) override;
 
+		///
+		/// Overridden to send the RTP and RTCP datagrams in batches with the live source task scheduler.
+		///
+		/// @param[in] address	Address to bind to.
+		/// @param[in] port		Port to bind to.
+		///
+		/// @return New groupsock.
+		Groupsock* createGroupsock(struct sockaddr_storage const& address, Port port) override;
+
 		///
 		/// Overridden so that we can store the client connection info of connecting RTP clients
 		void getStreamParameters(uint32_t clientSessionId,
@@ -298,6 +426,17 @@ namespace CvRtsp
 			Port& serverRTCPPort,
 			void*& streamToken) override;
 
+		///
+		/// Overridden to queue the RTP packets of RTP-over-TCP clients in the scheduler's
+		/// interleaved writer, if enabled, instead of letting the RTP sink write them.
+		void startStream(uint32_t clientSessionId, void* streamToken,
+			TaskFunc* rtcpRRHandler,
+			void* rtcpRRHandlerClientData,
+			unsigned short& rtpSeqNum,
+			unsigned& rtpTimestamp,
+			ServerRequestAlternativeByteHandler* serverRequestAlternativeByteHandler,
+			void* serverRequestAlternativeByteHandlerClientData) override;
+
 		///
 		/// Overridden so that we can manage connecting client info
 		///
@@ -322,6 +461,12 @@ namespace CvRtsp
 		/// RTP clients listed for this subsession 
 		LiveDeviceSourceList m_deviceSources;
 
+		/// Device sources that have frames queued since the last DeliverPreparedFrames().
+		LiveDeviceSourceList m_readyDeviceSources;
+
+		/// Output of prepareMediaSample(), reused to avoid allocating per sample.
+		std::vector<std::shared_ptr<MediaSample>> m_preparedSamples;
+
 		/// video or audio: helps find applicable sessions
 		bool m_isVideo;
 
@@ -332,6 +477,9 @@ namespace CvRtsp
 		/// Buffer for the samples
 		IMediaSampleBuffer* m_sampleBuffer;
 
+		/// Bitstream filters applied to each sample on ingest.
+		BitstreamFilterChain m_bitstreamFilterChain;
+
 		/// Rate adaptation factory
 		IRateAdaptationFactory* m_rateAdaptationFactory;
 
@@ -353,10 +501,67 @@ namespace CvRtsp
 		/// Has this been processed to kill already?
 		/// KE @TODO - this is a hack so that we dont break consistency. Not a big fan of this!
 		/// So need to update later.
-		/// Background on above: In LiveSourceTaskScheduler0::processMediaSubsessions(), it processes
-		/// faster than we can stop remote-session in our capture-server & call CvRtspServer::RemoveChannel().
+		/// Background on above: the idle timeout fires faster than we can stop remote-session in our
+		/// capture-server & call CvRtspServer::RemoveChannel().
 		/// We could do this from deleting this subsession from here, but the calls would be incosistent since we would 
 		/// be ending some sessions from here & some from there depending on situation, so this hack.
 		bool m_hasBeenProcessedToKill;
+
+		/// Time to wait for a client to rejoin before the channel is killed, in microseconds.
+		int64_t m_idleTimeoutMicroSec;
+
+		/// Idle timeout task, armed while no clients are connected.
+		TaskToken m_idleTimeoutTask;
+
+		/// RTSP connection of an RTP-over-TCP client.
+		struct InterleavedClient
+		{
+			/// RTSP connection socket.
+			int SocketNum;
+
+			/// Interleaved RTP channel id.
+			unsigned char RtpChannelId;
+
+			/// Interleaved RTCP channel id.
+			unsigned char RtcpChannelId;
+
+			/// True once the RTP and RTCP packets are queued in the scheduler's interleaved writer.
+			bool IsQueued;
+
+			/// Reads the receiver reports once RTCP is queued, nullptr before.
+			InterleavedRtcpReader* RtcpReader;
+		};
+
+		/// RTP-over-TCP clients by client session id.
+		std::unordered_map<uint32_t, InterleavedClient> m_interleavedClients;
+
+		/// Most recent samples, nullptr unless timeshift is enabled.
+		std::unique_ptr<TimeshiftBuffer> m_timeshiftBuffer;
+
+		/// Longer history on disk, nullptr unless the segment store is enabled.
+		std::unique_ptr<SegmentStore> m_segmentStore;
+
+		/// Client playing from the timeshift buffer.
+		struct TimeshiftClient
+		{
+			/// Device source of the client.
+			LiveDeviceSource* DeviceSource;
+
+			/// Point in time the client asked to start at.
+			TimeshiftBuffer::Clock::time_point StartTime;
+
+			/// Position of the next recorded sample to send.
+			uint64_t Position;
+
+			/// True until the start time has been looked up in the timeshift buffer.
+			bool IsSeekPending;
+
+			/// True if the client plays from the segment store rather than the timeshift buffer.
+			bool IsFromSegmentStore;
+		};
+
+		/// Clients playing from the recorded samples by client session id, they receive the live
+		/// samples once they have caught up.
+		std::unordered_map<uint32_t, TimeshiftClient> m_timeshiftClients;
 	};
 }
@@ -25,6 +25,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 #include <sstream>
 #include <boost/uuid/uuid_io.hpp>
+#include <live555/Base64.hh>
 
 #include <rtsp-logger/RtspServerLogging.h>
 
@@ -32,9 +33,11 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "VideoChannelDescriptor.h"
 #include "LiveAACSubsession.h"
 #include "LiveAMRSubsession.h"
+#include "LiveG711Subsession.h"
 #include "LiveH264Subsession.h"
 #include "LiveMediaSubsession.h"
 #include "CommonRtsp.h"
+#include "H264BitstreamFilters.h"
 #include "LiveMPEGSubsession.h"
 #include "LiveH265Subsession.h"
 
@@ -80,6 +83,7 @@ namespace CvRtsp
 					channelId, subsessionId, sessionName,
 					videoDescriptor.Sps, videoDescriptor.Pps,
 					rateAdaptationFactory, rateController);
+				addH264BitstreamFilters(*pMediaSubsession, videoDescriptor);
 			}
 			else if (videoDescriptor.Codec == MediaSubType::MPEG4)
 			{
@@ -140,13 +144,14 @@ namespace CvRtsp
 				std::stringstream message;
 				message << "Adding AMR subsession: channels: " << audioDescriptor.Channels
 					<< " bits per sample: " << audioDescriptor.BitsPerSample
-					<< " sampling frequency: " << audioDescriptor.SamplingFrequency;
+					<< " sampling frequency: " << audioDescriptor.SamplingFrequency
+					<< " packet time: " << audioDescriptor.PacketTimeMs << "ms";
 				log_rtsp_debug(message.str());
 
 				pMediaSubsession = new LiveAMRSubsession(env, rtspServer,
 					channelId, subsessionId, sessionName,
 					audioDescriptor.Channels, audioDescriptor.BitsPerSample, audioDescriptor.SamplingFrequency,
-					rateAdaptationFactory, rateController);
+					rateAdaptationFactory, rateController, audioDescriptor.PacketTimeMs);
 			}
 			else if (audioDescriptor.Codec == MediaSubType::AAC)
 			{
@@ -154,13 +159,31 @@ namespace CvRtsp
 				message << "Adding AAC subsession: channels: " << audioDescriptor.Channels
 					<< " bits per sample: " << audioDescriptor.BitsPerSample
 					<< " sampling frequency: " << audioDescriptor.SamplingFrequency
-					<< " AAC config string: " << audioDescriptor.ConfigString;
+					<< " AAC config string: " << audioDescriptor.ConfigString
+					<< " packet time: " << audioDescriptor.PacketTimeMs << "ms";
 				log_rtsp_debug(message.str());
 
 				pMediaSubsession = new LiveAACSubsession(env, rtspServer,
 					channelId, subsessionId, sessionName,
 					audioDescriptor.Channels, audioDescriptor.BitsPerSample, audioDescriptor.SamplingFrequency,
-					audioDescriptor.ConfigString, rateAdaptationFactory, rateController);
+					audioDescriptor.ConfigString, rateAdaptationFactory, rateController, audioDescriptor.PacketTimeMs);
+			}
+			else if ((audioDescriptor.Codec == MediaSubType::PCMU || audioDescriptor.Codec == MediaSubType::PCMA)
+				&& audioDescriptor.BitsPerSample == 16)
+			{
+				std::stringstream message;
+				message << "Adding G.711 subsession: " << audioDescriptor.Codec
+					<< " channels: " << audioDescriptor.Channels
+					<< " sampling frequency: " << audioDescriptor.SamplingFrequency
+					<< " packet time: " << audioDescriptor.PacketTimeMs << "ms";
+				log_rtsp_debug(message.str());
+
+				// Samples are delivered as 16 bit linear PCM and converted by the subsession.
+				pMediaSubsession = new LiveG711Subsession(env, rtspServer,
+					channelId, subsessionId, sessionName,
+					audioDescriptor.Channels, audioDescriptor.SamplingFrequency,
+					audioDescriptor.Codec == MediaSubType::PCMA,
+					rateAdaptationFactory, rateController, audioDescriptor.PacketTimeMs);
 			}
 			else
 			{
@@ -171,5 +194,57 @@ namespace CvRtsp
 			}
 			return pMediaSubsession;
 		}
+
+	private:
+		/// This method adds the H.264 bitstream filters configured in the video descriptor.
+		///
+		/// @param[in] mediaSubsession The H.264 subsession.
+		/// @param[in] videoDescriptor Video descriptor.
+		static void addH264BitstreamFilters(LiveMediaSubsession& mediaSubsession,
+			const VideoChannelDescriptor& videoDescriptor)
+		{
+			if (videoDescriptor.StripAccessUnitDelimiters || videoDescriptor.StripFillerData)
+			{
+				mediaSubsession.AddBitstreamFilter(std::unique_ptr<IBitstreamFilter>(new H264NalUnitStripFilter(
+					videoDescriptor.StripAccessUnitDelimiters, videoDescriptor.StripFillerData)));
+			}
+			if (videoDescriptor.StripSei)
+			{
+				mediaSubsession.AddBitstreamFilter(std::unique_ptr<IBitstreamFilter>(
+					new H264SeiFilter(videoDescriptor.SeiPayloadTypesToKeep)));
+			}
+			if (videoDescriptor.InsertParameterSets)
+			{
+				mediaSubsession.AddBitstreamFilter(std::unique_ptr<IBitstreamFilter>(new H264ParameterSetInsertFilter(
+					decodeParameterSet(videoDescriptor.Sps), decodeParameterSet(videoDescriptor.Pps))));
+			}
+			if (!videoDescriptor.NalRefIdcRewrites.empty())
+			{
+				// Rewritten last, inserted parameter sets included.
+				std::unique_ptr<H264NalRefIdcRewriteFilter> filter(new H264NalRefIdcRewriteFilter());
+				for (const auto& nalRefIdc : videoDescriptor.NalRefIdcRewrites)
+				{
+					filter->SetNalRefIdc(nalRefIdc.first, nalRefIdc.second);
+				}
+				mediaSubsession.AddBitstreamFilter(std::move(filter));
+			}
+		}
+
+		/// This method decodes a base64 parameter set as found in sprop-parameter-sets.
+		///
+		/// @param[in] parameterSet Base64 encoded parameter set, may be empty.
+		///
+		/// @return The nal unit, empty if there is none.
+		static std::vector<BYTE> decodeParameterSet(const std::string& parameterSet)
+		{
+			if (parameterSet.empty())
+			{
+				return std::vector<BYTE>();
+			}
+
+			unsigned size = 0;
+			const std::unique_ptr<unsigned char[]> nalUnit(base64Decode(parameterSet.c_str(), size));
+			return nalUnit ? std::vector<BYTE>(nalUnit.get(), nalUnit.get() + size) : std::vector<BYTE>();
+		}
 	};
 }
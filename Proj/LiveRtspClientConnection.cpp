@@ -1,6 +1,7 @@
 ﻿#include "pch.h"
 
 #include "LiveRtspClientSession.h"
+#include "LiveSourceTaskScheduler.h"
 #include <iostream>
 #include <boost/algorithm/string/constants.hpp>
 #include <boost/tokenizer.hpp>
@@ -41,3 +42,18 @@ handleCmd_DESCRIBE(char const* urlPreSuffix, char const* urlSuffix, char const*
 	assert(false);
 	// Should be overriden in child class.
 }
+
+void
+LiveRtspClientConnection::
+handleRequestBytes(int newBytesRead)
+{
+	// A response written behind half an RTP packet would break the framing of the connection: close
+	// it instead, as if the client had gone.
+	const auto pollingScheduler = dynamic_cast<LiveSourceTaskScheduler*>(&envir().taskScheduler());
+	if (pollingScheduler && !pollingScheduler->GetInterleavedTcpWriter().CompletePartialFrame(fClientOutputSocket))
+	{
+		newBytesRead = -1;
+	}
+
+	RTSPServer::RTSPClientConnection::handleRequestBytes(newBytesRead);
+}
@@ -51,5 +51,13 @@ namespace CvRtsp
 		/// @param[in]	urlSuffix		Suffix after the url.
 		/// @param[in]	fullRequestStr	Full url request.
 		void handleCmd_DESCRIBE(char const* urlPreSuffix, char const* urlSuffix, char const* fullRequestStr) override;
+
+		///
+		/// Overriding this so that the response is not written into an RTP packet that the
+		/// scheduler's interleaved writer has partially written to the connection. The connection
+		/// is closed if the packet cannot be completed without blocking.
+		///
+		/// @param[in] newBytesRead Bytes read into the request buffer.
+		void handleRequestBytes(int newBytesRead) override;
 	};
 }
\ No newline at end of file
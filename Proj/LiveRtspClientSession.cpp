@@ -1,14 +1,133 @@
 ﻿#include "pch.h"
 
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#if !defined(_WIN32)
+#include <strings.h>
+#endif
 
 #include <rtsp-logger/RtspServerLogging.h>
 
 #include "LiveRtspClientSession.h"
 #include "LiveRtspClientConnection.h"
+#include "LiveMediaSubsession.h"
 
 using namespace CvRtsp;
 
+/// Compare the first count characters of two strings, ignoring case.
+static int compareIgnoringCase(char const* left, char const* right, size_t count)
+{
+#if defined(_WIN32)
+	return _strnicmp(left, right, count);
+#else
+	return strncasecmp(left, right, count);
+#endif
+}
+
+/// Convert a broken down UTC time to seconds since the epoch, -1 if it cannot be represented.
+static std::time_t toUtcTime(std::tm& time)
+{
+#if defined(_WIN32)
+	return _mkgmtime(&time);
+#else
+	return timegm(&time);
+#endif
+}
+
+///
+/// Parse a PLAY "Range:" header that asks for a live stream to start in the past: "npt=-<seconds>-"
+/// counts back from now, "clock=<YYYYMMDDThhmmss[.fraction]Z>-" is an absolute UTC time. live555 reads
+/// "npt=-30-" as an end time and clamps the start of a live stream to 0, so it is parsed here.
+///
+/// @param[in] fullRequestStr	Full request.
+/// @param[out] startTime		Point in time to start at.
+///
+/// @return False if there is no such header, or it does not point to the past.
+static bool parseTimeshiftRange(char const* fullRequestStr, TimeshiftBuffer::Clock::time_point& startTime)
+{
+	char const* range = nullptr;
+	for (auto line = fullRequestStr; line != nullptr && range == nullptr; line = std::strchr(line, '\n'))
+	{
+		line += *line == '\n' ? 1 : 0;
+		if (compareIgnoringCase(line, "Range:", 6) == 0)
+		{
+			range = line + 6;
+		}
+	}
+	if (range == nullptr)
+	{
+		return false;
+	}
+
+	while (*range == ' ' || *range == '\t')
+	{
+		++range;
+	}
+
+	if (compareIgnoringCase(range, "npt=", 4) == 0)
+	{
+		auto seconds = 0.0;
+		auto length = 0;
+		if (std::sscanf(range + 4, " -%lf%n", &seconds, &length) != 1 || seconds <= 0.0)
+		{
+			return false;
+		}
+
+		// Without the trailing '-' the value is an end time.
+		range += 4 + length;
+		while (*range == ' ')
+		{
+			++range;
+		}
+		if (*range != '-')
+		{
+			return false;
+		}
+
+		startTime = TimeshiftBuffer::Clock::now()
+			- std::chrono::duration_cast<TimeshiftBuffer::Clock::duration>(std::chrono::duration<double>(seconds));
+		return true;
+	}
+
+	if (compareIgnoringCase(range, "clock=", 6) == 0)
+	{
+		std::tm time{};
+		auto seconds = 0.0;
+		if (std::sscanf(range + 6, "%4d%2d%2dT%2d%2d%lf", &time.tm_year, &time.tm_mon, &time.tm_mday,
+			&time.tm_hour, &time.tm_min, &seconds) != 6)
+		{
+			return false;
+		}
+		time.tm_year -= 1900;
+		time.tm_mon -= 1;
+		time.tm_sec = static_cast<int>(seconds);
+		const auto utcTime = toUtcTime(time);
+		const auto now = std::chrono::system_clock::now();
+		if (utcTime == -1 || utcTime > std::chrono::system_clock::to_time_t(now))
+		{
+			return false;
+		}
+
+		// The samples are timestamped with the steady clock, go back from now by the same amount.
+		const auto requestedTime = std::chrono::system_clock::from_time_t(utcTime)
+			+ std::chrono::duration_cast<std::chrono::system_clock::duration>(
+				std::chrono::duration<double>(seconds - time.tm_sec));
+		const auto age = now - requestedTime;
+		if (age <= std::chrono::system_clock::duration::zero())
+		{
+			return false;
+		}
+
+		startTime = TimeshiftBuffer::Clock::now() - std::chrono::duration_cast<TimeshiftBuffer::Clock::duration>(age);
+		return true;
+	}
+
+	return false;
+}
+
 LiveRtspClientSession::
 LiveRtspClientSession(LiveRtspServer& rtspParentServer, uint32_t sessionId) :
 	RTSPClientSession(rtspParentServer, sessionId),
@@ -93,5 +212,22 @@ handleCmd_PLAY(RTSPServer::RTSPClientConnection* ourClientConnection, ServerMedi
 	char const* fullRequestStr)
 {
 	m_rtspParentServer->onRtspClientSessionPlay(m_sessionId);
+
+	// Subsessions with a timeshift buffer start the stream in the past, they must be told before
+	// live555 starts the streams.
+	TimeshiftBuffer::Clock::time_point startTime;
+	if (fOurServerMediaSession != nullptr && parseTimeshiftRange(fullRequestStr, startTime))
+	{
+		ServerMediaSubsessionIterator iter(*fOurServerMediaSession);
+		for (auto mediaSubsession = iter.next(); mediaSubsession != nullptr; mediaSubsession = iter.next())
+		{
+			const auto liveMediaSubsession = dynamic_cast<LiveMediaSubsession*>(mediaSubsession);
+			if (liveMediaSubsession && (subsession == nullptr || subsession == mediaSubsession))
+			{
+				liveMediaSubsession->SeekTimeshift(m_sessionId, startTime);
+			}
+		}
+	}
+
 	RTSPClientSession::handleCmd_PLAY(ourClientConnection, subsession, fullRequestStr);
 }
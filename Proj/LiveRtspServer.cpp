@@ -33,6 +33,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "LiveRtspServer.h"
 #include "LiveMediaSubsession.h"
 #include "LiveMediaSubsessionFactory.h"
+#include "LiveSourceTaskScheduler.h"
 
 using namespace CvRtsp;
 
@@ -79,6 +80,9 @@ static void announceStream(RTSPServer* rtspServer, ServerMediaSession* sms,
 static char const* allowedCommandNames
 = "OPTIONS, DESCRIBE, SETUP, TEARDOWN, PLAY, PAUSE, GET_PARAMETER, SET_PARAMETER";
 
+const size_t LiveRtspServer::DefaultTimeshiftMemoryBytes;
+const int64_t LiveRtspServer::DefaultOnDemandIdleTimeoutMicroSec;
+
 //LiveRtspServer*
 //LiveRtspServer::
 //CreateNew(UsageEnvironment& env, Port rtspPort,
@@ -114,7 +118,9 @@ LiveRtspServer::LiveRtspServer(UsageEnvironment& env, int ourSocketIPv4, int our
 	m_checkClientSessionTask(nullptr),
 	m_maxConnectedClients(0),
 	m_rateFactory(rateFactory),
-	m_rateController(rateController)
+	m_rateController(rateController),
+	m_timeshiftMemoryBudget(std::make_shared<TimeshiftMemoryBudget>(DefaultTimeshiftMemoryBytes)),
+	m_onDemandIdleTimeoutMicroSec(DefaultOnDemandIdleTimeoutMicroSec)
 {
 	checkClientSessions();
 }
@@ -149,19 +155,31 @@ AddRtspMediaSession(const RtspChannel& channel)
 	// Next, check whether we already have an RTSP "ServerMediaSession" for this media stream:
 	auto serverMediaSession = getServerMediaSession(sSessionName.c_str());
 
-	const auto smsExists = serverMediaSession != nullptr;
+	const auto smsExists = serverMediaSession != nullptr || m_channelCatalog.count(sSessionName) != 0;
 
-	if (!smsExists)
+	if (!smsExists && channel.IsOnDemand)
 	{
-		log_rtsp_debug("Creating Session " + sSessionName + " on RTSP server.");
-		
-		// Create a new "ServerMediaSession" object for streaming from the named file.
-		serverMediaSession = createNewSMS(envir(), *this, channel, m_rateFactory, m_rateController);
-
-		log_rtsp_debug("Adding ServerMediaSession " + sSessionName + ".");
+		// The session is created once a client asks for it, see lookupServerMediaSession().
+		m_channelCatalog.emplace(sSessionName, channel);
 
-		addServerMediaSession(serverMediaSession);
-		announceStream(this, serverMediaSession, sSessionName.c_str());
+		// Until then no subsession reports the watchers of the channel, report none so that the
+		// producers do not fill its queues (source ids as hard-coded in createNewSMS()).
+		const auto pollingScheduler = dynamic_cast<LiveSourceTaskScheduler*>(&envir().taskScheduler());
+		if (pollingScheduler)
+		{
+			for (const uint32_t sourceId : { 0u, 1u })
+			{
+				pollingScheduler->SetWatcherCount(channel.ChannelId, sSessionName, sourceId, 0);
+			}
+		}
+	}
+	else if (!smsExists)
+	{
+		serverMediaSession = addSession(channel);
+		if (serverMediaSession)
+		{
+			announceStream(this, serverMediaSession, sSessionName.c_str());
+		}
 	}
 	else
 	{
@@ -173,6 +191,15 @@ void
 LiveRtspServer::
 RemoveRtspMediaSession(const RtspChannel& channel)
 {
+	// An on-demand channel may not have a session at the moment.
+	const auto isOnDemand = m_channelCatalog.erase(channel.ChannelName) != 0;
+	const auto hasSession = m_onDemandSessions.erase(channel.ChannelName) != 0;
+	if (isOnDemand && !hasSession)
+	{
+		log_rtsp_debug("Removed on-demand RtspChannel Id: " + to_string(channel.ChannelId) + " Name: " + channel.ChannelName + ".");
+		return;
+	}
+
 	/// code to kick clients before removing session so that there are no outstanding references
 	endServerSession(channel.ChannelName);
 
@@ -196,7 +223,7 @@ LiveRtspServer::
 DoesChannelExist(char const* streamName)
 {
 	const auto serverMediaSession = getServerMediaSession(streamName);
-	return serverMediaSession == nullptr ? false : true;
+	return serverMediaSession != nullptr || m_channelCatalog.count(streamName) != 0;
 }
 
 ServerMediaSession*
@@ -204,7 +231,84 @@ LiveRtspServer::
 lookupServerMediaSession(char const* streamName)
 {
 	log_rtsp_debug("Looking up new ServerMediaSession: " + std::string(streamName) + ".");
-	return getServerMediaSession(streamName);
+	auto serverMediaSession = getServerMediaSession(streamName);
+
+	const auto onDemandSession = m_onDemandSessions.find(streamName);
+	if (onDemandSession != m_onDemandSessions.end())
+	{
+		// Described or set up again, the idle timeout starts over.
+		onDemandSession->second = std::chrono::steady_clock::now();
+	}
+	else if (!serverMediaSession)
+	{
+		const auto channel = m_channelCatalog.find(streamName);
+		if (channel != m_channelCatalog.end())
+		{
+			serverMediaSession = addSession(channel->second);
+			if (serverMediaSession)
+			{
+				m_onDemandSessions.emplace(streamName, std::chrono::steady_clock::now());
+			}
+		}
+	}
+	return serverMediaSession;
+}
+
+ServerMediaSession*
+LiveRtspServer::
+addSession(const RtspChannel& channel)
+{
+	log_rtsp_debug("Creating Session " + channel.ChannelName + " on RTSP server.");
+
+	// Create a new "ServerMediaSession" object for streaming from the named file.
+	const auto serverMediaSession = createNewSMS(envir(), *this, channel, m_rateFactory, m_rateController);
+	if (!serverMediaSession)
+	{
+		log_rtsp_error("Unable to create session " + channel.ChannelName + ".");
+		return nullptr;
+	}
+
+	log_rtsp_debug("Adding ServerMediaSession " + channel.ChannelName + ".");
+	addServerMediaSession(serverMediaSession);
+	return serverMediaSession;
+}
+
+void
+LiveRtspServer::
+removeIdleSessions()
+{
+	const auto now = std::chrono::steady_clock::now();
+	for (auto onDemandSession = m_onDemandSessions.begin(); onDemandSession != m_onDemandSessions.end();)
+	{
+		const auto serverMediaSession = getServerMediaSession(onDemandSession->first.c_str());
+		if (!serverMediaSession)
+		{
+			onDemandSession = m_onDemandSessions.erase(onDemandSession);
+			continue;
+		}
+
+		// Client sessions reference the session from SETUP on, subsessions hold a device source per stream.
+		auto isInUse = serverMediaSession->referenceCount() != 0;
+		ServerMediaSubsessionIterator iter(*serverMediaSession);
+		for (auto subsession = iter.next(); subsession != nullptr && !isInUse; subsession = iter.next())
+		{
+			isInUse = static_cast<LiveMediaSubsession*>(subsession)->IsAnyActiveDeviceSourcePresent();
+		}
+
+		if (isInUse)
+		{
+			onDemandSession->second = now;
+		}
+		else if (now - onDemandSession->second >= std::chrono::microseconds(m_onDemandIdleTimeoutMicroSec))
+		{
+			// The channel stays in the catalog, the next client creates the session again.
+			log_rtsp_debug("Removing idle session " + onDemandSession->first + " from RTSP server.");
+			removeServerMediaSession(serverMediaSession);
+			onDemandSession = m_onDemandSessions.erase(onDemandSession);
+			continue;
+		}
+		++onDemandSession;
+	}
 }
 
 #define NEW_SMS(description) do {\
@@ -245,6 +349,17 @@ static ServerMediaSession* createNewSMS(UsageEnvironment& env, LiveRtspServer& r
 
 		log_rtsp_debug("Added " + channel.ChannelName + " to video ServerMediaSession.");
 
+		if (channel.TimeshiftSeconds > 0)
+		{
+			liveMediaSubsession->EnableTimeshift(std::chrono::seconds(channel.TimeshiftSeconds),
+				channel.TimeshiftMaxBytes, rtspServer.GetTimeshiftMemoryBudget());
+		}
+		if (!channel.SegmentStoreDirectory.empty() && channel.SegmentStoreMaxBytes > 0)
+		{
+			liveMediaSubsession->EnableSegmentStore(channel.SegmentStoreDirectory, channel.SegmentStoreMaxBytes,
+				std::chrono::seconds(channel.SegmentStoreSeconds));
+		}
+
 		sms->addSubsession(liveMediaSubsession);
 		liveMediaSubsession->SetClientJoinHandler(std::bind(&LiveRtspServer::OnClientJoin, &rtspServer,
 			std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4));
@@ -307,6 +422,8 @@ doCheckClientSessions()
 {
 	// Process all receiver reports
 
+	removeIdleSessions();
+
 	// schedule next task
 	checkClientSessions();
 }
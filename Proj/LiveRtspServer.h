@@ -23,7 +23,9 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 ///
 #pragma once
 
+#include <chrono>
 #include <map>
+#include <memory>
 #include <vector>
 
 #ifndef _RTSP_SERVER_HH
@@ -39,6 +41,7 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #include "VideoChannelDescriptor.h"
 #include "LiveRtspClientConnection.h"
 #include "LiveRtspClientSession.h"
+#include "TimeshiftBuffer.h"
 
 namespace CvRtsp
 {
@@ -110,6 +113,31 @@ namespace CvRtsp
 
 		/// Camera used for this channel.
 		unsigned int CameraId;
+
+		/// Feed the channel from the shared source of its camera (CameraSourceRegistry) rather than
+		/// directly, so that several channels of one camera take its samples from a single ingest.
+		bool IsCameraSourceShared = false;
+
+		/// Seconds of media kept for clients that start playing in the past, 0 to disable timeshift.
+		uint32_t TimeshiftSeconds = 0;
+
+		/// Maximum number of bytes kept per subsession for timeshift.
+		size_t TimeshiftMaxBytes = 64 * 1024 * 1024;
+
+		/// Directory of the segment files that keep the media history beyond the timeshift buffer,
+		/// empty to disable.
+		std::string SegmentStoreDirectory;
+
+		/// Maximum size of the segment files per subsession.
+		uint64_t SegmentStoreMaxBytes = 1024ull * 1024 * 1024;
+
+		/// Seconds of media kept in the segment files.
+		uint32_t SegmentStoreSeconds = 3600;
+
+		/// Create the session when a client first asks for it, and remove it again once it has
+		/// been idle for the server's on-demand idle timeout, instead of keeping it from the time
+		/// the channel is added.
+		bool IsOnDemand = false;
 	};
 
 	/// Our RTSP server class is derived from the liveMedia RTSP server. It extends the live555 RTSP server
@@ -122,6 +150,12 @@ namespace CvRtsp
 		friend class LiveRtspClientSession;
 
 	public:
+		/// Memory the timeshift buffers of a server's channels may hold, unless a budget is set.
+		static const size_t DefaultTimeshiftMemoryBytes = 512 * 1024 * 1024;
+
+		/// Time an on-demand session is kept without clients, unless a timeout is set.
+		static const int64_t DefaultOnDemandIdleTimeoutMicroSec = 30000000;
+
 		///
 		/// Constructor: called only by createNew();
 		LiveRtspServer(UsageEnvironment& env, int ourSocketIPv4, int ourSocketIPv6, Port rtspPort,
@@ -174,8 +208,40 @@ namespace CvRtsp
 			return static_cast<uint32_t>(m_rtspClientSessions.size());
 		}
 
+		///
+		/// Get the memory limit of the timeshift buffers of the channels added from now on.
+		///
+		/// @return Timeshift memory budget.
+		std::shared_ptr<TimeshiftMemoryBudget> GetTimeshiftMemoryBudget() const
+		{
+			return m_timeshiftMemoryBudget;
+		}
+
+		///
+		/// Set the memory limit of the timeshift buffers of the channels added from now on, it may
+		/// be shared with other servers.
+		///
+		/// @param[in] timeshiftMemoryBudget Timeshift memory budget.
+		void SetTimeshiftMemoryBudget(std::shared_ptr<TimeshiftMemoryBudget> timeshiftMemoryBudget)
+		{
+			m_timeshiftMemoryBudget = std::move(timeshiftMemoryBudget);
+		}
+
+		///
+		/// Set how long the session of an on-demand channel (RtspChannel::IsOnDemand) is kept
+		/// after its last client left, or after it was described without being set up.
+		///
+		/// @param[in] idleTimeoutMicroSec Idle timeout in microseconds, checked once a second.
+		void SetOnDemandIdleTimeout(int64_t idleTimeoutMicroSec)
+		{
+			m_onDemandIdleTimeoutMicroSec = idleTimeoutMicroSec;
+		}
+
 		///
 		/// Adds the Rtsp session described by channel to the Rtsp server if it does not already exist.
+		/// The session of an on-demand channel is only created when a client asks for it, until
+		/// then the channel is reported to the channel manager as unwatched: it must have been
+		/// added to the channel manager before.
 		///
 		/// @param[in] channel RtspChannel to add to the Rtsp media session.
 		void AddRtspMediaSession(const RtspChannel& channel);
@@ -308,9 +374,34 @@ namespace CvRtsp
 		/// Callback handler to destroy the specific channel/session in our camera-server instance.
 		OnDestroyChannelHandler m_onDestroyChannel;
 
-		/// Redefined virtual functions: this method returns the session identified by streamName provided its valid
+		/// Memory limit of the timeshift buffers.
+		std::shared_ptr<TimeshiftMemoryBudget> m_timeshiftMemoryBudget;
+
+		/// On-demand channels by name, their sessions are created by lookupServerMediaSession().
+		std::map<std::string, RtspChannel> m_channelCatalog;
+
+		/// Sessions created on demand by name, with the last time they were in use.
+		std::map<std::string, std::chrono::steady_clock::time_point> m_onDemandSessions;
+
+		/// Time an on-demand session is kept without clients.
+		int64_t m_onDemandIdleTimeoutMicroSec;
+
+		/// Redefined virtual functions: this method returns the session identified by streamName provided its valid,
+		/// creating the session of an on-demand channel on first use.
 		virtual ServerMediaSession* lookupServerMediaSession(char const* streamName);
 
+		///
+		/// Create the session of a channel and add it to the server.
+		///
+		/// @param[in] channel Channel description.
+		///
+		/// @return Session, nullptr if it could not be created.
+		ServerMediaSession* addSession(const RtspChannel& channel);
+
+		///
+		/// Remove the on-demand sessions that have been idle for longer than the idle timeout.
+		void removeIdleSessions();
+
 		///
 		/// Kicks clients from the server
 		/// this method SHOULD only be called from within the live555 eventloop!
@@ -29,14 +29,14 @@ using namespace CvRtsp;
 
 LiveSourceTaskScheduler*
 LiveSourceTaskScheduler::
-createNew(ChannelManager& channelManager)
+createNew(ChannelManager& channelManager, SocketHandling socketHandling)
 {
-	return new LiveSourceTaskScheduler(channelManager);
+	return new LiveSourceTaskScheduler(channelManager, socketHandling);
 }
 
 LiveSourceTaskScheduler::
-LiveSourceTaskScheduler(ChannelManager& channelManager)
-	:LiveSourceTaskScheduler0(channelManager)
+LiveSourceTaskScheduler(ChannelManager& channelManager, SocketHandling socketHandling)
+	:LiveSourceTaskScheduler0(channelManager, socketHandling)
 {
 
 }
@@ -51,5 +51,5 @@ void
 LiveSourceTaskScheduler::
 SingleStep(unsigned maxDelayTimeMicroSec)
 {
-	BasicTaskScheduler::SingleStep(maxDelayTimeMicroSec);
+	LiveSourceTaskScheduler0::SingleStep(maxDelayTimeMicroSec);
 }
@@ -34,7 +34,9 @@ namespace CvRtsp
 		/// Named constructor.
 		///
 		/// @param channelManager Channel manager.
-		static LiveSourceTaskScheduler* createNew(ChannelManager& channelManager);
+		/// @param socketHandling How to wait for socket events, select() by default.
+		static LiveSourceTaskScheduler* createNew(ChannelManager& channelManager,
+			SocketHandling socketHandling = SocketHandling::Select);
 
 		///
 		/// Destructor.
@@ -45,9 +47,10 @@ namespace CvRtsp
 		/// Protected constructor.
 		///
 		/// @param[in] channelManager Channel manager.
+		/// @param[in] socketHandling How to wait for socket events.
 		///
 		///	@remark Called only by "createNew()"
-		LiveSourceTaskScheduler(ChannelManager& channelManager);
+		LiveSourceTaskScheduler(ChannelManager& channelManager, SocketHandling socketHandling);
 
 		///
 		/// Redefined virtual function from BasicTaskScheduler.hh.
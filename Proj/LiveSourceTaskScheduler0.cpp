@@ -23,6 +23,9 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 ///
 #include "pch.h"
 
+#include <atomic>
+#include <chrono>
+#include <climits>
 #include <tbb/parallel_for_each.h>
 #include <boost/uuid/uuid_io.hpp>
 
@@ -34,15 +37,76 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 
 using namespace CvRtsp;
 
+/// Monotonic time base of the timer wheel.
+static int64_t
+nowMicroSec()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// Longest wait while RTP-over-TCP clients have packets queued that their sockets did not take.
+static const unsigned InterleavedRetryMicroSec = 1000;
+
 LiveSourceTaskScheduler0::
-LiveSourceTaskScheduler0(ChannelManager& channelManager)
-	: BasicTaskScheduler(m_maxDelayTimeMicroSec),
+LiveSourceTaskScheduler0(ChannelManager& channelManager, SocketHandling socketHandling)
+	: BasicTaskScheduler(0), // no periodic scheduler tick, the loop is woken up by media and socket events
 	m_channelManager(channelManager),
 	m_samplesReceived(0),
 	m_hasRun(false),
-	m_count(0)
+	m_mediaArrivalSignal(&channelManager.GetMediaArrivalSignal()),
+	m_pendingTriggers(0),
+	m_readyList(channelManager.GetMediaReadyList()),
+	m_timerWheel(nowMicroSec())
+{
+	for (auto index = 0; index < MAX_NUM_EVENT_TRIGGERS; ++index)
+	{
+		m_triggerHandlers[index] = nullptr;
+		m_triggerClientData[index].store(nullptr, std::memory_order_relaxed);
+	}
+
+	// Must be set up before the first socket handler.
+	if (socketHandling == SocketHandling::Poll)
+	{
+		m_socketPoller.reset(new SocketEventPoller());
+		if (!m_socketPoller->IsValid())
+		{
+			log_rtsp_warning("LiveSourceTaskScheduler0: socket poller unavailable, using select()");
+			m_socketPoller.reset();
+		}
+	}
+
+	if (m_mediaArrivalSignal->IsValid())
+	{
+		setBackgroundHandling(m_mediaArrivalSignal->GetSocket(), SOCKET_READABLE, &onMediaArrival, this);
+		m_channelManager.SetMediaArrivalSignal(m_mediaArrivalSignal);
+	}
+	else
+	{
+		// Without a wakeup the media queues have to be polled.
+		log_rtsp_warning("LiveSourceTaskScheduler0: media arrival signal unavailable, polling media channels");
+		m_maxDelayTimeMicroSec = 5;
+	}
+}
+
+LiveSourceTaskScheduler0::
+~LiveSourceTaskScheduler0()
 {
+	// Producers may still signal the channel manager's signal or notify its ready list after this,
+	// both outlive the scheduler and a restarted scheduler picks up what is left on the ready list.
+	if (m_mediaArrivalSignal->IsValid())
+	{
+		m_channelManager.SetMediaArrivalSignal(nullptr);
+		disableBackgroundHandling(m_mediaArrivalSignal->GetSocket());
+	}
 
+	for (auto& scheduledSubsession : m_scheduledSubsessions)
+	{
+		if (scheduledSubsession.second.Readiness)
+		{
+			scheduledSubsession.second.Readiness->Unbind();
+		}
+	}
 }
 
 void
@@ -77,16 +141,221 @@ doEventLoop(EventLoopWatchVariable* watchVariable)
 				}
 			}
 		}
-		log_rtsp_debug("Calling processLiveSources.");
-		processLiveSources();
-		processMediaSubsessions();
+		const auto hasPendingMedia = processLiveSources();
+
+		// Block until media is signalled, a socket becomes readable or a delayed task is due.
+		// If media arrived while spinning the media arrival socket is readable already and
+		// SingleStep() returns right away. Samples left over from this iteration have already
+		// been signalled, so only socket events that are ready are handled before continuing.
+		SingleStep(hasPendingMedia || spinForMediaArrival() ? 1 : m_maxDelayTimeMicroSec);
+	}
+}
+
+void
+LiveSourceTaskScheduler0::
+SingleStep(unsigned maxDelayTimeMicroSec)
+{
+	// The base class only sees its own, empty, delay queue: wake up in time for the next timer.
+	const auto timeToNextTimer = m_timerWheel.TimeToNextExpiry(nowMicroSec());
+	if (timeToNextTimer >= 0 && timeToNextTimer < UINT_MAX
+		&& (maxDelayTimeMicroSec == 0 || timeToNextTimer < maxDelayTimeMicroSec))
+	{
+		// 0 would mean no limit.
+		maxDelayTimeMicroSec = timeToNextTimer > 0 ? static_cast<unsigned>(timeToNextTimer) : 1;
+	}
+
+	// While timers are due, e.g. sinks sending the remaining packets of a frame, datagrams are
+	// collected, so that the packets to a client leave together once the burst is over.
+	if (timeToNextTimer != 0)
+	{
+		m_udpSendBatcher.Flush();
+		m_interleavedTcpWriter.Flush();
+	}
+
+	// Client sockets that were full are not watched, retry writing soon.
+	if (m_interleavedTcpWriter.HasPending()
+		&& (maxDelayTimeMicroSec == 0 || maxDelayTimeMicroSec > InterleavedRetryMicroSec))
+	{
+		maxDelayTimeMicroSec = InterleavedRetryMicroSec;
+	}
+
+	if (m_socketPoller)
+	{
+		// The base class' select() and event triggers are bypassed.
+		m_socketPoller->Poll(maxDelayTimeMicroSec);
+		handleTriggeredEvents();
+	}
+	else
+	{
+		BasicTaskScheduler::SingleStep(maxDelayTimeMicroSec);
+	}
+	m_timerWheel.Expire(nowMicroSec());
+}
+
+void
+LiveSourceTaskScheduler0::
+setBackgroundHandling(int socketNum, int conditionSet, BackgroundHandlerProc* handlerProc, void* clientData)
+{
+	if (m_socketPoller)
+	{
+		m_socketPoller->SetHandler(socketNum, conditionSet, handlerProc, clientData);
+	}
+	else
+	{
+		BasicTaskScheduler::setBackgroundHandling(socketNum, conditionSet, handlerProc, clientData);
+	}
+}
+
+void
+LiveSourceTaskScheduler0::
+moveSocketHandling(int oldSocketNum, int newSocketNum)
+{
+	if (m_socketPoller)
+	{
+		m_socketPoller->MoveHandler(oldSocketNum, newSocketNum);
+	}
+	else
+	{
+		BasicTaskScheduler::moveSocketHandling(oldSocketNum, newSocketNum);
+	}
+}
+
+EventTriggerId
+LiveSourceTaskScheduler0::
+createEventTrigger(TaskFunc* eventHandlerProc)
+{
+	if (!m_socketPoller)
+	{
+		return BasicTaskScheduler::createEventTrigger(eventHandlerProc);
+	}
+
+	for (auto index = 0; index < MAX_NUM_EVENT_TRIGGERS; ++index)
+	{
+		const auto eventTriggerId = static_cast<EventTriggerId>(1u << index);
+		if ((m_usedTriggers & eventTriggerId) == 0)
+		{
+			m_usedTriggers |= eventTriggerId;
+			m_triggerHandlers[index] = eventHandlerProc;
+			m_triggerClientData[index].store(nullptr, std::memory_order_relaxed);
+			return eventTriggerId;
+		}
+	}
+
+	return 0;
+}
+
+void
+LiveSourceTaskScheduler0::
+deleteEventTrigger(EventTriggerId eventTriggerId)
+{
+	if (!m_socketPoller)
+	{
+		BasicTaskScheduler::deleteEventTrigger(eventTriggerId);
+		return;
+	}
+
+	m_usedTriggers &= ~eventTriggerId;
+	m_pendingTriggers.fetch_and(~eventTriggerId, std::memory_order_acq_rel);
+	for (auto index = 0; index < MAX_NUM_EVENT_TRIGGERS; ++index)
+	{
+		if (eventTriggerId & (1u << index))
+		{
+			m_triggerHandlers[index] = nullptr;
+		}
+	}
+}
+
+void
+LiveSourceTaskScheduler0::
+triggerEvent(EventTriggerId eventTriggerId, void* clientData)
+{
+	if (!m_socketPoller)
+	{
+		BasicTaskScheduler::triggerEvent(eventTriggerId, clientData);
+		return;
+	}
+
+	// As with BasicTaskScheduler0, the client data of a trigger raised again before it is handled is replaced.
+	for (auto index = 0; index < MAX_NUM_EVENT_TRIGGERS; ++index)
+	{
+		if (eventTriggerId & (1u << index))
+		{
+			m_triggerClientData[index].store(clientData, std::memory_order_relaxed);
+		}
+	}
+	m_pendingTriggers.fetch_or(eventTriggerId, std::memory_order_acq_rel);
+	WakeUp();
+}
+
+void
+LiveSourceTaskScheduler0::
+handleTriggeredEvents()
+{
+	if (m_pendingTriggers.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	const auto pendingTriggers = m_pendingTriggers.exchange(0, std::memory_order_acq_rel) & m_usedTriggers;
+	for (auto index = 0; index < MAX_NUM_EVENT_TRIGGERS; ++index)
+	{
+		// A handler may delete triggers that are still pending in this step.
+		if ((pendingTriggers & (1u << index)) && m_triggerHandlers[index] != nullptr)
+		{
+			(*m_triggerHandlers[index])(m_triggerClientData[index].load(std::memory_order_relaxed));
+		}
+	}
+}
+
+TaskToken
+LiveSourceTaskScheduler0::
+scheduleDelayedTask(int64_t microseconds, TaskFunc* proc, void* clientData)
+{
+	return m_timerWheel.Schedule(nowMicroSec(), microseconds, proc, clientData);
+}
 
-		log_rtsp_debug("Done processLiveSources, calling SingleStep.");
+void
+LiveSourceTaskScheduler0::
+unscheduleDelayedTask(TaskToken& prevTask)
+{
+	m_timerWheel.Unschedule(prevTask);
+	prevTask = nullptr;
+}
 
-		SingleStep(m_maxDelayTimeMicroSec);
+void
+LiveSourceTaskScheduler0::
+rescheduleDelayedTask(TaskToken& task, int64_t microseconds, TaskFunc* proc, void* clientData)
+{
+	m_timerWheel.Reschedule(task, nowMicroSec(), microseconds, proc, clientData);
+}
 
-		log_rtsp_debug("Done SingleStep.");
+bool
+LiveSourceTaskScheduler0::
+spinForMediaArrival() const
+{
+	if (m_spinTimeMicroSec == 0 || !m_mediaArrivalSignal->IsValid())
+	{
+		return m_mediaArrivalSignal->IsSignalled();
 	}
+
+	const auto spinEnd = std::chrono::steady_clock::now() + std::chrono::microseconds(m_spinTimeMicroSec);
+	do
+	{
+		if (m_mediaArrivalSignal->IsSignalled())
+		{
+			return true;
+		}
+	} while (std::chrono::steady_clock::now() < spinEnd);
+
+	return false;
+}
+
+void
+LiveSourceTaskScheduler0::
+onMediaArrival(void* clientData, int /*mask*/)
+{
+	// The media queues are processed by the next event loop iteration.
+	static_cast<LiveSourceTaskScheduler0*>(clientData)->m_mediaArrivalSignal->Drain();
 }
 
 
@@ -110,9 +379,27 @@ RegisterMediaSubsession(const boost::uuids::uuid& channelId, const std::string&
 	{
 		// add media subsession
 		m_mediaSubSessionsMap.emplace(std::make_pair(channelId, channelName), mediaSubsession);
+
+		// resolve the media queue once, samples are dequeued through the handle from now on
+		const auto weight = m_channelWeights.find(std::make_pair(channelId, channelName));
+		auto& scheduledSubsession = m_scheduledSubsessions[std::make_pair(channelId, channelName)];
+		scheduledSubsession.Channel = std::make_pair(channelId, channelName);
+		scheduledSubsession.Subsession = mediaSubsession;
+		scheduledSubsession.Scheduler.reset(
+			new DeficitRoundRobinChannel(weight != m_channelWeights.end() ? weight->second : 1));
+		bindMediaQueue(scheduledSubsession);
+		updatePolledSubsessions();
 	}
 }
 
+void
+LiveSourceTaskScheduler0::
+SetWatcherCount(const boost::uuids::uuid& channelId, const std::string& channelName, uint32_t sourceId,
+	uint32_t watcherCount)
+{
+	m_channelManager.SetWatcherCount(channelId, channelName, sourceId, watcherCount);
+}
+
 void
 LiveSourceTaskScheduler0::
 DeRegisterMediaSubsession(const boost::uuids::uuid& channelId, const std::string& channelName,
@@ -133,6 +420,18 @@ DeRegisterMediaSubsession(const boost::uuids::uuid& channelId, const std::string
 	{
 		// remove media subsession
 		m_mediaSubSessionsMap.erase(std::make_pair(channelId, channelName));
+
+		// the readiness may still be on the ready list, unbinding makes the loop skip it
+		const auto scheduledSubsession = m_scheduledSubsessions.find(std::make_pair(channelId, channelName));
+		if (scheduledSubsession != m_scheduledSubsessions.end())
+		{
+			if (scheduledSubsession->second.Readiness)
+			{
+				scheduledSubsession->second.Readiness->Unbind();
+			}
+			m_scheduledSubsessions.erase(scheduledSubsession);
+		}
+		updatePolledSubsessions();
 	}
 }
 
@@ -151,76 +450,167 @@ GetMediaSubsession(const boost::uuids::uuid& channelId,
 
 void
 LiveSourceTaskScheduler0::
-processLiveSources()
+SetChannelWeight(const boost::uuids::uuid& channelId, const std::string& channelName, unsigned weight)
 {
-	log_rtsp_debug("Processing live sources.");
+	const auto channel = std::make_pair(channelId, channelName);
+	m_channelWeights[channel] = weight;
 
-	uint32_t sampleCount = 0;
-	auto exit = false;
+	const auto scheduledSubsession = m_scheduledSubsessions.find(channel);
+	if (scheduledSubsession != m_scheduledSubsessions.end())
+	{
+		scheduledSubsession->second.Scheduler->SetWeight(weight);
+	}
+}
 
-	// TODO - MK may need to rework this 
-	// try and retrieve a sample for each channel
-	// warning: the if condition of the for needs to be re-thought if there are more sessions
-	// i.e. some sessions may never be reached if the for always starts at begin and exits when 
-	// MaxSamplesToBeProcessedInEventLoop is reached. For the purpose of the single
-	// live media session this should suffice
-	tbb::parallel_for_each (m_mediaSubSessionsMap.cbegin(), m_mediaSubSessionsMap.cend(), [&](auto mediaSubSessionPair)
-		{
-			auto sampleCount = 0;
-			while (sampleCount < 30)
-			{
-				auto mediaSample = m_channelManager.GetMedia(mediaSubSessionPair.first.first,
-					mediaSubSessionPair.first.second, mediaSubSessionPair.second->GetSourceId());
+const SchedulingDelayHistogram*
+LiveSourceTaskScheduler0::
+GetSchedulingDelayHistogram(const boost::uuids::uuid& channelId, const std::string& channelName) const
+{
+	const auto scheduledSubsession = m_scheduledSubsessions.find(std::make_pair(channelId, channelName));
+	if (scheduledSubsession != m_scheduledSubsessions.end())
+	{
+		return &scheduledSubsession->second.Scheduler->GetSchedulingDelayHistogram();
+	}
+	return nullptr;
+}
 
-				if (mediaSample == nullptr)
-				{
-					break;
-				}
+void
+LiveSourceTaskScheduler0::
+bindMediaQueue(ScheduledMediaSubsession& scheduledSubsession)
+{
+	if (scheduledSubsession.Readiness)
+	{
+		scheduledSubsession.Readiness->Unbind();
+		scheduledSubsession.Readiness.reset();
+	}
 
-				// make sure channel-id, channel-name and source-id are set
-				mediaSample->SetChannelId(mediaSubSessionPair.first.first);
-				mediaSample->SetChannelName(mediaSubSessionPair.first.second);
-				mediaSample->SetSourceId(mediaSubSessionPair.second->GetSourceId());
+	scheduledSubsession.MediaQueue = m_channelManager.ResolveMediaQueue(scheduledSubsession.Channel.first,
+		scheduledSubsession.Channel.second, scheduledSubsession.Subsession->GetSourceId());
+	if (scheduledSubsession.MediaQueue.IsValid())
+	{
+		scheduledSubsession.Readiness = scheduledSubsession.MediaQueue.GetReadiness();
+		scheduledSubsession.Readiness->Bind(&m_readyList, &scheduledSubsession);
 
-				mediaSubSessionPair.second->AddMediaSample(mediaSample);
+		// Samples may have been queued before the readiness was bound.
+		scheduledSubsession.Readiness->Notify();
+	}
+}
 
-				++sampleCount;
-			}
-		});
+void
+LiveSourceTaskScheduler0::
+updatePolledSubsessions()
+{
+	m_polledSubsessions.clear();
+	for (auto& scheduledSubsession : m_scheduledSubsessions)
+	{
+		if (!scheduledSubsession.second.Readiness)
+		{
+			m_polledSubsessions.push_back(&scheduledSubsession.second);
+		}
+	}
+}
+
+void
+LiveSourceTaskScheduler0::
+resolveMediaQueues()
+{
+	// Read the generation first, a change while resolving is picked up by the next pass.
+	const auto mediaQueueGeneration = m_channelManager.GetMediaQueueGeneration();
+	if (mediaQueueGeneration == m_mediaQueueGeneration)
+	{
+		return;
+	}
+	m_mediaQueueGeneration = mediaQueueGeneration;
+
+	for (auto& scheduledSubsession : m_scheduledSubsessions)
+	{
+		bindMediaQueue(scheduledSubsession.second);
+	}
+	updatePolledSubsessions();
 }
 
-void 
+bool
 LiveSourceTaskScheduler0::
-processMediaSubsessions()
+processLiveSources()
 {
-	if (!m_mediaSubSessionsMap.empty())
+	std::atomic<bool> hasPendingMedia(false);
+
+	resolveMediaQueues();
+
+	// Only visit the subsessions whose queue received samples, and those that have to be polled.
+	m_activeSubsessions.assign(m_polledSubsessions.begin(), m_polledSubsessions.end());
+	m_readyList.Drain(m_readyQueues);
+	for (const auto& readiness : m_readyQueues)
 	{
-		// UniqueChannelSessionIdentifier, LiveMediaSubsession*
-		tbb::parallel_for_each (m_mediaSubSessionsMap.begin(), m_mediaSubSessionsMap.end(), [&](LiveMediaSession mediaSubsessionIt)
+		// Unbound if the subsession was deregistered or its queue resolved again.
+		const auto scheduledSubsession = static_cast<ScheduledMediaSubsession*>(readiness->GetClientData());
+		if (scheduledSubsession)
+		{
+			m_activeSubsessions.push_back(scheduledSubsession);
+		}
+	}
+	m_readyQueues.clear();
+
+	// Stage one runs on the worker threads: dequeue, filter, split and packetize per subsession.
+	// The event loop thread is blocked until all subsessions are done, and each subsession is
+	// handled by exactly one task, so nothing below races with live555.
+	// Every subsession is a deficit round robin channel: it dequeues while it has byte credit and
+	// time left, so a burst on one channel cannot hold up the iteration for all others.
+	tbb::parallel_for_each (m_activeSubsessions.begin(), m_activeSubsessions.end(), [&](ScheduledMediaSubsession* scheduledSubsession)
+		{
+			const auto& channel = scheduledSubsession->Channel;
+			const auto subsession = scheduledSubsession->Subsession;
+			auto& channelScheduler = *scheduledSubsession->Scheduler;
+			channelScheduler.BeginRound(m_byteQuantum, m_timeQuantumMicroSec);
+
+			auto& batch = scheduledSubsession->Batch;
+			auto isQueueEmpty = false;
+			while (channelScheduler.CanDequeue())
 			{
-				LiveMediaSubsession* subsession = mediaSubsessionIt.second;
-				if (m_count % 30 == 0)
+				// Dequeue a batch at a time, channel managers that cannot hand out queue handles look
+				// the channel up once per batch.
+				if (scheduledSubsession->BatchPosition == scheduledSubsession->BatchSize)
 				{
-					m_count = 0;
-
-					if (!subsession->IsAnyActiveDeviceSourcePresent()
-						&& subsession->HasServedVideoDeviceSource()
-						&& !subsession->HasBeenProcessedToKill())
+					scheduledSubsession->BatchPosition = 0;
+					scheduledSubsession->BatchSize = scheduledSubsession->MediaQueue.IsValid()
+						? ChannelManager::GetMediaBatch(scheduledSubsession->MediaQueue, batch.data(), batch.size())
+						: m_channelManager.GetMediaBatch(channel.first, channel.second, subsession->GetSourceId(),
+							batch.data(), batch.size());
+					if (scheduledSubsession->BatchSize == 0)
 					{
-						// kill the channel(remote rtsp-session in camera-server for this associated subsession)
-						subsession->KillChannel();
+						isQueueEmpty = true;
+						break;
 					}
 				}
-				else
-					m_count++;
 
-				// if there was only one obj in map & we just deleted it?
-				if (m_mediaSubSessionsMap.empty())
+				const auto mediaSample = std::move(batch[scheduledSubsession->BatchPosition++]);
+				channelScheduler.OnDequeued(*mediaSample);
+
+				// The sample may be shared with the subsessions of other channels of the same camera,
+				// which run in parallel: it is read only from here on, the subsession knows its own
+				// channel-id, channel-name and source-id.
+				subsession->PrepareMediaSample(mediaSample);
+			}
+
+			channelScheduler.EndRound(isQueueEmpty);
+			if (!isQueueEmpty)
+			{
+				// Out of credit or time, the channel may still hold samples: visit it again next pass.
+				hasPendingMedia = true;
+				if (scheduledSubsession->Readiness)
 				{
-					return; // exit here
+					scheduledSubsession->Readiness->Notify();
 				}
-			});
+			}
+		});
+
+	// Stage two stays on the event loop thread: hand the prepared frames to the sinks.
+	for (const auto scheduledSubsession : m_activeSubsessions)
+	{
+		scheduledSubsession->Subsession->DeliverPreparedFrames();
 	}
+
+	return hasPendingMedia;
 }
 
 void
@@ -24,13 +24,24 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 ///
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <map>
+#include <memory>
 
 #include <live555/BasicUsageEnvironment.hh>
 
 #include "LiveRtspServer.h"
 #include "LiveDeviceSource.h"
 #include "LiveMediaSubsession.h"
+#include "MediaArrivalSignal.h"
+#include "DeficitRoundRobinChannel.h"
+#include "MediaQueueHandle.h"
+#include "MediaReadyList.h"
+#include "TimerWheel.h"
+#include "SocketEventPoller.h"
+#include "UdpSendBatcher.h"
+#include "InterleavedTcpWriter.h"
 
 namespace CvRtsp
 {
@@ -47,8 +58,52 @@ namespace CvRtsp
 	/// Maximum number of cycles in the while loop.
 	const unsigned MaxRevolutions = 60;
 
-	/// Maximum number of samples to be processed in the event loop.
-	//const unsigned MaxSamplesToBeProcessedInEventLoop = 30;
+	/// Maximum number of samples dequeued from a media queue at once.
+	const size_t MaxDequeueBatch = 32;
+
+	///
+	/// Ingest state of a registered media subsession, used by the event loop on every pass.
+	struct ScheduledMediaSubsession
+	{
+		/// Channel id and name the subsession is registered with.
+		UniqueChannelSessionIdentifier Channel;
+
+		/// Registered media subsession.
+		LiveMediaSubsession* Subsession;
+
+		/// Queue the subsession's samples are dequeued from, resolved at registration.
+		MediaQueueHandle MediaQueue;
+
+		/// Readiness of the media queue, bound to the ready list. Null if the queue has to be polled.
+		std::shared_ptr<MediaQueueReadiness> Readiness;
+
+		/// Deficit round robin state.
+		std::unique_ptr<DeficitRoundRobinChannel> Scheduler;
+
+		/// Samples dequeued in one batch, those from BatchPosition on are left over from a round
+		/// that ran out of credit and are processed first in the next one.
+		std::array<std::shared_ptr<MediaSample>, MaxDequeueBatch> Batch;
+
+		/// Number of samples in Batch.
+		size_t BatchSize = 0;
+
+		/// Next sample to process in Batch.
+		size_t BatchPosition = 0;
+	};
+
+	/// Alias for map, containing the ingest state of the mediasubsession's identified by pair<channel-id, channel-name>
+	using ScheduledMediaSubsessionMap = std::map<CvRtsp::UniqueChannelSessionIdentifier, CvRtsp::ScheduledMediaSubsession>;
+
+	///
+	/// How the task scheduler waits for socket events.
+	enum class SocketHandling
+	{
+		/// select() of BasicTaskScheduler, limited to FD_SETSIZE sockets.
+		Select,
+
+		/// SocketEventPoller: epoll, WSAPoll on Windows.
+		Poll
+	};
 
 	///
 	/// The LiveSourceTaskScheduler0 class is aware of the media subsessions that
@@ -58,8 +113,9 @@ namespace CvRtsp
 	{
 	public:
 		///
-		/// Destructor.
-		~LiveSourceTaskScheduler0() = default;
+		/// Destructor. Producers may still be adding media to the channels: the media arrival signal
+		/// and the ready list belong to the channel manager and outlive the scheduler.
+		~LiveSourceTaskScheduler0();
 
 		/// Overriding from class BasicTaskScheduler0; this so that we can control the watch variable. 
 		/// 
@@ -69,7 +125,50 @@ namespace CvRtsp
 		/// that is being overridden.
 		void doEventLoop(EventLoopWatchVariable* watchVariable) override;
 
-		/// Set the maximum poll delay time. 
+		/// Overridden from BasicTaskScheduler0: delayed tasks are kept in a timer wheel instead of
+		/// the base class' sorted delay queue, so that scheduling is O(1) with many clients.
+		///
+		/// @param[in] microseconds Delay in microseconds.
+		/// @param[in] proc Task function.
+		/// @param[in] clientData Task function argument.
+		///
+		/// @return Task token.
+		TaskToken scheduleDelayedTask(int64_t microseconds, TaskFunc* proc, void* clientData) override;
+
+		/// Overridden from BasicTaskScheduler0, see scheduleDelayedTask().
+		///
+		/// @param[in,out] prevTask Task token, set to null.
+		void unscheduleDelayedTask(TaskToken& prevTask) override;
+
+		/// Overridden from TaskScheduler, moves the task within the timer wheel.
+		///
+		/// @param[in,out] task Task token.
+		/// @param[in] microseconds Delay in microseconds.
+		/// @param[in] proc Task function.
+		/// @param[in] clientData Task function argument.
+		void rescheduleDelayedTask(TaskToken& task, int64_t microseconds, TaskFunc* proc, void* clientData) override;
+
+		/// Overridden from BasicTaskScheduler0: with polled socket handling the event triggers are
+		/// handled by SingleStep() of this class, triggering an event also wakes up the event loop.
+		///
+		/// @param[in] eventHandlerProc Event handler.
+		///
+		/// @return Event trigger id, 0 if all triggers are in use.
+		EventTriggerId createEventTrigger(TaskFunc* eventHandlerProc) override;
+
+		/// Overridden from BasicTaskScheduler0, see createEventTrigger().
+		///
+		/// @param[in] eventTriggerId Event trigger id(s).
+		void deleteEventTrigger(EventTriggerId eventTriggerId) override;
+
+		/// Overridden from BasicTaskScheduler0, see createEventTrigger(). Can be called from any thread.
+		///
+		/// @param[in] eventTriggerId Event trigger id(s).
+		/// @param[in] clientData Event handler argument.
+		void triggerEvent(EventTriggerId eventTriggerId, void* clientData = nullptr) override;
+
+		/// Set the maximum poll delay time. The event loop blocks for at most this long when neither
+		/// media nor socket events arrive, 0 blocks until the next event or delayed task.
 		///
 		/// @param[in] maxDelayTimeMicroSec Maximum poll delay time in microseconds.
 		void SetMaximumPollDelay(unsigned maxDelayTimeMicroSec)
@@ -77,6 +176,103 @@ namespace CvRtsp
 			m_maxDelayTimeMicroSec = maxDelayTimeMicroSec;
 		}
 
+		/// Wake up the event loop. Can be called from any thread, e.g. after triggerEvent().
+		void WakeUp()
+		{
+			m_mediaArrivalSignal->Signal();
+		}
+
+		/// Set the time the event loop spins waiting for media before it blocks. Spinning trades
+		/// CPU time for wakeup latency, 0 (default) blocks right away.
+		///
+		/// @param[in] spinTimeMicroSec Spin time in microseconds.
+		void SetSpinTime(unsigned spinTimeMicroSec)
+		{
+			m_spinTimeMicroSec = spinTimeMicroSec;
+		}
+
+		/// Send the RTP/RTCP datagrams of groupsocks created from now on in batches (default), or
+		/// with a sendto() per datagram.
+		///
+		/// @param[in] isEnabled True to batch datagrams.
+		void SetUdpBatching(bool isEnabled)
+		{
+			m_isUdpBatchingEnabled = isEnabled;
+		}
+
+		/// Are datagrams of new groupsocks sent in batches.
+		///
+		/// @return True if datagrams are batched.
+		bool IsUdpBatchingEnabled() const
+		{
+			return m_isUdpBatchingEnabled;
+		}
+
+		/// Write the RTP packets of RTP-over-TCP clients that start playing from now on through the
+		/// interleaved writer (default off), so that a full client socket does not block the event loop.
+		/// Requires UDP batching.
+		///
+		/// @param[in] isEnabled True to queue interleaved RTP packets.
+		void SetInterleavedTcpOutput(bool isEnabled)
+		{
+			m_isInterleavedTcpOutputEnabled = isEnabled;
+		}
+
+		/// Are the RTP packets of RTP-over-TCP clients queued.
+		///
+		/// @return True if interleaved RTP packets are queued.
+		bool IsInterleavedTcpOutputEnabled() const
+		{
+			return m_isInterleavedTcpOutputEnabled;
+		}
+
+		/// Interleaved writer of RTP-over-TCP clients. Flushed before the event loop blocks.
+		///
+		/// @return Interleaved TCP writer.
+		InterleavedTcpWriter& GetInterleavedTcpWriter()
+		{
+			return m_interleavedTcpWriter;
+		}
+
+		/// Batcher the datagrams of BatchedGroupsocks are queued in. Flushed before the event loop blocks.
+		///
+		/// @return UDP send batcher.
+		UdpSendBatcher& GetUdpSendBatcher()
+		{
+			return m_udpSendBatcher;
+		}
+
+		/// Set the quanta every channel is credited per event loop iteration and unit of weight.
+		///
+		/// @param[in] byteQuantum Bytes of media per round.
+		/// @param[in] timeQuantumMicroSec Time spent dequeuing and packetizing per round, in microseconds.
+		void SetSchedulingQuantum(unsigned byteQuantum, unsigned timeQuantumMicroSec)
+		{
+			m_byteQuantum = byteQuantum > 0 ? byteQuantum : 1;
+			m_timeQuantumMicroSec = timeQuantumMicroSec;
+		}
+
+		///
+		/// Set the share of the event loop a channel gets relative to the other channels (default 1).
+		/// The weight is kept when the channel's subsession is re-created.
+		///
+		/// @param[in] channelId	Channel id.
+		/// @param[in] channelName	Channel name.
+		/// @param[in] weight		Weight, at least 1.
+		void SetChannelWeight(const boost::uuids::uuid& channelId, const std::string& channelName, unsigned weight);
+
+		///
+		/// Get the scheduling delay histogram of a channel, i.e. the time its samples waited in the
+		/// channel queue. Must be called on the event loop thread, the histogram is valid as long as
+		/// the channel's subsession is registered.
+		///
+		/// @param[in] channelId	Channel id.
+		/// @param[in] channelName	Channel name.
+		///
+		/// @return Scheduling delay histogram, nullptr if no subsession is registered for the channel.
+		const SchedulingDelayHistogram* GetSchedulingDelayHistogram(const boost::uuids::uuid& channelId,
+			const std::string& channelName) const;
+
 		/// 
 		/// Registers a LiveMediaSubsession with the scheduler.
 		///
@@ -97,6 +293,17 @@ namespace CvRtsp
 		void DeRegisterMediaSubsession(const boost::uuids::uuid &channelId, const std::string& channelName,
 			uint32_t sourceId, LiveMediaSubsession* mediaSubsession);
 
+		/// 
+		/// Reports the number of consumers of a channel's source to the channel manager, so that
+		/// the producer can stop while nobody watches.
+		///
+		/// @param[in] channelId		Channel id.
+		/// @param[in] channelName		Channel name.
+		/// @param[in] sourceId			Source id.
+		/// @param[in] watcherCount		Number of consumers.
+		void SetWatcherCount(const boost::uuids::uuid& channelId, const std::string& channelName,
+			uint32_t sourceId, uint32_t watcherCount);
+
 		/// 
 		/// Deregisters a LiveMediaSubsession from the scheduler.
 		///
@@ -123,11 +330,61 @@ namespace CvRtsp
 	protected:
 		///
 		/// Constructor.
-		LiveSourceTaskScheduler0(ChannelManager& channelManager);
+		///
+		/// @param[in] channelManager Channel manager.
+		/// @param[in] socketHandling How to wait for socket events.
+		LiveSourceTaskScheduler0(ChannelManager& channelManager, SocketHandling socketHandling);
+
+		///
+		/// Overridden from BasicTaskScheduler: waits no longer than the next timer of the timer
+		/// wheel and fires the timers that are due afterwards.
+		///
+		/// @param[in] maxDelayTimeMicroSec Maximum delay time in microseconds, 0 for no limit.
+		void SingleStep(unsigned maxDelayTimeMicroSec) override;
+
+		///
+		/// Overridden from BasicTaskScheduler: sets the handler in the socket poller with polled
+		/// socket handling.
+		///
+		/// @param[in] socketNum Socket.
+		/// @param[in] conditionSet Socket conditions, 0 removes the handler.
+		/// @param[in] handlerProc Handler, nullptr removes the handler.
+		/// @param[in] clientData Handler argument.
+		void setBackgroundHandling(int socketNum, int conditionSet, BackgroundHandlerProc* handlerProc,
+			void* clientData) override;
+
+		///
+		/// Overridden from BasicTaskScheduler, see setBackgroundHandling().
+		///
+		/// @param[in] oldSocketNum Socket the handler is set for.
+		/// @param[in] newSocketNum Socket the handler is moved to.
+		void moveSocketHandling(int oldSocketNum, int newSocketNum) override;
 
 	private:
-		/// "m_maxDelayTimeMicroSec" is in microseconds. Default time of once per second.
-		unsigned m_maxDelayTimeMicroSec = 5;
+		/// Maximum time blocked in the event loop, in microseconds.
+		unsigned m_maxDelayTimeMicroSec = 100000;
+
+		/// Time spent spinning before blocking, in microseconds.
+		unsigned m_spinTimeMicroSec = 0;
+
+		/// Raised by the media channels when media is added, wakes up the event loop. Owned by the
+		/// channel manager.
+		MediaArrivalSignal* const m_mediaArrivalSignal;
+
+		/// Socket handlers with polled socket handling, nullptr with select().
+		std::unique_ptr<SocketEventPoller> m_socketPoller;
+
+		/// Event trigger handlers with polled socket handling.
+		TaskFunc* m_triggerHandlers[MAX_NUM_EVENT_TRIGGERS];
+
+		/// Event handler arguments, set by triggerEvent().
+		std::atomic<void*> m_triggerClientData[MAX_NUM_EVENT_TRIGGERS];
+
+		/// Event triggers created.
+		EventTriggerId m_usedTriggers = 0;
+
+		/// Event triggers raised and not handled yet.
+		std::atomic<EventTriggerId> m_pendingTriggers;
 
 		/// Packet manager that receives media packets from device/network interface.
 		ChannelManager& m_channelManager;
@@ -137,16 +394,83 @@ namespace CvRtsp
 
 		///
 		bool m_hasRun;
-		int m_count;
 
 		/// Map which stores ALL media subsessions. Each subsession is identified via a unique id.
 		//MediaSessionMap m_mediaSessions;
 		LiveMediaSubSessionMap m_mediaSubSessionsMap;
 
+		/// Ingest state per registered subsession. m_mediaSubSessionsMap is kept for lookups.
+		ScheduledMediaSubsessionMap m_scheduledSubsessions;
+
+		/// Media queue generation of the channel manager the queue handles were resolved at.
+		uint64_t m_mediaQueueGeneration = 0;
+
+		/// Media queues that have received samples since the last pass, owned by the channel manager.
+		MediaReadyList& m_readyList;
+
+		/// Subsessions whose queue could not be resolved, these are visited on every pass.
+		std::vector<ScheduledMediaSubsession*> m_polledSubsessions;
+
+		/// Subsessions visited in this pass, reused to avoid allocating per pass.
+		std::vector<ScheduledMediaSubsession*> m_activeSubsessions;
+
+		/// Readiness taken off the ready list in this pass, reused to avoid allocating per pass.
+		std::vector<std::shared_ptr<MediaQueueReadiness>> m_readyQueues;
+
+		/// Channel weights, kept across subsession re-creation.
+		std::map<CvRtsp::UniqueChannelSessionIdentifier, unsigned> m_channelWeights;
+
+		/// Bytes credited per round and unit of weight.
+		unsigned m_byteQuantum = DeficitRoundRobinChannel::DefaultByteQuantum;
+
+		/// Time credited per round and unit of weight, in microseconds.
+		unsigned m_timeQuantumMicroSec = DeficitRoundRobinChannel::DefaultTimeQuantumMicroSec;
+
+		/// Delayed tasks.
+		TimerWheel m_timerWheel;
+
+		/// Datagrams sent while the event loop is busy.
+		UdpSendBatcher m_udpSendBatcher;
+
+		/// Send datagrams of new groupsocks in batches.
+		bool m_isUdpBatchingEnabled = true;
+
+		/// Packets of RTP-over-TCP clients, written before the event loop blocks.
+		InterleavedTcpWriter m_interleavedTcpWriter;
+
+		/// Queue the packets of RTP-over-TCP clients that start playing.
+		bool m_isInterleavedTcpOutputEnabled = false;
+
+		/// Resolve the media queue handles of all subsessions again if channels have changed.
+		void resolveMediaQueues();
+
+		/// Resolve the media queue of a subsession and bind its readiness to the ready list.
+		///
+		/// @param[in] scheduledSubsession Subsession ingest state.
+		void bindMediaQueue(ScheduledMediaSubsession& scheduledSubsession);
+
+		/// Rebuild the list of subsessions that have to be polled.
+		void updatePolledSubsessions();
+
+		/// Call the handlers of the event triggers raised since the last step.
+		void handleTriggeredEvents();
+
 		/// Helper method to process media samples within the live555 event loop.
-		void processLiveSources();
+		///
+		/// @return True if a channel has more samples queued than were processed.
+		bool processLiveSources();
 
-		/// Destroys subsession if there are no active device-sources usibg it.
-		void processMediaSubsessions();
+		///
+		/// Spin for at most the spin time until media is signalled.
+		///
+		/// @return True if media has been signalled.
+		bool spinForMediaArrival() const;
+
+		///
+		/// Background handler of the media arrival socket.
+		///
+		/// @param[in] clientData Task scheduler.
+		/// @param[in] mask Socket condition.
+		static void onMediaArrival(void* clientData, int mask);
 	};
 }
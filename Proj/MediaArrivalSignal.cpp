@@ -0,0 +1,92 @@
+///
+/// @class MediaArrivalSignal
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <live555/GroupsockHelper.hh>
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "MediaArrivalSignal.h"
+
+using namespace CvRtsp;
+
+MediaArrivalSignal::
+MediaArrivalSignal() :
+	m_socket(-1),
+	m_isSignalled(false)
+{
+#if defined(_WIN32)
+	// The signal may be created before live555 has opened its first socket.
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		log_rtsp_error("MediaArrivalSignal: WSAStartup failed");
+		return;
+	}
+#endif
+
+	m_socket = static_cast<int>(socket(AF_INET, SOCK_DGRAM, 0));
+	if (m_socket < 0)
+	{
+		log_rtsp_error("MediaArrivalSignal: unable to create socket");
+		return;
+	}
+
+	// Bind to an ephemeral loopback port and connect the socket to itself.
+	struct sockaddr_in address {};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	SOCKLEN_T addressLength = sizeof(address);
+	if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0
+		|| getsockname(m_socket, reinterpret_cast<struct sockaddr*>(&address), &addressLength) != 0
+		|| connect(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0
+		|| !makeSocketNonBlocking(m_socket))
+	{
+		log_rtsp_error("MediaArrivalSignal: unable to set up loopback socket");
+		closeSocket(m_socket);
+		m_socket = -1;
+	}
+}
+
+MediaArrivalSignal::
+~MediaArrivalSignal()
+{
+	if (m_socket >= 0)
+	{
+		closeSocket(m_socket);
+		m_socket = -1;
+	}
+
+#if defined(_WIN32)
+	WSACleanup();
+#endif
+}
+
+void
+MediaArrivalSignal::
+Signal()
+{
+	// Only the producer that raises the signal writes to the socket.
+	if (m_socket >= 0 && !m_isSignalled.exchange(true, std::memory_order_acq_rel))
+	{
+		const char wakeup = 1;
+		send(m_socket, &wakeup, sizeof(wakeup), 0);
+	}
+}
+
+void
+MediaArrivalSignal::
+Drain()
+{
+	char buffer[64];
+	while (m_socket >= 0 && recv(m_socket, buffer, sizeof(buffer), 0) > 0)
+	{
+	}
+
+	// Reset after reading: a producer signalling in between leaves a byte in the socket and
+	// causes at most one spurious wakeup, whereas resetting first could swallow its wakeup.
+	m_isSignalled.store(false, std::memory_order_release);
+}
@@ -0,0 +1,76 @@
+///
+/// @class MediaArrivalSignal
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <atomic>
+
+namespace CvRtsp
+{
+	///
+	/// Wakes up the live555 event loop when media samples are added to a media channel.
+	///
+	/// The signal is a UDP socket on the loopback interface that is connected to itself, so that
+	/// it can be watched by the select() based BasicTaskScheduler on every platform. Producers
+	/// only write to the socket when the signal is not already pending, bursts of samples result
+	/// in a single wakeup.
+	class MediaArrivalSignal
+	{
+	public:
+		///
+		/// Constructor, creates the loopback socket.
+		MediaArrivalSignal();
+
+		///
+		/// Destructor, closes the loopback socket.
+		~MediaArrivalSignal();
+
+		MediaArrivalSignal(const MediaArrivalSignal&) = delete;
+		MediaArrivalSignal& operator=(const MediaArrivalSignal&) = delete;
+
+		///
+		/// Signal that media is available. Can be called from any thread.
+		void Signal();
+
+		///
+		/// Reset the signal and read all pending wakeups from the socket.
+		/// Must be called from the event loop before the media queues are processed.
+		void Drain();
+
+		///
+		/// Is a wakeup pending.
+		///
+		/// @return True if media has been signalled since the last Drain().
+		bool IsSignalled() const
+		{
+			return m_isSignalled.load(std::memory_order_acquire);
+		}
+
+		///
+		/// Has the loopback socket been created.
+		///
+		/// @return True if the signal can be used.
+		bool IsValid() const
+		{
+			return m_socket >= 0;
+		}
+
+		///
+		/// Socket to be watched for readability by the task scheduler.
+		///
+		/// @return Socket number, negative if invalid.
+		int GetSocket() const
+		{
+			return m_socket;
+		}
+
+	private:
+		/// Loopback socket connected to itself.
+		int m_socket;
+
+		/// True while a wakeup is pending.
+		std::atomic<bool> m_isSignalled;
+	};
+}
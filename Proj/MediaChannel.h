@@ -24,31 +24,64 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 ///
 
 #pragma once
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
 #include <vector>
 
 #include "MediaSample.h"
+#include "MediaArrivalSignal.h"
 
 namespace CvRtsp
 {
+	/// Demand for the media of a channel direction, reported to the producer.
+	struct MediaDemand
+	{
+		/// Number of consumers of the media: clients, timeshift buffer and segment store.
+		uint32_t WatcherCount = 0;
+
+		/// Number of samples the producer may add before it should pause, 0 while the
+		/// queue is too full. Only meaningful while WatcherCount is not 0.
+		uint32_t Credits = 0;
+	};
+
 	/// A MediaChannel is comprised of an audio and a video channel.
 	/// The MediaChannel abstracts the delivery of media from a source to some
 	/// media sink.
 	/// 
 	/// A MediaChannel is identified by the channel ID. 
+	///
+	/// Once the server reports the watchers of a direction (SetWatcherCount()), samples of
+	/// a direction nobody watches are discarded without being queued, and the demand handler
+	/// tells the producer when to stop and resume producing: a direction is paused when its
+	/// queue holds a credit window of samples and resumed, with fresh credits, when the
+	/// event loop has drained it to half the window.
 	class MediaChannel
 	{
 	public:
+		/// Called when the demand of a direction changes, see SetDemandHandler().
+		using DemandHandler = std::function<void(bool isVideo, const MediaDemand& demand)>;
+
+		/// Default number of queued samples at which the producer is paused.
+		static const uint32_t DefaultCreditWindow = 512;
 
 		///Constructor.
 		///
 		/// @param channelId Media	Unique channel id.
 		MediaChannel(const boost::uuids::uuid& channelId, const std::string& channelName) :
 			m_channelId(channelId),
-			m_channelName(channelName)
+			m_channelName(channelName),
+			m_mediaArrivalSignal(nullptr),
+			m_hasDemandHandler(false),
+			m_creditWindow(DefaultCreditWindow)
 		{
 		}
 
+		MediaChannel(const MediaChannel&) = delete;
+		MediaChannel& operator=(const MediaChannel&) = delete;
+
 		/// Destructor.
 		virtual ~MediaChannel() = default;
 
@@ -60,7 +93,16 @@ namespace CvRtsp
 		/// @return True if delivery successful.
 		bool AddVideoMediaSamples(const std::vector<std::shared_ptr<MediaSample>>& mediaSamples)
 		{
-			return deliverVideo(m_channelId, m_channelName, mediaSamples);
+			if (!IsWatched(true))
+			{
+				return true;
+			}
+
+			setArrivalTime(mediaSamples);
+			const auto isDelivered = deliverVideo(m_channelId, m_channelName, mediaSamples);
+			signalMediaArrival();
+			updateCredits(true);
+			return isDelivered;
 		}
 
 		/// The addAudioMediaSamples() can be called to deliver media samples to 
@@ -71,10 +113,359 @@ namespace CvRtsp
 		/// @return True if delivery successful.
 		bool AddAudioMediaSamples(const std::vector<std::shared_ptr<MediaSample>>& mediaSamples)
 		{
-			return deliverAudio(m_channelId, m_channelName, mediaSamples);
+			if (!IsWatched(false))
+			{
+				return true;
+			}
+
+			setArrivalTime(mediaSamples);
+			const auto isDelivered = deliverAudio(m_channelId, m_channelName, mediaSamples);
+			signalMediaArrival();
+			updateCredits(false);
+			return isDelivered;
+		}
+
+		/// Deliver a single media sample to the media sink, moving it into the queue instead of
+		/// copying the pointer.
+		///
+		/// @param mediaSample Video sample, moved from unless it is dropped.
+		///
+		/// @return True if delivery successful.
+		bool AddVideoMediaSample(std::shared_ptr<MediaSample>&& mediaSample)
+		{
+			return AddVideoMediaSamples(&mediaSample, 1);
+		}
+
+		/// Deliver media samples to the media sink, moving them into the queue.
+		///
+		/// @param mediaSamples Video samples, moved from unless they are dropped.
+		///
+		/// @return True if delivery successful.
+		bool AddVideoMediaSamples(std::vector<std::shared_ptr<MediaSample>>&& mediaSamples)
+		{
+			return AddVideoMediaSamples(mediaSamples.data(), mediaSamples.size());
+		}
+
+		/// Deliver a range of media samples to the media sink, moving them into the queue. The
+		/// producer does not need to build a vector, and packet manager channels publish the whole
+		/// range to the event loop at once.
+		///
+		/// @param mediaSamples Video samples, moved from unless they are dropped.
+		/// @param count		Number of samples.
+		///
+		/// @return True if delivery successful.
+		bool AddVideoMediaSamples(std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+		{
+			if (!IsWatched(true))
+			{
+				return true;
+			}
+
+			setArrivalTime(mediaSamples, count);
+			const auto isDelivered = deliverMovedVideo(m_channelId, m_channelName, mediaSamples, count);
+			signalMediaArrival();
+			updateCredits(true);
+			return isDelivered;
+		}
+
+		/// Deliver a single audio sample to the media sink, moving it into the queue.
+		///
+		/// @param mediaSample Audio sample, moved from unless it is dropped.
+		///
+		/// @return True if delivery successful.
+		bool AddAudioMediaSample(std::shared_ptr<MediaSample>&& mediaSample)
+		{
+			return AddAudioMediaSamples(&mediaSample, 1);
+		}
+
+		/// Deliver audio samples to the media sink, moving them into the queue.
+		///
+		/// @param mediaSamples Audio samples, moved from unless they are dropped.
+		///
+		/// @return True if delivery successful.
+		bool AddAudioMediaSamples(std::vector<std::shared_ptr<MediaSample>>&& mediaSamples)
+		{
+			return AddAudioMediaSamples(mediaSamples.data(), mediaSamples.size());
+		}
+
+		/// Deliver a range of audio samples to the media sink, moving them into the queue.
+		///
+		/// @param mediaSamples Audio samples, moved from unless they are dropped.
+		/// @param count		Number of samples.
+		///
+		/// @return True if delivery successful.
+		bool AddAudioMediaSamples(std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+		{
+			if (!IsWatched(false))
+			{
+				return true;
+			}
+
+			setArrivalTime(mediaSamples, count);
+			const auto isDelivered = deliverMovedAudio(m_channelId, m_channelName, mediaSamples, count);
+			signalMediaArrival();
+			updateCredits(false);
+			return isDelivered;
+		}
+
+		/// Set the signal that wakes up the event loop once samples have been delivered. Can be
+		/// called while samples are added, the signal must outlive the channel's producers
+		/// (ChannelManager::GetMediaArrivalSignal()).
+		///
+		/// @param mediaArrivalSignal Signal of the task scheduler, nullptr for none.
+		void SetMediaArrivalSignal(MediaArrivalSignal* mediaArrivalSignal)
+		{
+			m_mediaArrivalSignal.store(mediaArrivalSignal, std::memory_order_release);
+		}
+
+		/// Set the handler told when a direction gains its first or loses its last watcher,
+		/// when it is paused (no credits) and when it is resumed. The handler is called on the
+		/// thread that changes the demand, with the demand lock held: it must only record the
+		/// demand or hand it to the producer, not change the channel's demand itself. A host
+		/// resuming a video producer should start at a keyframe.
+		///
+		/// @param demandHandler Handler, empty for none.
+		void SetDemandHandler(DemandHandler demandHandler)
+		{
+			std::lock_guard<std::mutex> lock(m_demandMutex);
+			m_hasDemandHandler.store(static_cast<bool>(demandHandler), std::memory_order_relaxed);
+			m_demandHandler = std::move(demandHandler);
+		}
+
+		/// Set the number of queued samples at which a direction is paused.
+		///
+		/// @param creditWindow Samples, at least 2.
+		virtual void SetCreditWindow(uint32_t creditWindow)
+		{
+			m_creditWindow.store(creditWindow < 2 ? 2 : creditWindow, std::memory_order_relaxed);
+		}
+
+		/// Get the number of queued samples at which a direction is paused.
+		///
+		/// @return Samples.
+		uint32_t GetCreditWindow() const
+		{
+			return m_creditWindow.load(std::memory_order_relaxed);
+		}
+
+		/// Report the number of consumers of a direction. Until this is first called for a
+		/// direction, its samples are queued whether or not anybody watches them.
+		///
+		/// @param isVideo		True for the video direction.
+		/// @param watcherCount	Number of consumers.
+		void SetWatcherCount(bool isVideo, uint32_t watcherCount)
+		{
+			auto& demand = getDemandState(isVideo);
+			std::lock_guard<std::mutex> lock(m_demandMutex);
+			const auto wasTracked = demand.IsTracked.exchange(true, std::memory_order_relaxed);
+			const auto previousCount = demand.WatcherCount.exchange(watcherCount, std::memory_order_relaxed);
+			if (!wasTracked || (previousCount == 0) != (watcherCount == 0))
+			{
+				notifyDemand(isVideo);
+			}
+		}
+
+		/// Get the current demand of a direction.
+		///
+		/// @param isVideo True for the video direction.
+		///
+		/// @return Watchers and credits.
+		MediaDemand GetDemand(bool isVideo) const
+		{
+			const auto& demand = getDemandState(isVideo);
+			MediaDemand mediaDemand;
+			mediaDemand.WatcherCount = demand.WatcherCount.load(std::memory_order_relaxed);
+			if (!demand.IsPaused.load(std::memory_order_relaxed))
+			{
+				const auto creditWindow = m_creditWindow.load(std::memory_order_relaxed);
+				const auto queuedCount = getQueuedCount(isVideo);
+				mediaDemand.Credits = queuedCount < creditWindow ? creditWindow - static_cast<uint32_t>(queuedCount) : 0;
+			}
+			return mediaDemand;
+		}
+
+		/// Have the watchers of a direction been reported.
+		///
+		/// @param isVideo True for the video direction.
+		///
+		/// @return False while its samples are queued whether or not anybody watches them.
+		bool IsDemandTracked(bool isVideo) const
+		{
+			return getDemandState(isVideo).IsTracked.load(std::memory_order_relaxed);
+		}
+
+		/// Has the producer of a direction been told to stop.
+		///
+		/// @param isVideo True for the video direction.
+		///
+		/// @return True while the direction has no credits.
+		bool IsPaused(bool isVideo) const
+		{
+			return getDemandState(isVideo).IsPaused.load(std::memory_order_relaxed);
+		}
+
+		/// Are the samples of a direction consumed. Unwatched samples are discarded on arrival.
+		///
+		/// @param isVideo True for the video direction.
+		///
+		/// @return False if the direction is tracked and has no watchers.
+		bool IsWatched(bool isVideo) const
+		{
+			const auto& demand = getDemandState(isVideo);
+			return !demand.IsTracked.load(std::memory_order_relaxed) || demand.WatcherCount.load(std::memory_order_relaxed) != 0;
+		}
+
+	protected:
+		/// Number of samples of a direction waiting for the event loop, used for the credits.
+		/// The default reports none, so that a channel without a queue is never paused.
+		///
+		/// @param isVideo True for the video direction.
+		///
+		/// @return Queued samples.
+		virtual size_t getQueuedCount(bool /*isVideo*/) const
+		{
+			return 0;
+		}
+
+		/// Must be called by subclasses after the event loop has taken samples of a direction,
+		/// resumes the producer once the queue has been drained to half the credit window.
+		///
+		/// @param isVideo True for the video direction.
+		void onDequeued(bool isVideo)
+		{
+			auto& demand = getDemandState(isVideo);
+
+			// Pairs with the fence in updateCredits(): either the producer sees the drained
+			// queue or this sees its pause.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!demand.IsPaused.load(std::memory_order_relaxed)
+				|| getQueuedCount(isVideo) > m_creditWindow.load(std::memory_order_relaxed) / 2)
+			{
+				return;
+			}
+
+			setPaused(isVideo, false);
+		}
+
+		/// Pause or resume the producer of a direction, for channels that derive their credits
+		/// from other channels instead of a queue.
+		///
+		/// @param isVideo	True for the video direction.
+		/// @param isPaused	True to pause.
+		void setPaused(bool isVideo, bool isPaused)
+		{
+			auto& demand = getDemandState(isVideo);
+			std::lock_guard<std::mutex> lock(m_demandMutex);
+			if (demand.IsPaused.load(std::memory_order_relaxed) != isPaused)
+			{
+				demand.IsPaused.store(isPaused, std::memory_order_relaxed);
+				notifyDemand(isVideo);
+			}
 		}
 
 	private:
+		/// Demand of a direction.
+		struct DemandState
+		{
+			/// Watchers are reported for the direction.
+			std::atomic<bool> IsTracked{ false };
+
+			/// Number of consumers.
+			std::atomic<uint32_t> WatcherCount{ 0 };
+
+			/// The producer has been told to stop.
+			std::atomic<bool> IsPaused{ false };
+		};
+
+		DemandState& getDemandState(bool isVideo)
+		{
+			return m_demand[isVideo ? 0 : 1];
+		}
+
+		const DemandState& getDemandState(bool isVideo) const
+		{
+			return m_demand[isVideo ? 0 : 1];
+		}
+
+		/// Pause the producer of a direction if its queue holds a credit window of samples.
+		void updateCredits(bool isVideo)
+		{
+			auto& demand = getDemandState(isVideo);
+			const auto creditWindow = m_creditWindow.load(std::memory_order_relaxed);
+			if (!m_hasDemandHandler.load(std::memory_order_relaxed) || !demand.IsTracked.load(std::memory_order_relaxed)
+				|| demand.IsPaused.load(std::memory_order_relaxed) || getQueuedCount(isVideo) < creditWindow)
+			{
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(m_demandMutex);
+			if (demand.IsPaused.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+			demand.IsPaused.store(true, std::memory_order_relaxed);
+
+			// The event loop may have drained the queue before the pause was visible to it.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (getQueuedCount(isVideo) <= creditWindow / 2)
+			{
+				demand.IsPaused.store(false, std::memory_order_relaxed);
+				return;
+			}
+			notifyDemand(isVideo);
+		}
+
+		/// Hand the demand of a direction to the handler. Must be called with m_demandMutex held.
+		void notifyDemand(bool isVideo)
+		{
+			if (m_demandHandler)
+			{
+				m_demandHandler(isVideo, GetDemand(isVideo));
+			}
+		}
+
+		/// Stamp the samples with the current time so that the scheduling delay can be measured.
+		/// Only the first media channel a sample is added to stamps it: a fan-out hands the sample
+		/// on to its subscribers, whose consumers may already be reading it, and the delay is
+		/// measured from ingest.
+		static void setArrivalTime(const std::vector<std::shared_ptr<MediaSample>>& mediaSamples)
+		{
+			const auto now = std::chrono::steady_clock::now();
+			for (const auto& mediaSample : mediaSamples)
+			{
+				setArrivalTime(*mediaSample, now);
+			}
+		}
+
+		/// Stamp a range of samples with the current time, unless they are stamped already.
+		static void setArrivalTime(const std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+		{
+			const auto now = std::chrono::steady_clock::now();
+			for (size_t index = 0; index < count; ++index)
+			{
+				setArrivalTime(*mediaSamples[index], now);
+			}
+		}
+
+		/// Stamp a sample with the given time, unless it is stamped already.
+		static void setArrivalTime(MediaSample& mediaSample, std::chrono::steady_clock::time_point now)
+		{
+			if (mediaSample.GetArrivalTime() == std::chrono::steady_clock::time_point())
+			{
+				mediaSample.SetArrivalTime(now);
+			}
+		}
+
+		/// Wake up the event loop, if a signal has been set.
+		void signalMediaArrival()
+		{
+			const auto mediaArrivalSignal = m_mediaArrivalSignal.load(std::memory_order_acquire);
+			if (mediaArrivalSignal)
+			{
+				mediaArrivalSignal->Signal();
+			}
+		}
+
 		/// The subclass must implement delivery of video media samples to the media sink
 		///
 		/// @param channelId		Unique channel id.
@@ -93,11 +484,57 @@ namespace CvRtsp
 		virtual bool deliverAudio(const boost::uuids::uuid& channelId, const std::string& channelName,
 			const std::vector<std::shared_ptr<MediaSample>>& mediaSamples) = 0;
 
+		/// Delivery of video samples that may be moved from. The default hands them to deliverVideo().
+		///
+		/// @param channelId		Unique channel id.
+		/// @param mediaSamples		Video samples.
+		/// @param count			Number of samples.
+		///
+		/// @return True if delivery successful.
+		virtual bool deliverMovedVideo(const boost::uuids::uuid& channelId, const std::string& channelName,
+			std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+		{
+			return deliverVideo(channelId, channelName, std::vector<std::shared_ptr<MediaSample>>(
+				std::make_move_iterator(mediaSamples), std::make_move_iterator(mediaSamples + count)));
+		}
+
+		/// Delivery of audio samples that may be moved from. The default hands them to deliverAudio().
+		///
+		/// @param channelId		Unique channel id.
+		/// @param mediaSamples		Audio samples.
+		/// @param count			Number of samples.
+		///
+		/// @return True if delivery successful.
+		virtual bool deliverMovedAudio(const boost::uuids::uuid& channelId, const std::string& channelName,
+			std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+		{
+			return deliverAudio(channelId, channelName, std::vector<std::shared_ptr<MediaSample>>(
+				std::make_move_iterator(mediaSamples), std::make_move_iterator(mediaSamples + count)));
+		}
+
 		/// Unique channel id
 		boost::uuids::uuid m_channelId;
 
 		/// Channel Name (should be unique).
 		std::string m_channelName;
+
+		/// Wakes up the event loop, not owned.
+		std::atomic<MediaArrivalSignal*> m_mediaArrivalSignal;
+
+		/// Serializes demand changes and their notifications.
+		std::mutex m_demandMutex;
+
+		/// Told about demand changes, protected by m_demandMutex.
+		DemandHandler m_demandHandler;
+
+		/// A demand handler is set, read without the lock when samples are added.
+		std::atomic<bool> m_hasDemandHandler;
+
+		/// Number of queued samples at which a direction is paused.
+		std::atomic<uint32_t> m_creditWindow;
+
+		/// Demand of the video and the audio direction.
+		DemandState m_demand[2];
 	};
 }
 
@@ -0,0 +1,88 @@
+///
+/// @class MediaQueueHandle
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <memory>
+
+#include "PacketManagerMediaChannel.h"
+
+namespace CvRtsp
+{
+	///
+	/// Direct handle to the video or audio queue of a packet manager media channel.
+	///
+	/// Resolved once by the channel manager so that the event loop can dequeue without looking the
+	/// channel up per sample. The handle keeps the media channel alive, a channel that is removed
+	/// from its channel manager simply stops yielding samples.
+	class MediaQueueHandle
+	{
+	public:
+		///
+		/// Default constructor, creates an invalid handle.
+		MediaQueueHandle() :
+			m_isVideo(false)
+		{
+		}
+
+		///
+		/// Constructor.
+		///
+		/// @param[in] mediaChannel Media channel owning the queue.
+		/// @param[in] isVideo True for the video queue, false for the audio queue.
+		MediaQueueHandle(std::shared_ptr<PacketManagerMediaChannel> mediaChannel, bool isVideo) :
+			m_mediaChannel(std::move(mediaChannel)),
+			m_isVideo(isVideo)
+		{
+		}
+
+		///
+		/// Does the handle refer to a queue.
+		///
+		/// @return True if valid.
+		bool IsValid() const
+		{
+			return m_mediaChannel != nullptr;
+		}
+
+		///
+		/// Dequeue the next media sample. The handle must be valid.
+		///
+		/// @return Media sample, nullptr if the queue is empty.
+		std::shared_ptr<MediaSample> Pop() const
+		{
+			return m_isVideo ? m_mediaChannel->GetVideo() : m_mediaChannel->GetAudio();
+		}
+
+		///
+		/// Dequeue up to maxCount media samples in one go. The handle must be valid.
+		///
+		/// @param[out] mediaSamples	Receives the samples, room for maxCount.
+		/// @param[in] maxCount			Maximum number of samples.
+		///
+		/// @return Number of samples dequeued, 0 if the queue is empty.
+		size_t PopBatch(std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount) const
+		{
+			return m_isVideo ? m_mediaChannel->GetVideoBatch(mediaSamples, maxCount)
+				: m_mediaChannel->GetAudioBatch(mediaSamples, maxCount);
+		}
+
+		///
+		/// Get the readiness that is notified when samples are added to the queue. The handle must be valid.
+		///
+		/// @return Media queue readiness.
+		std::shared_ptr<MediaQueueReadiness> GetReadiness() const
+		{
+			return m_isVideo ? m_mediaChannel->GetVideoReadiness() : m_mediaChannel->GetAudioReadiness();
+		}
+
+	private:
+		/// Media channel owning the queue.
+		std::shared_ptr<PacketManagerMediaChannel> m_mediaChannel;
+
+		/// Video or audio queue.
+		bool m_isVideo;
+	};
+}
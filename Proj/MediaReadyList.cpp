@@ -0,0 +1,102 @@
+///
+/// @class MediaReadyList
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "MediaReadyList.h"
+
+using namespace CvRtsp;
+
+#pragma region MediaQueueReadiness
+MediaQueueReadiness::
+MediaQueueReadiness() :
+	m_readyList(nullptr),
+	m_isQueued(false),
+	m_clientData(nullptr),
+	m_next(nullptr)
+{
+}
+
+void
+MediaQueueReadiness::
+Bind(MediaReadyList* readyList, void* clientData)
+{
+	m_clientData = clientData;
+	m_readyList.store(readyList, std::memory_order_release);
+}
+
+void
+MediaQueueReadiness::
+Notify()
+{
+	// Pairs with the fence in Drain(): either the event loop sees the samples added before this, or
+	// this sees the readiness taken off and queues it again. Without it both could miss each other.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	const auto readyList = m_readyList.load(std::memory_order_acquire);
+	if (readyList && !m_isQueued.exchange(true, std::memory_order_acq_rel))
+	{
+		// Only the thread that queued the readiness touches it until the event loop takes it off.
+		m_self = shared_from_this();
+		readyList->push(this);
+	}
+}
+#pragma endregion
+
+
+#pragma region MediaReadyList
+MediaReadyList::
+MediaReadyList() :
+	m_head(nullptr)
+{
+}
+
+MediaReadyList::
+~MediaReadyList()
+{
+	std::vector<std::shared_ptr<MediaQueueReadiness>> readyQueues;
+	Drain(readyQueues);
+}
+
+void
+MediaReadyList::
+push(MediaQueueReadiness* readiness)
+{
+	auto head = m_head.load(std::memory_order_relaxed);
+	do
+	{
+		readiness->m_next = head;
+	} while (!m_head.compare_exchange_weak(head, readiness, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void
+MediaReadyList::
+Drain(std::vector<std::shared_ptr<MediaQueueReadiness>>& readyQueues)
+{
+	auto readiness = m_head.exchange(nullptr, std::memory_order_acquire);
+
+	// The list is last in first out, reverse it while the readiness can't be pushed again.
+	MediaQueueReadiness* first = nullptr;
+	while (readiness)
+	{
+		const auto next = readiness->m_next;
+		readiness->m_next = first;
+		first = readiness;
+		readiness = next;
+	}
+
+	while (first)
+	{
+		const auto next = first->m_next;
+		readyQueues.push_back(std::move(first->m_self));
+		first->m_isQueued.store(false, std::memory_order_seq_cst);
+		first = next;
+	}
+
+	// The queues are read after the readiness has been taken off: without the fence the reads could
+	// be done before the stores above are visible, missing samples whose Notify() was dropped.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+#pragma endregion
@@ -0,0 +1,116 @@
+///
+/// @class MediaReadyList
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace CvRtsp
+{
+	/// Forward declarations
+	class MediaReadyList;
+
+	///
+	/// Readiness of one media queue. The producer notifies it after adding samples to the queue,
+	/// which puts it on the ready list of the task scheduler the queue is bound to. It is on the list
+	/// at most once, further notifications are dropped until the task scheduler has taken it off.
+	class MediaQueueReadiness : public std::enable_shared_from_this<MediaQueueReadiness>
+	{
+	public:
+		///
+		/// Constructor, the readiness is not bound to a ready list.
+		MediaQueueReadiness();
+
+		MediaQueueReadiness(const MediaQueueReadiness&) = delete;
+		MediaQueueReadiness& operator=(const MediaQueueReadiness&) = delete;
+
+		///
+		/// Bind to the ready list of a task scheduler. Must be called on the event loop thread.
+		///
+		/// @param[in] readyList Ready list, nullptr to unbind.
+		/// @param[in] clientData Passed back to the task scheduler with the readiness.
+		void Bind(MediaReadyList* readyList, void* clientData);
+
+		///
+		/// Unbind from the ready list. Must be called on the event loop thread.
+		void Unbind()
+		{
+			Bind(nullptr, nullptr);
+		}
+
+		///
+		/// Get the client data the readiness was bound with. Must be called on the event loop thread.
+		///
+		/// @return Client data, nullptr if unbound.
+		void* GetClientData() const
+		{
+			return m_clientData;
+		}
+
+		///
+		/// Put the readiness on the ready list, if bound and not on it already. Can be called from any thread.
+		void Notify();
+
+	private:
+		friend class MediaReadyList;
+
+		/// Ready list the readiness is put on.
+		std::atomic<MediaReadyList*> m_readyList;
+
+		/// Is the readiness on the ready list.
+		std::atomic<bool> m_isQueued;
+
+		/// Client data of the task scheduler.
+		void* m_clientData;
+
+		/// Next readiness on the ready list.
+		MediaQueueReadiness* m_next;
+
+		/// Keeps the readiness alive while it is on the ready list.
+		std::shared_ptr<MediaQueueReadiness> m_self;
+	};
+
+	///
+	/// Lock free multi-producer, single-consumer list of media queues that have received samples.
+	///
+	/// Producers push with a single compare-and-swap, the event loop takes the whole list with a
+	/// single exchange. The event loop therefore only visits channels that actually have media.
+	class MediaReadyList
+	{
+	public:
+		///
+		/// Constructor.
+		MediaReadyList();
+
+		///
+		/// Destructor. Producers must have stopped notifying.
+		~MediaReadyList();
+
+		MediaReadyList(const MediaReadyList&) = delete;
+		MediaReadyList& operator=(const MediaReadyList&) = delete;
+
+		///
+		/// Take all readiness off the list, in the order they were notified. Each may be notified
+		/// again as soon as it has been taken off, so the queues must only be read after this
+		/// returns. Must be called on the event loop thread.
+		///
+		/// @param[out] readyQueues Appended with the readiness of the media queues that are ready.
+		void Drain(std::vector<std::shared_ptr<MediaQueueReadiness>>& readyQueues);
+
+	private:
+		friend class MediaQueueReadiness;
+
+		///
+		/// Push a readiness that is not on the list.
+		///
+		/// @param[in] readiness Readiness.
+		void push(MediaQueueReadiness* readiness);
+
+		/// Most recently pushed readiness.
+		std::atomic<MediaQueueReadiness*> m_head;
+	};
+}
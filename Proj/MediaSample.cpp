@@ -63,6 +63,8 @@ MediaSample
 	m_channelName = mediaSample.m_channelName;
 	m_sourceId = mediaSample.m_sourceId;
 	m_isKeyFrame = mediaSample.m_isKeyFrame;
+	m_channelId = mediaSample.m_channelId;
+	m_arrivalTime = mediaSample.m_arrivalTime;
 	m_data.SetData(mediaSample.GetDataBuffer().Data(), mediaSample.GetSize());
 }
 
@@ -72,3 +74,25 @@ CreateMediaSample(BYTE* data, int size, double startTime, bool isKeyFrame, const
 {
 	return std::make_shared<MediaSample>(MediaSample(data, size, startTime, isKeyFrame, channelName, sourceId, isSyncPoint));
 }
+
+std::shared_ptr<MediaSample>
+MediaSample::
+AllocateMediaSample(int size, double startTime, bool isKeyFrame)
+{
+	std::shared_ptr<MediaSample> mediaSample(new MediaSample());
+	mediaSample->m_startTimeMs = startTime;
+	mediaSample->m_isKeyFrame = isKeyFrame;
+	mediaSample->m_data.Allocate(static_cast<size_t>(size));
+	return mediaSample;
+}
+
+std::shared_ptr<MediaSample>
+MediaSample::
+CreateBorrowedMediaSample(BYTE* data, int size, double startTime, bool isKeyFrame, std::shared_ptr<void> owner)
+{
+	std::shared_ptr<MediaSample> mediaSample(new MediaSample());
+	mediaSample->m_startTimeMs = startTime;
+	mediaSample->m_isKeyFrame = isKeyFrame;
+	mediaSample->m_data.SetBorrowedData(data, static_cast<size_t>(size), std::move(owner));
+	return mediaSample;
+}
@@ -40,6 +40,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <boost/uuid/uuid.hpp>
 
@@ -80,6 +81,33 @@ namespace CvRtsp
 		static std::shared_ptr<MediaSample> CreateMediaSample(BYTE* data, int size, double startTime,
 			bool isKeyFrame = false, const std::string& channelName = std::string(), uint32_t sourceId = 0, bool isSyncPoint = false);
 
+		///
+		/// Create a media sample with room for data, which the caller fills in through
+		/// GetDataBuffer().Data() before handing the sample on. Saves a copy where the data is
+		/// put together from pieces.
+		///
+		/// @param[in] size			Size of the data.
+		/// @param[in] startTime	Start time of the data stream.
+		/// @param[in] isKeyFrame	True, if this a keyframe.
+		///
+		/// @return Media sample.
+		static std::shared_ptr<MediaSample> AllocateMediaSample(int size, double startTime, bool isKeyFrame = false);
+
+		///
+		/// Create a media sample that refers to data owned by someone else instead of copying it.
+		/// Such samples are meant to be short-lived: whoever keeps a sample for long should keep
+		/// a copy (see IsBorrowed()), so that the owner can reuse the memory.
+		///
+		/// @param[in] data			Data buffer.
+		/// @param[in] size			Size of the data buffer.
+		/// @param[in] startTime	Start time of the data stream.
+		/// @param[in] isKeyFrame	True, if this a keyframe.
+		/// @param[in] owner		Keeps the data alive, released with the sample.
+		///
+		/// @return Media sample.
+		static std::shared_ptr<MediaSample> CreateBorrowedMediaSample(BYTE* data, int size, double startTime,
+			bool isKeyFrame, std::shared_ptr<void> owner);
+
 		/// 
 		/// Data buffer contained in this media sample.
 		///
@@ -98,6 +126,15 @@ namespace CvRtsp
 			return static_cast<int>(m_data.GetSize());
 		}
 
+		///
+		/// Does the sample refer to data owned by someone else.
+		///
+		/// @return True if created with CreateBorrowedMediaSample().
+		bool IsBorrowed() const
+		{
+			return m_data.IsBorrowed();
+		}
+
 		/// 
 		/// Media start time.
 		///
@@ -190,6 +227,23 @@ namespace CvRtsp
 			m_isKeyFrame = isKeyFrame;
 		}
 
+		/// Get the time the sample was added to its first media channel.
+		///
+		/// @return Arrival time, the clock's epoch if it has not been set.
+		std::chrono::steady_clock::time_point GetArrivalTime() const
+		{
+			return m_arrivalTime;
+		}
+
+		/// Set the time the sample was added to its first media channel. Must not be called once
+		/// the sample has been added to a media channel, its consumers may be reading it.
+		///
+		/// @param[in] arrivalTime Arrival time.
+		void SetArrivalTime(std::chrono::steady_clock::time_point arrivalTime)
+		{
+			m_arrivalTime = arrivalTime;
+		}
+
 
 	private:
 		///
@@ -236,5 +290,8 @@ namespace CvRtsp
 		/// Channel Id.
 		boost::uuids::uuid m_channelId;
 
+		/// Time the sample was added to its media channel, used to measure scheduling delay.
+		std::chrono::steady_clock::time_point m_arrivalTime;
+
 	};
 }
@@ -0,0 +1,303 @@
+///
+/// @class MediaSampleRing
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "MediaSampleRing.h"
+
+using namespace CvRtsp;
+
+/// Smallest power of two not below a value.
+static uint64_t
+roundUpToPowerOfTwo(uint64_t value)
+{
+	uint64_t powerOfTwo = 1;
+	while (powerOfTwo < value)
+	{
+		powerOfTwo <<= 1;
+	}
+	return powerOfTwo;
+}
+
+MediaSampleRing::
+MediaSampleRing(size_t capacity, bool isKeyFrameAware) :
+	m_capacity(capacity < 2 ? 2 : capacity),
+	m_isKeyFrameAware(isKeyFrameAware),
+	m_head(0),
+	m_cachedTail(0),
+	m_headGeneration(nullptr),
+	m_evictedSamples(0),
+	m_tail(0),
+	m_cachedHead(0),
+	m_tailGeneration(nullptr),
+	m_requestedEvictTo(0),
+	m_lastKeyFramePosition(0),
+	m_hasKeyFrame(false),
+	m_isWaitingForKeyFrame(false),
+	m_isOverflowing(false),
+	m_droppedSamples(0),
+	m_droppedKeyFrames(0),
+	m_overflowCount(0),
+	m_allocatedSlots(0),
+	m_evictTo(0)
+{
+	// An eighth of the ring is headroom for the samples pushed until the consumer has evicted.
+	m_softCapacity = m_capacity - m_capacity / 8;
+	m_maxSlotCount = roundUpToPowerOfTwo(m_capacity);
+
+	const auto slotCount = m_maxSlotCount < InitialSlotCount ? static_cast<size_t>(m_maxSlotCount) : InitialSlotCount;
+	m_headGeneration = new SlotGeneration(slotCount, 0);
+	m_tailGeneration = m_headGeneration;
+	m_allocatedSlots.store(slotCount, std::memory_order_relaxed);
+}
+
+MediaSampleRing::
+~MediaSampleRing()
+{
+	while (m_headGeneration)
+	{
+		const auto next = m_headGeneration->Next.load(std::memory_order_relaxed);
+		delete m_headGeneration;
+		m_headGeneration = next;
+	}
+}
+
+bool
+MediaSampleRing::
+Push(const std::shared_ptr<MediaSample>& mediaSample)
+{
+	auto queuedSample = mediaSample;
+	return Push(std::move(queuedSample));
+}
+
+bool
+MediaSampleRing::
+Push(std::shared_ptr<MediaSample>&& mediaSample)
+{
+	auto tail = m_tail.load(std::memory_order_relaxed);
+	if (!push(mediaSample, tail))
+	{
+		return false;
+	}
+
+	m_tail.store(tail, std::memory_order_release);
+	return true;
+}
+
+size_t
+MediaSampleRing::
+PushBatch(std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+{
+	const auto firstTail = m_tail.load(std::memory_order_relaxed);
+	auto tail = firstTail;
+	for (size_t index = 0; index < count; ++index)
+	{
+		push(mediaSamples[index], tail);
+	}
+
+	if (tail != firstTail)
+	{
+		m_tail.store(tail, std::memory_order_release);
+	}
+	return static_cast<size_t>(tail - firstTail);
+}
+
+bool
+MediaSampleRing::
+push(std::shared_ptr<MediaSample>& mediaSample, uint64_t& tail)
+{
+	const auto isKeyFrame = !m_isKeyFrameAware || mediaSample->GetIsKeyFrame();
+	if (m_isWaitingForKeyFrame)
+	{
+		if (!isKeyFrame)
+		{
+			m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		m_isWaitingForKeyFrame = false;
+	}
+
+	if (tail - m_cachedHead >= m_softCapacity)
+	{
+		m_cachedHead = m_head.load(std::memory_order_acquire);
+	}
+
+	const auto queuedSamples = tail - m_cachedHead;
+	if (queuedSamples < m_softCapacity)
+	{
+		m_isOverflowing = false;
+	}
+	else
+	{
+		if (!m_isOverflowing)
+		{
+			m_isOverflowing = true;
+			m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Ask the consumer to evict the oldest samples, 0 if there is no queued keyframe to evict to.
+		const auto isFull = queuedSamples >= m_capacity;
+		uint64_t evictTo = 0;
+		if (!m_isKeyFrameAware)
+		{
+			evictTo = tail - m_softCapacity / 2;
+		}
+		else if (isKeyFrame && !isFull)
+		{
+			evictTo = tail;
+		}
+		else if (m_hasKeyFrame && m_lastKeyFramePosition > m_cachedHead)
+		{
+			evictTo = m_lastKeyFramePosition;
+		}
+
+		if (evictTo > m_requestedEvictTo)
+		{
+			// The consumer may only evict published samples.
+			m_tail.store(tail, std::memory_order_release);
+			m_requestedEvictTo = evictTo;
+			m_evictTo.store(evictTo, std::memory_order_release);
+		}
+
+		// Delta frames only take headroom while the consumer has a keyframe to evict to.
+		if (isFull || (m_isKeyFrameAware && !isKeyFrame && evictTo == 0))
+		{
+			m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+			if (isKeyFrame && m_isKeyFrameAware)
+			{
+				m_droppedKeyFrames.fetch_add(1, std::memory_order_relaxed);
+			}
+			m_isWaitingForKeyFrame = m_isKeyFrameAware;
+			return false;
+		}
+	}
+
+	// The slot at tail is still queued from the last round when the queued samples fill the slots.
+	if (tail - m_cachedHead > m_tailGeneration->Mask)
+	{
+		m_cachedHead = m_head.load(std::memory_order_acquire);
+		if (tail - m_cachedHead > m_tailGeneration->Mask && m_tailGeneration->Mask + 1 < m_maxSlotCount)
+		{
+			grow(tail);
+		}
+	}
+
+	m_tailGeneration->Slots[static_cast<size_t>(tail & m_tailGeneration->Mask)] = std::move(mediaSample);
+	if (isKeyFrame)
+	{
+		m_lastKeyFramePosition = tail;
+		m_hasKeyFrame = true;
+	}
+	++tail;
+	return true;
+}
+
+std::shared_ptr<MediaSample>
+MediaSampleRing::
+Pop()
+{
+	const auto head = evict(m_head.load(std::memory_order_relaxed));
+	if (head >= m_cachedTail)
+	{
+		m_cachedTail = m_tail.load(std::memory_order_acquire);
+		if (head >= m_cachedTail)
+		{
+			return nullptr;
+		}
+	}
+
+	auto mediaSample = std::move(headSlot(head));
+	m_head.store(head + 1, std::memory_order_release);
+	return mediaSample;
+}
+
+size_t
+MediaSampleRing::
+PopBatch(std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount)
+{
+	auto head = evict(m_head.load(std::memory_order_relaxed));
+	if (head + maxCount > m_cachedTail)
+	{
+		m_cachedTail = m_tail.load(std::memory_order_acquire);
+		if (head >= m_cachedTail)
+		{
+			return 0;
+		}
+	}
+
+	const auto available = m_cachedTail - head;
+	const auto count = available < maxCount ? static_cast<size_t>(available) : maxCount;
+	for (size_t index = 0; index < count; ++index, ++head)
+	{
+		mediaSamples[index] = std::move(headSlot(head));
+	}
+	m_head.store(head, std::memory_order_release);
+	return count;
+}
+
+void
+MediaSampleRing::
+grow(uint64_t tail)
+{
+	const auto slotCount = static_cast<size_t>(m_tailGeneration->Mask + 1) * 2;
+	const auto generation = new SlotGeneration(slotCount, tail);
+	m_allocatedSlots.fetch_add(slotCount, std::memory_order_relaxed);
+
+	// Published to the consumer by the store to m_tail that publishes the sample at tail.
+	m_tailGeneration->Next.store(generation, std::memory_order_release);
+	m_tailGeneration = generation;
+}
+
+std::shared_ptr<MediaSample>&
+MediaSampleRing::
+headSlot(uint64_t position)
+{
+	// The positions before the next generation's start have all been popped or evicted.
+	auto next = m_headGeneration->Next.load(std::memory_order_acquire);
+	while (next && position >= next->Start)
+	{
+		m_allocatedSlots.fetch_sub(static_cast<size_t>(m_headGeneration->Mask + 1), std::memory_order_relaxed);
+		delete m_headGeneration;
+		m_headGeneration = next;
+		next = m_headGeneration->Next.load(std::memory_order_acquire);
+	}
+	return m_headGeneration->Slots[static_cast<size_t>(position & m_headGeneration->Mask)];
+}
+
+uint64_t
+MediaSampleRing::
+evict(uint64_t head)
+{
+	// The producer only asks for positions it has published, so the evicted slots are queued.
+	const auto evictTo = m_evictTo.load(std::memory_order_acquire);
+	if (evictTo <= head)
+	{
+		return head;
+	}
+
+	m_evictedSamples.fetch_add(evictTo - head, std::memory_order_relaxed);
+	for (; head < evictTo; ++head)
+	{
+		headSlot(head).reset();
+	}
+	m_head.store(head, std::memory_order_release);
+	return head;
+}
+
+MediaSampleRingStats
+MediaSampleRing::
+GetStats() const
+{
+	MediaSampleRingStats stats;
+	const auto head = m_head.load(std::memory_order_acquire);
+	const auto tail = m_tail.load(std::memory_order_acquire);
+	stats.QueuedSamples = tail > head ? static_cast<size_t>(tail - head) : 0;
+	stats.DroppedSamples = m_droppedSamples.load(std::memory_order_relaxed);
+	stats.DroppedKeyFrames = m_droppedKeyFrames.load(std::memory_order_relaxed);
+	stats.EvictedSamples = m_evictedSamples.load(std::memory_order_relaxed);
+	stats.OverflowCount = m_overflowCount.load(std::memory_order_relaxed);
+	stats.AllocatedSlots = m_allocatedSlots.load(std::memory_order_relaxed);
+	return stats;
+}
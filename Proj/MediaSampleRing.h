@@ -0,0 +1,263 @@
+///
+/// @class MediaSampleRing
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "MediaSample.h"
+
+namespace CvRtsp
+{
+	///
+	/// Overflow counters of a media sample ring.
+	struct MediaSampleRingStats
+	{
+		/// Samples currently queued.
+		size_t QueuedSamples = 0;
+
+		/// Samples dropped on push.
+		uint64_t DroppedSamples = 0;
+
+		/// Keyframes dropped on push, only when the consumer has not run for the whole headroom.
+		uint64_t DroppedKeyFrames = 0;
+
+		/// Queued samples evicted by the consumer to catch up.
+		uint64_t EvictedSamples = 0;
+
+		/// Number of times the ring filled up.
+		uint64_t OverflowCount = 0;
+
+		/// Slots currently allocated.
+		size_t AllocatedSlots = 0;
+	};
+
+	///
+	/// Bounded lock free single-producer, single-consumer ring of media samples.
+	///
+	/// The producer and the consumer indices live on separate cache lines and each side keeps a
+	/// cached copy of the other side's index, so that a push or a pop touches the shared lines only
+	/// when the cached index says the ring is full or empty.
+	///
+	/// Overflow policy: once the ring is filled up to its soft capacity the producer asks the
+	/// consumer to evict the oldest samples, down to the most recent keyframe (an incoming keyframe
+	/// evicts everything queued before it). The samples above the soft capacity are headroom, so that
+	/// keyframes are still queued until the consumer has evicted. Delta frames that cannot be queued
+	/// without a keyframe to evict to are dropped, together with all delta frames up to the next
+	/// keyframe since they could not be decoded. Without keyframe awareness (audio) every sample is
+	/// independent and the consumer evicts the older half of the queued samples.
+	///
+	/// The slots are allocated on demand: the ring starts with InitialSlotCount slots and the
+	/// producer doubles them whenever the queued samples fill them, up to the capacity. The samples
+	/// pushed from then on go to the new slots and the consumer frees the old ones once it has
+	/// popped past them, so growing does not stop either side.
+	///
+	/// Push() must only be called by one thread at a time, Pop() by one (other) thread at a time.
+	class MediaSampleRing
+	{
+	public:
+		/// Size of the cache lines the producer and consumer state is separated by. The state is
+		/// padded rather than aligned: the rings are members of heap allocated channels, which
+		/// new does not align beyond 16 bytes before C++17.
+		static const size_t CacheLineSize = 64;
+
+		/// Number of slots allocated by the constructor.
+		static const size_t InitialSlotCount = 64;
+
+		///
+		/// Constructor.
+		///
+		/// @param[in] capacity			Maximum number of queued samples.
+		/// @param[in] isKeyFrameAware	True if the samples depend on the preceding keyframe (video).
+		MediaSampleRing(size_t capacity, bool isKeyFrameAware);
+
+		///
+		/// Destructor.
+		~MediaSampleRing();
+
+		MediaSampleRing(const MediaSampleRing&) = delete;
+		MediaSampleRing& operator=(const MediaSampleRing&) = delete;
+
+		///
+		/// Queue a sample. Producer side.
+		///
+		/// @param[in] mediaSample Media sample.
+		///
+		/// @return False if the sample has been dropped.
+		bool Push(const std::shared_ptr<MediaSample>& mediaSample);
+
+		///
+		/// Queue a sample without touching its reference count. Producer side.
+		///
+		/// @param[in] mediaSample Media sample, moved from unless it is dropped.
+		///
+		/// @return False if the sample has been dropped.
+		bool Push(std::shared_ptr<MediaSample>&& mediaSample);
+
+		///
+		/// Queue samples without touching their reference counts and publish them to the consumer
+		/// at once. Producer side.
+		///
+		/// @param[in] mediaSamples	Media samples, moved from unless they are dropped.
+		/// @param[in] count		Number of samples.
+		///
+		/// @return Number of samples queued, the others have been dropped.
+		size_t PushBatch(std::shared_ptr<MediaSample>* mediaSamples, size_t count);
+
+		///
+		/// Take the oldest sample, after evicting the samples the producer asked for. Consumer side.
+		///
+		/// @return Media sample, nullptr if the ring is empty.
+		std::shared_ptr<MediaSample> Pop();
+
+		///
+		/// Take up to maxCount of the oldest samples with a single update of the consumer index,
+		/// after evicting the samples the producer asked for. Consumer side.
+		///
+		/// @param[out] mediaSamples	Receives the samples, room for maxCount.
+		/// @param[in] maxCount			Maximum number of samples.
+		///
+		/// @return Number of samples taken, 0 if the ring is empty.
+		size_t PopBatch(std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount);
+
+		///
+		/// Get the overflow counters, can be called from any thread.
+		///
+		/// @return Overflow counters.
+		MediaSampleRingStats GetStats() const;
+
+	private:
+		///
+		/// Slots of the positions from Start on, up to the Start of the next generation.
+		struct SlotGeneration
+		{
+			SlotGeneration(size_t slotCount, uint64_t start) :
+				Slots(new std::shared_ptr<MediaSample>[slotCount]),
+				Mask(slotCount - 1),
+				Start(start),
+				Next(nullptr)
+			{
+			}
+
+			/// Samples, indexed by position modulo the power of two size.
+			std::unique_ptr<std::shared_ptr<MediaSample>[]> Slots;
+
+			/// Slot index mask.
+			uint64_t Mask;
+
+			/// First position stored in these slots.
+			uint64_t Start;
+
+			/// Slots the producer moved on to, published before the positions stored in them.
+			std::atomic<SlotGeneration*> Next;
+		};
+
+		/// Largest number of slots, the capacity rounded up to a power of two.
+		uint64_t m_maxSlotCount;
+
+		/// Maximum number of queued samples.
+		uint64_t m_capacity;
+
+		/// Queued samples from which on the consumer is asked to evict.
+		uint64_t m_softCapacity;
+
+		/// Samples depend on the preceding keyframe.
+		bool m_isKeyFrameAware;
+
+		/// Keeps the consumer state off the line of the members above.
+		char m_consumerPadding[CacheLineSize];
+
+		/// Position of the next sample to pop, written by the consumer.
+		std::atomic<uint64_t> m_head;
+
+		/// Consumer's copy of m_tail.
+		uint64_t m_cachedTail;
+
+		/// Oldest slots, freed by the consumer once it has popped past them.
+		SlotGeneration* m_headGeneration;
+
+		/// Queued samples evicted by the consumer.
+		std::atomic<uint64_t> m_evictedSamples;
+
+		/// Keeps the producer state off the consumer's lines.
+		char m_producerPadding[CacheLineSize];
+
+		/// Position of the next sample to push, written by the producer.
+		std::atomic<uint64_t> m_tail;
+
+		/// Producer's copy of m_head.
+		uint64_t m_cachedHead;
+
+		/// Slots the producer stores to.
+		SlotGeneration* m_tailGeneration;
+
+		/// Producer's copy of m_evictTo.
+		uint64_t m_requestedEvictTo;
+
+		/// Position of the most recent keyframe pushed, valid if m_hasKeyFrame.
+		uint64_t m_lastKeyFramePosition;
+
+		/// Has a keyframe been pushed.
+		bool m_hasKeyFrame;
+
+		/// Delta frames are dropped until the next keyframe.
+		bool m_isWaitingForKeyFrame;
+
+		/// The ring is above its soft capacity, to count overflows once.
+		bool m_isOverflowing;
+
+		/// Samples dropped on push.
+		std::atomic<uint64_t> m_droppedSamples;
+
+		/// Keyframes dropped on push.
+		std::atomic<uint64_t> m_droppedKeyFrames;
+
+		/// Number of times the ring filled up.
+		std::atomic<uint64_t> m_overflowCount;
+
+		/// Slots currently allocated.
+		std::atomic<size_t> m_allocatedSlots;
+
+		/// Keeps the eviction request off the producer's lines.
+		char m_evictPadding[CacheLineSize];
+
+		/// Position up to which the consumer evicts, written by the producer.
+		std::atomic<uint64_t> m_evictTo;
+
+		/// Keeps the eviction request off the lines of whatever follows the ring.
+		char m_trailingPadding[CacheLineSize];
+
+		/// Apply the overflow policy and move a sample into the slot at tail. Producer side. The
+		/// sample is published by storing tail to m_tail, the samples before it are published
+		/// before the consumer is asked to evict.
+		///
+		/// @param[in] mediaSample	Media sample, moved from if queued.
+		/// @param[in,out] tail		Producer position, advanced if the sample is queued.
+		///
+		/// @return False if the sample has been dropped.
+		bool push(std::shared_ptr<MediaSample>& mediaSample, uint64_t& tail);
+
+		/// Move on to twice the slots, for the positions from tail on. Producer side.
+		///
+		/// @param[in] tail Producer position.
+		void grow(uint64_t tail);
+
+		/// Get the slot of a queued position, freeing the slots popped past. Consumer side.
+		///
+		/// @param[in] position Queued position, not below the positions asked for before.
+		///
+		/// @return Slot.
+		std::shared_ptr<MediaSample>& headSlot(uint64_t position);
+
+		/// Evict the samples the producer asked for. Consumer side.
+		///
+		/// @param[in] head Consumer position.
+		///
+		/// @return Consumer position after evicting.
+		uint64_t evict(uint64_t head);
+	};
+}
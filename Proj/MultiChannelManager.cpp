@@ -9,14 +9,29 @@
 
 using namespace CvRtsp;
 
+MultiChannelManager::
+MultiChannelManager() :
+	m_channels(new PacketManagerChannelMap())
+{
+}
+
+MultiChannelManager::
+~MultiChannelManager()
+{
+	delete m_channels.load(std::memory_order_relaxed);
+}
+
 void
 MultiChannelManager::
 SetVideoSourceId(const boost::uuids::uuid& channelId, const std::string& channelName, 
 	const uint32_t videoSourceId)
 {
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+	std::unique_ptr<PacketManagerChannelMap> channels(new PacketManagerChannelMap(*m_channels.load(std::memory_order_relaxed)));
+
 	// Do we have a packet-manager with the said <channelId, channelName> ?
-	const auto packetManager = m_packetManagerMediaChannelMap.find(std::make_pair(channelId, channelName));
-	if (packetManager != std::end(m_packetManagerMediaChannelMap))
+	const auto packetManager = channels->find(std::make_pair(channelId, channelName));
+	if (packetManager != std::end(*channels))
 	{
 		packetManager->second.SetVideoSourceId(videoSourceId);
 	}
@@ -25,8 +40,10 @@ SetVideoSourceId(const boost::uuids::uuid& channelId, const std::string& channel
 		// Create and associate packet-manager with the `channelName`.
 		PacketManager manager(channelId, channelName);
 		manager.SetVideoSourceId(videoSourceId);
-		m_packetManagerMediaChannelMap.emplace(std::make_pair(channelId, channelName), manager);
+		manager.GetPacketManager()->SetMediaArrivalSignal(m_mediaArrivalSignal);
+		channels->emplace(std::make_pair(channelId, channelName), manager);
 	}
+	publish(std::move(channels));
 }
 
 void
@@ -34,9 +51,12 @@ MultiChannelManager::
 SetAudioSourceId(const boost::uuids::uuid& channelId, const std::string& channelName, 
 	const uint32_t audioSourceId)
 {
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+	std::unique_ptr<PacketManagerChannelMap> channels(new PacketManagerChannelMap(*m_channels.load(std::memory_order_relaxed)));
+
 	// Do we have a packet-manager with the said  <channelId, channelName> ?
-	const auto packetManager = m_packetManagerMediaChannelMap.find(std::make_pair(channelId, channelName));
-	if (packetManager != std::end(m_packetManagerMediaChannelMap))
+	const auto packetManager = channels->find(std::make_pair(channelId, channelName));
+	if (packetManager != std::end(*channels))
 	{
 		packetManager->second.SetAudioSourceId(audioSourceId);
 	}
@@ -45,7 +65,79 @@ SetAudioSourceId(const boost::uuids::uuid& channelId, const std::string& channel
 		// Create and associate packet-manager with the <channelId, channelName> ?
 		PacketManager manager(channelId, channelName);
 		manager.SetAudioSourceId(audioSourceId);
-		m_packetManagerMediaChannelMap.emplace(std::make_pair(channelId, channelName), manager);
+		manager.GetPacketManager()->SetMediaArrivalSignal(m_mediaArrivalSignal);
+		channels->emplace(std::make_pair(channelId, channelName), manager);
+	}
+	publish(std::move(channels));
+}
+
+std::shared_ptr<PacketManagerMediaChannel>
+MultiChannelManager::
+AddChannel(const RtspChannel& channel, uint32_t videoSourceId, uint32_t audioSourceId)
+{
+	std::shared_ptr<PacketManagerMediaChannel> packetManager;
+	{
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		std::unique_ptr<PacketManagerChannelMap> channels(new PacketManagerChannelMap(*m_channels.load(std::memory_order_relaxed)));
+
+		const auto key = std::make_pair(channel.ChannelId, channel.ChannelName);
+		auto manager = channels->find(key);
+		if (manager == std::end(*channels))
+		{
+			manager = channels->emplace(key, PacketManager(channel.ChannelId, channel.ChannelName)).first;
+			manager->second.GetPacketManager()->SetMediaArrivalSignal(m_mediaArrivalSignal);
+		}
+		if (videoSourceId != UINT_MAX)
+		{
+			manager->second.SetVideoSourceId(videoSourceId);
+		}
+		if (audioSourceId != UINT_MAX)
+		{
+			manager->second.SetAudioSourceId(audioSourceId);
+		}
+		if (channel.IsCameraSourceShared)
+		{
+			manager->second.SetCameraId(channel.CameraId);
+		}
+		packetManager = manager->second.GetPacketManager();
+		publish(std::move(channels));
+	}
+
+	// Waits for samples being handed on, outside of the lock.
+	if (channel.IsCameraSourceShared)
+	{
+		m_cameraSources.Subscribe(channel.CameraId, packetManager);
+	}
+	return packetManager;
+}
+
+void
+MultiChannelManager::
+RemoveChannel(const boost::uuids::uuid& channelId, const std::string& channelName)
+{
+	std::shared_ptr<PacketManagerMediaChannel> cameraSubscriber;
+	unsigned cameraId = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		std::unique_ptr<PacketManagerChannelMap> channels(new PacketManagerChannelMap(*m_channels.load(std::memory_order_relaxed)));
+		const auto manager = channels->find(std::make_pair(channelId, channelName));
+		if (manager == std::end(*channels))
+		{
+			return;
+		}
+
+		if (manager->second.IsCameraSourceShared())
+		{
+			cameraSubscriber = manager->second.GetPacketManager();
+			cameraId = manager->second.GetCameraId();
+		}
+		channels->erase(manager);
+		publish(std::move(channels));
+	}
+
+	if (cameraSubscriber)
+	{
+		m_cameraSources.Unsubscribe(cameraId, cameraSubscriber);
 	}
 }
 
@@ -54,8 +146,10 @@ MultiChannelManager::
 GetPacketManager(const boost::uuids::uuid &channelId,
 	const std::string &channelName) const
 {
-	const auto packetManagerIt = m_packetManagerMediaChannelMap.find(std::make_pair(channelId, channelName));
-	if (packetManagerIt != std::cend(m_packetManagerMediaChannelMap))
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	const auto& channels = *m_channels.load(std::memory_order_seq_cst);
+	const auto packetManagerIt = channels.find(std::make_pair(channelId, channelName));
+	if (packetManagerIt != std::cend(channels))
 	{
 		return packetManagerIt->second.GetPacketManager();
 	}
@@ -68,8 +162,10 @@ MultiChannelManager::
 GetMedia(const boost::uuids::uuid& channelId, const std::string& channelName,
 	uint32_t sourceId)
 {
-	const auto packetManager = m_packetManagerMediaChannelMap.find(std::make_pair(channelId, channelName));
-	if (packetManager != std::end(m_packetManagerMediaChannelMap))
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	const auto& channels = *m_channels.load(std::memory_order_seq_cst);
+	const auto packetManager = channels.find(std::make_pair(channelId, channelName));
+	if (packetManager != std::end(channels))
 	{
 		if (sourceId == packetManager->second.GetVideoSourceId())
 		{
@@ -84,3 +180,96 @@ GetMedia(const boost::uuids::uuid& channelId, const std::string& channelName,
 	//assert(false);
 	return nullptr;
 }
+
+size_t
+MultiChannelManager::
+GetMediaBatch(const boost::uuids::uuid& channelId, const std::string& channelName,
+	uint32_t sourceId, std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount)
+{
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	const auto& channels = *m_channels.load(std::memory_order_seq_cst);
+	const auto packetManager = channels.find(std::make_pair(channelId, channelName));
+	if (packetManager != std::end(channels))
+	{
+		if (sourceId == packetManager->second.GetVideoSourceId())
+		{
+			return packetManager->second.GetPacketManager()->GetVideoBatch(mediaSamples, maxCount);
+		}
+		if (sourceId == packetManager->second.GetAudioSourceId())
+		{
+			return packetManager->second.GetPacketManager()->GetAudioBatch(mediaSamples, maxCount);
+		}
+	}
+
+	return 0;
+}
+
+MediaQueueHandle
+MultiChannelManager::
+ResolveMediaQueue(const boost::uuids::uuid& channelId, const std::string& channelName,
+	uint32_t sourceId)
+{
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	const auto& channels = *m_channels.load(std::memory_order_seq_cst);
+	const auto packetManager = channels.find(std::make_pair(channelId, channelName));
+	if (packetManager != std::end(channels))
+	{
+		if (sourceId == packetManager->second.GetVideoSourceId())
+		{
+			return MediaQueueHandle(packetManager->second.GetPacketManager(), true);
+		}
+		if (sourceId == packetManager->second.GetAudioSourceId())
+		{
+			return MediaQueueHandle(packetManager->second.GetPacketManager(), false);
+		}
+	}
+
+	return MediaQueueHandle();
+}
+
+void
+MultiChannelManager::
+SetMediaArrivalSignal(MediaArrivalSignal* mediaArrivalSignal)
+{
+	std::lock_guard<std::mutex> lock(m_writeMutex);
+	ChannelManager::SetMediaArrivalSignal(mediaArrivalSignal);
+	for (const auto& packetManager : *m_channels.load(std::memory_order_relaxed))
+	{
+		packetManager.second.GetPacketManager()->SetMediaArrivalSignal(mediaArrivalSignal);
+	}
+}
+
+void
+MultiChannelManager::
+SetWatcherCount(const boost::uuids::uuid& channelId, const std::string& channelName, uint32_t sourceId,
+	uint32_t watcherCount)
+{
+	EpochReclaimer::ReadGuard guard(m_reclaimer);
+	const auto& channels = *m_channels.load(std::memory_order_seq_cst);
+	const auto packetManager = channels.find(std::make_pair(channelId, channelName));
+	if (packetManager == std::end(channels))
+	{
+		return;
+	}
+
+	if (sourceId == packetManager->second.GetVideoSourceId())
+	{
+		packetManager->second.GetPacketManager()->SetWatcherCount(true, watcherCount);
+	}
+	else if (sourceId == packetManager->second.GetAudioSourceId())
+	{
+		packetManager->second.GetPacketManager()->SetWatcherCount(false, watcherCount);
+	}
+}
+
+void
+MultiChannelManager::
+publish(std::unique_ptr<PacketManagerChannelMap> channels)
+{
+	const std::unique_ptr<const PacketManagerChannelMap> previousChannels(
+		m_channels.exchange(channels.release(), std::memory_order_seq_cst));
+	invalidateMediaQueues();
+
+	// Readers may still be looking at the previous map, the packet managers themselves are shared.
+	m_reclaimer.Synchronize();
+}
@@ -5,11 +5,16 @@
 /// Modified by: M. Kinzer
 ///
 #pragma once
+#include <atomic>
 #include <climits>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "LiveRtspServer.h"
+#include "CameraSourceRegistry.h"
 #include "ChannelManager.h"
+#include "EpochReclaimer.h"
 #include "PacketManagerMediaChannel.h"
 
 namespace CvRtsp
@@ -22,6 +27,8 @@ namespace CvRtsp
 		PacketManager(const boost::uuids::uuid& channelId, const std::string& channelName) :
 			m_videoSourceId(UINT_MAX),
 			m_audioSourceId(UINT_MAX),
+			m_cameraId(0),
+			m_isCameraSourceShared(false),
 			m_packetManager(std::make_shared<PacketManagerMediaChannel>(channelId, channelName))
 		{
 		}
@@ -50,7 +57,7 @@ namespace CvRtsp
 		/// Get the video source id.
 		///
 		/// @return Video source id.
-		uint32_t GetVideoSourceId()
+		uint32_t GetVideoSourceId() const
 		{
 			return m_videoSourceId;
 		}
@@ -59,11 +66,39 @@ namespace CvRtsp
 		/// Get the audio source id.
 		///
 		/// @return Audio source id.
-		uint32_t GetAudioSourceId()
+		uint32_t GetAudioSourceId() const
 		{
 			return m_audioSourceId;
 		}
 
+		///
+		/// Set the camera whose shared source feeds the packet manager.
+		///
+		/// @param cameraId Camera id.
+		void SetCameraId(unsigned cameraId)
+		{
+			m_cameraId = cameraId;
+			m_isCameraSourceShared = true;
+		}
+
+		///
+		/// Is the packet manager fed by the shared source of a camera.
+		///
+		/// @return True if subscribed to the camera's source.
+		bool IsCameraSourceShared() const
+		{
+			return m_isCameraSourceShared;
+		}
+
+		///
+		/// Get the camera whose shared source feeds the packet manager.
+		///
+		/// @return Camera id, only valid if IsCameraSourceShared().
+		unsigned GetCameraId() const
+		{
+			return m_cameraId;
+		}
+
 		///
 		/// Get the packet manager for this channel manager.
 		///
@@ -89,6 +124,12 @@ namespace CvRtsp
 		/// Audio source id.
 		uint32_t m_audioSourceId;
 
+		/// Camera whose shared source feeds the packet manager.
+		unsigned m_cameraId;
+
+		/// True if the packet manager is subscribed to the camera's source.
+		bool m_isCameraSourceShared;
+
 		/// Packet manager.
 		std::shared_ptr<PacketManagerMediaChannel> m_packetManager;
 	};
@@ -97,12 +138,23 @@ namespace CvRtsp
 	/// This class manages a single channel with audio and video.
 	/// The channel id is not used much here. It is however needed when there are 
 	/// multiple channels that supply the task manager with data.
+	///
+	/// Channels can be added and removed while the task scheduler reads media: the channel map is
+	/// never modified in place. Writers copy it, publish the copy and free the previous map once
+	/// no reader can still be looking at it (EpochReclaimer), so lookups take no locks.
 	class MultiChannelManager : public ChannelManager
 	{
 	public:
 		///
 		/// Default constructor.
-		MultiChannelManager() = default;
+		MultiChannelManager();
+
+		///
+		/// Destructor.
+		~MultiChannelManager() override;
+
+		MultiChannelManager(const MultiChannelManager&) = delete;
+		MultiChannelManager& operator=(const MultiChannelManager&) = delete;
 
 		/// 
 		/// Set the video source id.
@@ -124,6 +176,35 @@ namespace CvRtsp
 		void SetAudioSourceId(const boost::uuids::uuid &channelId, const std::string& channelName, 
 			const uint32_t audioSourceId);
 
+		///
+		/// Add the packet manager of a channel. If the channel shares the source of its camera
+		/// (RtspChannel::IsCameraSourceShared) the packet manager is subscribed to the camera's
+		/// source in GetCameraSourceRegistry(), until the channel is removed.
+		///
+		/// @param[in] channel			Channel description.
+		/// @param[in] videoSourceId	Video source id, UINT_MAX if the channel has no video.
+		/// @param[in] audioSourceId	Audio source id, UINT_MAX if the channel has no audio.
+		///
+		/// @return Media channel packet manager.
+		std::shared_ptr<PacketManagerMediaChannel> AddChannel(const RtspChannel& channel, uint32_t videoSourceId,
+			uint32_t audioSourceId);
+
+		///
+		/// Remove the packet manager of a channel, unsubscribing it from its camera's source.
+		///
+		/// @param[in] channelId	Unique channel id.
+		/// @param[in] channelName	Channel name.
+		void RemoveChannel(const boost::uuids::uuid& channelId, const std::string& channelName);
+
+		///
+		/// Shared per-camera sources of the channels added with AddChannel().
+		///
+		/// @return Camera source registry.
+		CameraSourceRegistry& GetCameraSourceRegistry()
+		{
+			return m_cameraSources;
+		}
+
 		///
 		/// Get the packet manager for this channel.
 		///
@@ -143,11 +224,69 @@ namespace CvRtsp
 		std::shared_ptr<MediaSample> GetMedia(const boost::uuids::uuid& channelId, const std::string& channelName, 
 			uint32_t sourceId) override;
 
+		///
+		/// Get up to maxCount media samples with a single channel lookup.
+		///
+		/// @param channelId	Unique channel id.
+		/// @param channelName	Channel name.
+		/// @param sourceId		Source id.
+		/// @param mediaSamples	Receives the samples, room for maxCount.
+		/// @param maxCount		Maximum number of samples.
+		///
+		/// @return Number of samples returned.
+		size_t GetMediaBatch(const boost::uuids::uuid& channelId, const std::string& channelName,
+			uint32_t sourceId, std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount) override;
+
+		///
+		/// Resolve the video or audio queue of a channel's packet manager.
+		///
+		/// @param channelId	Unique channel id.
+		/// @param channelName	Channel name.
+		/// @param sourceId		Source id.
+		///
+		/// @return Media queue handle, invalid if the channel or source id is unknown.
+		MediaQueueHandle ResolveMediaQueue(const boost::uuids::uuid& channelId, const std::string& channelName,
+			uint32_t sourceId) override;
+
+		///
+		/// Set the media arrival signal on all current and future packet managers.
+		///
+		/// @param[in] mediaArrivalSignal Signal of the task scheduler, nullptr to detach.
+		void SetMediaArrivalSignal(MediaArrivalSignal* mediaArrivalSignal) override;
+
+		///
+		/// Report the number of consumers of a channel's source to its packet manager.
+		///
+		/// @param channelId	Unique channel id.
+		/// @param channelName	Channel name.
+		/// @param sourceId		Source id.
+		/// @param watcherCount	Number of consumers.
+		void SetWatcherCount(const boost::uuids::uuid& channelId, const std::string& channelName,
+			uint32_t sourceId, uint32_t watcherCount) override;
+
 	protected:
 		///
 		/// Alias that maps a packet-manager related to particular pair <channelid, channelName>.
 		using PacketManagerChannelMap = std::map<UniqueChannelSessionIdentifier, PacketManager>;
 
-		PacketManagerChannelMap m_packetManagerMediaChannelMap;
+		/// Current channel map, replaced as a whole by writers.
+		std::atomic<const PacketManagerChannelMap*> m_channels;
+
+		/// Protects readers of previous channel maps.
+		mutable EpochReclaimer m_reclaimer;
+
+		/// Serializes writers.
+		std::mutex m_writeMutex;
+
+		/// Shared per-camera sources.
+		CameraSourceRegistry m_cameraSources;
+
+	private:
+		///
+		/// Publish a new channel map and free the previous one once no reader uses it anymore.
+		/// Must be called with m_writeMutex held.
+		///
+		/// @param[in] channels New channel map.
+		void publish(std::unique_ptr<PacketManagerChannelMap> channels);
 	};
 }
@@ -30,10 +30,12 @@ using namespace CvRtsp;
 
 PacketManagerMediaChannel::
 PacketManagerMediaChannel(const boost::uuids::uuid& channelId, const std::string& channelName):
-	MediaChannel(channelId, channelName)
+	MediaChannel(channelId, channelName),
+	m_videoSamples(QueueCapacity, true),
+	m_audioSamples(QueueCapacity, false),
+	m_videoReadiness(std::make_shared<MediaQueueReadiness>()),
+	m_audioReadiness(std::make_shared<MediaQueueReadiness>())
 {
-	m_videoSamples.set_capacity(QueueCapacity);
-	m_audioSamples.set_capacity(QueueCapacity);
 }
 
 bool
@@ -41,12 +43,14 @@ PacketManagerMediaChannel::
 deliverVideo(const boost::uuids::uuid& channelId, const std::string& channelName,
 	const std::vector<std::shared_ptr<MediaSample>>& mediaSamples)
 {
+	auto isDelivered = true;
 	for (const auto& mediaSample : mediaSamples)
 	{
-		m_videoSamples.try_push(mediaSample);
+		isDelivered = m_videoSamples.Push(mediaSample) && isDelivered;
 	}
+	m_videoReadiness->Notify();
 
-	return true;
+	return isDelivered;
 }
 
 bool
@@ -54,33 +58,62 @@ PacketManagerMediaChannel::
 deliverAudio(const boost::uuids::uuid& channelId, const std::string& channelName,
 	const std::vector<std::shared_ptr<MediaSample>>& mediaSamples)
 {
+	auto isDelivered = true;
 	for (const auto& mediaSample : mediaSamples)
 	{
-		m_audioSamples.try_push(mediaSample);
+		isDelivered = m_audioSamples.Push(mediaSample) && isDelivered;
 	}
-	return true;
+	m_audioReadiness->Notify();
+	return isDelivered;
+}
+
+bool
+PacketManagerMediaChannel::
+deliverMovedVideo(const boost::uuids::uuid& channelId, const std::string& channelName,
+	std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+{
+	const auto isDelivered = m_videoSamples.PushBatch(mediaSamples, count) == count;
+	m_videoReadiness->Notify();
+	return isDelivered;
+}
+
+bool
+PacketManagerMediaChannel::
+deliverMovedAudio(const boost::uuids::uuid& channelId, const std::string& channelName,
+	std::shared_ptr<MediaSample>* mediaSamples, size_t count)
+{
+	const auto isDelivered = m_audioSamples.PushBatch(mediaSamples, count) == count;
+	m_audioReadiness->Notify();
+	return isDelivered;
 }
 
 std::shared_ptr<MediaSample>
 PacketManagerMediaChannel::
 GetVideo()
 {
-	std::shared_ptr<MediaSample> mediaSample;
-	if (m_videoSamples.try_pop(mediaSample))
+	auto mediaSample = m_videoSamples.Pop();
+	if (mediaSample)
 	{
-		return mediaSample;
+		onDequeued(true);
 	}
-	return nullptr;
+	return mediaSample;
 }
 
 std::shared_ptr<MediaSample>
 PacketManagerMediaChannel::
 GetAudio()
 {
-	std::shared_ptr<MediaSample> mediaSample;
-	if (m_audioSamples.try_pop(mediaSample))
+	auto mediaSample = m_audioSamples.Pop();
+	if (mediaSample)
 	{
-		return mediaSample;
+		onDequeued(false);
 	}
-	return nullptr;
+	return mediaSample;
+}
+
+size_t
+PacketManagerMediaChannel::
+getQueuedCount(bool isVideo) const
+{
+	return (isVideo ? m_videoSamples : m_audioSamples).GetStats().QueuedSamples;
 }
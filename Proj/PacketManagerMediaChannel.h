@@ -24,18 +24,21 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 ///
 #pragma once
 
-#include <tbb/concurrent_queue.h>
 #include <boost/uuid/uuid.hpp>
 
 #include "MediaChannel.h"
+#include "MediaReadyList.h"
+#include "MediaSampleRing.h"
 
 namespace CvRtsp
 {
 	///
 	/// Implementation of packet manager-based media channel
 	///
-	/// This implementation will use the lock-free queue implementations
-	/// of the tbb libraries.
+	/// Video and audio samples are each queued in a lock-free single-producer, single-consumer
+	/// ring: samples of a direction must be added by one thread at a time and are taken by the
+	/// event loop. When a ring fills up the oldest samples are evicted down to the most recent
+	/// keyframe instead of dropping the newest ones.
 	class PacketManagerMediaChannel : public MediaChannel
 	{
 	public:
@@ -55,15 +58,99 @@ namespace CvRtsp
 		/// @return Media sample, if found, nullptr if not.
 		std::shared_ptr<MediaSample> GetAudio();
 
+		///
+		/// Take up to maxCount video samples in one go.
+		///
+		/// @param[out] mediaSamples	Receives the samples, room for maxCount.
+		/// @param[in] maxCount			Maximum number of samples.
+		///
+		/// @return Number of samples taken.
+		size_t GetVideoBatch(std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount)
+		{
+			const auto count = m_videoSamples.PopBatch(mediaSamples, maxCount);
+			if (count != 0)
+			{
+				onDequeued(true);
+			}
+			return count;
+		}
+
+		///
+		/// Take up to maxCount audio samples in one go.
+		///
+		/// @param[out] mediaSamples	Receives the samples, room for maxCount.
+		/// @param[in] maxCount			Maximum number of samples.
+		///
+		/// @return Number of samples taken.
+		size_t GetAudioBatch(std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount)
+		{
+			const auto count = m_audioSamples.PopBatch(mediaSamples, maxCount);
+			if (count != 0)
+			{
+				onDequeued(false);
+			}
+			return count;
+		}
+
+		///
+		/// Readiness of the video queue, notified whenever video samples are added.
+		///
+		/// @return Video queue readiness.
+		std::shared_ptr<MediaQueueReadiness> GetVideoReadiness() const
+		{
+			return m_videoReadiness;
+		}
+
+		///
+		/// Readiness of the audio queue, notified whenever audio samples are added.
+		///
+		/// @return Audio queue readiness.
+		std::shared_ptr<MediaQueueReadiness> GetAudioReadiness() const
+		{
+			return m_audioReadiness;
+		}
+
+		///
+		/// Overflow counters of the video queue.
+		///
+		/// @return Video queue counters.
+		MediaSampleRingStats GetVideoStats() const
+		{
+			return m_videoSamples.GetStats();
+		}
+
+		///
+		/// Overflow counters of the audio queue.
+		///
+		/// @return Audio queue counters.
+		MediaSampleRingStats GetAudioStats() const
+		{
+			return m_audioSamples.GetStats();
+		}
+
 	private:
-		/// Queue maximum capacity.
-		const int QueueCapacity = 10240;
+		/// Queue maximum capacity, the rings allocate their slots as they fill up.
+		static const size_t QueueCapacity = 10240;
+
+		/// Lock free ring to store video media samples.
+		MediaSampleRing m_videoSamples;
 
-		/// Lock free queue to store video media samples.
-		tbb::concurrent_bounded_queue<std::shared_ptr<MediaSample>> m_videoSamples;
+		/// Lock free ring to store audio media samples.
+		MediaSampleRing m_audioSamples;
 
-		/// Lock free queue to store audio media samples.
-		tbb::concurrent_bounded_queue<std::shared_ptr<MediaSample>> m_audioSamples;
+		/// Puts the video queue on the task scheduler's ready list.
+		std::shared_ptr<MediaQueueReadiness> m_videoReadiness;
+
+		/// Puts the audio queue on the task scheduler's ready list.
+		std::shared_ptr<MediaQueueReadiness> m_audioReadiness;
+
+		///
+		/// Samples of a direction waiting in its ring.
+		///
+		/// @param[in] isVideo True for the video ring.
+		///
+		/// @return Queued samples.
+		size_t getQueuedCount(bool isVideo) const override;
 
 		///
 		/// The subclass must implement delivery of video media samples to the media sink.
@@ -71,7 +158,7 @@ namespace CvRtsp
 		/// @param[in] channelId		Unique channel id.
 		/// @param[in] mediaSamples		Media samples to send.
 		///
-		/// @return True if sample sent.
+		/// @return False if samples have been dropped.
 		bool deliverVideo(const boost::uuids::uuid& channelId, const std::string &channelName, const std::vector<std::shared_ptr<MediaSample>>& mediaSamples) override;
 
 		///
@@ -80,7 +167,29 @@ namespace CvRtsp
 		/// @param[in] channelId Channel id.
 		/// @param[in] mediaSamples Media samples to send.
 		///
-		/// @return True if sample sent.
+		/// @return False if samples have been dropped.
 		bool deliverAudio(const boost::uuids::uuid& channelId, const std::string& channelName, const std::vector<std::shared_ptr<MediaSample>>& mediaSamples) override;
+
+		///
+		/// Moves the video samples into the ring and publishes them at once.
+		///
+		/// @param[in] channelId		Unique channel id.
+		/// @param[in] mediaSamples		Media samples to send, moved from.
+		/// @param[in] count			Number of samples.
+		///
+		/// @return False if samples have been dropped.
+		bool deliverMovedVideo(const boost::uuids::uuid& channelId, const std::string& channelName,
+			std::shared_ptr<MediaSample>* mediaSamples, size_t count) override;
+
+		///
+		/// Moves the audio samples into the ring and publishes them at once.
+		///
+		/// @param[in] channelId		Unique channel id.
+		/// @param[in] mediaSamples		Media samples to send, moved from.
+		/// @param[in] count			Number of samples.
+		///
+		/// @return False if samples have been dropped.
+		bool deliverMovedAudio(const boost::uuids::uuid& channelId, const std::string& channelName,
+			std::shared_ptr<MediaSample>* mediaSamples, size_t count) override;
 	};
 }
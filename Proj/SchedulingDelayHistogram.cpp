@@ -0,0 +1,75 @@
+///
+/// @class SchedulingDelayHistogram
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "SchedulingDelayHistogram.h"
+
+using namespace CvRtsp;
+
+SchedulingDelayHistogram::
+SchedulingDelayHistogram()
+{
+	Reset();
+}
+
+void
+SchedulingDelayHistogram::
+Add(uint64_t delayMicroSec)
+{
+	// Bucket index is the bit length of the delay.
+	size_t bucket = 0;
+	for (auto delay = delayMicroSec; delay != 0 && bucket + 1 < BucketCount; delay >>= 1)
+	{
+		++bucket;
+	}
+
+	m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	m_sampleCount.fetch_add(1, std::memory_order_relaxed);
+
+	// Single writer, so a plain compare is enough.
+	if (delayMicroSec > m_maxDelayMicroSec.load(std::memory_order_relaxed))
+	{
+		m_maxDelayMicroSec.store(delayMicroSec, std::memory_order_relaxed);
+	}
+}
+
+void
+SchedulingDelayHistogram::
+Reset()
+{
+	for (auto& bucket : m_buckets)
+	{
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	m_sampleCount.store(0, std::memory_order_relaxed);
+	m_maxDelayMicroSec.store(0, std::memory_order_relaxed);
+}
+
+uint64_t
+SchedulingDelayHistogram::
+GetPercentile(double percentile) const
+{
+	const auto sampleCount = GetSampleCount();
+	if (sampleCount == 0)
+	{
+		return 0;
+	}
+
+	const auto rank = static_cast<uint64_t>(percentile / 100.0 * sampleCount);
+	uint64_t counted = 0;
+	for (size_t bucket = 0; bucket < BucketCount; ++bucket)
+	{
+		counted += GetBucketCount(bucket);
+		if (counted > rank || bucket + 1 == BucketCount)
+		{
+			const auto upperBound = GetBucketUpperBound(bucket);
+			const auto maxDelay = GetMaxDelay();
+			return upperBound < maxDelay ? upperBound : maxDelay;
+		}
+	}
+
+	return GetMaxDelay();
+}
@@ -0,0 +1,102 @@
+///
+/// @class SchedulingDelayHistogram
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace CvRtsp
+{
+	///
+	/// Histogram of the time media samples wait in their channel queue before the event loop picks them up.
+	///
+	/// Buckets are powers of two in microseconds: bucket 0 counts delays below 1 us, bucket i counts
+	/// delays in [2^(i-1), 2^i) us, and the last bucket also counts everything above. One thread adds
+	/// delays, any thread may read the counters.
+	class SchedulingDelayHistogram
+	{
+	public:
+		/// Number of buckets, the last one starts at about 4.2 seconds.
+		static const size_t BucketCount = 24;
+
+		///
+		/// Constructor.
+		SchedulingDelayHistogram();
+
+		SchedulingDelayHistogram(const SchedulingDelayHistogram&) = delete;
+		SchedulingDelayHistogram& operator=(const SchedulingDelayHistogram&) = delete;
+
+		///
+		/// Count a scheduling delay.
+		///
+		/// @param[in] delayMicroSec Scheduling delay in microseconds.
+		void Add(uint64_t delayMicroSec);
+
+		///
+		/// Clear all counters.
+		void Reset();
+
+		///
+		/// Get the number of delays counted in a bucket.
+		///
+		/// @param[in] bucket Bucket index, less than BucketCount.
+		///
+		/// @return Number of delays.
+		uint64_t GetBucketCount(size_t bucket) const
+		{
+			return m_buckets[bucket].load(std::memory_order_relaxed);
+		}
+
+		///
+		/// Get the exclusive upper bound of a bucket.
+		///
+		/// @param[in] bucket Bucket index, less than BucketCount.
+		///
+		/// @return Upper bound in microseconds, UINT64_MAX for the last bucket.
+		static uint64_t GetBucketUpperBound(size_t bucket)
+		{
+			return bucket + 1 < BucketCount ? 1ull << bucket : UINT64_MAX;
+		}
+
+		///
+		/// Get the total number of delays counted.
+		///
+		/// @return Number of delays.
+		uint64_t GetSampleCount() const
+		{
+			return m_sampleCount.load(std::memory_order_relaxed);
+		}
+
+		///
+		/// Get the largest delay counted.
+		///
+		/// @return Largest delay in microseconds.
+		uint64_t GetMaxDelay() const
+		{
+			return m_maxDelayMicroSec.load(std::memory_order_relaxed);
+		}
+
+		///
+		/// Estimate a percentile of the delays.
+		///
+		/// @param[in] percentile Percentile in the range [0, 100].
+		///
+		/// @return Upper bound of the bucket the percentile falls into in microseconds, capped
+		/// at the largest delay counted. 0 if nothing has been counted.
+		uint64_t GetPercentile(double percentile) const;
+
+	private:
+		/// Delay counts per bucket.
+		std::array<std::atomic<uint64_t>, BucketCount> m_buckets;
+
+		/// Total number of delays counted.
+		std::atomic<uint64_t> m_sampleCount;
+
+		/// Largest delay counted.
+		std::atomic<uint64_t> m_maxDelayMicroSec;
+	};
+}
@@ -0,0 +1,422 @@
+///
+/// @class SegmentStore
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "SegmentStore.h"
+
+using namespace CvRtsp;
+
+#if defined(_WIN32)
+/// Separates the directory from the file name of the segment files.
+static const char* const PathSeparator = "\\";
+
+/// Error of the last failed call, for the log.
+static unsigned long
+getLastError()
+{
+	return GetLastError();
+}
+
+/// Id of the process, part of the file names.
+static unsigned long
+getProcessId()
+{
+	return GetCurrentProcessId();
+}
+#else
+static const char* const PathSeparator = "/";
+
+static int
+getLastError()
+{
+	return errno;
+}
+
+static int
+getProcessId()
+{
+	return static_cast<int>(getpid());
+}
+#endif
+
+///
+/// Segment file mapped into memory, written front to back.
+class SegmentStore::Segment
+{
+public:
+	Segment() :
+#if defined(_WIN32)
+		m_file(INVALID_HANDLE_VALUE),
+		m_mapping(nullptr),
+#else
+		m_file(-1),
+#endif
+		m_data(nullptr),
+		m_size(0),
+		m_usedBytes(0)
+	{
+	}
+
+	~Segment()
+	{
+#if defined(_WIN32)
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping)
+		{
+			CloseHandle(m_mapping);
+		}
+		if (m_file != INVALID_HANDLE_VALUE)
+		{
+			// Deletes the file.
+			CloseHandle(m_file);
+		}
+#else
+		if (m_data)
+		{
+			munmap(m_data, m_size);
+		}
+		if (m_file >= 0)
+		{
+			// The file has been unlinked when it was opened, closing it frees the space.
+			close(m_file);
+		}
+#endif
+	}
+
+	Segment(const Segment&) = delete;
+	Segment& operator=(const Segment&) = delete;
+
+	///
+	/// Create the file and map it.
+	///
+	/// @param[in] path Path of the file.
+	/// @param[in] size Size of the file.
+	///
+	/// @return False on failure, see getLastError().
+	bool Open(const std::string& path, size_t size)
+	{
+#if defined(_WIN32)
+		// A temporary file is only written back when the system is short of memory.
+		m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+			CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		const auto mappingSize = static_cast<uint64_t>(size);
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE,
+			static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize), nullptr);
+		if (!m_mapping)
+		{
+			return false;
+		}
+
+		m_data = static_cast<BYTE*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, size));
+		m_size = size;
+		return m_data != nullptr;
+#else
+		m_file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+		if (m_file < 0)
+		{
+			return false;
+		}
+
+		// As FILE_FLAG_DELETE_ON_CLOSE: the file goes away with the last descriptor, also after a crash.
+		unlink(path.c_str());
+		if (ftruncate(m_file, static_cast<off_t>(size)) != 0)
+		{
+			return false;
+		}
+
+		const auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+		if (data == MAP_FAILED)
+		{
+			return false;
+		}
+		m_data = static_cast<BYTE*>(data);
+		m_size = size;
+		return true;
+#endif
+	}
+
+	///
+	/// Copy a sample into the segment.
+	///
+	/// @param[in] data Sample data.
+	/// @param[in] size Sample size, at most GetFreeBytes().
+	/// @param[in] time Recording time.
+	///
+	/// @return Offset of the sample.
+	uint32_t Append(const BYTE* data, size_t size, Clock::time_point time)
+	{
+		assert(size <= GetFreeBytes());
+		const auto offset = m_usedBytes;
+		memcpy(m_data + offset, data, size);
+		m_usedBytes += size;
+		m_lastTime = time;
+		return static_cast<uint32_t>(offset);
+	}
+
+	///
+	/// Get the mapped data.
+	///
+	/// @return Start of the segment.
+	BYTE* GetData() const
+	{
+		return m_data;
+	}
+
+	///
+	/// Get the number of bytes left.
+	///
+	/// @return Free bytes.
+	size_t GetFreeBytes() const
+	{
+		return m_size - m_usedBytes;
+	}
+
+	///
+	/// Get the recording time of the newest sample.
+	///
+	/// @return Recording time.
+	Clock::time_point GetLastTime() const
+	{
+		return m_lastTime;
+	}
+
+private:
+#if defined(_WIN32)
+	/// File handle.
+	HANDLE m_file;
+
+	/// File mapping handle.
+	HANDLE m_mapping;
+#else
+	/// File descriptor.
+	int m_file;
+#endif
+
+	/// Mapped view of the whole file.
+	BYTE* m_data;
+
+	/// Size of the file.
+	size_t m_size;
+
+	/// Bytes written.
+	size_t m_usedBytes;
+
+	/// Recording time of the newest sample.
+	Clock::time_point m_lastTime;
+};
+
+/// Makes the file names of the stores of a process unique.
+static std::atomic<uint32_t> NextStoreId(0);
+
+SegmentStore::
+SegmentStore(const std::string& directory, const std::string& filePrefix, uint64_t maxBytes,
+	Clock::duration maxAge, bool isKeyFrameAware, size_t segmentSize) :
+	m_directory(directory),
+	m_filePrefix(filePrefix + "-" + std::to_string(getProcessId()) + "-" + std::to_string(NextStoreId++)),
+	m_maxBytes(maxBytes),
+	m_maxAge(maxAge),
+	m_isKeyFrameAware(isKeyFrameAware),
+	m_segmentSize(maxBytes < segmentSize ? static_cast<size_t>(maxBytes) : segmentSize),
+	m_firstSegment(0),
+	m_firstPosition(0),
+	m_isWaitingForKeyFrame(isKeyFrameAware),
+	m_hasFailed(false)
+{
+	assert(m_segmentSize > 0);
+}
+
+SegmentStore::
+~SegmentStore() = default;
+
+bool
+SegmentStore::
+Append(const std::shared_ptr<MediaSample>& mediaSample, Clock::time_point now)
+{
+	const auto isRandomAccessPoint = !m_isKeyFrameAware || mediaSample->GetIsKeyFrame();
+	if (m_hasFailed || (m_isWaitingForKeyFrame && !isRandomAccessPoint))
+	{
+		return false;
+	}
+
+	// Drop the segments that only hold samples older than the maximum age, except the one written to.
+	while (m_segments.size() > 1 && m_segments.front()->GetLastTime() < now - m_maxAge)
+	{
+		dropOldestSegment();
+	}
+
+	// The expired samples of the remaining segments are no longer served, their space is
+	// reclaimed with their segment.
+	while (!m_index.empty() && m_index.front().Time < now - m_maxAge)
+	{
+		dropOldestSample();
+	}
+
+	const auto size = static_cast<size_t>(mediaSample->GetSize());
+	if (size > m_segmentSize)
+	{
+		m_isWaitingForKeyFrame = m_isKeyFrameAware;
+		return false;
+	}
+
+	if ((m_segments.empty() || m_segments.back()->GetFreeBytes() < size) && !addSegment())
+	{
+		m_hasFailed = true;
+		return false;
+	}
+
+	const auto offset = m_segments.back()->Append(mediaSample->GetDataBuffer().Data(), size, now);
+	if (m_isKeyFrameAware && isRandomAccessPoint)
+	{
+		m_keyFramePositions.push_back(GetEndPosition());
+	}
+	m_index.push_back({ now, mediaSample->StartTime(), m_firstSegment + m_segments.size() - 1, offset,
+		static_cast<uint32_t>(size), mediaSample->GetIsKeyFrame() });
+	m_isWaitingForKeyFrame = false;
+	return true;
+}
+
+uint64_t
+SegmentStore::
+Seek(Clock::time_point time) const
+{
+	if (!m_isKeyFrameAware)
+	{
+		const auto entry = std::upper_bound(m_index.begin(), m_index.end(), time,
+			[](Clock::time_point value, const IndexEntry& element) { return value < element.Time; });
+		return entry == m_index.begin()
+			? m_firstPosition
+			: m_firstPosition + static_cast<uint64_t>(entry - m_index.begin()) - 1;
+	}
+
+	if (m_keyFramePositions.empty())
+	{
+		return GetEndPosition();
+	}
+
+	const auto keyFrame = std::upper_bound(m_keyFramePositions.begin(), m_keyFramePositions.end(), time,
+		[this](Clock::time_point value, uint64_t position)
+		{
+			return value < m_index[static_cast<size_t>(position - m_firstPosition)].Time;
+		});
+	return keyFrame == m_keyFramePositions.begin() ? m_keyFramePositions.front() : *(keyFrame - 1);
+}
+
+bool
+SegmentStore::
+Read(uint64_t& position, SegmentSlice& slice) const
+{
+	if (position < m_firstPosition)
+	{
+		position = getRandomAccessPosition(m_firstPosition);
+	}
+
+	if (position >= GetEndPosition())
+	{
+		return false;
+	}
+
+	const auto& entry = m_index[static_cast<size_t>(position - m_firstPosition)];
+	slice.Data = m_segments[static_cast<size_t>(entry.Segment - m_firstSegment)]->GetData() + entry.Offset;
+	slice.Size = entry.Size;
+	slice.StartTime = entry.StartTime;
+	slice.IsKeyFrame = entry.IsKeyFrame;
+	++position;
+	return true;
+}
+
+bool
+SegmentStore::
+GetOldestTime(Clock::time_point& time) const
+{
+	const auto position = getRandomAccessPosition(m_firstPosition);
+	if (position >= GetEndPosition())
+	{
+		return false;
+	}
+
+	time = m_index[static_cast<size_t>(position - m_firstPosition)].Time;
+	return true;
+}
+
+bool
+SegmentStore::
+addSegment()
+{
+	const auto maxSegments = m_maxBytes / m_segmentSize;
+	while (!m_segments.empty() && m_segments.size() >= maxSegments)
+	{
+		dropOldestSegment();
+	}
+
+	const auto path = m_directory + PathSeparator + m_filePrefix + "-" + std::to_string(m_firstSegment + m_segments.size()) + ".seg";
+	auto segment = std::make_unique<Segment>();
+	if (!segment->Open(path, m_segmentSize))
+	{
+		log_rtsp_error("Unable to map segment file " + path + ", error " + std::to_string(getLastError()) + ".");
+		return false;
+	}
+
+	m_segments.push_back(std::move(segment));
+	return true;
+}
+
+void
+SegmentStore::
+dropOldestSegment()
+{
+	m_segments.pop_front();
+	while (!m_index.empty() && m_index.front().Segment == m_firstSegment)
+	{
+		dropOldestSample();
+	}
+	++m_firstSegment;
+}
+
+void
+SegmentStore::
+dropOldestSample()
+{
+	if (!m_keyFramePositions.empty() && m_keyFramePositions.front() == m_firstPosition)
+	{
+		m_keyFramePositions.pop_front();
+	}
+	m_index.pop_front();
+	++m_firstPosition;
+}
+
+uint64_t
+SegmentStore::
+getRandomAccessPosition(uint64_t position) const
+{
+	if (!m_isKeyFrameAware)
+	{
+		return position;
+	}
+
+	const auto keyFrame = std::lower_bound(m_keyFramePositions.begin(), m_keyFramePositions.end(), position);
+	return keyFrame == m_keyFramePositions.end() ? GetEndPosition() : *keyFrame;
+}
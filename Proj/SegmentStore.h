@@ -0,0 +1,215 @@
+///
+/// @class SegmentStore
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "MediaSample.h"
+
+namespace CvRtsp
+{
+	///
+	/// Recorded sample handed out by SegmentStore::Read(), pointing into a mapped segment.
+	struct SegmentSlice
+	{
+		/// Sample data, valid until the next SegmentStore::Append().
+		BYTE* Data = nullptr;
+
+		/// Sample size.
+		unsigned Size = 0;
+
+		/// Media start time of the sample.
+		double StartTime = 0.0;
+
+		/// True if the sample is a keyframe.
+		bool IsKeyFrame = false;
+	};
+
+	///
+	/// On-disk lookback cache of the most recent samples of a channel, for history longer than a
+	/// TimeshiftBuffer can keep in memory.
+	///
+	/// Samples are appended to fixed size segment files that are mapped into memory: recording is
+	/// a copy into the mapped pages and playback hands out pointers into them, without read() or
+	/// write() calls, the system's file cache decides what is on disk. The keyframe and time index
+	/// is kept in memory only: the segment files are temporary, deleted when they are closed, and
+	/// are not meant to be read back by anything else.
+	///
+	/// Retention is bounded by size and age, whole segments are dropped oldest first. Samples are
+	/// addressed by positions like in TimeshiftBuffer, a cursor whose segment has been dropped
+	/// continues at the next keyframe. Not thread safe.
+	class SegmentStore
+	{
+	public:
+		/// Clock the samples are timestamped with on recording.
+		using Clock = std::chrono::steady_clock;
+
+		/// Default size of a segment file.
+		static const size_t DefaultSegmentSize = 32 * 1024 * 1024;
+
+		///
+		/// Constructor, no file is created until the first sample is appended.
+		///
+		/// @param[in] directory		Directory the segment files are created in.
+		/// @param[in] filePrefix		Prefix of the segment file names, the store makes them unique.
+		/// @param[in] maxBytes			Maximum size of all segment files, not 0.
+		/// @param[in] maxAge			Age after which a segment is dropped.
+		/// @param[in] isKeyFrameAware	True if the samples depend on the preceding keyframe (video).
+		/// @param[in] segmentSize		Size of a segment file.
+		SegmentStore(const std::string& directory, const std::string& filePrefix, uint64_t maxBytes,
+			Clock::duration maxAge, bool isKeyFrameAware, size_t segmentSize = DefaultSegmentSize);
+
+		///
+		/// Destructor, unmaps and deletes the segment files.
+		~SegmentStore();
+
+		SegmentStore(const SegmentStore&) = delete;
+		SegmentStore& operator=(const SegmentStore&) = delete;
+
+		///
+		/// Record a sample and drop the segments that are older than the maximum age.
+		///
+		/// @param[in] mediaSample	Media sample.
+		/// @param[in] now			Recording time.
+		///
+		/// @return False if the sample has not been recorded.
+		bool Append(const std::shared_ptr<MediaSample>& mediaSample, Clock::time_point now);
+
+		///
+		/// Find the position to start playing from for a point in time: the nearest random access
+		/// point recorded at or before it, the oldest one if the time is older than the store.
+		///
+		/// @param[in] time Point in time.
+		///
+		/// @return Position, GetEndPosition() if there is no random access point.
+		uint64_t Seek(Clock::time_point time) const;
+
+		///
+		/// Get the sample at a cursor and advance the cursor.
+		///
+		/// @param[in,out] position	Cursor.
+		/// @param[out] slice		Recorded sample.
+		///
+		/// @return False if the cursor has reached the end of the store.
+		bool Read(uint64_t& position, SegmentSlice& slice) const;
+
+		///
+		/// Get the position the next recorded sample will have.
+		///
+		/// @return End position.
+		uint64_t GetEndPosition() const
+		{
+			return m_firstPosition + m_index.size();
+		}
+
+		///
+		/// Get the recording time of the oldest sample.
+		///
+		/// @param[out] time Recording time.
+		///
+		/// @return False if the store is empty.
+		bool GetOldestTime(Clock::time_point& time) const;
+
+		///
+		/// Get the size of the segment files.
+		///
+		/// @return Bytes.
+		uint64_t GetBytes() const
+		{
+			return static_cast<uint64_t>(m_segments.size()) * m_segmentSize;
+		}
+
+	private:
+		class Segment;
+
+		/// Index entry of a recorded sample.
+		struct IndexEntry
+		{
+			/// Recording time.
+			Clock::time_point Time;
+
+			/// Media start time.
+			double StartTime;
+
+			/// Sequence number of the segment holding the sample.
+			uint64_t Segment;
+
+			/// Offset of the sample in the segment.
+			uint32_t Offset;
+
+			/// Sample size.
+			uint32_t Size;
+
+			/// True if the sample is a keyframe.
+			bool IsKeyFrame;
+		};
+
+		/// Directory the segment files are created in.
+		std::string m_directory;
+
+		/// Prefix of the segment file names.
+		std::string m_filePrefix;
+
+		/// Maximum size of all segment files.
+		uint64_t m_maxBytes;
+
+		/// Age after which a segment is dropped.
+		Clock::duration m_maxAge;
+
+		/// Samples depend on the preceding keyframe.
+		bool m_isKeyFrameAware;
+
+		/// Size of a segment file.
+		size_t m_segmentSize;
+
+		/// Mapped segments, oldest first, the last one is written to.
+		std::deque<std::unique_ptr<Segment>> m_segments;
+
+		/// Sequence number of the oldest segment.
+		uint64_t m_firstSegment;
+
+		/// Index of the recorded samples, oldest first.
+		std::deque<IndexEntry> m_index;
+
+		/// Positions of the recorded keyframes, only if keyframe aware.
+		std::deque<uint64_t> m_keyFramePositions;
+
+		/// Position of the oldest recorded sample.
+		uint64_t m_firstPosition;
+
+		/// Delta frames are not recorded until the next keyframe.
+		bool m_isWaitingForKeyFrame;
+
+		/// Creating a segment failed, the store records nothing anymore.
+		bool m_hasFailed;
+
+		///
+		/// Map a new segment to write to, dropping the oldest ones to stay within the size limit.
+		///
+		/// @return False if the segment could not be created.
+		bool addSegment();
+
+		///
+		/// Unmap the oldest segment and drop its samples from the index.
+		void dropOldestSegment();
+
+		///
+		/// Drop the oldest sample from the index.
+		void dropOldestSample();
+
+		///
+		/// Get the first random access point at or after a position.
+		///
+		/// @param[in] position Position.
+		///
+		/// @return Position, GetEndPosition() if there is none.
+		uint64_t getRandomAccessPosition(uint64_t position) const;
+	};
+}
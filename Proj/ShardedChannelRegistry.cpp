@@ -0,0 +1,76 @@
+///
+/// @class ShardedChannelRegistry
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include "ShardedChannelRegistry.h"
+
+using namespace CvRtsp;
+
+#pragma region ShardedChannelRegistry
+ShardedChannelRegistry::
+ShardedChannelRegistry(unsigned shardCount)
+{
+	assert(shardCount > 0);
+	const auto count = shardCount > 0 ? shardCount : 1;
+	for (unsigned shardIndex = 0; shardIndex < count; ++shardIndex)
+	{
+		m_shards.emplace_back(new MultiChannelManager());
+	}
+}
+
+ChannelManager&
+ShardedChannelRegistry::
+GetShard(unsigned shardIndex)
+{
+	assert(shardIndex < m_shards.size());
+	return *m_shards[shardIndex];
+}
+
+std::shared_ptr<MediaChannel>
+ShardedChannelRegistry::
+AddChannel(const boost::uuids::uuid& channelId, const std::string& channelName,
+	uint32_t videoSourceId, uint32_t audioSourceId)
+{
+	const auto mediaChannel = std::make_shared<FanOutMediaChannel>(channelId, channelName);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& shard : m_shards)
+	{
+		if (videoSourceId != UINT_MAX)
+		{
+			shard->SetVideoSourceId(channelId, channelName, videoSourceId);
+		}
+		if (audioSourceId != UINT_MAX)
+		{
+			shard->SetAudioSourceId(channelId, channelName, audioSourceId);
+		}
+
+		// A shard channel is only consumed by the subsessions of its shard, which report their
+		// watchers: shards without clients do not count as watchers of the fan-out.
+		const auto shardChannel = shard->GetPacketManager(channelId, channelName);
+		for (const auto isVideo : { true, false })
+		{
+			if (!shardChannel->IsDemandTracked(isVideo))
+			{
+				shardChannel->SetWatcherCount(isVideo, 0);
+			}
+		}
+		mediaChannel->Subscribe(shardChannel);
+	}
+	return mediaChannel;
+}
+
+void
+ShardedChannelRegistry::
+RemoveChannel(const boost::uuids::uuid& channelId, const std::string& channelName)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& shard : m_shards)
+	{
+		shard->RemoveChannel(channelId, channelName);
+	}
+}
+#pragma endregion
@@ -0,0 +1,79 @@
+///
+/// @class ShardedChannelRegistry
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "FanOutMediaChannel.h"
+#include "MultiChannelManager.h"
+
+namespace CvRtsp
+{
+	///
+	/// Thread-safe channel registry for a server that runs several event loops (shards).
+	///
+	/// Every shard has its own channel manager with its own media queues, so that the task
+	/// schedulers never compete for samples. Producers get one media channel per channel that
+	/// hands each sample to the queues of all shards (FanOutMediaChannel); the samples themselves
+	/// are shared, not copied. The shards dequeue the same samples concurrently, so the task
+	/// schedulers and subsessions only read them.
+	class ShardedChannelRegistry
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param[in] shardCount Number of shards, at least 1.
+		explicit ShardedChannelRegistry(unsigned shardCount);
+
+		///
+		/// Number of shards.
+		///
+		/// @return Shard count.
+		unsigned GetShardCount() const
+		{
+			return static_cast<unsigned>(m_shards.size());
+		}
+
+		///
+		/// Channel manager to be passed to the task scheduler of a shard.
+		///
+		/// @param[in] shardIndex Shard index.
+		///
+		/// @return Channel manager of the shard.
+		ChannelManager& GetShard(unsigned shardIndex);
+
+		///
+		/// Add a channel to all shards.
+		///
+		/// @param[in] channelId		Unique channel id.
+		/// @param[in] channelName		Channel name.
+		/// @param[in] videoSourceId	Video source id, UINT_MAX if the channel has no video.
+		/// @param[in] audioSourceId	Audio source id, UINT_MAX if the channel has no audio.
+		///
+		/// @return Media channel that producers add the samples of the channel to.
+		std::shared_ptr<MediaChannel> AddChannel(const boost::uuids::uuid& channelId, const std::string& channelName,
+			uint32_t videoSourceId, uint32_t audioSourceId);
+
+		///
+		/// Remove a channel from all shards. Media channels handed out for it stay valid,
+		/// samples added to them are dropped.
+		///
+		/// @param[in] channelId	Unique channel id.
+		/// @param[in] channelName	Channel name.
+		void RemoveChannel(const boost::uuids::uuid& channelId, const std::string& channelName);
+
+	private:
+		/// Serializes adding and removing channels across all shards, the shards' channel managers
+		/// are read without locks.
+		std::mutex m_mutex;
+
+		/// Channel managers, one per shard.
+		std::vector<std::unique_ptr<MultiChannelManager>> m_shards;
+	};
+}
@@ -0,0 +1,337 @@
+///
+/// @class ShardedRtspServer
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <algorithm>
+#include <future>
+
+#include <live555/GroupsockHelper.hh>
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "ShardedRtspServer.h"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace CvRtsp;
+
+#if !defined(_WIN32) && defined(SO_REUSEPORT)
+/// Create a stream socket bound to a port that the sockets of the other shards bind as well.
+/// live555's setupStreamSocket() only sets SO_REUSEADDR and binds right away, SO_REUSEPORT has to
+/// be set on every socket before it is bound.
+///
+/// @return Socket, negative on error.
+static int
+setUpReusePortSocket(UsageEnvironment& env, Port port)
+{
+	const auto newSocket = static_cast<int>(socket(AF_INET, SOCK_STREAM, 0));
+	if (newSocket < 0)
+	{
+		env.setResultErrMsg("unable to create stream socket: ");
+		return -1;
+	}
+
+	const int reuseFlag = 1;
+	struct sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = port.num();
+	address.sin_addr.s_addr = ReceivingInterfaceAddr;
+	if (setsockopt(newSocket, SOL_SOCKET, SO_REUSEADDR, &reuseFlag, sizeof(reuseFlag)) < 0
+		|| setsockopt(newSocket, SOL_SOCKET, SO_REUSEPORT, &reuseFlag, sizeof(reuseFlag)) < 0
+		|| bind(newSocket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0
+		|| !makeSocketNonBlocking(newSocket))
+	{
+		env.setResultErrMsg("unable to set up stream socket: ");
+		closeSocket(newSocket);
+		return -1;
+	}
+
+	return newSocket;
+}
+#endif
+
+ShardedRtspServer::
+ShardedRtspServer(unsigned shardCount, Port rtspPort,
+	IRateAdaptationFactory* rateFactory, IRateController* rateController) :
+	m_rtspPort(rtspPort),
+	m_rateFactory(rateFactory),
+	m_rateController(rateController),
+	m_channelRegistry(shardCount),
+	m_timeshiftMemoryBudget(std::make_shared<TimeshiftMemoryBudget>(LiveRtspServer::DefaultTimeshiftMemoryBytes)),
+	m_listeningSocket(-1)
+{
+}
+
+ShardedRtspServer::
+~ShardedRtspServer()
+{
+	Stop();
+}
+
+bool
+ShardedRtspServer::
+Start()
+{
+	assert(m_shards.empty());
+
+	// Shards are started one after the other, later shards may duplicate the socket of the first.
+	for (unsigned shardIndex = 0; shardIndex < m_channelRegistry.GetShardCount(); ++shardIndex)
+	{
+		Shard* shard = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_shards.emplace_back(new Shard());
+			shard = m_shards.back().get();
+		}
+
+		std::promise<bool> started;
+		auto isStarted = started.get_future();
+		shard->Thread = std::thread([this, shard, shardIndex, &started]()
+			{
+				runShard(*shard, shardIndex, [&started](bool isListening) { started.set_value(isListening); });
+			});
+
+		if (!isStarted.get())
+		{
+			std::stringstream message;
+			message << "ShardedRtspServer: unable to start shard " << shardIndex;
+			log_rtsp_error(message.str());
+			Stop();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+ShardedRtspServer::
+Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto& shard : m_shards)
+		{
+			if (shard->IsRunning)
+			{
+				auto stoppingShard = shard.get();
+				post(*shard, [stoppingShard](LiveRtspServer&) { stoppingShard->WatchVariable = 1; });
+			}
+		}
+	}
+
+	// Only Start() and Stop() change the shards, which are called on this thread.
+	for (auto& shard : m_shards)
+	{
+		if (shard->Thread.joinable())
+		{
+			shard->Thread.join();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_shards.clear();
+	m_listeningSocket = -1;
+}
+
+std::shared_ptr<MediaChannel>
+ShardedRtspServer::
+AddChannel(const RtspChannel& channel, uint32_t videoSourceId, uint32_t audioSourceId)
+{
+	auto mediaChannel = m_channelRegistry.AddChannel(channel.ChannelId, channel.ChannelName,
+		videoSourceId, audioSourceId);
+	if (channel.IsCameraSourceShared)
+	{
+		m_cameraSources.Subscribe(channel.CameraId, mediaChannel);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (channel.IsCameraSourceShared)
+	{
+		m_cameraSubscribers[std::make_pair(channel.ChannelId, channel.ChannelName)] = std::make_pair(channel.CameraId, mediaChannel);
+	}
+	m_channels.push_back(channel);
+	for (auto& shard : m_shards)
+	{
+		if (shard->IsRunning)
+		{
+			post(*shard, [channel](LiveRtspServer& server) { server.AddRtspMediaSession(channel); });
+		}
+	}
+
+	return mediaChannel;
+}
+
+void
+ShardedRtspServer::
+RemoveChannel(const RtspChannel& channel)
+{
+	std::pair<unsigned, std::shared_ptr<MediaChannel>> cameraSubscriber;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const auto subscriber = m_cameraSubscribers.find(std::make_pair(channel.ChannelId, channel.ChannelName));
+		if (subscriber != m_cameraSubscribers.end())
+		{
+			cameraSubscriber = subscriber->second;
+			m_cameraSubscribers.erase(subscriber);
+		}
+
+		m_channels.erase(std::remove_if(m_channels.begin(), m_channels.end(), [&channel](const RtspChannel& servedChannel)
+			{
+				return servedChannel.ChannelId == channel.ChannelId && servedChannel.ChannelName == channel.ChannelName;
+			}), m_channels.end());
+
+		for (auto& shard : m_shards)
+		{
+			if (shard->IsRunning)
+			{
+				post(*shard, [channel](LiveRtspServer& server) { server.RemoveRtspMediaSession(channel); });
+			}
+		}
+	}
+
+	if (cameraSubscriber.second)
+	{
+		m_cameraSources.Unsubscribe(cameraSubscriber.first, cameraSubscriber.second);
+	}
+	m_channelRegistry.RemoveChannel(channel.ChannelId, channel.ChannelName);
+}
+
+void
+ShardedRtspServer::
+runShard(Shard& shard, unsigned shardIndex, const std::function<void(bool)>& onStarted)
+{
+	// The scheduler, environment and server of a shard are only touched on this thread.
+	shard.Scheduler = LiveSourceTaskScheduler::createNew(m_channelRegistry.GetShard(shardIndex));
+	auto env = BasicUsageEnvironment::createNew(*shard.Scheduler);
+
+	const auto listeningSocket = setUpListeningSocket(*env, shardIndex);
+	if (listeningSocket < 0)
+	{
+		env->reclaim();
+		delete shard.Scheduler;
+		shard.Scheduler = nullptr;
+		onStarted(false);
+		return;
+	}
+
+	shard.Server = new LiveRtspServer(*env, listeningSocket, -1, m_rtspPort, nullptr,
+		m_rateFactory, m_rateController);
+	shard.Server->SetTimeshiftMemoryBudget(m_timeshiftMemoryBudget);
+	shard.CommandTrigger = shard.Scheduler->createEventTrigger(&runCommands);
+
+	// Channels added before the shard was started, the ones added from now on are posted.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const auto& channel : m_channels)
+		{
+			shard.Server->AddRtspMediaSession(channel);
+		}
+		shard.IsRunning = true;
+	}
+
+	onStarted(true);
+
+	shard.Scheduler->doEventLoop(&shard.WatchVariable);
+
+	// Commands posted from now on are dropped with the shard.
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		shard.IsRunning = false;
+	}
+	shard.Scheduler->deleteEventTrigger(shard.CommandTrigger);
+	Medium::close(shard.Server);
+	shard.Server = nullptr;
+	env->reclaim();
+	delete shard.Scheduler;
+	shard.Scheduler = nullptr;
+}
+
+int
+ShardedRtspServer::
+setUpListeningSocket(UsageEnvironment& env, unsigned shardIndex)
+{
+#if !defined(_WIN32) && defined(SO_REUSEPORT)
+	const auto listeningSocket = setUpReusePortSocket(env, m_rtspPort);
+#else
+	if (shardIndex > 0)
+	{
+		// Each server closes its socket, so every shard gets its own handle to the shared listening socket.
+#if defined(_WIN32)
+		WSAPROTOCOL_INFOW protocolInfo;
+		if (WSADuplicateSocketW(static_cast<SOCKET>(m_listeningSocket), GetCurrentProcessId(), &protocolInfo) != 0)
+		{
+			return -1;
+		}
+
+		const auto duplicate = WSASocketW(FROM_PROTOCOL_INFO, FROM_PROTOCOL_INFO, FROM_PROTOCOL_INFO, &protocolInfo, 0, 0);
+		if (duplicate == INVALID_SOCKET)
+		{
+			return -1;
+		}
+
+		const auto duplicateSocket = static_cast<int>(duplicate);
+		makeSocketNonBlocking(duplicateSocket);
+		return duplicateSocket;
+#else
+		return dup(m_listeningSocket);
+#endif
+	}
+
+	const auto listeningSocket = setupStreamSocket(env, m_rtspPort, AF_INET);
+#endif
+	if (listeningSocket < 0)
+	{
+		return -1;
+	}
+
+	if (listen(listeningSocket, LISTEN_BACKLOG_SIZE) < 0)
+	{
+		closeSocket(listeningSocket);
+		return -1;
+	}
+
+	if (shardIndex == 0)
+	{
+		m_listeningSocket = listeningSocket;
+	}
+
+	return listeningSocket;
+}
+
+void
+ShardedRtspServer::
+post(Shard& shard, ShardCommand command)
+{
+	{
+		std::lock_guard<std::mutex> lock(shard.CommandMutex);
+		shard.Commands.push_back(std::move(command));
+	}
+
+	// triggerEvent() is the only live555 call that may be made from another thread, it is
+	// handled once the loop wakes up.
+	shard.Scheduler->triggerEvent(shard.CommandTrigger, &shard);
+	shard.Scheduler->WakeUp();
+}
+
+void
+ShardedRtspServer::
+runCommands(void* clientData)
+{
+	auto& shard = *static_cast<Shard*>(clientData);
+
+	std::deque<ShardCommand> commands;
+	{
+		std::lock_guard<std::mutex> lock(shard.CommandMutex);
+		commands.swap(shard.Commands);
+	}
+
+	for (auto& command : commands)
+	{
+		command(*shard.Server);
+	}
+}
@@ -0,0 +1,209 @@
+///
+/// @class ShardedRtspServer
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CameraSourceRegistry.h"
+#include "LiveRtspServer.h"
+#include "LiveSourceTaskScheduler.h"
+#include "ShardedChannelRegistry.h"
+
+namespace CvRtsp
+{
+	///
+	/// Runs several independent live555 event loops (shards) that serve the same RTSP port.
+	///
+	/// Each shard has its own thread, task scheduler, usage environment and LiveRtspServer, and
+	/// serves the clients that connected to it. Channels are added to every shard and receive
+	/// their samples through a ShardedChannelRegistry.
+	///
+	/// On platforms with SO_REUSEPORT each shard listens on its own socket, bound with SO_REUSEPORT,
+	/// and the kernel balances connections. Elsewhere (Windows) all shards accept on duplicates of
+	/// one listening socket and the shard that accepts first wins.
+	///
+	/// Start() and Stop() must be called from the same thread, channels can be added and removed
+	/// from any thread.
+	class ShardedRtspServer
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param[in] shardCount Number of event loops, at least 1.
+		/// @param[in] rtspPort Rtsp port.
+		/// @param[in] rateFactory Rate adaptation factory.
+		/// @param[in] rateController Rate controller.
+		ShardedRtspServer(unsigned shardCount, Port rtspPort,
+			IRateAdaptationFactory* rateFactory = nullptr, IRateController* rateController = nullptr);
+
+		///
+		/// Destructor, stops all shards.
+		~ShardedRtspServer();
+
+		ShardedRtspServer(const ShardedRtspServer&) = delete;
+		ShardedRtspServer& operator=(const ShardedRtspServer&) = delete;
+
+		///
+		/// Start the event loop threads.
+		///
+		/// @return True if all shards are listening.
+		bool Start();
+
+		///
+		/// Stop the event loop threads and close the servers. Producers can keep adding media, the
+		/// media arrival signal and ready list of a shard belong to its channel manager in the
+		/// channel registry and outlive the shard's scheduler.
+		void Stop();
+
+		///
+		/// Add a channel to all shards. If the channel shares the source of its camera
+		/// (RtspChannel::IsCameraSourceShared) its media channel is subscribed to the camera's source
+		/// in GetCameraSourceRegistry(), until the channel is removed.
+		///
+		/// @param[in] channel			Channel description.
+		/// @param[in] videoSourceId	Video source id, UINT_MAX if the channel has no video.
+		/// @param[in] audioSourceId	Audio source id, UINT_MAX if the channel has no audio.
+		///
+		/// @return Media channel that producers add the samples of the channel to.
+		std::shared_ptr<MediaChannel> AddChannel(const RtspChannel& channel, uint32_t videoSourceId, uint32_t audioSourceId);
+
+		///
+		/// Remove a channel from all shards, unsubscribing it from its camera's source.
+		///
+		/// @param[in] channel Channel description.
+		void RemoveChannel(const RtspChannel& channel);
+
+		///
+		/// Shared per-camera sources of the channels served.
+		///
+		/// @return Camera source registry.
+		CameraSourceRegistry& GetCameraSourceRegistry()
+		{
+			return m_cameraSources;
+		}
+
+		///
+		/// Channel registry shared by the shards.
+		///
+		/// @return Channel registry.
+		ShardedChannelRegistry& GetChannelRegistry()
+		{
+			return m_channelRegistry;
+		}
+
+		///
+		/// Memory limit shared by the timeshift buffers of all shards.
+		///
+		/// @return Timeshift memory budget.
+		std::shared_ptr<TimeshiftMemoryBudget> GetTimeshiftMemoryBudget() const
+		{
+			return m_timeshiftMemoryBudget;
+		}
+
+	private:
+		/// Command run on the event loop thread of a shard.
+		using ShardCommand = std::function<void(LiveRtspServer&)>;
+
+		/// State of one event loop.
+		struct Shard
+		{
+			/// Commands can be posted, guarded by m_mutex.
+			bool IsRunning = false;
+
+			/// Event loop thread.
+			std::thread Thread;
+
+			/// Task scheduler, owned by the event loop thread.
+			LiveSourceTaskScheduler* Scheduler = nullptr;
+
+			/// Rtsp server, owned by the event loop thread.
+			LiveRtspServer* Server = nullptr;
+
+			/// Event trigger that runs the pending commands.
+			EventTriggerId CommandTrigger = 0;
+
+			/// Event loop watch variable, only written on the event loop thread.
+			EventLoopWatchVariable WatchVariable = 0;
+
+			/// Guards Commands.
+			std::mutex CommandMutex;
+
+			/// Commands waiting to be run on the event loop thread.
+			std::deque<ShardCommand> Commands;
+		};
+
+		/// Rtsp port.
+		Port m_rtspPort;
+
+		/// Rate adaptation factory.
+		IRateAdaptationFactory* m_rateFactory;
+
+		/// Rate controller.
+		IRateController* m_rateController;
+
+		/// Channel registry shared by the shards.
+		ShardedChannelRegistry m_channelRegistry;
+
+		/// Memory limit shared by the timeshift buffers of all shards.
+		std::shared_ptr<TimeshiftMemoryBudget> m_timeshiftMemoryBudget;
+
+		/// Guards m_shards, m_channels and the shards' IsRunning: a channel is either added by a
+		/// starting shard or posted to it, never both or neither.
+		std::mutex m_mutex;
+
+		/// Event loops.
+		std::vector<std::unique_ptr<Shard>> m_shards;
+
+		/// Channels served, added to shards when they start.
+		std::vector<RtspChannel> m_channels;
+
+		/// Shared per-camera sources.
+		CameraSourceRegistry m_cameraSources;
+
+		/// Media channels subscribed to their camera's source, with the camera id, guarded by m_mutex.
+		std::map<UniqueChannelSessionIdentifier, std::pair<unsigned, std::shared_ptr<MediaChannel>>> m_cameraSubscribers;
+
+		/// Listening socket of the first shard, duplicated for the others where there is no SO_REUSEPORT.
+		int m_listeningSocket;
+
+		///
+		/// Event loop thread of a shard.
+		///
+		/// @param[in] shard Shard.
+		/// @param[in] shardIndex Shard index.
+		/// @param[in] onStarted Called with true once the shard listens, false if it could not be set up.
+		void runShard(Shard& shard, unsigned shardIndex, const std::function<void(bool)>& onStarted);
+
+		///
+		/// Create the listening socket of a shard.
+		///
+		/// @param[in] env Usage environment of the shard.
+		/// @param[in] shardIndex Shard index.
+		///
+		/// @return Listening socket, negative on error.
+		int setUpListeningSocket(UsageEnvironment& env, unsigned shardIndex);
+
+		///
+		/// Queue a command for the event loop thread of a shard and wake up the loop.
+		///
+		/// @param[in] shard Shard.
+		/// @param[in] command Command to run.
+		static void post(Shard& shard, ShardCommand command);
+
+		///
+		/// Event trigger handler that runs the pending commands of a shard.
+		///
+		/// @param[in] clientData Shard.
+		static void runCommands(void* clientData);
+	};
+}
@@ -0,0 +1,379 @@
+///
+/// @class ShmIngestChannelManager
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "ShmIngestChannelManager.h"
+
+using namespace CvRtsp;
+using namespace CvRtsp::ShmIngestRing;
+
+// Interval at which closed streams are freed when no frames arrive.
+static const DWORD ReclaimIntervalMs = 100;
+
+///
+/// Mapped region, unmapped when the manager and all samples borrowing it are gone.
+class ShmIngestChannelManager::Region
+{
+public:
+	Region(HANDLE mapping, void* view) :
+		m_mapping(mapping),
+		m_view(view)
+	{
+	}
+
+	~Region()
+	{
+		UnmapViewOfFile(m_view);
+		CloseHandle(m_mapping);
+	}
+
+	Region(const Region&) = delete;
+	Region& operator=(const Region&) = delete;
+
+	void* GetView() const
+	{
+		return m_view;
+	}
+
+private:
+	/// File mapping.
+	HANDLE m_mapping;
+
+	/// Mapped view.
+	void* m_view;
+};
+
+///
+/// Consumer state of a stream. The records handed out are tracked in order, the ring space is
+/// given back up to the oldest record that is still referenced.
+class ShmIngestChannelManager::StreamReader
+{
+public:
+	StreamReader(std::shared_ptr<Region> region, uint32_t streamIndex) :
+		m_region(std::move(region)),
+		m_stream(GetStream(m_region->GetView(), streamIndex)),
+		m_ring(GetRing(m_region->GetView(), streamIndex)),
+		m_ringSize(static_cast<const Header*>(m_region->GetView())->RingSize),
+		m_isAttached(false),
+		m_readIndex(0),
+		m_firstSequence(0)
+	{
+	}
+
+	///
+	/// Is this the open stream of a channel's source.
+	bool IsStream(const boost::uuids::uuid& channelId, uint32_t sourceId) const
+	{
+		return m_stream.State.load(std::memory_order_acquire) == StreamOpen && m_stream.SourceId == sourceId
+			&& memcmp(m_stream.ChannelId, channelId.data, sizeof(m_stream.ChannelId)) == 0;
+	}
+
+	///
+	/// Hand out up to maxCount published records as samples borrowing the ring.
+	static size_t Read(const std::shared_ptr<StreamReader>& reader, const boost::uuids::uuid& channelId,
+		uint32_t sourceId, std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount)
+	{
+		// Samples left in the output would release their records with the lock held.
+		for (size_t index = 0; index < maxCount; ++index)
+		{
+			mediaSamples[index].reset();
+		}
+
+		std::lock_guard<std::mutex> lock(reader->m_mutex);
+
+		// The stream may have been freed and reused since it was looked up.
+		if (!reader->IsStream(channelId, sourceId))
+		{
+			return 0;
+		}
+		if (!reader->m_isAttached)
+		{
+			// Continue where a previous server stopped.
+			reader->m_readIndex = reader->m_stream.ReleaseIndex.load(std::memory_order_relaxed);
+			reader->m_isAttached = true;
+		}
+
+		const auto writeIndex = reader->m_stream.WriteIndex.load(std::memory_order_acquire);
+		size_t count = 0;
+		while (count < maxCount && reader->m_readIndex != writeIndex)
+		{
+			// The producer is another process: the header is copied once and only the copy is
+			// validated and used, the ring may change under us if the producer misbehaves.
+			const auto offset = reader->m_readIndex % reader->m_ringSize;
+			const auto published = writeIndex - reader->m_readIndex;
+			const auto record = reinterpret_cast<Record*>(reader->m_ring + offset);
+			Record header = {};
+			const auto isHeaderInRing = published >= sizeof(Record) && published <= reader->m_ringSize
+				&& offset + sizeof(Record) <= reader->m_ringSize;
+			if (isHeaderInRing)
+			{
+				memcpy(&header, record, sizeof(Record));
+			}
+			if (!isHeaderInRing || header.Size < sizeof(Record) || header.Size % RecordAlignment != 0
+				|| header.Size > reader->m_ringSize - offset || header.Size > published
+				|| header.DataSize > header.Size - sizeof(Record))
+			{
+				log_rtsp_error("ShmIngestChannelManager: corrupt record in stream of " + std::string(reader->m_stream.ChannelName)
+					+ ", skipping the published frames.");
+				reader->m_inFlight.push_back({ writeIndex, true });
+				reader->m_readIndex = writeIndex;
+				break;
+			}
+
+			const auto isPadding = (header.Flags & Padding) != 0;
+			reader->m_readIndex += header.Size;
+			reader->m_inFlight.push_back({ reader->m_readIndex, isPadding });
+			if (isPadding)
+			{
+				continue;
+			}
+
+			const auto sequence = reader->m_firstSequence + reader->m_inFlight.size() - 1;
+			auto& mediaSample = mediaSamples[count++];
+			mediaSample = MediaSample::CreateBorrowedMediaSample(reinterpret_cast<BYTE*>(record + 1),
+				static_cast<int>(header.DataSize), header.StartTime, (header.Flags & KeyFrame) != 0,
+				std::shared_ptr<void>(record, [reader, sequence](void*) { reader->release(sequence); }));
+
+			// The steady clock is system wide, the producer's timestamp is comparable with ours.
+			mediaSample->SetArrivalTime(std::chrono::steady_clock::time_point(
+				std::chrono::steady_clock::duration(header.ArrivalTime)));
+		}
+		reader->releaseCompleted();
+		return count;
+	}
+
+	///
+	/// Free the stream if its producer has closed it and all its samples have been released.
+	void Reclaim()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_stream.State.load(std::memory_order_acquire) != StreamClosing || !m_inFlight.empty())
+		{
+			return;
+		}
+
+		m_isAttached = false;
+		m_stream.State.store(StreamFree, std::memory_order_release);
+		log_rtsp_debug("ShmIngestChannelManager: freed stream of " + std::string(m_stream.ChannelName) + ".");
+	}
+
+private:
+	/// Record handed out.
+	struct InFlightRecord
+	{
+		/// Index after the record.
+		uint64_t End;
+
+		/// The record is no longer referenced.
+		bool IsReleased;
+	};
+
+	/// Region, kept mapped while samples borrow it.
+	std::shared_ptr<Region> m_region;
+
+	/// Control block.
+	Stream& m_stream;
+
+	/// Ring.
+	uint8_t* m_ring;
+
+	/// Ring size.
+	uint32_t m_ringSize;
+
+	/// Protects the state below, samples may be released on any thread.
+	std::mutex m_mutex;
+
+	/// The read index has been taken from the control block.
+	bool m_isAttached;
+
+	/// Index of the next record to hand out.
+	uint64_t m_readIndex;
+
+	/// Sequence number of the oldest record in m_inFlight.
+	uint64_t m_firstSequence;
+
+	/// Records handed out, oldest first.
+	std::deque<InFlightRecord> m_inFlight;
+
+	///
+	/// Called when the sample borrowing a record is destroyed.
+	void release(uint64_t sequence)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_inFlight[static_cast<size_t>(sequence - m_firstSequence)].IsReleased = true;
+		releaseCompleted();
+	}
+
+	///
+	/// Give the ring space of the oldest released records back to the producer.
+	/// Must be called with m_mutex held.
+	void releaseCompleted()
+	{
+		if (m_inFlight.empty() || !m_inFlight.front().IsReleased)
+		{
+			return;
+		}
+
+		uint64_t releaseIndex = 0;
+		while (!m_inFlight.empty() && m_inFlight.front().IsReleased)
+		{
+			releaseIndex = m_inFlight.front().End;
+			m_inFlight.pop_front();
+			++m_firstSequence;
+		}
+		m_stream.ReleaseIndex.store(releaseIndex, std::memory_order_release);
+	}
+};
+
+ShmIngestChannelManager::
+ShmIngestChannelManager(const std::string& regionName, uint32_t streamCount, uint32_t ringSize) :
+	m_event(nullptr),
+	m_signal(nullptr),
+	m_isRunning(true)
+{
+	ringSize = (ringSize + RecordAlignment - 1) & ~(RecordAlignment - 1);
+	const auto regionSize = GetRegionSize(streamCount, ringSize);
+
+	const auto mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(regionSize >> 32), static_cast<DWORD>(regionSize), regionName.c_str());
+	const auto isExisting = GetLastError() == ERROR_ALREADY_EXISTS;
+	const auto view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(regionSize)) : nullptr;
+	if (!view)
+	{
+		log_rtsp_error("ShmIngestChannelManager: unable to map region " + regionName + ", error "
+			+ std::to_string(GetLastError()) + ".");
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+		return;
+	}
+
+	auto& header = *static_cast<Header*>(view);
+	if (!isExisting)
+	{
+		header.Version = Version;
+		header.StreamCount = streamCount;
+		header.RingSize = ringSize;
+		header.IsSignalled.store(0, std::memory_order_relaxed);
+		header.Magic.store(Magic, std::memory_order_release);
+	}
+	else if (header.Magic.load(std::memory_order_acquire) != Magic || header.Version != Version
+		|| header.StreamCount != streamCount || header.RingSize != ringSize)
+	{
+		log_rtsp_error("ShmIngestChannelManager: region " + regionName + " exists with a different layout.");
+		UnmapViewOfFile(view);
+		CloseHandle(mapping);
+		return;
+	}
+
+	m_event = CreateEventA(nullptr, FALSE, FALSE, GetEventName(regionName).c_str());
+	if (!m_event)
+	{
+		log_rtsp_error("ShmIngestChannelManager: unable to create the event of region " + regionName + ".");
+		UnmapViewOfFile(view);
+		CloseHandle(mapping);
+		return;
+	}
+
+	m_region = std::make_shared<Region>(mapping, view);
+	m_readers.reserve(streamCount);
+	for (uint32_t streamIndex = 0; streamIndex < streamCount; ++streamIndex)
+	{
+		m_readers.push_back(std::make_shared<StreamReader>(m_region, streamIndex));
+	}
+	m_thread = std::thread(&ShmIngestChannelManager::run, this);
+	log_rtsp_information("ShmIngestChannelManager: " + std::string(isExisting ? "attached to" : "created")
+		+ " region " + regionName + ".");
+}
+
+ShmIngestChannelManager::
+~ShmIngestChannelManager()
+{
+	m_isRunning.store(false, std::memory_order_release);
+	if (m_thread.joinable())
+	{
+		SetEvent(m_event);
+		m_thread.join();
+	}
+	if (m_event)
+	{
+		CloseHandle(m_event);
+	}
+}
+
+std::shared_ptr<MediaSample>
+ShmIngestChannelManager::
+GetMedia(const boost::uuids::uuid& channelId, const std::string& channelName, uint32_t sourceId)
+{
+	std::shared_ptr<MediaSample> mediaSample;
+	GetMediaBatch(channelId, channelName, sourceId, &mediaSample, 1);
+	return mediaSample;
+}
+
+size_t
+ShmIngestChannelManager::
+GetMediaBatch(const boost::uuids::uuid& channelId, const std::string& /*channelName*/,
+	uint32_t sourceId, std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount)
+{
+	const auto reader = findStream(channelId, sourceId);
+	return reader ? StreamReader::Read(*reader, channelId, sourceId, mediaSamples, maxCount) : 0;
+}
+
+void
+ShmIngestChannelManager::
+SetMediaArrivalSignal(MediaArrivalSignal* mediaArrivalSignal)
+{
+	ChannelManager::SetMediaArrivalSignal(mediaArrivalSignal);
+	m_signal.store(mediaArrivalSignal, std::memory_order_release);
+}
+
+void
+ShmIngestChannelManager::
+run()
+{
+	auto& header = *static_cast<Header*>(m_region->GetView());
+	while (m_isRunning.load(std::memory_order_acquire))
+	{
+		WaitForSingleObject(m_event, ReclaimIntervalMs);
+
+		// Sequentially consistent, pairs with the producers' exchange: the records published
+		// before the flag was set are visible to the task scheduler woken up here.
+		if (header.IsSignalled.exchange(0, std::memory_order_seq_cst) != 0)
+		{
+			const auto signal = m_signal.load(std::memory_order_acquire);
+			if (signal)
+			{
+				signal->Signal();
+			}
+		}
+
+		for (const auto& reader : m_readers)
+		{
+			reader->Reclaim();
+		}
+	}
+}
+
+const std::shared_ptr<ShmIngestChannelManager::StreamReader>*
+ShmIngestChannelManager::
+findStream(const boost::uuids::uuid& channelId, uint32_t sourceId) const
+{
+	for (const auto& reader : m_readers)
+	{
+		if (reader->IsStream(channelId, sourceId))
+		{
+			return &reader;
+		}
+	}
+	return nullptr;
+}
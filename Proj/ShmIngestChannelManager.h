@@ -0,0 +1,125 @@
+///
+/// @class ShmIngestChannelManager
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ChannelManager.h"
+#include "ShmIngestRing.h"
+
+namespace CvRtsp
+{
+	///
+	/// Channel manager fed by another process through a shared memory region (ShmIngestRing),
+	/// so that a crash of the producer does not take the server down and vice versa.
+	///
+	/// The media samples handed out borrow the frame data in the ring: nothing is copied on the way
+	/// in, the ring space of a frame is given back to the producer once its sample is released.
+	/// Samples must therefore not be kept for long, see MediaSample::IsBorrowed(). Streams are found
+	/// by channel id and source id, media queue handles are not supported.
+	///
+	/// A thread waits for the producers' event and raises the media arrival signal of the task
+	/// scheduler, it also frees the streams the producers have closed.
+	class ShmIngestChannelManager : public ChannelManager
+	{
+	public:
+		/// Default size of a stream's ring.
+		static const uint32_t DefaultRingSize = 16 * 1024 * 1024;
+
+		///
+		/// Constructor, creates the region or attaches to the one left by a previous server.
+		///
+		/// @param[in] regionName	Name of the region and prefix of its event, e.g. "Local\\CvRtspIngest".
+		/// @param[in] streamCount	Number of streams.
+		/// @param[in] ringSize		Size of every stream's ring, rounded up to the record alignment.
+		ShmIngestChannelManager(const std::string& regionName, uint32_t streamCount, uint32_t ringSize = DefaultRingSize);
+
+		///
+		/// Destructor, stops the thread. The region stays mapped until the last sample is released.
+		~ShmIngestChannelManager() override;
+
+		ShmIngestChannelManager(const ShmIngestChannelManager&) = delete;
+		ShmIngestChannelManager& operator=(const ShmIngestChannelManager&) = delete;
+
+		///
+		/// Has the region been set up.
+		///
+		/// @return True if media can be received.
+		bool IsValid() const
+		{
+			return m_region != nullptr;
+		}
+
+		///
+		/// Get media.
+		///
+		/// @param channelId	Unique channel id.
+		/// @param channelName	Channel name.
+		/// @param sourceId		Source id.
+		///
+		/// @return Media sample borrowing the ring, nullptr if there is none.
+		std::shared_ptr<MediaSample> GetMedia(const boost::uuids::uuid& channelId, const std::string& channelName,
+			uint32_t sourceId) override;
+
+		///
+		/// Get up to maxCount media samples with a single stream lookup.
+		///
+		/// @param channelId	Unique channel id.
+		/// @param channelName	Channel name.
+		/// @param sourceId		Source id.
+		/// @param mediaSamples	Receives the samples, room for maxCount.
+		/// @param maxCount		Maximum number of samples.
+		///
+		/// @return Number of samples returned.
+		size_t GetMediaBatch(const boost::uuids::uuid& channelId, const std::string& channelName,
+			uint32_t sourceId, std::shared_ptr<MediaSample>* mediaSamples, size_t maxCount) override;
+
+		///
+		/// Set the signal raised when producers publish frames.
+		///
+		/// @param[in] mediaArrivalSignal Signal of the task scheduler, nullptr to detach.
+		void SetMediaArrivalSignal(MediaArrivalSignal* mediaArrivalSignal) override;
+
+	private:
+		class Region;
+		class StreamReader;
+
+		/// Mapped region, shared with the samples borrowing it, nullptr if it could not be set up.
+		std::shared_ptr<Region> m_region;
+
+		/// Reader per stream, shared with the samples borrowing its ring.
+		std::vector<std::shared_ptr<StreamReader>> m_readers;
+
+		/// Event that signals new records.
+		void* m_event;
+
+		/// Signal of the task scheduler, read by m_thread.
+		std::atomic<MediaArrivalSignal*> m_signal;
+
+		/// False once the thread must stop.
+		std::atomic<bool> m_isRunning;
+
+		/// Waits for new records and frees closed streams.
+		std::thread m_thread;
+
+		///
+		/// Thread function.
+		void run();
+
+		///
+		/// Get the reader of an open stream.
+		///
+		/// @param[in] channelId	Channel id.
+		/// @param[in] sourceId		Source id.
+		///
+		/// @return Reader, nullptr if there is no such stream.
+		const std::shared_ptr<StreamReader>* findStream(const boost::uuids::uuid& channelId, uint32_t sourceId) const;
+	};
+}
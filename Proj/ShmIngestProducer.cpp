@@ -0,0 +1,195 @@
+///
+/// @class ShmIngestProducer
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "ShmIngestProducer.h"
+
+using namespace CvRtsp;
+using namespace CvRtsp::ShmIngestRing;
+
+ShmIngestProducer::
+ShmIngestProducer() :
+	m_mapping(nullptr),
+	m_event(nullptr),
+	m_region(nullptr)
+{
+}
+
+ShmIngestProducer::
+~ShmIngestProducer()
+{
+	close();
+}
+
+bool
+ShmIngestProducer::
+Open(const std::string& regionName)
+{
+	close();
+
+	m_mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, regionName.c_str());
+	if (!m_mapping)
+	{
+		log_rtsp_warning("ShmIngestProducer: region " + regionName + " does not exist.");
+		return false;
+	}
+	m_region = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	m_event = OpenEventA(EVENT_MODIFY_STATE, FALSE, GetEventName(regionName).c_str());
+	if (!m_region || !m_event)
+	{
+		log_rtsp_error("ShmIngestProducer: unable to attach to region " + regionName + ", error "
+			+ std::to_string(GetLastError()) + ".");
+		close();
+		return false;
+	}
+
+	const auto& header = *static_cast<const Header*>(m_region);
+	if (header.Magic.load(std::memory_order_acquire) != ShmIngestRing::Magic || header.Version != ShmIngestRing::Version)
+	{
+		log_rtsp_error("ShmIngestProducer: region " + regionName + " is incompatible.");
+		close();
+		return false;
+	}
+	return true;
+}
+
+int
+ShmIngestProducer::
+OpenStream(const boost::uuids::uuid& channelId, const std::string& channelName, uint32_t sourceId)
+{
+	if (!m_region)
+	{
+		return -1;
+	}
+
+	const auto streamCount = static_cast<const Header*>(m_region)->StreamCount;
+	for (uint32_t streamIndex = 0; streamIndex < streamCount; ++streamIndex)
+	{
+		auto& stream = GetStream(m_region, streamIndex);
+		if (stream.State.load(std::memory_order_acquire) == StreamOpen && stream.SourceId == sourceId
+			&& memcmp(stream.ChannelId, channelId.data, sizeof(stream.ChannelId)) == 0)
+		{
+			return static_cast<int>(streamIndex);
+		}
+	}
+
+	for (uint32_t streamIndex = 0; streamIndex < streamCount; ++streamIndex)
+	{
+		auto& stream = GetStream(m_region, streamIndex);
+		auto state = static_cast<uint32_t>(StreamFree);
+		if (!stream.State.compare_exchange_strong(state, StreamClaimed, std::memory_order_acquire))
+		{
+			continue;
+		}
+
+		stream.SourceId = sourceId;
+		memcpy(stream.ChannelId, channelId.data, sizeof(stream.ChannelId));
+		const auto nameLength = channelName.size() < MaxChannelNameLength ? channelName.size() : MaxChannelNameLength - 1;
+		memcpy(stream.ChannelName, channelName.data(), nameLength);
+		stream.ChannelName[nameLength] = '\0';
+		stream.WriteIndex.store(0, std::memory_order_relaxed);
+		stream.DroppedCount.store(0, std::memory_order_relaxed);
+		stream.ReleaseIndex.store(0, std::memory_order_relaxed);
+		stream.State.store(StreamOpen, std::memory_order_release);
+		return static_cast<int>(streamIndex);
+	}
+
+	log_rtsp_warning("ShmIngestProducer: no stream available for " + channelName + ".");
+	return -1;
+}
+
+void
+ShmIngestProducer::
+CloseStream(int streamIndex)
+{
+	if (m_region && streamIndex >= 0)
+	{
+		GetStream(m_region, static_cast<uint32_t>(streamIndex)).State.store(StreamClosing, std::memory_order_release);
+	}
+}
+
+bool
+ShmIngestProducer::
+Push(int streamIndex, const uint8_t* data, uint32_t size, double startTime, bool isKeyFrame)
+{
+	assert(m_region && streamIndex >= 0);
+
+	const auto ringSize = static_cast<const Header*>(m_region)->RingSize;
+	auto& stream = GetStream(m_region, static_cast<uint32_t>(streamIndex));
+	auto ring = GetRing(m_region, static_cast<uint32_t>(streamIndex));
+
+	const auto recordSize = (sizeof(Record) + static_cast<uint64_t>(size) + RecordAlignment - 1) & ~static_cast<uint64_t>(RecordAlignment - 1);
+	const auto writeIndex = stream.WriteIndex.load(std::memory_order_relaxed);
+	const auto offset = static_cast<uint32_t>(writeIndex % ringSize);
+	const auto paddingSize = ringSize - offset < recordSize ? ringSize - offset : 0;
+	if (recordSize > ringSize / 2
+		|| writeIndex + paddingSize + recordSize - stream.ReleaseIndex.load(std::memory_order_acquire) > ringSize)
+	{
+		stream.DroppedCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	auto record = reinterpret_cast<Record*>(ring + offset);
+	if (paddingSize != 0)
+	{
+		record->Size = paddingSize;
+		record->DataSize = 0;
+		record->Flags = Padding;
+		record = reinterpret_cast<Record*>(ring);
+	}
+	record->Size = static_cast<uint32_t>(recordSize);
+	record->DataSize = size;
+	record->StartTime = startTime;
+	record->ArrivalTime = std::chrono::steady_clock::now().time_since_epoch().count();
+	record->Flags = isKeyFrame ? KeyFrame : 0;
+	memcpy(record + 1, data, size);
+	stream.WriteIndex.store(writeIndex + paddingSize + recordSize, std::memory_order_release);
+
+	// Sequentially consistent, so that the consumer that clears the flag sees the record.
+	auto& header = *static_cast<Header*>(m_region);
+	if (header.IsSignalled.exchange(1, std::memory_order_seq_cst) == 0)
+	{
+		SetEvent(m_event);
+	}
+	return true;
+}
+
+uint64_t
+ShmIngestProducer::
+GetDroppedCount(int streamIndex) const
+{
+	if (!m_region || streamIndex < 0)
+	{
+		return 0;
+	}
+	return GetStream(m_region, static_cast<uint32_t>(streamIndex)).DroppedCount.load(std::memory_order_relaxed);
+}
+
+void
+ShmIngestProducer::
+close()
+{
+	if (m_region)
+	{
+		UnmapViewOfFile(m_region);
+		m_region = nullptr;
+	}
+	if (m_event)
+	{
+		CloseHandle(m_event);
+		m_event = nullptr;
+	}
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+}
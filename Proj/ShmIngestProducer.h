@@ -0,0 +1,96 @@
+///
+/// @class ShmIngestProducer
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <boost/uuid/uuid.hpp>
+
+#include "ShmIngestRing.h"
+
+namespace CvRtsp
+{
+	///
+	/// Producer side of the shared memory ingest region (ShmIngestRing), used by processes that
+	/// hand frames to a server running a ShmIngestChannelManager. Frames are copied into the ring
+	/// once, the server delivers them from there.
+	///
+	/// Each stream must only be written by one thread at a time. A frame that does not fit into its
+	/// ring because the server is behind (or not running) is dropped and counted.
+	class ShmIngestProducer
+	{
+	public:
+		///
+		/// Constructor, does not attach to a region.
+		ShmIngestProducer();
+
+		///
+		/// Destructor, detaches from the region, the streams stay open.
+		~ShmIngestProducer();
+
+		ShmIngestProducer(const ShmIngestProducer&) = delete;
+		ShmIngestProducer& operator=(const ShmIngestProducer&) = delete;
+
+		///
+		/// Attach to a region created by the server.
+		///
+		/// @param[in] regionName Name of the region.
+		///
+		/// @return False if the region does not exist or is incompatible.
+		bool Open(const std::string& regionName);
+
+		///
+		/// Open a stream for the frames of a channel's source. A stream left open by a previous
+		/// producer for the same channel and source is taken over.
+		///
+		/// @param[in] channelId	Channel id.
+		/// @param[in] channelName	Channel name, truncated to fit.
+		/// @param[in] sourceId		Source id.
+		///
+		/// @return Stream index, negative if no stream is available.
+		int OpenStream(const boost::uuids::uuid& channelId, const std::string& channelName, uint32_t sourceId);
+
+		///
+		/// Close a stream, the server frees it once the frames it still delivers are released.
+		///
+		/// @param[in] streamIndex Stream index returned by OpenStream().
+		void CloseStream(int streamIndex);
+
+		///
+		/// Publish a frame.
+		///
+		/// @param[in] streamIndex	Stream index returned by OpenStream().
+		/// @param[in] data			Frame data.
+		/// @param[in] size			Frame size.
+		/// @param[in] startTime	Media start time.
+		/// @param[in] isKeyFrame	True if the frame is a keyframe.
+		///
+		/// @return False if the frame has been dropped.
+		bool Push(int streamIndex, const uint8_t* data, uint32_t size, double startTime, bool isKeyFrame);
+
+		///
+		/// Get the number of frames dropped on a stream, by this and previous producers.
+		///
+		/// @param[in] streamIndex Stream index returned by OpenStream().
+		///
+		/// @return Dropped frames.
+		uint64_t GetDroppedCount(int streamIndex) const;
+
+	private:
+		/// File mapping of the region.
+		void* m_mapping;
+
+		/// Event that signals new records.
+		void* m_event;
+
+		/// Mapped region, nullptr if not attached.
+		void* m_region;
+
+		///
+		/// Detach from the region.
+		void close();
+	};
+}
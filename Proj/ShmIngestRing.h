@@ -0,0 +1,184 @@
+///
+/// @class ShmIngestRing
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace CvRtsp
+{
+	///
+	/// Layout of the shared memory region through which a producer process hands frames to the
+	/// server process (ShmIngestProducer, ShmIngestChannelManager).
+	///
+	/// The region holds a header, a control block per stream and a byte ring per stream. Every
+	/// stream (a video or audio source of a channel) is a single producer, single consumer ring of
+	/// variable size records: the producer publishes records by advancing WriteIndex, the consumer
+	/// hands them out in place and advances ReleaseIndex once they are no longer referenced. The
+	/// indices only grow, the offset in the ring is the index modulo the ring size. A record never
+	/// wraps: if it does not fit at the end of the ring, the rest of the ring is filled with a
+	/// padding record. Producers signal new records with a named event, only if no wakeup is
+	/// pending already.
+	///
+	/// The region is created by the consumer, which outlives producers: a restarted producer
+	/// reattaches to its open streams, a restarted consumer continues at ReleaseIndex.
+	namespace ShmIngestRing
+	{
+		/// Identifies an initialized region.
+		static const uint32_t Magic = 0x52534D43;
+
+		/// Layout version, incremented on incompatible changes.
+		static const uint32_t Version = 1;
+
+		/// Alignment of the records and of the ring sizes.
+		static const uint32_t RecordAlignment = 32;
+
+		/// Maximum length of a channel name, including the terminating zero.
+		static const size_t MaxChannelNameLength = 64;
+
+		/// Stream states.
+		enum StreamState : uint32_t
+		{
+			/// Not used, can be claimed by a producer.
+			StreamFree = 0,
+			/// Being set up by a producer.
+			StreamClaimed = 1,
+			/// Carrying frames.
+			StreamOpen = 2,
+			/// Closed by the producer, freed by the consumer once it has released all records.
+			StreamClosing = 3
+		};
+
+		/// Record flags.
+		enum RecordFlags : uint32_t
+		{
+			/// The frame is a keyframe.
+			KeyFrame = 1,
+			/// The record only fills the end of the ring.
+			Padding = 2
+		};
+
+		/// Region header.
+		struct Header
+		{
+			/// Magic, written last when the region is initialized.
+			std::atomic<uint32_t> Magic;
+
+			/// Layout version.
+			uint32_t Version;
+
+			/// Number of streams.
+			uint32_t StreamCount;
+
+			/// Size of every stream's ring.
+			uint32_t RingSize;
+
+			/// A wakeup is pending, producers only set the event when it is not.
+			alignas(64) std::atomic<uint32_t> IsSignalled;
+		};
+
+		/// Control block of a stream.
+		struct Stream
+		{
+			/// StreamState.
+			alignas(64) std::atomic<uint32_t> State;
+
+			/// Source id of the frames.
+			uint32_t SourceId;
+
+			/// Channel id of the frames.
+			uint8_t ChannelId[16];
+
+			/// Channel name, zero terminated.
+			char ChannelName[MaxChannelNameLength];
+
+			/// Index after the last published record, written by the producer.
+			alignas(64) std::atomic<uint64_t> WriteIndex;
+
+			/// Frames dropped because the ring was full, written by the producer.
+			std::atomic<uint64_t> DroppedCount;
+
+			/// Index after the last released record, written by the consumer.
+			alignas(64) std::atomic<uint64_t> ReleaseIndex;
+		};
+
+		/// Record header, followed by the frame data.
+		struct Record
+		{
+			/// Size of the record including the header, a multiple of RecordAlignment.
+			uint32_t Size;
+
+			/// Size of the frame data.
+			uint32_t DataSize;
+
+			/// Media start time of the frame.
+			double StartTime;
+
+			/// Time the producer published the frame, steady clock ticks.
+			int64_t ArrivalTime;
+
+			/// RecordFlags.
+			uint32_t Flags;
+
+			/// Unused.
+			uint32_t Reserved;
+		};
+
+		static_assert(sizeof(Record) == RecordAlignment, "Record headers must keep the records aligned.");
+		static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+			"Atomics shared between processes must be lock free.");
+
+		///
+		/// Get the size of the region.
+		///
+		/// @param[in] streamCount	Number of streams.
+		/// @param[in] ringSize		Size of every stream's ring.
+		///
+		/// @return Bytes.
+		inline uint64_t GetRegionSize(uint32_t streamCount, uint32_t ringSize)
+		{
+			return sizeof(Header) + static_cast<uint64_t>(streamCount) * (sizeof(Stream) + ringSize);
+		}
+
+		///
+		/// Get a stream's control block.
+		///
+		/// @param[in] region		Mapped region.
+		/// @param[in] streamIndex	Stream index.
+		///
+		/// @return Control block.
+		inline Stream& GetStream(void* region, uint32_t streamIndex)
+		{
+			return reinterpret_cast<Stream*>(static_cast<uint8_t*>(region) + sizeof(Header))[streamIndex];
+		}
+
+		///
+		/// Get a stream's ring.
+		///
+		/// @param[in] region		Mapped region.
+		/// @param[in] streamIndex	Stream index.
+		///
+		/// @return First byte of the ring.
+		inline uint8_t* GetRing(void* region, uint32_t streamIndex)
+		{
+			const auto& header = *static_cast<const Header*>(region);
+			return static_cast<uint8_t*>(region) + sizeof(Header) + header.StreamCount * sizeof(Stream)
+				+ static_cast<uint64_t>(streamIndex) * header.RingSize;
+		}
+
+		///
+		/// Get the name of the event that signals new records.
+		///
+		/// @param[in] regionName Name of the region.
+		///
+		/// @return Event name.
+		inline std::string GetEventName(const std::string& regionName)
+		{
+			return regionName + "-ready";
+		}
+	}
+}
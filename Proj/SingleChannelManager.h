@@ -127,6 +127,23 @@ namespace CvRtsp
 			return nullptr;
 		}
 
+		///
+		/// Report the number of consumers of the video or audio source to the packet manager.
+		///
+		/// @param[in]	channelId		Unique channel id.
+		/// @param[in]	channelName		Channel name.
+		/// @param[in]	sourceId		Source id.
+		/// @param[in]	watcherCount	Number of consumers.
+		void SetWatcherCount(const boost::uuids::uuid& channelId, const std::string& /*channelName*/,
+			uint32_t sourceId, uint32_t watcherCount) override
+		{
+			assert(channelId == m_channelId);
+			if (sourceId == m_videoSourceId || sourceId == m_audioSourceId)
+			{
+				m_packetManager.SetWatcherCount(sourceId == m_videoSourceId, watcherCount);
+			}
+		}
+
 	protected:
 		/// Packet manager.
 		PacketManagerMediaChannel m_packetManager;
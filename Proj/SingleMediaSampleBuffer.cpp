@@ -9,6 +9,7 @@ SingleMediaSampleBuffer::
 SingleMediaSampleBuffer(unsigned maxFrameSize) :
 	m_currentBufferSize(maxFrameSize),
 	m_buffer(std::make_unique<BYTE[]>(maxFrameSize)),
+	m_borrowedData(nullptr),
 	m_size(0),
 	m_currentChannel(0),
 	m_startTime(0.0)
@@ -35,6 +36,7 @@ AddMediaSample(const std::shared_ptr<MediaSample>& mediaSample)
 {
 	const auto mediaData = mediaSample->GetDataBuffer().Data();
 
+	m_borrowedData = nullptr;
 	m_startTime = mediaSample->StartTime();
 	// Grow buffer if too small
 	m_size = mediaSample->GetSize();
@@ -72,10 +74,23 @@ GetCurrentStartTime()
 	return m_startTime;
 }
 
+void
+SingleMediaSampleBuffer::
+SetBorrowedFrame(BYTE* data, unsigned size, double startTime)
+{
+	m_borrowedData = data;
+	m_size = size;
+	m_startTime = startTime;
+}
+
 BYTE*
 SingleMediaSampleBuffer::
 GetCurrentBuffer()
 {
+	if (m_borrowedData)
+	{
+		return m_borrowedData;
+	}
 	if (m_buffer)
 	{
 		return m_buffer.get();
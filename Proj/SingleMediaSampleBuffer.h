@@ -65,6 +65,14 @@ namespace CvRtsp
 		/// @note This method should copy the media sample in the buffers according to the media type.
 		void AddMediaSample(const std::shared_ptr<MediaSample>& mediaSample) override;
 
+		///
+		/// Overridden from IMediaSampleBuffer to point at the caller's frame instead of copying it.
+		///
+		/// @param[in] data			Frame data, valid until the next frame is added.
+		/// @param[in] size			Frame size.
+		/// @param[in] startTime	Frame start time.
+		void SetBorrowedFrame(BYTE* data, unsigned size, double startTime) override;
+
 		///
 		/// Overridden from IMediaSampleBuffer to get number of channels, for this
 		/// implementation the value should always be 1.
@@ -103,6 +111,9 @@ namespace CvRtsp
 		/// Data buffer.
 		DataBuffer m_buffer;
 
+		/// Frame set with SetBorrowedFrame(), not owned, nullptr if the current frame is in m_buffer.
+		BYTE* m_borrowedData;
+
 		/// Media sample size.
 		unsigned m_size;
 
@@ -0,0 +1,358 @@
+///
+/// @class SocketEventPoller
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <cerrno>
+#include <chrono>
+#include <thread>
+
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "SocketEventPoller.h"
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace CvRtsp;
+
+/// Initial number of events taken per epoll_wait(), grown while steps fill it up.
+static const size_t InitialEventCount = 256;
+
+#if defined(_WIN32)
+/// Map live555 socket conditions to WSAPoll() events. WSAPoll() rejects POLLPRI, out-of-band
+/// data is reported as POLLRDBAND.
+static SHORT
+toPollEvents(int conditionSet)
+{
+	SHORT events = 0;
+	if (conditionSet & SOCKET_READABLE)
+	{
+		events |= POLLRDNORM;
+	}
+	if (conditionSet & SOCKET_WRITABLE)
+	{
+		events |= POLLWRNORM;
+	}
+	if (conditionSet & SOCKET_EXCEPTION)
+	{
+		events |= POLLRDBAND;
+	}
+	return events;
+}
+
+/// Map WSAPoll() results to live555 socket conditions. Errors and hangups are reported the way
+/// select() reports them, as readable and writable, so that the handler sees the error.
+static int
+toConditionSet(SHORT revents)
+{
+	auto conditionSet = 0;
+	if (revents & POLLRDNORM)
+	{
+		conditionSet |= SOCKET_READABLE;
+	}
+	if (revents & POLLWRNORM)
+	{
+		conditionSet |= SOCKET_WRITABLE;
+	}
+	if (revents & POLLRDBAND)
+	{
+		conditionSet |= SOCKET_EXCEPTION;
+	}
+	if (revents & (POLLERR | POLLHUP | POLLNVAL))
+	{
+		conditionSet |= SOCKET_READABLE | SOCKET_WRITABLE;
+	}
+	return conditionSet;
+}
+#else
+/// Map live555 socket conditions to epoll events.
+static uint32_t
+toPollEvents(int conditionSet)
+{
+	uint32_t events = 0;
+	if (conditionSet & SOCKET_READABLE)
+	{
+		events |= EPOLLIN;
+	}
+	if (conditionSet & SOCKET_WRITABLE)
+	{
+		events |= EPOLLOUT;
+	}
+	if (conditionSet & SOCKET_EXCEPTION)
+	{
+		events |= EPOLLPRI;
+	}
+	return events;
+}
+
+/// Map epoll events to live555 socket conditions. Errors and hangups are reported the way
+/// select() reports them, as readable and writable, so that the handler sees the error.
+static int
+toConditionSet(uint32_t events)
+{
+	auto conditionSet = 0;
+	if (events & EPOLLIN)
+	{
+		conditionSet |= SOCKET_READABLE;
+	}
+	if (events & EPOLLOUT)
+	{
+		conditionSet |= SOCKET_WRITABLE;
+	}
+	if (events & EPOLLPRI)
+	{
+		conditionSet |= SOCKET_EXCEPTION;
+	}
+	if (events & (EPOLLERR | EPOLLHUP))
+	{
+		conditionSet |= SOCKET_READABLE | SOCKET_WRITABLE;
+	}
+	return conditionSet;
+}
+#endif
+
+SocketEventPoller::
+SocketEventPoller()
+#if !defined(_WIN32)
+	: m_epollFd(epoll_create1(EPOLL_CLOEXEC)),
+	m_events(InitialEventCount)
+#endif
+{
+#if !defined(_WIN32)
+	if (m_epollFd < 0)
+	{
+		log_rtsp_error("SocketEventPoller: unable to create epoll instance");
+	}
+#endif
+}
+
+SocketEventPoller::
+~SocketEventPoller()
+{
+#if !defined(_WIN32)
+	if (m_epollFd >= 0)
+	{
+		close(m_epollFd);
+	}
+#endif
+}
+
+bool
+SocketEventPoller::
+IsValid() const
+{
+#if defined(_WIN32)
+	return true;
+#else
+	return m_epollFd >= 0;
+#endif
+}
+
+void
+SocketEventPoller::
+SetHandler(int socketNum, int conditionSet, TaskScheduler::BackgroundHandlerProc* handlerProc, void* clientData)
+{
+	if (socketNum < 0)
+	{
+		return;
+	}
+
+	auto it = m_handlers.find(socketNum);
+	if (conditionSet == 0 || handlerProc == nullptr)
+	{
+		if (it != m_handlers.end())
+		{
+			unwatch(socketNum, it->second);
+			m_handlers.erase(it);
+		}
+		return;
+	}
+
+	const auto isNew = it == m_handlers.end();
+	if (isNew)
+	{
+		it = m_handlers.emplace(socketNum, Handler()).first;
+	}
+
+	auto& handler = it->second;
+	handler.ConditionSet = conditionSet;
+	handler.HandlerProc = handlerProc;
+	handler.ClientData = clientData;
+	watch(socketNum, handler, isNew);
+}
+
+void
+SocketEventPoller::
+MoveHandler(int oldSocketNum, int newSocketNum)
+{
+	if (oldSocketNum < 0 || newSocketNum < 0 || oldSocketNum == newSocketNum)
+	{
+		return;
+	}
+
+	const auto it = m_handlers.find(oldSocketNum);
+	if (it == m_handlers.end())
+	{
+		return;
+	}
+
+	const auto handler = it->second;
+	unwatch(oldSocketNum, handler);
+	m_handlers.erase(it);
+	SetHandler(newSocketNum, handler.ConditionSet, handler.HandlerProc, handler.ClientData);
+}
+
+unsigned
+SocketEventPoller::
+Poll(unsigned maxDelayTimeMicroSec)
+{
+	// Rounded up: a wait rounded down to 0 returns right away and the caller spins until it is over.
+	// 1 us, what the scheduler passes while work is pending, only handles the sockets that are ready.
+	const auto timeoutMilliSec = maxDelayTimeMicroSec == 0 ? -1
+		: maxDelayTimeMicroSec == 1 ? 0
+		: static_cast<int>(maxDelayTimeMicroSec / 1000 + (maxDelayTimeMicroSec % 1000 != 0 ? 1 : 0));
+	wait(timeoutMilliSec);
+
+	// Handlers may remove any handler, look each one up again before calling it.
+	unsigned handlerCount = 0;
+	for (const auto& readySocket : m_readySockets)
+	{
+		const auto it = m_handlers.find(readySocket.SocketNum);
+		if (it == m_handlers.end())
+		{
+			continue;
+		}
+
+		const auto conditionSet = readySocket.ConditionSet & it->second.ConditionSet;
+		if (conditionSet != 0)
+		{
+			(*it->second.HandlerProc)(it->second.ClientData, conditionSet);
+			++handlerCount;
+		}
+	}
+
+	return handlerCount;
+}
+
+#if defined(_WIN32)
+void
+SocketEventPoller::
+watch(int socketNum, Handler& handler, bool isNew)
+{
+	if (isNew)
+	{
+		handler.PollIndex = m_pollFds.size();
+		WSAPOLLFD pollFd {};
+		pollFd.fd = static_cast<SOCKET>(socketNum);
+		m_pollFds.push_back(pollFd);
+	}
+	m_pollFds[handler.PollIndex].events = toPollEvents(handler.ConditionSet);
+}
+
+void
+SocketEventPoller::
+unwatch(int /*socketNum*/, const Handler& handler)
+{
+	// Fill the gap with the last socket.
+	const auto lastIndex = m_pollFds.size() - 1;
+	if (handler.PollIndex != lastIndex)
+	{
+		m_pollFds[handler.PollIndex] = m_pollFds[lastIndex];
+		m_handlers[static_cast<int>(m_pollFds[handler.PollIndex].fd)].PollIndex = handler.PollIndex;
+	}
+	m_pollFds.pop_back();
+}
+
+void
+SocketEventPoller::
+wait(int timeoutMilliSec)
+{
+	m_readySockets.clear();
+
+	// WSAPoll() fails without sockets.
+	if (m_pollFds.empty())
+	{
+		if (timeoutMilliSec > 0)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMilliSec));
+		}
+		return;
+	}
+
+	const auto result = WSAPoll(m_pollFds.data(), static_cast<ULONG>(m_pollFds.size()), timeoutMilliSec);
+	if (result == SOCKET_ERROR)
+	{
+		log_rtsp_error("SocketEventPoller: WSAPoll failed with error " + std::to_string(WSAGetLastError()));
+		return;
+	}
+
+	for (size_t index = 0; index < m_pollFds.size() && m_readySockets.size() < static_cast<size_t>(result); ++index)
+	{
+		const auto conditionSet = toConditionSet(m_pollFds[index].revents);
+		if (conditionSet != 0)
+		{
+			m_readySockets.push_back({ static_cast<int>(m_pollFds[index].fd), conditionSet });
+		}
+	}
+}
+#else
+void
+SocketEventPoller::
+watch(int socketNum, Handler& handler, bool isNew)
+{
+	struct epoll_event event {};
+	event.events = toPollEvents(handler.ConditionSet);
+	event.data.fd = socketNum;
+	auto result = epoll_ctl(m_epollFd, isNew ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, socketNum, &event);
+	if (result != 0 && !isNew && errno == ENOENT)
+	{
+		// The socket was closed and its number reused without unwatching, closing dropped it from the epoll set.
+		result = epoll_ctl(m_epollFd, EPOLL_CTL_ADD, socketNum, &event);
+	}
+	if (result != 0)
+	{
+		log_rtsp_error("SocketEventPoller: unable to watch socket " + std::to_string(socketNum)
+			+ ", error " + std::to_string(errno));
+	}
+}
+
+void
+SocketEventPoller::
+unwatch(int socketNum, const Handler& /*handler*/)
+{
+	// Fails harmlessly if the socket has been closed already, closing removes it from the epoll set.
+	epoll_ctl(m_epollFd, EPOLL_CTL_DEL, socketNum, nullptr);
+}
+
+void
+SocketEventPoller::
+wait(int timeoutMilliSec)
+{
+	m_readySockets.clear();
+
+	const auto result = epoll_wait(m_epollFd, m_events.data(), static_cast<int>(m_events.size()), timeoutMilliSec);
+	if (result < 0)
+	{
+		if (errno != EINTR)
+		{
+			log_rtsp_error("SocketEventPoller: epoll_wait failed with error " + std::to_string(errno));
+		}
+		return;
+	}
+
+	for (auto index = 0; index < result; ++index)
+	{
+		m_readySockets.push_back({ m_events[index].data.fd, toConditionSet(m_events[index].events) });
+	}
+
+	// Sockets left over are reported again by the next step, take more events next time.
+	if (static_cast<size_t>(result) == m_events.size() && m_events.size() < m_handlers.size())
+	{
+		m_events.resize(m_events.size() * 2);
+	}
+}
+#endif
@@ -0,0 +1,149 @@
+///
+/// @class SocketEventPoller
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <live555/NetCommon.h>
+#include <live555/UsageEnvironment.hh>
+
+#if !defined(_WIN32)
+#include <sys/epoll.h>
+#endif
+
+namespace CvRtsp
+{
+	///
+	/// Socket handler set of the task scheduler that is waited on with epoll (WSAPoll on Windows)
+	/// instead of select().
+	///
+	/// select() copies and scans an fd_set of all sockets on every step, is limited to FD_SETSIZE
+	/// sockets and BasicTaskScheduler calls a single handler per step. The poller has no socket
+	/// limit, epoll only reports the sockets that are ready and all ready handlers are called
+	/// per step. Sockets are watched level-triggered: live555 handlers read one packet per call
+	/// and rely on being called again while data is left.
+	class SocketEventPoller
+	{
+	public:
+		///
+		/// Constructor, creates the epoll instance.
+		SocketEventPoller();
+
+		///
+		/// Destructor.
+		~SocketEventPoller();
+
+		SocketEventPoller(const SocketEventPoller&) = delete;
+		SocketEventPoller& operator=(const SocketEventPoller&) = delete;
+
+		///
+		/// Can the poller be used.
+		///
+		/// @return False if the epoll instance could not be created.
+		bool IsValid() const;
+
+		///
+		/// Set, change or remove the handler of a socket.
+		///
+		/// @param[in] socketNum	Socket.
+		/// @param[in] conditionSet	SOCKET_READABLE, SOCKET_WRITABLE and/or SOCKET_EXCEPTION, 0 removes the handler.
+		/// @param[in] handlerProc	Handler, nullptr removes the handler.
+		/// @param[in] clientData	Handler argument.
+		void SetHandler(int socketNum, int conditionSet, TaskScheduler::BackgroundHandlerProc* handlerProc,
+			void* clientData);
+
+		///
+		/// Move the handler of a socket to another socket.
+		///
+		/// @param[in] oldSocketNum Socket the handler is set for.
+		/// @param[in] newSocketNum Socket the handler is moved to.
+		void MoveHandler(int oldSocketNum, int newSocketNum);
+
+		///
+		/// Wait for socket events and call the handlers of all sockets that are ready.
+		/// Handlers may set or remove handlers, including their own.
+		///
+		/// @param[in] maxDelayTimeMicroSec Maximum wait time in microseconds, 0 for no limit. The wait
+		/// has millisecond resolution and is rounded up, 1 only handles sockets that are ready.
+		///
+		/// @return Number of handlers called.
+		unsigned Poll(unsigned maxDelayTimeMicroSec);
+
+		///
+		/// Number of sockets watched.
+		///
+		/// @return Number of handlers set.
+		size_t GetHandlerCount() const
+		{
+			return m_handlers.size();
+		}
+
+	private:
+		/// Handler of a socket.
+		struct Handler
+		{
+			/// Conditions the handler is called for.
+			int ConditionSet;
+
+			/// Handler function.
+			TaskScheduler::BackgroundHandlerProc* HandlerProc;
+
+			/// Handler argument.
+			void* ClientData;
+
+#if defined(_WIN32)
+			/// Index of the socket in m_pollFds.
+			size_t PollIndex;
+#endif
+		};
+
+		/// Socket ready in the current step.
+		struct ReadySocket
+		{
+			/// Socket.
+			int SocketNum;
+
+			/// SOCKET_READABLE, SOCKET_WRITABLE and/or SOCKET_EXCEPTION.
+			int ConditionSet;
+		};
+
+		/// Handlers by socket.
+		std::unordered_map<int, Handler> m_handlers;
+
+		/// Sockets ready in the current step, reused to avoid allocating per step.
+		std::vector<ReadySocket> m_readySockets;
+
+#if defined(_WIN32)
+		/// Sockets passed to WSAPoll(), in no particular order.
+		std::vector<WSAPOLLFD> m_pollFds;
+#else
+		/// epoll instance.
+		int m_epollFd;
+
+		/// Events returned by epoll_wait().
+		std::vector<struct epoll_event> m_events;
+#endif
+
+		/// Add the socket to or update it in the wait set.
+		///
+		/// @param[in] socketNum	Socket.
+		/// @param[in] handler		Handler of the socket.
+		/// @param[in] isNew		True if the socket is not in the wait set yet.
+		void watch(int socketNum, Handler& handler, bool isNew);
+
+		/// Remove the socket from the wait set.
+		///
+		/// @param[in] socketNum	Socket.
+		/// @param[in] handler		Handler of the socket.
+		void unwatch(int socketNum, const Handler& handler);
+
+		/// Wait for the sockets in the wait set and fill m_readySockets.
+		///
+		/// @param[in] timeoutMilliSec Timeout in milliseconds, -1 for no limit.
+		void wait(int timeoutMilliSec);
+	};
+}
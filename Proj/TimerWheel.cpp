@@ -0,0 +1,347 @@
+///
+/// @class TimerWheel
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <cassert>
+
+#include "TimerWheel.h"
+
+using namespace CvRtsp;
+
+/// Split of a token into timer index (low half) and generation (high half).
+static const unsigned TokenIndexBits = sizeof(uintptr_t) * 4;
+static const uintptr_t TokenIndexMask = (static_cast<uintptr_t>(1) << TokenIndexBits) - 1;
+
+/// Initialise a list sentinel.
+template <typename T>
+static void initList(T& sentinel)
+{
+	sentinel.Prev = &sentinel;
+	sentinel.Next = &sentinel;
+}
+
+TimerWheel::
+TimerWheel(int64_t nowMicroSec, int64_t resolutionMicroSec) :
+	m_resolutionMicroSec(resolutionMicroSec > 0 ? resolutionMicroSec : 1),
+	m_nextTick(0),
+	m_timerCount(0)
+{
+	m_nextTick = toTick(nowMicroSec);
+	for (auto& level : m_slots)
+	{
+		for (auto& slot : level)
+		{
+			initList(slot);
+		}
+	}
+	initList(m_due);
+	m_level0Occupancy.fill(0);
+}
+
+uint64_t
+TimerWheel::
+toTick(int64_t microSec) const
+{
+	return microSec > 0 ? static_cast<uint64_t>((microSec + m_resolutionMicroSec - 1) / m_resolutionMicroSec) : 0;
+}
+
+void*
+TimerWheel::
+toToken(const Timer& timer)
+{
+	// Index 0 is reserved for the null token.
+	return reinterpret_cast<void*>((static_cast<uintptr_t>(timer.Generation) << TokenIndexBits) | (timer.Index + 1));
+}
+
+TimerWheel::Timer*
+TimerWheel::
+fromToken(void* token)
+{
+	const auto value = reinterpret_cast<uintptr_t>(token);
+	const auto index = value & TokenIndexMask;
+	if (index == 0 || index > m_timers.size())
+	{
+		return nullptr;
+	}
+
+	auto& timer = m_timers[index - 1];
+	const auto generation = static_cast<uint32_t>(value >> TokenIndexBits);
+	if (timer.Level == FreeLevel || static_cast<uintptr_t>(timer.Generation) != generation)
+	{
+		return nullptr;
+	}
+	return &timer;
+}
+
+TimerWheel::Timer*
+TimerWheel::
+allocate()
+{
+	Timer* timer = nullptr;
+	if (!m_freeTimers.empty())
+	{
+		timer = &m_timers[m_freeTimers.back()];
+		m_freeTimers.pop_back();
+	}
+	else
+	{
+		assert(m_timers.size() < TokenIndexMask);
+		m_timers.emplace_back();
+		timer = &m_timers.back();
+		timer->Index = static_cast<uint32_t>(m_timers.size() - 1);
+	}
+
+	++m_timerCount;
+	return timer;
+}
+
+void
+TimerWheel::
+release(Timer* timer)
+{
+	// Bumping the generation invalidates all tokens handed out for the timer.
+	++timer->Generation;
+	timer->Level = FreeLevel;
+	timer->Prev = nullptr;
+	timer->Next = nullptr;
+	m_freeTimers.push_back(timer->Index);
+	--m_timerCount;
+}
+
+void
+TimerWheel::
+insert(Timer* timer)
+{
+	Timer* list = nullptr;
+	if (timer->ExpiryTick < m_nextTick)
+	{
+		timer->Level = DueLevel;
+		list = &m_due;
+	}
+	else
+	{
+		// Beyond the range of the top level the timer is parked in its last slot and cascaded again.
+		const auto maxDelta = (static_cast<uint64_t>(1) << (SlotBits * LevelCount)) - 1;
+		if (timer->ExpiryTick - m_nextTick > maxDelta)
+		{
+			timer->ExpiryTick = m_nextTick + maxDelta;
+		}
+
+		const auto delta = timer->ExpiryTick - m_nextTick;
+		unsigned level = 0;
+		while (level + 1 < LevelCount && delta >= (static_cast<uint64_t>(1) << (SlotBits * (level + 1))))
+		{
+			++level;
+		}
+
+		timer->Level = static_cast<int>(level);
+		timer->Slot = static_cast<unsigned>((timer->ExpiryTick >> (SlotBits * level)) & SlotMask);
+		list = &m_slots[level][timer->Slot];
+		if (level == 0)
+		{
+			m_level0Occupancy[timer->Slot / 64] |= static_cast<uint64_t>(1) << (timer->Slot % 64);
+		}
+	}
+
+	timer->Prev = list->Prev;
+	timer->Next = list;
+	list->Prev->Next = timer;
+	list->Prev = timer;
+}
+
+void
+TimerWheel::
+unlink(Timer* timer)
+{
+	if (timer->Level == ExpiringLevel)
+	{
+		// Collected by Expire(), not on a list any more.
+		return;
+	}
+
+	timer->Prev->Next = timer->Next;
+	timer->Next->Prev = timer->Prev;
+	if (timer->Level == 0)
+	{
+		const auto& slot = m_slots[0][timer->Slot];
+		if (slot.Next == &slot)
+		{
+			m_level0Occupancy[timer->Slot / 64] &= ~(static_cast<uint64_t>(1) << (timer->Slot % 64));
+		}
+	}
+}
+
+void*
+TimerWheel::
+Schedule(int64_t nowMicroSec, int64_t delayMicroSec, TimerFunc* proc, void* clientData)
+{
+	const auto timer = allocate();
+	timer->Proc = proc;
+	timer->ClientData = clientData;
+	timer->ExpiryTick = toTick(nowMicroSec + (delayMicroSec > 0 ? delayMicroSec : 0));
+	insert(timer);
+	return toToken(*timer);
+}
+
+void
+TimerWheel::
+Reschedule(void*& token, int64_t nowMicroSec, int64_t delayMicroSec, TimerFunc* proc, void* clientData)
+{
+	const auto timer = fromToken(token);
+	if (!timer)
+	{
+		token = Schedule(nowMicroSec, delayMicroSec, proc, clientData);
+		return;
+	}
+
+	// Move the timer in place, the token stays valid.
+	unlink(timer);
+	timer->Proc = proc;
+	timer->ClientData = clientData;
+	timer->ExpiryTick = toTick(nowMicroSec + (delayMicroSec > 0 ? delayMicroSec : 0));
+	insert(timer);
+}
+
+bool
+TimerWheel::
+Unschedule(void* token)
+{
+	const auto timer = fromToken(token);
+	if (!timer)
+	{
+		return false;
+	}
+
+	unlink(timer);
+	release(timer);
+	return true;
+}
+
+int64_t
+TimerWheel::
+TimeToNextExpiry(int64_t nowMicroSec) const
+{
+	if (m_due.Next != &m_due)
+	{
+		return 0;
+	}
+
+	if (m_timerCount == 0)
+	{
+		return -1;
+	}
+
+	// Level 0 holds the timers due within the next 256 ticks, find the first occupied slot before
+	// the next cascade: that may bring timers down from the higher levels that are due earlier.
+	auto nextTick = (m_nextTick + SlotMask) & ~SlotMask;
+	for (auto tick = m_nextTick; tick < nextTick; ++tick)
+	{
+		const auto slot = static_cast<unsigned>(tick & SlotMask);
+		if (m_level0Occupancy[slot / 64] & (static_cast<uint64_t>(1) << (slot % 64)))
+		{
+			nextTick = tick;
+			break;
+		}
+		if (m_level0Occupancy[slot / 64] == 0)
+		{
+			// Skip the rest of an empty word.
+			tick += 63 - slot % 64;
+		}
+	}
+
+	const auto timeToNextTick = static_cast<int64_t>(nextTick) * m_resolutionMicroSec - nowMicroSec;
+	return timeToNextTick > 0 ? timeToNextTick : 0;
+}
+
+void
+TimerWheel::
+cascade(unsigned level, unsigned slot)
+{
+	auto& list = m_slots[level][slot];
+	auto timer = list.Next;
+	initList(list);
+
+	while (timer != &list)
+	{
+		const auto next = timer->Next;
+		insert(timer);
+		timer = next;
+	}
+}
+
+void
+TimerWheel::
+collect(Timer& list)
+{
+	for (auto timer = list.Next; timer != &list; timer = timer->Next)
+	{
+		timer->Level = ExpiringLevel;
+		m_expired.push_back(timer);
+	}
+	initList(list);
+}
+
+size_t
+TimerWheel::
+Expire(int64_t nowMicroSec)
+{
+	// Timers that were due when scheduled go first.
+	collect(m_due);
+
+	// Fire the timers whose expiry tick has been reached, i.e. tick * resolution <= now.
+	const auto nowTick = nowMicroSec >= 0 ? static_cast<uint64_t>(nowMicroSec / m_resolutionMicroSec) : 0;
+	if (m_timerCount == m_expired.size() && m_nextTick <= nowTick)
+	{
+		// Nothing left on the wheel, skip the idle ticks.
+		m_nextTick = nowTick + 1;
+	}
+
+	while (m_nextTick <= nowTick)
+	{
+		// Cascade from the top when the lower levels wrap.
+		const auto slot = static_cast<unsigned>(m_nextTick & SlotMask);
+		if (slot == 0)
+		{
+			for (unsigned level = 1; level < LevelCount; ++level)
+			{
+				const auto levelSlot = static_cast<unsigned>((m_nextTick >> (SlotBits * level)) & SlotMask);
+				cascade(level, levelSlot);
+				if (levelSlot != 0)
+				{
+					break;
+				}
+			}
+		}
+
+		auto& list = m_slots[0][slot];
+		if (list.Next != &list)
+		{
+			collect(list);
+			m_level0Occupancy[slot / 64] &= ~(static_cast<uint64_t>(1) << (slot % 64));
+		}
+		++m_nextTick;
+	}
+
+	// Callbacks may cancel or reschedule timers that are about to fire, those are skipped.
+	size_t fired = 0;
+	for (size_t index = 0; index < m_expired.size(); ++index)
+	{
+		const auto timer = m_expired[index];
+		if (timer->Level != ExpiringLevel)
+		{
+			continue;
+		}
+
+		const auto proc = timer->Proc;
+		const auto clientData = timer->ClientData;
+		release(timer);
+		proc(clientData);
+		++fired;
+	}
+	m_expired.clear();
+
+	return fired;
+}
@@ -0,0 +1,192 @@
+///
+/// @class TimerWheel
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace CvRtsp
+{
+	///
+	/// Hierarchical timer wheel with O(1) schedule, unschedule and reschedule.
+	///
+	/// Four levels of 256 slots, level 0 holds the timers due within 256 ticks, each higher level
+	/// covers 256 times the range of the one below and is cascaded down when the lower level wraps.
+	/// Timers fire at the first tick at or after their expiry time, timers that are due when they
+	/// are scheduled fire with the next call to Expire().
+	///
+	/// Tokens carry a generation count, so unscheduling a timer that has fired already is harmless,
+	/// as with live555's delay queue. Not thread-safe, used from the event loop thread only.
+	class TimerWheel
+	{
+	public:
+		/// Timer callback, same signature as live555's TaskFunc.
+		using TimerFunc = void(void* clientData);
+
+		/// Default tick length in microseconds.
+		static const int64_t DefaultResolutionMicroSec = 100;
+
+		///
+		/// Constructor.
+		///
+		/// @param[in] nowMicroSec Current time in microseconds.
+		/// @param[in] resolutionMicroSec Tick length in microseconds.
+		explicit TimerWheel(int64_t nowMicroSec, int64_t resolutionMicroSec = DefaultResolutionMicroSec);
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		///
+		/// Schedule a timer.
+		///
+		/// @param[in] nowMicroSec Current time in microseconds.
+		/// @param[in] delayMicroSec Delay in microseconds, negative delays are taken as 0.
+		/// @param[in] proc Callback.
+		/// @param[in] clientData Callback argument.
+		///
+		/// @return Token identifying the timer, never null.
+		void* Schedule(int64_t nowMicroSec, int64_t delayMicroSec, TimerFunc* proc, void* clientData);
+
+		///
+		/// Move a scheduled timer to a new expiry time, or schedule a new one if the token has fired
+		/// or is null.
+		///
+		/// @param[in,out] token Token of the timer, replaced by the token of the rescheduled timer.
+		/// @param[in] nowMicroSec Current time in microseconds.
+		/// @param[in] delayMicroSec Delay in microseconds.
+		/// @param[in] proc Callback.
+		/// @param[in] clientData Callback argument.
+		void Reschedule(void*& token, int64_t nowMicroSec, int64_t delayMicroSec, TimerFunc* proc, void* clientData);
+
+		///
+		/// Cancel a timer.
+		///
+		/// @param[in] token Token of the timer, may be null or refer to a timer that has fired.
+		///
+		/// @return True if a scheduled timer was cancelled.
+		bool Unschedule(void* token);
+
+		///
+		/// Time until the next timer may be due. Timers in the higher levels are only accounted for by
+		/// the next cascade, so the result may be earlier than the next expiry but never later.
+		///
+		/// @param[in] nowMicroSec Current time in microseconds.
+		///
+		/// @return Time in microseconds, 0 if timers are due, negative if no timers are scheduled.
+		int64_t TimeToNextExpiry(int64_t nowMicroSec) const;
+
+		///
+		/// Fire all timers that are due. Timers scheduled by the callbacks with no delay fire with
+		/// the next call, so a callback that keeps rescheduling itself cannot starve the event loop.
+		///
+		/// @param[in] nowMicroSec Current time in microseconds.
+		///
+		/// @return Number of timers fired.
+		size_t Expire(int64_t nowMicroSec);
+
+		///
+		/// Get the number of scheduled timers.
+		///
+		/// @return Number of timers.
+		size_t GetTimerCount() const
+		{
+			return m_timerCount;
+		}
+
+	private:
+		/// Number of levels and slots per level.
+		static const unsigned LevelCount = 4;
+		static const unsigned SlotBits = 8;
+		static const unsigned SlotCount = 1u << SlotBits;
+		static const uint64_t SlotMask = SlotCount - 1;
+
+		/// Timer states other than a wheel level.
+		static const int FreeLevel = -1;
+		static const int DueLevel = LevelCount;
+		static const int ExpiringLevel = LevelCount + 1;
+
+		/// Timer, also used as list sentinel.
+		struct Timer
+		{
+			Timer* Prev = nullptr;
+			Timer* Next = nullptr;
+			TimerFunc* Proc = nullptr;
+			void* ClientData = nullptr;
+			uint64_t ExpiryTick = 0;
+			uint32_t Generation = 0;
+			uint32_t Index = 0;
+			int Level = FreeLevel;
+			unsigned Slot = 0;
+		};
+
+		/// Tick length in microseconds.
+		int64_t m_resolutionMicroSec;
+
+		/// Next tick to be processed.
+		uint64_t m_nextTick;
+
+		/// Number of scheduled timers.
+		size_t m_timerCount;
+
+		/// Slot lists, each a circular list around its sentinel.
+		std::array<std::array<Timer, SlotCount>, LevelCount> m_slots;
+
+		/// Timers that are due and fire with the next Expire().
+		Timer m_due;
+
+		/// Occupancy of the level 0 slots.
+		std::array<uint64_t, SlotCount / 64> m_level0Occupancy;
+
+		/// Timer storage, a deque so that timers don't move when it grows.
+		std::deque<Timer> m_timers;
+
+		/// Indices of unused timers.
+		std::vector<uint32_t> m_freeTimers;
+
+		/// Timers fired by the current Expire(), reused to avoid allocating.
+		std::vector<Timer*> m_expired;
+
+		///
+		/// Convert a time to the first tick at or after it.
+		uint64_t toTick(int64_t microSec) const;
+
+		///
+		/// Look up the timer of a token.
+		///
+		/// @return Timer, nullptr if the token is null or stale.
+		Timer* fromToken(void* token);
+
+		///
+		/// Build the token of a timer.
+		static void* toToken(const Timer& timer);
+
+		///
+		/// Allocate an unused timer.
+		Timer* allocate();
+
+		///
+		/// Return a timer to the unused timers, invalidating its token.
+		void release(Timer* timer);
+
+		///
+		/// Insert a timer into the list that matches its expiry tick.
+		void insert(Timer* timer);
+
+		///
+		/// Remove a timer from its list.
+		void unlink(Timer* timer);
+
+		///
+		/// Re-insert the timers of a higher level slot into the levels below.
+		void cascade(unsigned level, unsigned slot);
+
+		///
+		/// Append the timers of a list to the expired timers and empty it.
+		void collect(Timer& list);
+	};
+}
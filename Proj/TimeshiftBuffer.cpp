@@ -0,0 +1,161 @@
+///
+/// @class TimeshiftBuffer
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "TimeshiftBuffer.h"
+
+using namespace CvRtsp;
+
+TimeshiftBuffer::
+TimeshiftBuffer(Clock::duration maxDuration, size_t maxBytes, bool isKeyFrameAware,
+	std::shared_ptr<TimeshiftMemoryBudget> memoryBudget) :
+	m_maxDuration(maxDuration),
+	m_maxBytes(maxBytes),
+	m_isKeyFrameAware(isKeyFrameAware),
+	m_memoryBudget(std::move(memoryBudget)),
+	m_firstPosition(0),
+	m_bytes(0),
+	m_isWaitingForKeyFrame(isKeyFrameAware)
+{
+	assert(m_memoryBudget);
+}
+
+TimeshiftBuffer::
+~TimeshiftBuffer()
+{
+	m_memoryBudget->Release(m_bytes);
+}
+
+bool
+TimeshiftBuffer::
+Append(const std::shared_ptr<MediaSample>& mediaSample, Clock::time_point now)
+{
+	const auto isRandomAccessPoint = !m_isKeyFrameAware || mediaSample->GetIsKeyFrame();
+	if (m_isWaitingForKeyFrame && !isRandomAccessPoint)
+	{
+		return false;
+	}
+
+	// Drop the GOPs that are older than the duration, as long as the remaining ones still cover it.
+	for (auto end = getSecondRandomAccessPosition(); end != GetEndPosition() && getTime(end) <= now - m_maxDuration;
+		end = getSecondRandomAccessPosition())
+	{
+		evictOldest();
+	}
+
+	const auto size = static_cast<size_t>(mediaSample->GetSize());
+	auto isReserved = size <= m_maxBytes;
+	while (isReserved && !m_entries.empty() && m_bytes + size > m_maxBytes)
+	{
+		evictOldest();
+	}
+	while (isReserved && !m_memoryBudget->TryReserve(size))
+	{
+		// Other channels hold the budget: give up this channel's history before its live edge.
+		isReserved = !m_entries.empty();
+		if (isReserved)
+		{
+			evictOldest();
+		}
+	}
+
+	// A delta frame whose GOP has been evicted cannot be played back.
+	if (isReserved && !isRandomAccessPoint && m_entries.empty())
+	{
+		m_memoryBudget->Release(size);
+		isReserved = false;
+	}
+
+	m_isWaitingForKeyFrame = !isReserved && m_isKeyFrameAware;
+	if (!isReserved)
+	{
+		return false;
+	}
+
+	if (m_isKeyFrameAware && isRandomAccessPoint)
+	{
+		m_keyFramePositions.push_back(GetEndPosition());
+	}
+	// Borrowed samples point into memory their owner wants back soon, the buffer keeps a copy.
+	m_entries.push_back({ mediaSample->IsBorrowed() ? std::make_shared<MediaSample>(*mediaSample) : mediaSample, now, size });
+	m_bytes += size;
+	return true;
+}
+
+uint64_t
+TimeshiftBuffer::
+Seek(Clock::time_point time) const
+{
+	if (m_entries.empty())
+	{
+		return GetEndPosition();
+	}
+
+	if (!m_isKeyFrameAware)
+	{
+		const auto entry = std::upper_bound(m_entries.begin(), m_entries.end(), time,
+			[](Clock::time_point value, const Entry& element) { return value < element.Time; });
+		return entry == m_entries.begin()
+			? m_firstPosition
+			: m_firstPosition + static_cast<uint64_t>(entry - m_entries.begin()) - 1;
+	}
+
+	// The buffer starts with a keyframe, so the GOP index is not empty.
+	const auto keyFrame = std::upper_bound(m_keyFramePositions.begin(), m_keyFramePositions.end(), time,
+		[this](Clock::time_point value, uint64_t position) { return value < getTime(position); });
+	return keyFrame == m_keyFramePositions.begin() ? m_keyFramePositions.front() : *(keyFrame - 1);
+}
+
+std::shared_ptr<MediaSample>
+TimeshiftBuffer::
+Read(uint64_t& position) const
+{
+	if (position < m_firstPosition)
+	{
+		position = m_firstPosition;
+	}
+
+	if (position >= GetEndPosition())
+	{
+		return nullptr;
+	}
+
+	return m_entries[static_cast<size_t>(position++ - m_firstPosition)].Sample;
+}
+
+uint64_t
+TimeshiftBuffer::
+getSecondRandomAccessPosition() const
+{
+	if (m_isKeyFrameAware)
+	{
+		return m_keyFramePositions.size() > 1 ? m_keyFramePositions[1] : GetEndPosition();
+	}
+	return m_entries.size() > 1 ? m_firstPosition + 1 : GetEndPosition();
+}
+
+void
+TimeshiftBuffer::
+evictOldest()
+{
+	const auto end = getSecondRandomAccessPosition();
+	size_t evictedBytes = 0;
+	for (; m_firstPosition < end; ++m_firstPosition)
+	{
+		evictedBytes += m_entries.front().Size;
+		m_entries.pop_front();
+	}
+
+	if (!m_keyFramePositions.empty())
+	{
+		m_keyFramePositions.pop_front();
+	}
+	m_bytes -= evictedBytes;
+	m_memoryBudget->Release(evictedBytes);
+}
@@ -0,0 +1,259 @@
+///
+/// @class TimeshiftBuffer
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "MediaSample.h"
+
+namespace CvRtsp
+{
+	///
+	/// Memory limit shared by the timeshift buffers of all channels. Thread safe, the buffers may
+	/// be filled on different event loops.
+	class TimeshiftMemoryBudget
+	{
+	public:
+		///
+		/// Constructor.
+		///
+		/// @param[in] maxBytes Maximum number of sample bytes held by all timeshift buffers.
+		explicit TimeshiftMemoryBudget(size_t maxBytes) :
+			m_maxBytes(maxBytes),
+			m_usedBytes(0)
+		{
+		}
+
+		TimeshiftMemoryBudget(const TimeshiftMemoryBudget&) = delete;
+		TimeshiftMemoryBudget& operator=(const TimeshiftMemoryBudget&) = delete;
+
+		///
+		/// Reserve memory for a sample.
+		///
+		/// @param[in] bytes Number of bytes.
+		///
+		/// @return False if the budget is exhausted, nothing has been reserved then.
+		bool TryReserve(size_t bytes)
+		{
+			auto usedBytes = m_usedBytes.load(std::memory_order_relaxed);
+			do
+			{
+				if (bytes > m_maxBytes || usedBytes > m_maxBytes - bytes)
+				{
+					return false;
+				}
+			} while (!m_usedBytes.compare_exchange_weak(usedBytes, usedBytes + bytes, std::memory_order_relaxed));
+			return true;
+		}
+
+		///
+		/// Release memory reserved with TryReserve().
+		///
+		/// @param[in] bytes Number of bytes.
+		void Release(size_t bytes)
+		{
+			m_usedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+		}
+
+		///
+		/// Get the number of bytes held by all timeshift buffers.
+		///
+		/// @return Used bytes.
+		size_t GetUsedBytes() const
+		{
+			return m_usedBytes.load(std::memory_order_relaxed);
+		}
+
+		///
+		/// Get the memory limit.
+		///
+		/// @return Maximum number of bytes.
+		size_t GetMaxBytes() const
+		{
+			return m_maxBytes;
+		}
+
+	private:
+		/// Maximum number of bytes.
+		const size_t m_maxBytes;
+
+		/// Bytes reserved by the timeshift buffers.
+		std::atomic<size_t> m_usedBytes;
+	};
+
+	///
+	/// In-memory timeshift ring of the most recent samples of a channel.
+	///
+	/// The buffer holds references to the ingested samples, so recording costs no copies, except
+	/// for borrowed samples (MediaSample::IsBorrowed()) whose memory is wanted back. Samples
+	/// are evicted a whole GOP at a time, so that the buffer always starts with a keyframe and
+	/// keeps at least the configured duration. Memory is bounded per buffer and by the shared
+	/// TimeshiftMemoryBudget: when either limit is reached the oldest GOPs are evicted first,
+	/// a sample that still does not fit is not recorded, nor are the delta frames up to the next
+	/// keyframe. Without keyframe awareness (audio) every sample is a random access point.
+	///
+	/// Samples are addressed by a position that increases with every sample recorded, so that
+	/// readers can keep a cursor across evictions. Not thread safe.
+	class TimeshiftBuffer
+	{
+	public:
+		/// Clock the samples are timestamped with on recording.
+		using Clock = std::chrono::steady_clock;
+
+		///
+		/// Constructor.
+		///
+		/// @param[in] maxDuration		Duration of media to keep.
+		/// @param[in] maxBytes			Maximum number of sample bytes in this buffer.
+		/// @param[in] isKeyFrameAware	True if the samples depend on the preceding keyframe (video).
+		/// @param[in] memoryBudget		Memory limit shared with the other buffers.
+		TimeshiftBuffer(Clock::duration maxDuration, size_t maxBytes, bool isKeyFrameAware,
+			std::shared_ptr<TimeshiftMemoryBudget> memoryBudget);
+
+		///
+		/// Destructor, returns the memory to the budget.
+		~TimeshiftBuffer();
+
+		TimeshiftBuffer(const TimeshiftBuffer&) = delete;
+		TimeshiftBuffer& operator=(const TimeshiftBuffer&) = delete;
+
+		///
+		/// Record a sample and evict the samples that have become older than the buffer's duration.
+		///
+		/// @param[in] mediaSample	Media sample.
+		/// @param[in] now			Recording time.
+		///
+		/// @return False if the sample has not been recorded.
+		bool Append(const std::shared_ptr<MediaSample>& mediaSample, Clock::time_point now);
+
+		///
+		/// Find the position to start playing from for a point in time: the nearest random access
+		/// point recorded at or before it, the oldest one if the time is older than the buffer.
+		///
+		/// @param[in] time Point in time.
+		///
+		/// @return Position, GetEndPosition() if the buffer is empty.
+		uint64_t Seek(Clock::time_point time) const;
+
+		///
+		/// Get the sample at a cursor and advance the cursor. A cursor whose sample has been
+		/// evicted continues at the oldest sample, which is a random access point.
+		///
+		/// @param[in,out] position Cursor.
+		///
+		/// @return Media sample, nullptr if the cursor has reached the end of the buffer.
+		std::shared_ptr<MediaSample> Read(uint64_t& position) const;
+
+		///
+		/// Get the position the next recorded sample will have.
+		///
+		/// @return End position.
+		uint64_t GetEndPosition() const
+		{
+			return m_firstPosition + m_entries.size();
+		}
+
+		///
+		/// Get the number of sample bytes held.
+		///
+		/// @return Bytes.
+		size_t GetBytes() const
+		{
+			return m_bytes;
+		}
+
+		///
+		/// Get the duration of media held.
+		///
+		/// @return Time between the oldest and the newest sample recorded.
+		Clock::duration GetDuration() const
+		{
+			return m_entries.empty() ? Clock::duration::zero() : m_entries.back().Time - m_entries.front().Time;
+		}
+
+		///
+		/// Get the recording time of the oldest sample.
+		///
+		/// @param[out] time Recording time.
+		///
+		/// @return False if the buffer is empty.
+		bool GetOldestTime(Clock::time_point& time) const
+		{
+			if (m_entries.empty())
+			{
+				return false;
+			}
+			time = m_entries.front().Time;
+			return true;
+		}
+
+	private:
+		/// Recorded sample.
+		struct Entry
+		{
+			/// Media sample.
+			std::shared_ptr<MediaSample> Sample;
+
+			/// Recording time.
+			Clock::time_point Time;
+
+			/// Bytes reserved for the sample.
+			size_t Size;
+		};
+
+		/// Duration of media to keep.
+		Clock::duration m_maxDuration;
+
+		/// Maximum number of sample bytes.
+		size_t m_maxBytes;
+
+		/// Samples depend on the preceding keyframe.
+		bool m_isKeyFrameAware;
+
+		/// Memory limit shared with the other buffers.
+		std::shared_ptr<TimeshiftMemoryBudget> m_memoryBudget;
+
+		/// Recorded samples, oldest first.
+		std::deque<Entry> m_entries;
+
+		/// Positions of the recorded keyframes (GOP index), only if keyframe aware.
+		std::deque<uint64_t> m_keyFramePositions;
+
+		/// Position of the oldest recorded sample.
+		uint64_t m_firstPosition;
+
+		/// Sample bytes held.
+		size_t m_bytes;
+
+		/// Delta frames are not recorded until the next keyframe.
+		bool m_isWaitingForKeyFrame;
+
+		///
+		/// Get the position of the second oldest random access point, where the oldest GOP ends.
+		///
+		/// @return Position, GetEndPosition() if the buffer holds a single GOP.
+		uint64_t getSecondRandomAccessPosition() const;
+
+		///
+		/// Evict the oldest GOP (the oldest sample without keyframe awareness).
+		void evictOldest();
+
+		///
+		/// Get the recording time of a sample.
+		///
+		/// @param[in] position Position of a recorded sample.
+		///
+		/// @return Recording time.
+		Clock::time_point getTime(uint64_t position) const
+		{
+			return m_entries[static_cast<size_t>(position - m_firstPosition)].Time;
+		}
+	};
+}
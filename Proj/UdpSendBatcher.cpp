@@ -0,0 +1,326 @@
+///
+/// @class UdpSendBatcher
+///
+/// Created 10/18/2026
+///
+#include "pch.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <rtsp-logger/RtspServerLogging.h>
+
+#include "UdpSendBatcher.h"
+
+#if !defined(_WIN32)
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+#endif
+
+using namespace CvRtsp;
+
+#if !defined(_WIN32)
+/// Words of a control buffer holding the UDP_SEGMENT size.
+static const size_t ControlWords = (CMSG_SPACE(sizeof(uint16_t)) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+/// Most messages per sendmmsg(), UIO_MAXIOV.
+static const size_t MaxMessagesPerCall = 1024;
+#endif
+
+/// Order destinations so that the datagrams to one destination are adjacent.
+static bool
+isBefore(const struct sockaddr_storage& address, SOCKLEN_T addressLength,
+	const struct sockaddr_storage& otherAddress, SOCKLEN_T otherAddressLength)
+{
+	if (addressLength != otherAddressLength)
+	{
+		return addressLength < otherAddressLength;
+	}
+	return memcmp(&address, &otherAddress, addressLength) < 0;
+}
+
+UdpSendBatcher::
+UdpSendBatcher() :
+	m_isSegmentationOffloadEnabled(true),
+	m_sendCallCount(0),
+	m_datagramCount(0)
+{
+	m_payload.reserve(MaxPendingBytes);
+	m_datagrams.reserve(MaxPendingDatagrams);
+}
+
+void
+UdpSendBatcher::
+Add(int socketNum, const struct sockaddr_storage& destination, const unsigned char* data, unsigned size)
+{
+	if (m_datagrams.size() >= MaxPendingDatagrams || m_payload.size() + size > MaxPendingBytes)
+	{
+		Flush();
+	}
+
+	Datagram datagram;
+	datagram.SocketNum = socketNum;
+	datagram.Destination = destination;
+	datagram.DestinationLength = destination.ss_family == AF_INET6
+		? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+	datagram.Offset = m_payload.size();
+	datagram.Size = size;
+	m_datagrams.push_back(datagram);
+	m_payload.insert(m_payload.end(), data, data + size);
+	++m_datagramCount;
+}
+
+void
+UdpSendBatcher::
+Flush()
+{
+	if (m_datagrams.empty())
+	{
+		return;
+	}
+
+	// Group by socket and destination, keeping the order in which the datagrams were added.
+	m_order.resize(m_datagrams.size());
+	for (size_t index = 0; index < m_order.size(); ++index)
+	{
+		m_order[index] = index;
+	}
+	std::stable_sort(m_order.begin(), m_order.end(), [this](size_t left, size_t right)
+	{
+		const auto& leftDatagram = m_datagrams[left];
+		const auto& rightDatagram = m_datagrams[right];
+		if (leftDatagram.SocketNum != rightDatagram.SocketNum)
+		{
+			return leftDatagram.SocketNum < rightDatagram.SocketNum;
+		}
+		return isBefore(leftDatagram.Destination, leftDatagram.DestinationLength,
+			rightDatagram.Destination, rightDatagram.DestinationLength);
+	});
+
+	size_t first = 0;
+	while (first < m_order.size())
+	{
+		const auto socketNum = m_datagrams[m_order[first]].SocketNum;
+		auto last = first + 1;
+		while (last < m_order.size() && m_datagrams[m_order[last]].SocketNum == socketNum)
+		{
+			++last;
+		}
+
+		buildRuns(first, last);
+		sendRuns(socketNum);
+		first = last;
+	}
+
+	m_datagrams.clear();
+	m_payload.clear();
+}
+
+void
+UdpSendBatcher::
+buildRuns(size_t first, size_t last)
+{
+	m_runs.clear();
+
+	auto index = first;
+	while (index < last)
+	{
+		const auto& head = m_datagrams[m_order[index]];
+		Run run { index, 1, head.Size };
+		auto runBytes = head.Size;
+
+		if (m_isSegmentationOffloadEnabled)
+		{
+			// Extend the run with datagrams of the same size to the same destination, a shorter
+			// datagram ends the run as its last segment.
+			while (index + run.Count < last && run.Count < MaxSegments)
+			{
+				const auto& next = m_datagrams[m_order[index + run.Count]];
+				if (next.Size > run.SegmentSize || next.Size == 0 || runBytes + next.Size > MaxSegmentedBytes
+					|| next.DestinationLength != head.DestinationLength
+					|| memcmp(&next.Destination, &head.Destination, head.DestinationLength) != 0)
+				{
+					break;
+				}
+
+				++run.Count;
+				runBytes += next.Size;
+				if (next.Size < run.SegmentSize)
+				{
+					break;
+				}
+			}
+		}
+
+		m_runs.push_back(run);
+		index += run.Count;
+	}
+}
+
+void
+UdpSendBatcher::
+sendDatagrams(int socketNum, const Run& run)
+{
+	for (size_t index = run.First; index < run.First + run.Count; ++index)
+	{
+		const auto& datagram = m_datagrams[m_order[index]];
+		sendto(socketNum, reinterpret_cast<const char*>(m_payload.data() + datagram.Offset), datagram.Size, 0,
+			reinterpret_cast<const struct sockaddr*>(&datagram.Destination), datagram.DestinationLength);
+		++m_sendCallCount;
+	}
+}
+
+#if defined(_WIN32)
+bool
+UdpSendBatcher::
+isSegmentationOffloadError(int error)
+{
+	return error == WSAEINVAL || error == WSAEOPNOTSUPP || error == WSAENOPROTOOPT;
+}
+
+void
+UdpSendBatcher::
+sendRuns(int socketNum)
+{
+	// Windows has no sendmmsg(), each run is one call.
+	for (const auto& run : m_runs)
+	{
+#if defined(UDP_SEND_MSG_SIZE)
+		if (run.Count > 1 && m_isSegmentationOffloadEnabled)
+		{
+			m_buffers.resize(run.Count);
+			for (size_t index = 0; index < run.Count; ++index)
+			{
+				const auto& datagram = m_datagrams[m_order[run.First + index]];
+				m_buffers[index].buf = reinterpret_cast<CHAR*>(m_payload.data() + datagram.Offset);
+				m_buffers[index].len = datagram.Size;
+			}
+
+			const auto& head = m_datagrams[m_order[run.First]];
+			alignas(WSACMSGHDR) CHAR control[WSA_CMSG_SPACE(sizeof(DWORD))] = {};
+			WSAMSG message {};
+			message.name = const_cast<LPSOCKADDR>(reinterpret_cast<const struct sockaddr*>(&head.Destination));
+			message.namelen = head.DestinationLength;
+			message.lpBuffers = m_buffers.data();
+			message.dwBufferCount = static_cast<DWORD>(run.Count);
+			message.Control.buf = control;
+			message.Control.len = sizeof(control);
+
+			const auto controlHeader = WSA_CMSG_FIRSTHDR(&message);
+			controlHeader->cmsg_level = IPPROTO_UDP;
+			controlHeader->cmsg_type = UDP_SEND_MSG_SIZE;
+			controlHeader->cmsg_len = WSA_CMSG_LEN(sizeof(DWORD));
+			*reinterpret_cast<DWORD*>(WSA_CMSG_DATA(controlHeader)) = run.SegmentSize;
+
+			DWORD bytesSent = 0;
+			++m_sendCallCount;
+			if (WSASendMsg(static_cast<SOCKET>(socketNum), &message, 0, &bytesSent, nullptr, nullptr) != SOCKET_ERROR)
+			{
+				continue;
+			}
+
+			const auto error = WSAGetLastError();
+			if (!isSegmentationOffloadError(error))
+			{
+				// E.g. the send buffer is full, the run is dropped like a single datagram would be.
+				continue;
+			}
+
+			log_rtsp_warning("UdpSendBatcher: UDP segmentation offload unavailable (error "
+				+ std::to_string(error) + "), sending datagrams one by one");
+			m_isSegmentationOffloadEnabled = false;
+		}
+#endif
+		sendDatagrams(socketNum, run);
+	}
+}
+#else
+bool
+UdpSendBatcher::
+isSegmentationOffloadError(int error)
+{
+	// EIO: the device cannot checksum segmented datagrams, EINVAL/ENOPROTOOPT: no UDP_SEGMENT support.
+	return error == EIO || error == EINVAL || error == ENOPROTOOPT;
+}
+
+void
+UdpSendBatcher::
+sendRuns(int socketNum)
+{
+	size_t datagramCount = 0;
+	for (const auto& run : m_runs)
+	{
+		datagramCount += run.Count;
+	}
+
+	// Sized up front, the messages point into these.
+	m_messages.assign(m_runs.size(), mmsghdr());
+	m_buffers.resize(datagramCount);
+	m_controls.assign(m_runs.size() * ControlWords, 0);
+
+	size_t bufferIndex = 0;
+	for (size_t runIndex = 0; runIndex < m_runs.size(); ++runIndex)
+	{
+		const auto& run = m_runs[runIndex];
+		const auto& head = m_datagrams[m_order[run.First]];
+		for (size_t index = 0; index < run.Count; ++index)
+		{
+			const auto& datagram = m_datagrams[m_order[run.First + index]];
+			m_buffers[bufferIndex + index].iov_base = m_payload.data() + datagram.Offset;
+			m_buffers[bufferIndex + index].iov_len = datagram.Size;
+		}
+
+		auto& message = m_messages[runIndex].msg_hdr;
+		message.msg_name = const_cast<struct sockaddr_storage*>(&head.Destination);
+		message.msg_namelen = head.DestinationLength;
+		message.msg_iov = &m_buffers[bufferIndex];
+		message.msg_iovlen = run.Count;
+		if (run.Count > 1)
+		{
+			message.msg_control = &m_controls[runIndex * ControlWords];
+			message.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+			const auto controlHeader = CMSG_FIRSTHDR(&message);
+			controlHeader->cmsg_level = SOL_UDP;
+			controlHeader->cmsg_type = UDP_SEGMENT;
+			controlHeader->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+			const auto segmentSize = static_cast<uint16_t>(run.SegmentSize);
+			memcpy(CMSG_DATA(controlHeader), &segmentSize, sizeof(segmentSize));
+		}
+		bufferIndex += run.Count;
+	}
+
+	size_t sent = 0;
+	while (sent < m_messages.size())
+	{
+		const auto count = m_messages.size() - sent < MaxMessagesPerCall ? m_messages.size() - sent : MaxMessagesPerCall;
+		++m_sendCallCount;
+		const auto result = sendmmsg(socketNum, &m_messages[sent], static_cast<unsigned>(count), 0);
+		if (result > 0)
+		{
+			sent += result;
+			continue;
+		}
+
+		// The message at 'sent' failed.
+		const auto error = errno;
+		if (m_runs[sent].Count > 1 && isSegmentationOffloadError(error))
+		{
+			if (m_isSegmentationOffloadEnabled)
+			{
+				log_rtsp_warning("UdpSendBatcher: UDP segmentation offload unavailable (error "
+					+ std::to_string(error) + "), sending datagrams one by one");
+				m_isSegmentationOffloadEnabled = false;
+			}
+			sendDatagrams(socketNum, m_runs[sent]);
+		}
+
+		// Otherwise, e.g. the send buffer is full, the message is dropped like a single datagram would be.
+		++sent;
+	}
+}
+#endif
@@ -0,0 +1,193 @@
+///
+/// @class UdpSendBatcher
+///
+/// Created 10/18/2026
+///
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <live555/NetCommon.h>
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#endif
+
+namespace CvRtsp
+{
+	///
+	/// Collects the UDP datagrams sent during an event loop iteration and sends them per socket in
+	/// as few system calls as possible.
+	///
+	/// Runs of equally sized datagrams to the same destination (the packets of a video frame, the
+	/// last one may be shorter) are sent as one segmented datagram: UDP_SEGMENT (GSO) on Linux,
+	/// UDP_SEND_MSG_SIZE (USO) on Windows. On Linux all messages of a socket are sent with a single
+	/// sendmmsg(). If the stack rejects segmentation offload it is turned off and datagrams are sent
+	/// one by one.
+	///
+	/// Not thread-safe, owned by the event loop.
+	class UdpSendBatcher
+	{
+	public:
+		/// Datagrams collected before they are sent regardless of the event loop.
+		static const size_t MaxPendingDatagrams = 8192;
+
+		/// Payload collected before it is sent regardless of the event loop.
+		static const size_t MaxPendingBytes = 12 * 1024 * 1024;
+
+		/// Most segments the stack accepts per segmented datagram.
+		static const unsigned MaxSegments = 64;
+
+		/// Most payload per segmented datagram, the limit of a single UDP datagram.
+		static const unsigned MaxSegmentedBytes = 65507;
+
+		///
+		/// Constructor.
+		UdpSendBatcher();
+
+		UdpSendBatcher(const UdpSendBatcher&) = delete;
+		UdpSendBatcher& operator=(const UdpSendBatcher&) = delete;
+
+		///
+		/// Queue a datagram, the data is copied.
+		///
+		/// @param[in] socketNum	Socket to send from.
+		/// @param[in] destination	Destination address and port.
+		/// @param[in] data			Datagram.
+		/// @param[in] size			Datagram size.
+		void Add(int socketNum, const struct sockaddr_storage& destination, const unsigned char* data, unsigned size);
+
+		///
+		/// Send all queued datagrams.
+		void Flush();
+
+		///
+		/// Are datagrams queued.
+		///
+		/// @return True if Flush() has something to send.
+		bool HasPending() const
+		{
+			return !m_datagrams.empty();
+		}
+
+		///
+		/// Enable or disable segmentation offload (enabled by default).
+		///
+		/// @param[in] isEnabled True to send runs of datagrams as segmented datagrams.
+		void SetSegmentationOffload(bool isEnabled)
+		{
+			m_isSegmentationOffloadEnabled = isEnabled;
+		}
+
+		///
+		/// Number of send system calls made.
+		///
+		/// @return Send calls since construction.
+		uint64_t GetSendCallCount() const
+		{
+			return m_sendCallCount;
+		}
+
+		///
+		/// Number of datagrams queued.
+		///
+		/// @return Datagrams since construction.
+		uint64_t GetDatagramCount() const
+		{
+			return m_datagramCount;
+		}
+
+	private:
+		/// Queued datagram.
+		struct Datagram
+		{
+			/// Socket to send from.
+			int SocketNum;
+
+			/// Destination address and port.
+			struct sockaddr_storage Destination;
+
+			/// Size of the destination address.
+			SOCKLEN_T DestinationLength;
+
+			/// Offset of the datagram in m_payload.
+			size_t Offset;
+
+			/// Datagram size.
+			unsigned Size;
+		};
+
+		/// Datagrams sent as one message: one datagram, or a run of datagrams sent with segmentation offload.
+		struct Run
+		{
+			/// Index of the first datagram in m_order.
+			size_t First;
+
+			/// Number of datagrams.
+			size_t Count;
+
+			/// Size of all but the last datagram.
+			unsigned SegmentSize;
+		};
+
+		/// Payload of the queued datagrams.
+		std::vector<unsigned char> m_payload;
+
+		/// Queued datagrams, in the order they were added.
+		std::vector<Datagram> m_datagrams;
+
+		/// Datagram indices grouped by socket and destination, in the order they were added.
+		std::vector<size_t> m_order;
+
+		/// Runs of the socket being sent.
+		std::vector<Run> m_runs;
+
+#if defined(_WIN32)
+		/// Datagram buffers of a run.
+		std::vector<WSABUF> m_buffers;
+#else
+		/// Messages passed to sendmmsg().
+		std::vector<struct mmsghdr> m_messages;
+
+		/// Datagram buffers of the messages.
+		std::vector<struct iovec> m_buffers;
+
+		/// Segmentation control messages, one per run.
+		std::vector<uint64_t> m_controls;
+#endif
+
+		/// Send runs with segmentation offload.
+		bool m_isSegmentationOffloadEnabled;
+
+		/// Number of send system calls made.
+		uint64_t m_sendCallCount;
+
+		/// Number of datagrams queued.
+		uint64_t m_datagramCount;
+
+		/// Split the datagrams of a socket into runs.
+		///
+		/// @param[in] first	Index of the socket's first datagram in m_order.
+		/// @param[in] last		Index past the socket's last datagram in m_order.
+		void buildRuns(size_t first, size_t last);
+
+		/// Send the runs of a socket.
+		///
+		/// @param[in] socketNum Socket.
+		void sendRuns(int socketNum);
+
+		/// Send the datagrams of a run one by one.
+		///
+		/// @param[in] socketNum	Socket.
+		/// @param[in] run			Run.
+		void sendDatagrams(int socketNum, const Run& run);
+
+		/// Is the error a rejection of segmentation offload.
+		///
+		/// @param[in] error Socket error.
+		///
+		/// @return True if the run should be sent without segmentation offload.
+		static bool isSegmentationOffloadError(int error);
+	};
+}
@@ -19,6 +19,8 @@ along with this library; if not, write to the Free Software Foundation, Inc.,
 #pragma once
 
 #include <cstdint>
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -70,11 +72,36 @@ namespace CvRtsp
 		/// h265 video parameter set
 		std::string vps;
 
+#pragma region H.264 bitstream filters, run once per frame on ingest
+
+		/// Remove access unit delimiters
+		bool StripAccessUnitDelimiters;
+
+		/// Remove filler data
+		bool StripFillerData;
+
+		/// Remove SEI nal units
+		bool StripSei;
+
+		/// SEI payload types that are kept if StripSei is set, e.g. 5 for user data unregistered
+		std::set<unsigned> SeiPayloadTypesToKeep;
+
+		/// Insert the last seen SPS and PPS (initially Sps and Pps) in front of IDR frames without them
+		bool InsertParameterSets;
+
+		/// New nal_ref_idc by nal unit type
+		std::map<unsigned, unsigned> NalRefIdcRewrites;
+#pragma endregion
+
 		/// Constructor
 		VideoChannelDescriptor() :
 			Width(0),
 			Height(0),
-			InitialChannel(0)
+			InitialChannel(0),
+			StripAccessUnitDelimiters(false),
+			StripFillerData(false),
+			StripSei(false),
+			InsertParameterSets(false)
 		{
 		}
 	};